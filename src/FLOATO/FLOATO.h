@@ -0,0 +1,582 @@
+#pragma once
+
+// FLOATO -- turning floating point exceptions on/off for the whole project (Linux/x86-64, glibc).
+//
+// Two ways of catching NaN/overflow/division by zero without hand-written checks after every operation:
+// - trapping: unmasked exceptions raise SIGFPE on the offending instruction (ScopedTraps, SetThreadDefault,
+//   EnableForProcess), the installed handler reports the faulting instruction and either aborts or masks
+//   the exception and lets the program continue,
+// - sticky flags only: nothing traps, the accumulated status flags are tested once per batch (StickyCheck),
+//   which costs two instructions per check and keeps the compiler free to vectorize the numeric code.
+// Everything here compiles to no-ops unless __DEBUG_CHECK_FLOAT_EXCEPTIONS is defined, the same way INTO's
+// checks are controlled by __DEBUG_CHECK_INTEGER_OVERFLOW. Defining __DEBUG_CHECK_FLOAT_EXCEPTIONS_AT_STARTUP as
+// well enables DEFAULT_TRAPS on the main thread before main() runs, so every thread created later inherits them.
+// The denormal controls (FTZ/DAZ) are not debugging aids but performance settings, so they are always active.
+
+#include <cfenv>
+#include <cstdint>
+#include <cstring>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+#if defined(__linux__) && defined(__x86_64__)
+#define FLOATO_LINUX_X86_64
+#include <csignal>
+#include <cstdlib>
+#include <execinfo.h>
+#include <signal.h>
+#include <ucontext.h>
+#include <unistd.h>
+#include <xmmintrin.h>
+#endif
+
+namespace FLOATO {
+
+#ifdef __DEBUG_CHECK_FLOAT_EXCEPTIONS
+constexpr bool FLOATO_ACTIVE = true;
+#else
+constexpr bool FLOATO_ACTIVE = false;
+#endif
+
+// values are the <cfenv> FE_* bits, which on x86 coincide with the MXCSR status flag bits
+enum FPException : int {
+	Invalid = FE_INVALID,
+	DivByZero = FE_DIVBYZERO,
+	Overflow = FE_OVERFLOW,
+	Underflow = FE_UNDERFLOW,
+	Inexact = FE_INEXACT,
+	AllExceptions = FE_ALL_EXCEPT
+};
+
+constexpr int DEFAULT_TRAPS = Invalid | DivByZero | Overflow;		// NaN, inf from finite operands, x/0
+
+class FLOATO_exception : public std::runtime_error {
+public:
+	FLOATO_exception(const std::string& message, int raised) :
+		std::runtime_error(message), m_raised(raised) {}
+	int Raised() const { return m_raised; }
+private:
+	int m_raised;
+};
+
+inline std::string DescribeExceptions(int mask)
+{
+	std::string retval;
+	auto add = [&](int bit, const char* name) { if (mask & bit) { if (!retval.empty()) retval += "|"; retval += name; } };
+	add(Invalid, "invalid");
+	add(DivByZero, "divbyzero");
+	add(Overflow, "overflow");
+	add(Underflow, "underflow");
+	add(Inexact, "inexact");
+	return retval.empty() ? "none" : retval;
+}
+
+namespace details {
+
+#ifdef FLOATO_LINUX_X86_64
+constexpr unsigned MXCSR_MASK_SHIFT = 7;							// exception mask bits sit 7 bits above the status flags
+#endif
+
+inline std::atomic<int>& ProcessDefault()
+{
+	static std::atomic<int> mask{ 0 };
+	return mask;
+}
+
+inline int& ThreadDefault()
+{
+	static thread_local int mask = -1;								// -1: follow the process default
+	return mask;
+}
+
+// feenableexcept/fedisableexcept set both the x87 control word and MXCSR; traps are per thread
+inline void SetTrapMask(int mask)
+{
+#ifdef FLOATO_LINUX_X86_64
+	std::feclearexcept(FE_ALL_EXCEPT);								// a pending x87 flag would trap on the next x87 instruction
+	fedisableexcept(FE_ALL_EXCEPT & ~mask);
+	if (mask)
+		feenableexcept(mask);
+#else
+	(void)mask;
+#endif
+}
+
+inline int GetTrapMask()
+{
+#ifdef FLOATO_LINUX_X86_64
+	return fegetexcept();
+#else
+	return 0;
+#endif
+}
+
+} // namespace details
+
+// Currently unmasked (trapping) exceptions of the calling thread.
+inline int GetEnabledTraps()
+{
+	return details::GetTrapMask();
+}
+
+// Process-wide default: applied to the calling thread immediately, and to any thread calling ApplyThreadDefault()
+// that has no thread default of its own. Threads created afterwards inherit the creator's settings anyway (glibc).
+inline void EnableForProcess(int mask = DEFAULT_TRAPS)
+{
+	if constexpr (FLOATO_ACTIVE)
+	{
+		details::ProcessDefault().store(mask, std::memory_order_relaxed);
+		details::SetTrapMask(mask);
+	}
+}
+
+// Per-thread default, e.g. for worker threads of a pool that run only numeric kernels. Applied immediately.
+inline void SetThreadDefault(int mask)
+{
+	if constexpr (FLOATO_ACTIVE)
+	{
+		details::ThreadDefault() = mask;
+		details::SetTrapMask(mask);
+	}
+}
+
+inline int GetThreadDefault()
+{
+	const int threadMask = details::ThreadDefault();
+	return threadMask >= 0 ? threadMask : details::ProcessDefault().load(std::memory_order_relaxed);
+}
+
+// to be called at thread start by thread pools that don't create their threads from a configured thread
+inline void ApplyThreadDefault()
+{
+	if constexpr (FLOATO_ACTIVE)
+		details::SetTrapMask(GetThreadDefault());
+}
+
+// Enables the given traps for the lifetime of the object and restores the whole FP environment afterwards
+// (trap mask, status flags and rounding mode). Without an argument: the thread default, or DEFAULT_TRAPS if that is empty.
+class ScopedTraps {
+public:
+	explicit ScopedTraps(int mask) { Enter(mask); }
+	ScopedTraps() { Enter(GetThreadDefault() ? GetThreadDefault() : DEFAULT_TRAPS); }
+	ScopedTraps(const ScopedTraps&) = delete;
+	ScopedTraps& operator= (const ScopedTraps&) = delete;
+	~ScopedTraps()
+	{
+		if constexpr (FLOATO_ACTIVE)
+		{
+			std::feclearexcept(FE_ALL_EXCEPT);
+			std::fesetenv(&m_saved);
+		}
+	}
+private:
+	void Enter(int mask)
+	{
+		if constexpr (FLOATO_ACTIVE)
+		{
+			std::fegetenv(&m_saved);
+			details::SetTrapMask(mask);
+		}
+	}
+	std::fenv_t m_saved;
+};
+
+// The opposite: masks all exceptions for code that legitimately produces inf/NaN (e.g. calls into a library
+// that relies on IEEE default results), and restores the previous environment on exit.
+class ScopedNoTraps {
+public:
+	ScopedNoTraps()
+	{
+		if constexpr (FLOATO_ACTIVE)
+			std::feholdexcept(&m_saved);
+	}
+	ScopedNoTraps(const ScopedNoTraps&) = delete;
+	ScopedNoTraps& operator= (const ScopedNoTraps&) = delete;
+	~ScopedNoTraps()
+	{
+		if constexpr (FLOATO_ACTIVE)
+		{
+			std::feclearexcept(FE_ALL_EXCEPT);					// flags raised inside don't leak into an outer StickyCheck
+			std::fesetenv(&m_saved);
+		}
+	}
+private:
+	std::fenv_t m_saved;
+};
+
+// Sticky-flags-only mode: nothing traps, the status flags accumulated since construction (or the last Check())
+// are tested at batch boundaries. Throws FLOATO_exception, or calls the handler given in the constructor.
+class StickyCheck {
+public:
+	typedef void (*Handler)(int raised, const char* where);
+
+	explicit StickyCheck(int mask = DEFAULT_TRAPS, Handler handler = nullptr) :
+		m_mask(mask), m_handler(handler)
+	{
+		if constexpr (FLOATO_ACTIVE)
+			std::feclearexcept(m_mask);
+	}
+
+	// returns the raised exceptions (0 if none) and clears them; reports if any was raised
+	int Check(const char* where = "")
+	{
+		if constexpr (FLOATO_ACTIVE)
+		{
+			const int raised = std::fetestexcept(m_mask);
+			if (raised)
+			{
+				std::feclearexcept(raised);
+				if (m_handler)
+					m_handler(raised, where);
+				else
+					throw FLOATO_exception(std::string("floating point exception (") + DescribeExceptions(raised) + ") in batch " + where, raised);
+			}
+			return raised;
+		}
+		else
+		{
+			(void)where;
+			return 0;
+		}
+	}
+
+	// just the flags, no reporting and no clearing
+	int Peek() const
+	{
+		if constexpr (FLOATO_ACTIVE)
+			return std::fetestexcept(m_mask);
+		else
+			return 0;
+	}
+
+private:
+	int		m_mask;
+	Handler	m_handler;
+};
+
+#define FLOATO_STRINGIZE2(x)		#x
+#define FLOATO_STRINGIZE(x)			FLOATO_STRINGIZE2(x)
+#define FLOATO_CHECK(stickyCheck)	(stickyCheck).Check(__FILE__ ":" FLOATO_STRINGIZE(__LINE__))
+
+// Denormal control (FTZ/DAZ) -----------------------------------------------------------------------------------
+// Arithmetic on subnormal operands or results takes a microcode assist on x86 (~100+ cycles per instruction),
+// which is what makes decaying filters and near-silent signals suddenly slow. FTZ flushes subnormal results to
+// zero, DAZ treats subnormal inputs as zero; both are per-thread MXCSR bits and only affect SSE/AVX code.
+
+enum DenormalMode : unsigned {
+	KeepDenormals = 0,
+	FlushToZero = 0x8000,											// MXCSR.FTZ
+	DenormalsAreZero = 0x0040,										// MXCSR.DAZ
+	FlushDenormals = FlushToZero | DenormalsAreZero
+};
+
+namespace details {
+
+constexpr uint32_t MXCSR_DENORMAL_FLAG = 0x0002;					// DE: a denormal operand was seen (not set with DAZ on)
+constexpr uint32_t MXCSR_UNDERFLOW_FLAG = 0x0010;					// UE: a result was tiny (and inexact), i.e. denormal or flushed
+
+inline uint32_t GetCsr()
+{
+#ifdef FLOATO_LINUX_X86_64
+	return _mm_getcsr();
+#else
+	return 0;
+#endif
+}
+
+inline void SetCsr(uint32_t csr)
+{
+#ifdef FLOATO_LINUX_X86_64
+	_mm_setcsr(csr);
+#else
+	(void)csr;
+#endif
+}
+
+} // namespace details
+
+inline void SetDenormalMode(DenormalMode mode)
+{
+	details::SetCsr((details::GetCsr() & ~static_cast<uint32_t>(FlushDenormals)) | mode);
+}
+
+inline DenormalMode GetDenormalMode()
+{
+	return static_cast<DenormalMode>(details::GetCsr() & FlushDenormals);
+}
+
+// Sets FTZ/DAZ for a region and restores the previous bits (and only those) on exit.
+class ScopedDenormalMode {
+public:
+	explicit ScopedDenormalMode(DenormalMode mode = FlushDenormals) :
+		m_previous(GetDenormalMode())
+	{
+		SetDenormalMode(mode);
+	}
+	ScopedDenormalMode(const ScopedDenormalMode&) = delete;
+	ScopedDenormalMode& operator= (const ScopedDenormalMode&) = delete;
+	~ScopedDenormalMode() { SetDenormalMode(m_previous); }
+private:
+	DenormalMode m_previous;
+};
+
+// Sets the denormal mode on every worker of a thread pool, which can't be done from the outside since MXCSR
+// is per thread. `submit` must enqueue a callable (std::function<void()>) on the pool; it is called workerCount
+// times and the tasks block on a barrier until all of them have started, so each one runs on a different worker.
+// workerCount must therefore be exactly the number of workers that can pick up tasks, or this never returns.
+template <typename Submit>
+void ApplyToAllWorkers(Submit&& submit, unsigned workerCount, DenormalMode mode)
+{
+	struct Barrier
+	{
+		std::mutex				lock;
+		std::condition_variable	changed;
+		unsigned				arrived = 0;
+		unsigned				finished = 0;
+	};
+	auto barrier = std::make_shared<Barrier>();
+	for (unsigned i = 0; i < workerCount; ++i)
+	{
+		submit([barrier, workerCount, mode]() {
+			SetDenormalMode(mode);
+			std::unique_lock<std::mutex> guard(barrier->lock);
+			if (++barrier->arrived == workerCount)
+				barrier->changed.notify_all();
+			barrier->changed.wait(guard, [&]() { return barrier->arrived == workerCount; });
+			if (++barrier->finished == workerCount)
+				barrier->changed.notify_all();
+		});
+	}
+	std::unique_lock<std::mutex> guard(barrier->lock);
+	barrier->changed.wait(guard, [&]() { return barrier->finished == workerCount; });
+}
+
+// Counts how often code regions run into denormals, from the sticky MXCSR flags: a sampled region clears DE/UE
+// on entry and reads them on exit (one stmxcsr/ldmxcsr pair each), an unsampled one costs a decrement.
+// One sampler per region of interest; Region objects may be used from any number of threads. Every sampler
+// counts down on its own in each thread, so a busy sampler doesn't shift when the others take their samples.
+class DenormalSampler {
+public:
+	explicit DenormalSampler(unsigned samplePeriod = 1) :
+		m_period(samplePeriod ? samplePeriod : 1), m_id(NextId()) {}
+
+	class Region {
+	public:
+		explicit Region(DenormalSampler& sampler) :
+			m_sampler(sampler), m_sampled(sampler.Tick())
+		{
+			if (m_sampled)
+				details::SetCsr(details::GetCsr() & ~(details::MXCSR_DENORMAL_FLAG | details::MXCSR_UNDERFLOW_FLAG));
+		}
+		Region(const Region&) = delete;
+		Region& operator= (const Region&) = delete;
+		~Region()
+		{
+			if (m_sampled)
+				m_sampler.Record(details::GetCsr());
+		}
+	private:
+		DenormalSampler&	m_sampler;
+		bool				m_sampled;
+	};
+
+	uint64_t Samples() const { return m_samples.load(std::memory_order_relaxed); }
+	uint64_t DenormalInputs() const { return m_denormalInputs.load(std::memory_order_relaxed); }	// regions that read a denormal operand
+	uint64_t TinyResults() const { return m_tinyResults.load(std::memory_order_relaxed); }			// regions that produced (or flushed) a denormal
+	double DenormalRate() const
+	{
+		const uint64_t samples = Samples();
+		return samples ? double(DenormalInputs() > TinyResults() ? DenormalInputs() : TinyResults()) / samples : 0.0;
+	}
+	void Reset()
+	{
+		m_samples.store(0, std::memory_order_relaxed);
+		m_denormalInputs.store(0, std::memory_order_relaxed);
+		m_tinyResults.store(0, std::memory_order_relaxed);
+	}
+
+private:
+	// ids are never reused, so a sampler created at a dead one's address doesn't inherit its countdowns
+	static uint64_t NextId()
+	{
+		static std::atomic<uint64_t> next{ 1 };
+		return next.fetch_add(1, std::memory_order_relaxed);
+	}
+	// the thread's countdown for this sampler; the last one used is cached, the others are looked up by id
+	// (map nodes don't move, so the cached pointer stays valid); entries of destroyed samplers are left behind
+	unsigned& Countdown()
+	{
+		struct Countdowns
+		{
+			uint64_t								lastId = 0;
+			unsigned*								last = nullptr;
+			std::unordered_map<uint64_t, unsigned>	byId;
+		};
+		static thread_local Countdowns countdowns;
+		if (countdowns.lastId != m_id)
+		{
+			countdowns.last = &countdowns.byId[m_id];
+			countdowns.lastId = m_id;
+		}
+		return *countdowns.last;
+	}
+	bool Tick()
+	{
+		unsigned& countdown = Countdown();
+		if (countdown)
+		{
+			--countdown;
+			return false;
+		}
+		countdown = m_period - 1;
+		return true;
+	}
+	void Record(uint32_t csr)
+	{
+		m_samples.fetch_add(1, std::memory_order_relaxed);
+		if (csr & details::MXCSR_DENORMAL_FLAG)
+			m_denormalInputs.fetch_add(1, std::memory_order_relaxed);
+		if (csr & details::MXCSR_UNDERFLOW_FLAG)
+			m_tinyResults.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	unsigned				m_period;
+	uint64_t				m_id;
+	std::atomic<uint64_t>	m_samples{ 0 };
+	std::atomic<uint64_t>	m_denormalInputs{ 0 };
+	std::atomic<uint64_t>	m_tinyResults{ 0 };
+};
+
+// SIGFPE handling -----------------------------------------------------------------------------------------------
+
+enum class TrapAction {
+	Abort,			// report, then die with SIGFPE (core dump shows the faulting instruction)
+	Continue		// report, mask the exception in the interrupted context and resume: the instruction is re-executed
+					// and yields the IEEE default result; the trap stays masked on that thread until re-enabled
+};
+
+struct FaultInfo
+{
+	int			code;		// si_code: FPE_FLTDIV, FPE_FLTOVF, FPE_FLTINV, ...
+	const void*	address;	// faulting instruction
+	int			raised;		// FE_* bits found set in the interrupted context's MXCSR
+};
+
+// Called from the signal handler: must be async-signal-safe.
+typedef void (*FaultCallback)(const FaultInfo& info);
+
+namespace details {
+
+inline TrapAction& ConfiguredAction()
+{
+	static TrapAction action = TrapAction::Abort;
+	return action;
+}
+
+inline FaultCallback& ConfiguredCallback()
+{
+	static FaultCallback callback = nullptr;
+	return callback;
+}
+
+#ifdef FLOATO_LINUX_X86_64
+inline const char* FpeCodeName(int code)
+{
+	switch (code)
+	{
+	case FPE_FLTDIV: return "division by zero";
+	case FPE_FLTOVF: return "overflow";
+	case FPE_FLTUND: return "underflow";
+	case FPE_FLTRES: return "inexact result";
+	case FPE_FLTINV: return "invalid operation";
+	case FPE_FLTSUB: return "subscript out of range";
+	case FPE_INTDIV: return "integer division by zero";
+	case FPE_INTOVF: return "integer overflow";
+	default: return "unknown";
+	}
+}
+
+inline void WriteStr(const char* str)
+{
+	ssize_t ignored = ::write(STDERR_FILENO, str, std::strlen(str));
+	(void)ignored;
+}
+
+inline void WriteHex(uintptr_t value)
+{
+	char buf[2 + 16 + 1] = "0x";
+	for (int i = 0; i < 16; ++i)
+		buf[2 + i] = "0123456789abcdef"[(value >> (60 - 4 * i)) & 0xF];
+	buf[18] = '\0';
+	WriteStr(buf);
+}
+
+inline void SigfpeHandler(int sig, siginfo_t* info, void* context)
+{
+	ucontext_t* uc = static_cast<ucontext_t*>(context);
+	const uint32_t mxcsr = uc->uc_mcontext.fpregs ? uc->uc_mcontext.fpregs->mxcsr : 0;
+	FaultInfo fault{ info->si_code, info->si_addr, static_cast<int>(mxcsr & FE_ALL_EXCEPT) };
+
+	WriteStr("FLOATO: SIGFPE (");
+	WriteStr(FpeCodeName(fault.code));
+	WriteStr(") at ");
+	WriteHex(reinterpret_cast<uintptr_t>(fault.address));
+	WriteStr(", backtrace:\n");
+	void* frames[64];
+	const int depth = backtrace(frames, 64);
+	backtrace_symbols_fd(frames, depth, STDERR_FILENO);
+	if (ConfiguredCallback())
+		ConfiguredCallback()(fault);
+
+	const bool isFloatingPoint = fault.code >= FPE_FLTDIV && fault.code <= FPE_FLTSUB;
+	if (ConfiguredAction() == TrapAction::Continue && isFloatingPoint && uc->uc_mcontext.fpregs)
+	{
+		// mask everything that's currently unmasked on that thread and drop the flags, both SSE and x87
+		uc->uc_mcontext.fpregs->mxcsr |= (FE_ALL_EXCEPT << MXCSR_MASK_SHIFT);
+		uc->uc_mcontext.fpregs->mxcsr &= ~static_cast<uint32_t>(FE_ALL_EXCEPT);
+		uc->uc_mcontext.fpregs->cwd |= FE_ALL_EXCEPT;
+		uc->uc_mcontext.fpregs->swd &= ~static_cast<uint16_t>(FE_ALL_EXCEPT | 0x80);	// 0x80: x87 error summary
+		return;
+	}
+	signal(sig, SIG_DFL);
+	raise(sig);
+}
+#endif
+
+} // namespace details
+
+// Installs the process-wide SIGFPE handler. The callback (if any) runs inside the handler.
+inline bool InstallSigfpeHandler(TrapAction action = TrapAction::Abort, FaultCallback callback = nullptr)
+{
+#ifdef FLOATO_LINUX_X86_64
+	if constexpr (FLOATO_ACTIVE)
+	{
+		details::ConfiguredAction() = action;
+		details::ConfiguredCallback() = callback;
+		void* warmup[1];
+		backtrace(warmup, 1);										// first call loads libgcc -- not something to do in a signal handler
+		struct sigaction sa;
+		std::memset(&sa, 0, sizeof(sa));
+		sa.sa_sigaction = &details::SigfpeHandler;
+		sa.sa_flags = SA_SIGINFO;
+		sigemptyset(&sa.sa_mask);
+		return sigaction(SIGFPE, &sa, nullptr) == 0;
+	}
+#endif
+	(void)action;
+	(void)callback;
+	return false;
+}
+
+#ifdef __DEBUG_CHECK_FLOAT_EXCEPTIONS_AT_STARTUP
+namespace details {
+inline const bool s_bEnabledAtStartup = (InstallSigfpeHandler(), EnableForProcess(DEFAULT_TRAPS), true);
+}
+#endif
+
+} // namespace FLOATO
@@ -0,0 +1,321 @@
+#pragma once
+
+// FLOATO::Scan -- counting NaN, inf and subnormal values in float/double buffers, for validating data at ingest.
+//
+// Trapping (FLOATO.h) tells where a NaN is made, which is for debugging; data coming from files, the network or
+// other processes has to be checked as it arrives, and a std::isfinite loop doesn't keep up with multi-GB batches.
+// Scan classifies the values by their bits (no FP arithmetic, so no flags are raised and FTZ/DAZ don't matter):
+//
+//		FLOATO::ScanResult r = FLOATO::Scan(samples);					// std::span<const double> / <const float>
+//		if (!r.Clean())
+//			throw std::runtime_error("bad batch: " + r.Describe());	// counts and the first index of each kind
+//		r = FLOATO::ParallelScan(huge);								// one std::thread per hardware thread
+//
+// The kernel is chosen once per process from what the CPU supports: AVX-512F, AVX2 or scalar (GCC/Clang on x86-64,
+// scalar elsewhere). The vector kernels test 4 vectors at a time for any special value and only classify the
+// ones that have some, so a clean buffer goes at memory bandwidth. Like the denormal controls this is not a
+// debugging aid, so unlike the rest of FLOATO it is active without __DEBUG_CHECK_FLOAT_EXCEPTIONS.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if __has_include(<span>) && __cplusplus >= 202002L
+#include <span>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define FLOATO_SCAN_X86_64
+#include <immintrin.h>
+#define FLOATO_TARGET_AVX2		__attribute__((target("avx2")))
+#define FLOATO_TARGET_AVX512	__attribute__((target("avx512f")))
+#endif
+
+#ifndef FLOATO_SCAN_MIN_PER_THREAD
+#define FLOATO_SCAN_MIN_PER_THREAD	(size_t(1) << 20)
+#endif
+
+namespace FLOATO {
+
+constexpr size_t SCAN_NOT_FOUND = ~size_t(0);
+
+struct ScanResult
+{
+	size_t	nans = 0, infs = 0, subnormals = 0;
+	size_t	firstNan = SCAN_NOT_FOUND, firstInf = SCAN_NOT_FOUND, firstSubnormal = SCAN_NOT_FOUND;
+
+	bool Clean() const { return nans == 0 && infs == 0 && subnormals == 0; }
+	bool Finite() const { return nans == 0 && infs == 0; }
+	std::string Describe() const
+	{
+		auto describe = [](const char* what, size_t count, size_t first) {
+			return std::to_string(count) + " " + what + (count ? " (first at " + std::to_string(first) + ")" : "");
+		};
+		return describe("NaN", nans, firstNan) + ", " + describe("inf", infs, firstInf) + ", " + describe("subnormal", subnormals, firstSubnormal);
+	}
+	// the result of the range that follows this one, starting at offset
+	void Merge(const ScanResult& next, size_t offset)
+	{
+		auto merge = [offset](size_t& count, size_t& first, size_t nextCount, size_t nextFirst) {
+			if (count == 0 && nextCount != 0)
+				first = nextFirst + offset;
+			count += nextCount;
+		};
+		merge(nans, firstNan, next.nans, next.firstNan);
+		merge(infs, firstInf, next.infs, next.firstInf);
+		merge(subnormals, firstSubnormal, next.subnormals, next.firstSubnormal);
+	}
+};
+
+enum ScanKernel { ScanScalar, ScanAvx2, ScanAvx512 };
+
+namespace details {
+
+// the absolute value's bits order the classes: 0 < subnormal < MIN_NORMAL <= normal < INF < NaN
+template <typename T> struct ScanTraits;
+template <> struct ScanTraits<double>
+{
+	typedef uint64_t Bits_t;
+	static constexpr Bits_t ABS = 0x7FFFFFFFFFFFFFFFull, INF = 0x7FF0000000000000ull, MIN_NORMAL = 0x0010000000000000ull;
+};
+template <> struct ScanTraits<float>
+{
+	typedef uint32_t Bits_t;
+	static constexpr Bits_t ABS = 0x7FFFFFFFu, INF = 0x7F800000u, MIN_NORMAL = 0x00800000u;
+};
+
+inline void Record(size_t& count, size_t& first, uint32_t mask, size_t index)
+{
+	if (mask)
+	{
+#ifdef _MSC_VER
+		if (first == SCAN_NOT_FOUND)
+		{
+			unsigned long lowest;
+			_BitScanForward(&lowest, mask);
+			first = index + static_cast<size_t>(lowest);
+		}
+		count += static_cast<size_t>(__popcnt(mask));
+#else
+		if (first == SCAN_NOT_FOUND)
+			first = index + static_cast<size_t>(__builtin_ctz(mask));
+		count += static_cast<size_t>(__builtin_popcount(mask));
+#endif
+	}
+}
+
+template <typename T> void ScanScalarRange(const T* data, size_t from, size_t to, ScanResult& result)
+{
+	typedef ScanTraits<T> Traits;
+	for (size_t i = from; i < to; ++i)
+	{
+		typename Traits::Bits_t bits;
+		std::memcpy(&bits, data + i, sizeof(bits));
+		bits &= Traits::ABS;
+		if (bits - 1 < Traits::MIN_NORMAL - 1 || bits >= Traits::INF)			// 0 wraps around to the top
+		{
+			Record(result.nans, result.firstNan, bits > Traits::INF, i);
+			Record(result.infs, result.firstInf, bits == Traits::INF, i);
+			Record(result.subnormals, result.firstSubnormal, bits < Traits::MIN_NORMAL, i);
+		}
+	}
+}
+
+#ifdef FLOATO_SCAN_X86_64
+
+// lane masks of the classes, one bit per element; AVX2 has signed compares only, fine for values without the sign bit
+template <typename T> struct Avx2Ops;
+template <> struct Avx2Ops<double>
+{
+	static constexpr size_t LANES = 4;
+	typedef __m256i Vec_t;
+	FLOATO_TARGET_AVX2 static Vec_t Abs(const double* p) { return _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)), _mm256_set1_epi64x(0x7FFFFFFFFFFFFFFFll)); }
+	FLOATO_TARGET_AVX2 static uint32_t Mask(Vec_t m) { return static_cast<uint32_t>(_mm256_movemask_pd(_mm256_castsi256_pd(m))); }
+	FLOATO_TARGET_AVX2 static Vec_t SubnormalLanes(Vec_t v)
+	{
+		return _mm256_andnot_si256(_mm256_cmpeq_epi64(v, _mm256_setzero_si256()), _mm256_cmpgt_epi64(_mm256_set1_epi64x(0x0010000000000000ll), v));
+	}
+	FLOATO_TARGET_AVX2 static uint32_t Special(Vec_t v) { return Mask(_mm256_or_si256(_mm256_cmpgt_epi64(v, _mm256_set1_epi64x(0x7FEFFFFFFFFFFFFFll)), SubnormalLanes(v))); }
+	FLOATO_TARGET_AVX2 static uint32_t Nan(Vec_t v) { return Mask(_mm256_cmpgt_epi64(v, _mm256_set1_epi64x(0x7FF0000000000000ll))); }
+	FLOATO_TARGET_AVX2 static uint32_t Inf(Vec_t v) { return Mask(_mm256_cmpeq_epi64(v, _mm256_set1_epi64x(0x7FF0000000000000ll))); }
+	FLOATO_TARGET_AVX2 static uint32_t Subnormal(Vec_t v) { return Mask(SubnormalLanes(v)); }
+	// what the kernel calls: is there anything special among the 4 vectors at p, and the classes of one vector
+	FLOATO_TARGET_AVX2 static uint32_t AnySpecial(const double* p) { return Special(Abs(p)) | Special(Abs(p + LANES)) | Special(Abs(p + 2 * LANES)) | Special(Abs(p + 3 * LANES)); }
+	FLOATO_TARGET_AVX2 static void Classify(const double* p, size_t index, ScanResult& result)
+	{
+		const Vec_t v = Abs(p);
+		Record(result.nans, result.firstNan, Nan(v), index);
+		Record(result.infs, result.firstInf, Inf(v), index);
+		Record(result.subnormals, result.firstSubnormal, Subnormal(v), index);
+	}
+};
+template <> struct Avx2Ops<float>
+{
+	static constexpr size_t LANES = 8;
+	typedef __m256i Vec_t;
+	FLOATO_TARGET_AVX2 static Vec_t Abs(const float* p) { return _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)), _mm256_set1_epi32(0x7FFFFFFF)); }
+	FLOATO_TARGET_AVX2 static uint32_t Mask(Vec_t m) { return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(m))); }
+	FLOATO_TARGET_AVX2 static Vec_t SubnormalLanes(Vec_t v)
+	{
+		return _mm256_andnot_si256(_mm256_cmpeq_epi32(v, _mm256_setzero_si256()), _mm256_cmpgt_epi32(_mm256_set1_epi32(0x00800000), v));
+	}
+	FLOATO_TARGET_AVX2 static uint32_t Special(Vec_t v) { return Mask(_mm256_or_si256(_mm256_cmpgt_epi32(v, _mm256_set1_epi32(0x7F7FFFFF)), SubnormalLanes(v))); }
+	FLOATO_TARGET_AVX2 static uint32_t Nan(Vec_t v) { return Mask(_mm256_cmpgt_epi32(v, _mm256_set1_epi32(0x7F800000))); }
+	FLOATO_TARGET_AVX2 static uint32_t Inf(Vec_t v) { return Mask(_mm256_cmpeq_epi32(v, _mm256_set1_epi32(0x7F800000))); }
+	FLOATO_TARGET_AVX2 static uint32_t Subnormal(Vec_t v) { return Mask(SubnormalLanes(v)); }
+	FLOATO_TARGET_AVX2 static uint32_t AnySpecial(const float* p) { return Special(Abs(p)) | Special(Abs(p + LANES)) | Special(Abs(p + 2 * LANES)) | Special(Abs(p + 3 * LANES)); }
+	FLOATO_TARGET_AVX2 static void Classify(const float* p, size_t index, ScanResult& result)
+	{
+		const Vec_t v = Abs(p);
+		Record(result.nans, result.firstNan, Nan(v), index);
+		Record(result.infs, result.firstInf, Inf(v), index);
+		Record(result.subnormals, result.firstSubnormal, Subnormal(v), index);
+	}
+};
+
+// AVX-512F compares straight into mask registers, unsigned ones too
+template <typename T> struct Avx512Ops;
+template <> struct Avx512Ops<double>
+{
+	static constexpr size_t LANES = 8;
+	typedef __m512i Vec_t;
+	FLOATO_TARGET_AVX512 static Vec_t Abs(const double* p) { return _mm512_and_si512(_mm512_loadu_si512(p), _mm512_set1_epi64(0x7FFFFFFFFFFFFFFFll)); }
+	FLOATO_TARGET_AVX512 static uint32_t Special(Vec_t v) { return static_cast<uint32_t>(_mm512_cmpge_epu64_mask(v, _mm512_set1_epi64(0x7FF0000000000000ll)) | Subnormal(v)); }
+	FLOATO_TARGET_AVX512 static uint32_t Nan(Vec_t v) { return _mm512_cmpgt_epu64_mask(v, _mm512_set1_epi64(0x7FF0000000000000ll)); }
+	FLOATO_TARGET_AVX512 static uint32_t Inf(Vec_t v) { return _mm512_cmpeq_epu64_mask(v, _mm512_set1_epi64(0x7FF0000000000000ll)); }
+	FLOATO_TARGET_AVX512 static uint32_t Subnormal(Vec_t v) { return _mm512_mask_cmplt_epu64_mask(_mm512_test_epi64_mask(v, v), v, _mm512_set1_epi64(0x0010000000000000ll)); }
+	FLOATO_TARGET_AVX512 static uint32_t AnySpecial(const double* p) { return Special(Abs(p)) | Special(Abs(p + LANES)) | Special(Abs(p + 2 * LANES)) | Special(Abs(p + 3 * LANES)); }
+	FLOATO_TARGET_AVX512 static void Classify(const double* p, size_t index, ScanResult& result)
+	{
+		const Vec_t v = Abs(p);
+		Record(result.nans, result.firstNan, Nan(v), index);
+		Record(result.infs, result.firstInf, Inf(v), index);
+		Record(result.subnormals, result.firstSubnormal, Subnormal(v), index);
+	}
+};
+template <> struct Avx512Ops<float>
+{
+	static constexpr size_t LANES = 16;
+	typedef __m512i Vec_t;
+	FLOATO_TARGET_AVX512 static Vec_t Abs(const float* p) { return _mm512_and_si512(_mm512_loadu_si512(p), _mm512_set1_epi32(0x7FFFFFFF)); }
+	FLOATO_TARGET_AVX512 static uint32_t Special(Vec_t v) { return static_cast<uint32_t>(_mm512_cmpge_epu32_mask(v, _mm512_set1_epi32(0x7F800000)) | Subnormal(v)); }
+	FLOATO_TARGET_AVX512 static uint32_t Nan(Vec_t v) { return _mm512_cmpgt_epu32_mask(v, _mm512_set1_epi32(0x7F800000)); }
+	FLOATO_TARGET_AVX512 static uint32_t Inf(Vec_t v) { return _mm512_cmpeq_epu32_mask(v, _mm512_set1_epi32(0x7F800000)); }
+	FLOATO_TARGET_AVX512 static uint32_t Subnormal(Vec_t v) { return _mm512_mask_cmplt_epu32_mask(_mm512_test_epi32_mask(v, v), v, _mm512_set1_epi32(0x00800000)); }
+	FLOATO_TARGET_AVX512 static uint32_t AnySpecial(const float* p) { return Special(Abs(p)) | Special(Abs(p + LANES)) | Special(Abs(p + 2 * LANES)) | Special(Abs(p + 3 * LANES)); }
+	FLOATO_TARGET_AVX512 static void Classify(const float* p, size_t index, ScanResult& result)
+	{
+		const Vec_t v = Abs(p);
+		Record(result.nans, result.firstNan, Nan(v), index);
+		Record(result.infs, result.firstInf, Inf(v), index);
+		Record(result.subnormals, result.firstSubnormal, Subnormal(v), index);
+	}
+};
+
+// inlined into the target-specific wrappers below, so it is compiled for their instruction set; vectors stay inside Ops
+template <typename T, typename Ops> __attribute__((always_inline)) inline void ScanVectorRange(const T* data, size_t count, ScanResult& result)
+{
+	constexpr size_t BLOCK = 4 * Ops::LANES;
+	size_t i = 0;
+	for (; i + BLOCK <= count; i += BLOCK)
+	{
+		if (Ops::AnySpecial(data + i) == 0)
+			continue;
+		for (size_t k = 0; k < 4; ++k)
+			Ops::Classify(data + i + k * Ops::LANES, i + k * Ops::LANES, result);
+	}
+	ScanScalarRange(data, i, count, result);
+}
+
+FLOATO_TARGET_AVX2 inline void ScanAvx2Range(const double* data, size_t count, ScanResult& result) { ScanVectorRange<double, Avx2Ops<double>>(data, count, result); }
+FLOATO_TARGET_AVX2 inline void ScanAvx2Range(const float* data, size_t count, ScanResult& result) { ScanVectorRange<float, Avx2Ops<float>>(data, count, result); }
+FLOATO_TARGET_AVX512 inline void ScanAvx512Range(const double* data, size_t count, ScanResult& result) { ScanVectorRange<double, Avx512Ops<double>>(data, count, result); }
+FLOATO_TARGET_AVX512 inline void ScanAvx512Range(const float* data, size_t count, ScanResult& result) { ScanVectorRange<float, Avx512Ops<float>>(data, count, result); }
+
+#endif
+
+template <typename T> ScanResult ScanWith(ScanKernel kernel, const T* data, size_t count)
+{
+	ScanResult result;
+#ifdef FLOATO_SCAN_X86_64
+	if (kernel == ScanAvx512)
+		ScanAvx512Range(data, count, result);
+	else if (kernel == ScanAvx2)
+		ScanAvx2Range(data, count, result);
+	else
+#endif
+		ScanScalarRange(data, 0, count, result);
+	return result;
+}
+
+} // namespace details
+
+inline bool ScanKernelSupported(ScanKernel kernel)
+{
+#ifdef FLOATO_SCAN_X86_64
+	if (kernel == ScanAvx512)
+		return __builtin_cpu_supports("avx512f");
+	if (kernel == ScanAvx2)
+		return __builtin_cpu_supports("avx2");
+#endif
+	return kernel == ScanScalar;
+}
+
+// the widest kernel the CPU runs, decided on first use
+inline ScanKernel BestScanKernel()
+{
+	static const ScanKernel best = ScanKernelSupported(ScanAvx512) ? ScanAvx512 : ScanKernelSupported(ScanAvx2) ? ScanAvx2 : ScanScalar;
+	return best;
+}
+
+inline ScanResult Scan(const double* data, size_t count) { return details::ScanWith(BestScanKernel(), data, count); }
+inline ScanResult Scan(const float* data, size_t count) { return details::ScanWith(BestScanKernel(), data, count); }
+
+// a given kernel, for tests and benchmarks; it must be ScanKernelSupported
+inline ScanResult Scan(ScanKernel kernel, const double* data, size_t count) { return details::ScanWith(kernel, data, count); }
+inline ScanResult Scan(ScanKernel kernel, const float* data, size_t count) { return details::ScanWith(kernel, data, count); }
+
+// Contiguous chunks, one per thread (threads == 0: one per hardware thread), the calling thread takes the last one.
+// Buffers below FLOATO_SCAN_MIN_PER_THREAD elements per thread are scanned on the calling thread.
+template <typename T> ScanResult ParallelScan(const T* data, size_t count, unsigned threads = 0)
+{
+	if (threads == 0)
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	threads = static_cast<unsigned>(std::min<size_t>(threads, std::max<size_t>(1, count / FLOATO_SCAN_MIN_PER_THREAD)));
+	if (threads <= 1)
+		return Scan(data, count);
+	const size_t perThread = count / threads;
+	std::vector<ScanResult> partials(threads);
+	std::vector<std::thread> workers;
+	workers.reserve(threads - 1);
+	auto work = [&](unsigned index) {
+		const size_t first = index * perThread;
+		partials[index] = Scan(data + first, index + 1 == threads ? count - first : perThread);
+	};
+	for (unsigned i = 0; i + 1 < threads; ++i)
+		workers.emplace_back(work, i);
+	work(threads - 1);
+	for (std::thread& worker : workers)
+		worker.join();
+	ScanResult result;
+	for (unsigned i = 0; i < threads; ++i)
+		result.Merge(partials[i], i * perThread);
+	return result;
+}
+
+#if __has_include(<span>) && __cplusplus >= 202002L
+inline ScanResult Scan(std::span<const double> values) { return Scan(values.data(), values.size()); }
+inline ScanResult Scan(std::span<const float> values) { return Scan(values.data(), values.size()); }
+inline ScanResult ParallelScan(std::span<const double> values, unsigned threads = 0) { return ParallelScan(values.data(), values.size(), threads); }
+inline ScanResult ParallelScan(std::span<const float> values, unsigned threads = 0) { return ParallelScan(values.data(), values.size(), threads); }
+#endif
+
+} // namespace FLOATO
@@ -0,0 +1,241 @@
+#pragma once
+
+// fpchecked<T> -- the floating point sibling of INTO's overflowchecked<T>, for float/double/long double.
+//
+// Arithmetic on fpchecked values runs at full speed, nothing is tested per operation. Instead the accumulated
+// IEEE status flags (invalid -> NaN, division by zero, overflow -> inf) are tested once:
+// - per expression: when an fpchecked value is converted back to T (the end of a typical expression),
+// - or per block: inside an fpchecked_block nothing is tested on conversion, the block tests once when it
+//   ends (or on Check()), which is the mode for tight loops.
+// The flags are sticky, so an intermediate inf/NaN is caught even when the final result looks fine
+// (e.g. 1/(x*x) with x*x overflowing). They are also cleared after each check, which means anything raised by
+// unrelated code since the last check is reported too -- put an fpchecked_block around the region to bound that.
+// Compilers may move FP operations across the flag test unless they're told the FP environment is accessed
+// (GCC: -ftrapping-math, the default; MSVC: /fp:strict or #pragma fenv_access(on)).
+//
+// Optionally (__DEBUG_CHECK_FLOAT_PRECISION_LOSS) integer <-> fpchecked conversions are checked for lost
+// precision too: an integer that has no exact T representation, or a T with a fractional part converted to integer.
+// Like INTO, the floato/doubleo/ldoubleo aliases switch between checked and plain types with __DEBUG_CHECK_FLOAT.
+
+#include <cfenv>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
+
+#include "FLOATO.h"
+
+#ifdef __DEBUG_CHECK_FLOAT_NAMESPACE
+namespace __DEBUG_CHECK_FLOAT_NAMESPACE {
+#endif
+
+#ifdef __DEBUG_CHECK_FLOAT
+#define CREATE_FP_TYPE_ALIAS_WITHNAME(type,aliasprefix)	typedef fpchecked<type> aliasprefix##o;
+#else
+#define CREATE_FP_TYPE_ALIAS_WITHNAME(type,aliasprefix)	typedef type aliasprefix##o;
+#endif
+#define CREATE_FP_TYPE_ALIAS(type)		CREATE_FP_TYPE_ALIAS_WITHNAME(type,type)
+
+constexpr bool FPCHECK_ON_BY_DEFAULT = true;
+#ifdef __DEBUG_CHECK_FLOAT_PRECISION_LOSS
+constexpr bool FPCHECK_PRECISION_LOSS = true;
+#else
+constexpr bool FPCHECK_PRECISION_LOSS = false;
+#endif
+constexpr int FPCHECK_EXCEPTIONS = FE_INVALID | FE_DIVBYZERO | FE_OVERFLOW;
+
+template <typename T>
+class fpchecked;
+
+template <typename T> [[noreturn]] inline void SignalFPError(const fpchecked<T>* /*object*/, std::string errorMsg, int raised)
+{
+	throw FLOATO::FLOATO_exception(errorMsg, raised);
+}
+
+namespace detail
+{
+	inline int& FPCheckBlockDepth()
+	{
+		static thread_local int depth = 0;
+		return depth;
+	}
+
+	// tests (and clears) the status flags; the only place where fpchecked looks at the FP environment
+	template <typename T> inline void FPTestFlags(const fpchecked<T>* object, const char* where)
+	{
+		const int raised = std::fetestexcept(FPCHECK_EXCEPTIONS);
+		if (raised)
+		{
+			std::feclearexcept(raised);
+			SignalFPError(object, std::string(typeid(T).name()) + " floating point exception (" + FLOATO::DescribeExceptions(raised) + ") " + where, raised);
+		}
+	}
+
+	// true if the integer has an exact representation in T: its significant bits fit in T's mantissa
+	template <typename T, typename I> inline bool FPExactlyRepresentable(I value)
+	{
+		using unsigned_type = std::make_unsigned_t<I>;
+		unsigned_type magnitude = value < 0 ? unsigned_type(0) - static_cast<unsigned_type>(value) : static_cast<unsigned_type>(value);
+		constexpr int mantissaBits = std::numeric_limits<T>::digits;
+		if (std::numeric_limits<unsigned_type>::digits <= mantissaBits)
+			return true;
+		while (magnitude && !(magnitude & 1))
+			magnitude >>= 1;
+		int bits = 0;
+		while (magnitude >> bits)
+			++bits;
+		return bits <= mantissaBits;
+	}
+}
+
+template <typename T>
+class fpchecked {
+	static_assert(std::is_floating_point<T>::value, "fpchecked<T> is for floating point types, use overflowchecked<T> for integers");
+private:
+	T m_value;
+	static bool s_bCheckActive;
+	static bool IsCheckActive() { return s_bCheckActive; }
+public:
+	fpchecked() = default;
+	fpchecked(T initval) : m_value(initval) {}
+	template <typename U, typename std::enable_if<std::is_floating_point<U>::value, int>::type = 0>
+	fpchecked(fpchecked<U> other) : m_value(static_cast<T>(other.m_value)) {}
+	template <typename I, typename std::enable_if<std::is_integral<I>::value, int>::type = 0>
+	fpchecked(I initval) : m_value(static_cast<T>(initval))
+	{
+		if (FPCHECK_PRECISION_LOSS && IsCheckActive() && !detail::FPExactlyRepresentable<T>(initval))
+		{
+			SignalFPError(this, std::string(typeid(T).name()) + " initialization precision loss: " + std::to_string(initval) +
+				" is not exactly representable, became " + std::to_string(m_value), FE_INEXACT);
+		}
+	}
+
+	// end of an expression: tests the flags unless an fpchecked_block does it later
+	operator T () const
+	{
+		if (IsCheckActive() && detail::FPCheckBlockDepth() == 0)
+			detail::FPTestFlags(this, "in expression");
+		return m_value;
+	}
+
+	// checked conversion to integers: finite, in range, and (optionally) without fractional part
+	template <typename I, typename std::enable_if<std::is_integral<I>::value, int>::type = 0>
+	explicit operator I () const
+	{
+		const T value = static_cast<T>(*this);
+		if (IsCheckActive())
+		{
+			// the bounds are powers of two (or zero), so they are exact in T
+			constexpr T lowerBound = static_cast<T>(std::numeric_limits<I>::min());
+			constexpr T upperBoundExcl = static_cast<T>(std::numeric_limits<I>::max() / 2 + 1) * 2;
+			if (!(value >= lowerBound && value < upperBoundExcl))		// also false for NaN
+			{
+				SignalFPError(this, std::string(typeid(T).name()) + " to " + typeid(I).name() + " conversion overflow: " +
+					std::to_string(value) + " is out of range", FE_INVALID);
+			}
+			if (FPCHECK_PRECISION_LOSS && std::trunc(value) != value)
+			{
+				SignalFPError(this, std::string(typeid(T).name()) + " to " + typeid(I).name() + " conversion precision loss: " +
+					std::to_string(value) + " has a fractional part", FE_INEXACT);
+			}
+		}
+		return static_cast<I>(value);
+	}
+
+	T raw() const { return m_value; }								// no check at all
+
+	fpchecked operator- () const { return fpchecked(-m_value); }
+	fpchecked operator+ () const { return *this; }
+	fpchecked& operator+= (fpchecked rhs) { m_value += rhs.m_value; return *this; }
+	fpchecked& operator-= (fpchecked rhs) { m_value -= rhs.m_value; return *this; }
+	fpchecked& operator*= (fpchecked rhs) { m_value *= rhs.m_value; return *this; }
+	fpchecked& operator/= (fpchecked rhs) { m_value /= rhs.m_value; return *this; }
+
+	template <typename U> friend class fpchecked;
+	template <typename U, typename V> friend const fpchecked<std::common_type_t<U, V>> operator+ (fpchecked<U> lhs, fpchecked<V> rhs);
+	template <typename U, typename V> friend const fpchecked<std::common_type_t<U, V>> operator- (fpchecked<U> lhs, fpchecked<V> rhs);
+	template <typename U, typename V> friend const fpchecked<std::common_type_t<U, V>> operator* (fpchecked<U> lhs, fpchecked<V> rhs);
+	template <typename U, typename V> friend const fpchecked<std::common_type_t<U, V>> operator/ (fpchecked<U> lhs, fpchecked<V> rhs);
+};
+
+template <typename T> bool fpchecked<T>::s_bCheckActive = FPCHECK_ON_BY_DEFAULT;
+
+// The operators themselves do no checking at all, that's the point: the hardware keeps track of the
+// exceptions in the sticky status flags for free, and they're tested at the end of the expression/block.
+template <typename U, typename V> const fpchecked<std::common_type_t<U, V>> operator+ (fpchecked<U> lhs, fpchecked<V> rhs)
+{
+	return fpchecked<std::common_type_t<U, V>>(lhs.m_value + rhs.m_value);
+}
+
+template <typename U, typename V> const fpchecked<std::common_type_t<U, V>> operator- (fpchecked<U> lhs, fpchecked<V> rhs)
+{
+	return fpchecked<std::common_type_t<U, V>>(lhs.m_value - rhs.m_value);
+}
+
+template <typename U, typename V> const fpchecked<std::common_type_t<U, V>> operator* (fpchecked<U> lhs, fpchecked<V> rhs)
+{
+	return fpchecked<std::common_type_t<U, V>>(lhs.m_value * rhs.m_value);
+}
+
+template <typename U, typename V> const fpchecked<std::common_type_t<U, V>> operator/ (fpchecked<U> lhs, fpchecked<V> rhs)
+{
+	return fpchecked<std::common_type_t<U, V>>(lhs.m_value / rhs.m_value);
+}
+
+// mixed fpchecked/plain arithmetic operands (2.0 * x, x + 1)
+#define FPCHECKED_MIXED_OPERATOR(op)																						\
+template <typename U, typename S, typename std::enable_if<std::is_arithmetic<S>::value, int>::type = 0>					\
+const fpchecked<std::common_type_t<U, S>> operator op (fpchecked<U> lhs, S rhs)											\
+	{ return fpchecked<std::common_type_t<U, S>>(lhs) op fpchecked<std::common_type_t<U, S>>(static_cast<std::common_type_t<U, S>>(rhs)); }	\
+template <typename S, typename U, typename std::enable_if<std::is_arithmetic<S>::value, int>::type = 0>					\
+const fpchecked<std::common_type_t<U, S>> operator op (S lhs, fpchecked<U> rhs)											\
+	{ return fpchecked<std::common_type_t<U, S>>(static_cast<std::common_type_t<U, S>>(lhs)) op fpchecked<std::common_type_t<U, S>>(rhs); }
+FPCHECKED_MIXED_OPERATOR(+)
+FPCHECKED_MIXED_OPERATOR(-)
+FPCHECKED_MIXED_OPERATOR(*)
+FPCHECKED_MIXED_OPERATOR(/)
+#undef FPCHECKED_MIXED_OPERATOR
+
+// Block mode: clears the flags on entry, suppresses the per-expression tests inside, and tests once on exit
+// (or whenever Check() is called, e.g. after each batch). Nests; only the outermost block tests on exit.
+// The destructor doesn't throw if the block is left by an exception already in flight.
+// T only names the type in the report (fpchecked_block<float>), the flags are shared by all FP types.
+template <typename T = double>
+class fpchecked_block {
+public:
+	fpchecked_block()
+	{
+		if (detail::FPCheckBlockDepth()++ == 0)
+			std::feclearexcept(FPCHECK_EXCEPTIONS);
+	}
+	fpchecked_block(const fpchecked_block&) = delete;
+	fpchecked_block& operator= (const fpchecked_block&) = delete;
+	void Check(const char* where = "in block")
+	{
+		detail::FPTestFlags<T>(nullptr, where);
+	}
+	~fpchecked_block() noexcept(false)
+	{
+		if (--detail::FPCheckBlockDepth() == 0 && std::uncaught_exceptions() == m_uncaughtOnEntry)
+			Check("in block");
+	}
+private:
+	int m_uncaughtOnEntry = std::uncaught_exceptions();
+};
+
+#ifdef __DEBUG_CHECK_FLOAT_NAMESPACE
+} // namespace __DEBUG_CHECK_FLOAT_NAMESPACE
+#endif
+
+// namespace ends here, the followings are typedefs in global namespace (if enabled)
+
+#ifdef __DEBUG_CHECK_FLOAT_ALIAS
+CREATE_FP_TYPE_ALIAS(float);								// this one creates floato
+CREATE_FP_TYPE_ALIAS(double);								//		...doubleo
+CREATE_FP_TYPE_ALIAS_WITHNAME(long double,		ldouble);		//		...ldoubleo
+#endif //__DEBUG_CHECK_FLOAT_ALIAS
+
+#undef CREATE_FP_TYPE_ALIAS
+#undef CREATE_FP_TYPE_ALIAS_WITHNAME
@@ -0,0 +1,22 @@
+// The compiled part of INTO, for projects built with __DEBUG_CHECK_INTEGER_OVERFLOW_PRECOMPILED: the message
+// building and throwing behind the overflow checks, and the explicit instantiations of overflowchecked<T>, its
+// checks and its same-type operators for the types of the aliases. Has to be compiled with the same INTO
+// switches (__DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE in particular) as the rest of the project.
+
+#ifndef __DEBUG_CHECK_INTEGER_OVERFLOW_PRECOMPILED
+#define __DEBUG_CHECK_INTEGER_OVERFLOW_PRECOMPILED
+#endif
+#define __DEBUG_CHECK_INTEGER_OVERFLOW_INTO_CPP
+#include "INTO.h"
+
+#ifdef __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE
+namespace __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE {
+#endif
+
+#define INTO_DEFINE_FOR_TYPE(type)		INTO_INSTANTIATE_FOR_TYPE(, type)
+INTO_FOR_EACH_ALIAS_TYPE(INTO_DEFINE_FOR_TYPE)
+#undef INTO_DEFINE_FOR_TYPE
+
+#ifdef __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE
+} // namespace __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE
+#endif
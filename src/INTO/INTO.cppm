@@ -0,0 +1,46 @@
+// lsct.into -- INTO.h as a C++20 named module: import lsct.into; instead of #include "INTO.h".
+//
+// Build it with the switches of lsct_config.h, and include that header in the importers too. The module is also
+// the compiled part of INTO, like INTO.cpp with __DEBUG_CHECK_INTEGER_OVERFLOW_PRECOMPILED: the reporting code
+// and the alias types' instantiations are compiled here once, so link its object file and not INTO.cpp.
+//
+// The standard headers INTO uses are included in the global module fragment and INTO.h in an export block, so
+// everything it declares is exported, the detail namespaces too. (export using ::overflowchecked; after including
+// INTO.h in the global module fragment would be finer-grained, but GCC 12 doesn't export such using-declarations.)
+// A TU can import the module or include INTO.h, not both.
+
+module;
+
+#include "../lsct_config.h"
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
+
+export module lsct.into;
+
+#ifndef __DEBUG_CHECK_INTEGER_OVERFLOW_PRECOMPILED
+#define __DEBUG_CHECK_INTEGER_OVERFLOW_PRECOMPILED
+#endif
+#define __DEBUG_CHECK_INTEGER_OVERFLOW_INTO_CPP
+
+export
+{
+#include "INTO.h"
+}
+
+#ifdef __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE
+namespace __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE {
+#endif
+
+#define INTO_DEFINE_FOR_TYPE(type)		INTO_INSTANTIATE_FOR_TYPE(, type)
+INTO_FOR_EACH_ALIAS_TYPE(INTO_DEFINE_FOR_TYPE)
+#undef INTO_DEFINE_FOR_TYPE
+
+#ifdef __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE
+} // namespace __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE
+#endif
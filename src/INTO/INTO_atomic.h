@@ -0,0 +1,170 @@
+#pragma once
+
+// atomic_overflowchecked<T, Policy> -- lock-free shared counters with the overflow detection of overflowchecked<T>.
+//
+// What happens on overflow is chosen per type with the policy:
+// - Report:   the operation is a plain lock xadd (std::atomic::fetch_add), the previous value it returns tells
+//             whether the addition wrapped around; if it did, it's reported through SignalOverflowError.
+//             The wrapped value stays in the counter (other threads may have seen it already), this is the
+//             cheapest one: the fast path is exactly a fetch_add plus a register compare.
+// - Reject:   CAS loop, the new value is computed with the overflow builtins and only stored if it's in range;
+//             on overflow the counter keeps its old value and the overflow is reported.
+// - Saturate: CAS loop, an out of range result is clamped to the type's min/max, nothing is reported.
+// The CAS loop costs a load plus a lock cmpxchg, and a retry under contention: about twice a lock xadd
+// (see test/INTO_atomic_bench.cpp). For statistics counters that only need to be watched, Report is the one.
+// fetch_mul has no hardware counterpart, it's always a CAS loop (Report stores the wrapped product).
+// When overflow checking is switched off for T (overflowchecked<T>'s global switch), all of them are plain atomics.
+
+#include "INTO.h"
+
+#include <atomic>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
+
+#if !defined(__SIZEOF_INT128__)
+#error INTO_atomic.h needs __builtin_*_overflow (GCC/Clang)
+#endif
+
+#ifdef __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE
+namespace __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE {
+#endif
+
+enum class AtomicOverflowPolicy { Reject, Saturate, Report };
+
+namespace detail
+{
+	// the same checks as overflowchecked's operators, but through the compiler builtins (GCC/Clang), which
+	// give the wrapped result and the overflow flag in one go (add/sub compile to the add + jo/jc pair)
+	enum class AtomicOp { Add, Sub, Mul };
+
+	template <AtomicOp Op, typename T> inline bool AtomicApply(T lhs, T rhs, T& result)
+	{
+		if constexpr (Op == AtomicOp::Add)		return __builtin_add_overflow(lhs, rhs, &result);
+		else if constexpr (Op == AtomicOp::Sub)	return __builtin_sub_overflow(lhs, rhs, &result);
+		else									return __builtin_mul_overflow(lhs, rhs, &result);
+	}
+
+	// the direction of the overflow, for saturation: the sign of the exact result
+	template <AtomicOp Op, typename T> inline T AtomicSaturated(T lhs, T rhs)
+	{
+		bool bPositive;
+		if constexpr (Op == AtomicOp::Add)		bPositive = rhs > 0;
+		else if constexpr (Op == AtomicOp::Sub)	bPositive = rhs < 0;
+		else									bPositive = (lhs < 0) == (rhs < 0);
+		return bPositive ? std::numeric_limits<T>::max() : std::numeric_limits<T>::min();
+	}
+
+	template <AtomicOp Op, typename T> [[noreturn]] void SignalAtomicOverflow(T lhs, T rhs)
+	{
+		constexpr const char* opName = Op == AtomicOp::Add ? "+" : Op == AtomicOp::Sub ? "-" : "*";
+		SignalOverflowError<T>(nullptr, std::string(typeid(T).name()) + " atomic op" + opName + " overflow: " +
+			std::to_string(lhs) + opName + std::to_string(rhs) + " does not fit in range " +
+			std::to_string(std::numeric_limits<T>::min()) + ".." + std::to_string(std::numeric_limits<T>::max()));
+	}
+}
+
+template <typename T, AtomicOverflowPolicy Policy = AtomicOverflowPolicy::Reject>
+class atomic_overflowchecked {
+	static_assert(std::is_integral<T>::value && !std::is_same<T, bool>::value, "atomic_overflowchecked<T> is for integer types");
+private:
+	std::atomic<T> m_value;
+
+	static bool IsOverflowCheckActive() { return detail::OverflowcheckedAccess::IsCheckActive<T>(); }
+
+	template <detail::AtomicOp Op> T FetchCAS(T arg, std::memory_order order, bool bCheck)
+	{
+		T expected = m_value.load(std::memory_order_relaxed);
+		T desired;
+		for (;;)
+		{
+			const bool bOverflow = detail::AtomicApply<Op>(expected, arg, desired) && bCheck;
+			if (bOverflow && Policy == AtomicOverflowPolicy::Reject)
+				detail::SignalAtomicOverflow<Op>(expected, arg);		// nothing stored
+			if (bOverflow && Policy == AtomicOverflowPolicy::Saturate)
+				desired = detail::AtomicSaturated<Op>(expected, arg);
+			if (m_value.compare_exchange_weak(expected, desired, order, std::memory_order_relaxed))
+			{
+				if (bOverflow && Policy == AtomicOverflowPolicy::Report)
+					detail::SignalAtomicOverflow<Op>(expected, arg);	// already stored
+				return expected;
+			}
+		}
+	}
+
+	// xadd, then the previous value tells whether it wrapped
+	template <detail::AtomicOp Op> T FetchXadd(T arg, std::memory_order order)
+	{
+		const T previous = Op == detail::AtomicOp::Add ? m_value.fetch_add(arg, order) : m_value.fetch_sub(arg, order);
+		T result;
+		if (detail::AtomicApply<Op>(previous, arg, result))
+			detail::SignalAtomicOverflow<Op>(previous, arg);
+		return previous;
+	}
+
+	template <detail::AtomicOp Op> T Fetch(T arg, std::memory_order order)
+	{
+		if (!IsOverflowCheckActive())
+		{
+			if constexpr (Op == detail::AtomicOp::Add)		return m_value.fetch_add(arg, order);
+			else if constexpr (Op == detail::AtomicOp::Sub)	return m_value.fetch_sub(arg, order);
+			else											return FetchCAS<Op>(arg, order, false);
+		}
+		if constexpr (Policy == AtomicOverflowPolicy::Report && Op != detail::AtomicOp::Mul)
+			return FetchXadd<Op>(arg, order);
+		else
+			return FetchCAS<Op>(arg, order, true);
+	}
+
+public:
+	typedef T value_type;
+	static constexpr AtomicOverflowPolicy policy = Policy;
+	static constexpr bool is_always_lock_free = std::atomic<T>::is_always_lock_free;
+
+	atomic_overflowchecked() : m_value(T(0)) {}
+	atomic_overflowchecked(T initval) : m_value(initval) {}
+	atomic_overflowchecked(overflowchecked<T> initval) : m_value(static_cast<T>(initval)) {}
+	atomic_overflowchecked(const atomic_overflowchecked&) = delete;
+	atomic_overflowchecked& operator= (const atomic_overflowchecked&) = delete;
+
+	// all of them return the previous value, like std::atomic
+	T fetch_add(T arg, std::memory_order order = std::memory_order_seq_cst) { return Fetch<detail::AtomicOp::Add>(arg, order); }
+	T fetch_sub(T arg, std::memory_order order = std::memory_order_seq_cst) { return Fetch<detail::AtomicOp::Sub>(arg, order); }
+	T fetch_mul(T arg, std::memory_order order = std::memory_order_seq_cst) { return Fetch<detail::AtomicOp::Mul>(arg, order); }
+
+	// overflowchecked operands: their own value is in range already, only the operation is checked here
+	template <typename U> T fetch_add(overflowchecked<U> arg, std::memory_order order = std::memory_order_seq_cst) { return fetch_add(static_cast<T>(overflowchecked<T>(static_cast<U>(arg))), order); }
+	template <typename U> T fetch_sub(overflowchecked<U> arg, std::memory_order order = std::memory_order_seq_cst) { return fetch_sub(static_cast<T>(overflowchecked<T>(static_cast<U>(arg))), order); }
+	template <typename U> T fetch_mul(overflowchecked<U> arg, std::memory_order order = std::memory_order_seq_cst) { return fetch_mul(static_cast<T>(overflowchecked<T>(static_cast<U>(arg))), order); }
+
+	// the result of the operation, which (with Saturate) is the clamped value actually stored
+	T operator+= (T arg) { return Result<detail::AtomicOp::Add>(fetch_add(arg), arg); }
+	T operator-= (T arg) { return Result<detail::AtomicOp::Sub>(fetch_sub(arg), arg); }
+	T operator*= (T arg) { return Result<detail::AtomicOp::Mul>(fetch_mul(arg), arg); }
+	T operator++ () { return *this += T(1); }
+	T operator-- () { return *this -= T(1); }
+	T operator++ (int) { return fetch_add(T(1)); }
+	T operator-- (int) { return fetch_sub(T(1)); }
+
+	overflowchecked<T> load(std::memory_order order = std::memory_order_seq_cst) const { return overflowchecked<T>(m_value.load(order)); }
+	void store(T value, std::memory_order order = std::memory_order_seq_cst) { m_value.store(value, order); }
+	T exchange(T value, std::memory_order order = std::memory_order_seq_cst) { return m_value.exchange(value, order); }
+	bool compare_exchange_weak(T& expected, T desired, std::memory_order order = std::memory_order_seq_cst) { return m_value.compare_exchange_weak(expected, desired, order); }
+	bool compare_exchange_strong(T& expected, T desired, std::memory_order order = std::memory_order_seq_cst) { return m_value.compare_exchange_strong(expected, desired, order); }
+	operator T () const { return m_value.load(); }
+	bool is_lock_free() const { return m_value.is_lock_free(); }
+
+private:
+	template <detail::AtomicOp Op> static T Result(T previous, T arg)
+	{
+		T result;
+		if (detail::AtomicApply<Op>(previous, arg, result) && Policy == AtomicOverflowPolicy::Saturate && IsOverflowCheckActive())
+			return detail::AtomicSaturated<Op>(previous, arg);
+		return result;
+	}
+};
+
+#ifdef __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE
+} // namespace __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE
+#endif
@@ -0,0 +1,276 @@
+#pragma once
+
+// bounded<T, Lo, Hi> -- integers that carry their value range in the type, so overflow checks can be decided
+// at compile time. The operators compute the exact range of the result from the operand ranges; when that range
+// fits the common type, the result is returned as a bounded<> with that range and no runtime check is emitted at
+// all (e.g. adding two bounded<int, 0, 65535> values). Only when the result range can exceed the common type
+// is the exact result checked at runtime, and reported through SignalOverflowError like overflowchecked does.
+// Narrowing into a declared target range (assigning to bounded<T, 0, 1000>) is likewise checked only if the
+// source range isn't already inside the target range.
+//
+// Conversions to and from overflowchecked<T> are explicit (and checked), conversion to T is implicit.
+// Needs a 128-bit integer type (GCC/Clang) for the range arithmetic and the compiler's overflow builtins.
+
+#include "INTO.h"
+
+#include <limits>
+#include <string>
+#include <type_traits>
+
+#if !defined(__SIZEOF_INT128__)
+#error INTO_bounded.h needs __int128 and __builtin_*_overflow (GCC/Clang)
+#endif
+
+#ifdef __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE
+namespace __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE {
+#endif
+
+template <typename T, T Lo = std::numeric_limits<T>::min(), T Hi = std::numeric_limits<T>::max()>
+class bounded;
+
+// single-value range, for constants in bounded expressions: x * bounded_constant<1000>()
+template <auto V>
+using bounded_constant = bounded<decltype(V), V, V>;
+
+namespace detail
+{
+	typedef __int128 BoundedRange_t;
+	constexpr BoundedRange_t BOUNDED_RANGE_MAX = static_cast<BoundedRange_t>(~static_cast<unsigned __int128>(0) >> 1);
+	constexpr BoundedRange_t BOUNDED_RANGE_MIN = -BOUNDED_RANGE_MAX - 1;
+
+	// range endpoints of products can exceed 128 bits (uint64 * uint64), they saturate:
+	// such a range exceeds every common type anyway
+	constexpr BoundedRange_t SaturatingMul(BoundedRange_t a, BoundedRange_t b)
+	{
+		return
+			a == 0 || b == 0 ? 0 :
+			(a > 0) == (b > 0) ?
+				((a > 0 ? a : -a) > BOUNDED_RANGE_MAX / (b > 0 ? b : -b) ? BOUNDED_RANGE_MAX : a * b) :
+				((a > 0 ? a : -a) > BOUNDED_RANGE_MAX / (b > 0 ? b : -b) ? BOUNDED_RANGE_MIN : a * b);
+	}
+
+	constexpr BoundedRange_t Min4(BoundedRange_t a, BoundedRange_t b, BoundedRange_t c, BoundedRange_t d)
+	{
+		return (a < b ? a : b) < (c < d ? c : d) ? (a < b ? a : b) : (c < d ? c : d);
+	}
+	constexpr BoundedRange_t Max4(BoundedRange_t a, BoundedRange_t b, BoundedRange_t c, BoundedRange_t d)
+	{
+		return (a > b ? a : b) > (c > d ? c : d) ? (a > b ? a : b) : (c > d ? c : d);
+	}
+
+	template <typename T> constexpr BoundedRange_t TypeMin() { return static_cast<BoundedRange_t>(std::numeric_limits<T>::min()); }
+	template <typename T> constexpr BoundedRange_t TypeMax() { return static_cast<BoundedRange_t>(std::numeric_limits<T>::max()); }
+
+	template <typename T> constexpr T ClampToType(BoundedRange_t value)
+	{
+		return static_cast<T>(value < TypeMin<T>() ? TypeMin<T>() : value > TypeMax<T>() ? TypeMax<T>() : value);
+	}
+
+	// divisors to try for the quotient range: the endpoints, and +-1 when the range crosses zero
+	// (0 itself is excluded, it's caught at runtime)
+	constexpr BoundedRange_t DivisorNearZero(BoundedRange_t lo, BoundedRange_t hi, bool positive)
+	{
+		return positive ? (hi >= 1 ? (lo >= 1 ? lo : 1) : hi) : (lo <= -1 ? (hi <= -1 ? hi : -1) : lo);
+	}
+	// for a fixed divisor the quotient grows with the numerator, and on either side of zero it is monotonic in the
+	// divisor, so the extremes are among the numerator endpoints divided by the divisor candidates above
+	constexpr BoundedRange_t QuotientExtreme(BoundedRange_t lo1, BoundedRange_t hi1, BoundedRange_t lo2, BoundedRange_t hi2, bool largest)
+	{
+		const BoundedRange_t divisors[4] = { lo2, hi2, DivisorNearZero(lo2, hi2, true), DivisorNearZero(lo2, hi2, false) };
+		const BoundedRange_t numerators[2] = { lo1, hi1 };
+		bool bFound = false;
+		BoundedRange_t extreme = 0;								// divisor range {0}: every division is reported anyway
+		for (BoundedRange_t d : divisors)
+		{
+			if (d == 0)
+				continue;
+			for (BoundedRange_t n : numerators)
+			{
+				const BoundedRange_t q = n / d;
+				if (!bFound || (largest ? q > extreme : q < extreme))
+					extreme = q, bFound = true;
+			}
+		}
+		return extreme;
+	}
+
+	template <typename C, BoundedRange_t ResultLo, BoundedRange_t ResultHi>
+	struct BoundedResult
+	{
+		static constexpr bool NEEDS_CHECK = ResultLo < TypeMin<C>() || ResultHi > TypeMax<C>();
+		typedef bounded<C, ClampToType<C>(ResultLo), ClampToType<C>(ResultHi)> type;
+	};
+
+	template <typename T> std::string BoundedDescribe(T lo, T hi)
+	{
+		return std::string("bounded<") + typeid(T).name() + "," + std::to_string(lo) + "," + std::to_string(hi) + ">";
+	}
+}
+
+template <typename T, T Lo, T Hi>
+class bounded {
+	static_assert(std::is_integral<T>::value, "bounded<T, Lo, Hi> is for integer types");
+	static_assert(Lo <= Hi, "bounded<T, Lo, Hi> needs Lo <= Hi");
+private:
+	T m_value;
+	struct unchecked_tag {};
+	bounded(T value, unchecked_tag) : m_value(value) {}
+
+	static constexpr bool RangeContains(detail::BoundedRange_t lo, detail::BoundedRange_t hi)
+	{
+		return lo >= static_cast<detail::BoundedRange_t>(Lo) && hi <= static_cast<detail::BoundedRange_t>(Hi);
+	}
+
+	template <typename U> void InitChecked(U initval, const char* what)
+	{
+		if (static_cast<detail::BoundedRange_t>(initval) < static_cast<detail::BoundedRange_t>(Lo) ||
+			static_cast<detail::BoundedRange_t>(initval) > static_cast<detail::BoundedRange_t>(Hi))
+		{
+			SignalOverflowError<T>(nullptr, detail::BoundedDescribe<T>(Lo, Hi) + " " + what + " overflow: " +
+				std::to_string(initval) + " is not in range " + std::to_string(Lo) + ".." + std::to_string(Hi));
+		}
+		m_value = static_cast<T>(initval);
+	}
+
+public:
+	typedef T value_type;
+	static constexpr T min_value = Lo;
+	static constexpr T max_value = Hi;
+
+	// never uninitialized: the elided checks rely on the value being in range (a bounded_constant<V>() is V)
+	bounded() : m_value(Lo <= T(0) && T(0) <= Hi ? T(0) : Lo) {}
+
+	// from plain integers: checked unless every value of U is in range
+	template <typename U, typename std::enable_if<std::is_integral<U>::value, int>::type = 0>
+	bounded(U initval)
+	{
+		if constexpr (RangeContains(detail::TypeMin<U>(), detail::TypeMax<U>()))
+			m_value = static_cast<T>(initval);
+		else
+			InitChecked(initval, "initialization");
+	}
+
+	// from other bounded values (including operator results): checked only if the source range isn't inside ours
+	template <typename U, U L, U H>
+	bounded(bounded<U, L, H> other)
+	{
+		if constexpr (RangeContains(static_cast<detail::BoundedRange_t>(L), static_cast<detail::BoundedRange_t>(H)))
+			m_value = static_cast<T>(static_cast<U>(other));
+		else
+			InitChecked(static_cast<U>(other), "narrowing");
+	}
+
+	template <typename U>
+	explicit bounded(overflowchecked<U> other)
+	{
+		InitChecked(static_cast<U>(other), "conversion from overflowchecked");
+	}
+
+	// the target's own initialization check takes care of the range of U
+	template <typename U>
+	explicit operator overflowchecked<U> () const { return overflowchecked<U>(m_value); }
+
+	operator T () const { return m_value; }
+
+	// for the operators, which have already established the result is in range
+	static bounded from_unchecked(T value) { return bounded(value, unchecked_tag()); }
+};
+
+// For each operator: the result range is computed from the operand ranges at compile time. If it fits the
+// common type, the naked operation can't overflow and is returned as is; otherwise the compiler builtin tells
+// whether the exact result fits the common type, and the result type's range is clamped to the common type.
+template <typename U, U L1, U H1, typename V, V L2, V H2>
+auto operator+ (bounded<U, L1, H1> lhs, bounded<V, L2, H2> rhs)
+{
+	using common_type = INTO_common_t<U, V>;
+	using info = detail::BoundedResult<common_type,
+		static_cast<detail::BoundedRange_t>(L1) + static_cast<detail::BoundedRange_t>(L2),
+		static_cast<detail::BoundedRange_t>(H1) + static_cast<detail::BoundedRange_t>(H2)>;
+	common_type result;
+	if constexpr (!info::NEEDS_CHECK)
+		result = static_cast<common_type>(static_cast<common_type>(static_cast<U>(lhs)) + static_cast<common_type>(static_cast<V>(rhs)));
+	else if (__builtin_add_overflow(static_cast<U>(lhs), static_cast<V>(rhs), &result))
+	{
+		SignalOverflowError<common_type>(nullptr, std::string("bounded op+ overflow: ") + std::to_string(static_cast<U>(lhs)) + "+" +
+			std::to_string(static_cast<V>(rhs)) + " does not fit in " + typeid(common_type).name());
+	}
+	return info::type::from_unchecked(result);
+}
+
+template <typename U, U L1, U H1, typename V, V L2, V H2>
+auto operator- (bounded<U, L1, H1> lhs, bounded<V, L2, H2> rhs)
+{
+	using common_type = INTO_common_t<U, V>;
+	using info = detail::BoundedResult<common_type,
+		static_cast<detail::BoundedRange_t>(L1) - static_cast<detail::BoundedRange_t>(H2),
+		static_cast<detail::BoundedRange_t>(H1) - static_cast<detail::BoundedRange_t>(L2)>;
+	common_type result;
+	if constexpr (!info::NEEDS_CHECK)
+		result = static_cast<common_type>(static_cast<common_type>(static_cast<U>(lhs)) - static_cast<common_type>(static_cast<V>(rhs)));
+	else if (__builtin_sub_overflow(static_cast<U>(lhs), static_cast<V>(rhs), &result))
+	{
+		SignalOverflowError<common_type>(nullptr, std::string("bounded op- overflow: ") + std::to_string(static_cast<U>(lhs)) + "-" +
+			std::to_string(static_cast<V>(rhs)) + " does not fit in " + typeid(common_type).name());
+	}
+	return info::type::from_unchecked(result);
+}
+
+template <typename U, U L1, U H1, typename V, V L2, V H2>
+auto operator* (bounded<U, L1, H1> lhs, bounded<V, L2, H2> rhs)
+{
+	using common_type = INTO_common_t<U, V>;
+	using R = detail::BoundedRange_t;
+	constexpr R p1 = detail::SaturatingMul(R(L1), R(L2)), p2 = detail::SaturatingMul(R(L1), R(H2));
+	constexpr R p3 = detail::SaturatingMul(R(H1), R(L2)), p4 = detail::SaturatingMul(R(H1), R(H2));
+	using info = detail::BoundedResult<common_type, detail::Min4(p1, p2, p3, p4), detail::Max4(p1, p2, p3, p4)>;
+	common_type result;
+	if constexpr (!info::NEEDS_CHECK)
+	{
+		// computed unsigned: the range says it fits, but the naked signed product of promoted types could still
+		// be formally out of range for int when U and V are narrower (it isn't, but the compiler can't know)
+		using unsigned_type = std::make_unsigned_t<common_type>;
+		result = static_cast<common_type>(static_cast<unsigned_type>(static_cast<common_type>(static_cast<U>(lhs))) *
+			static_cast<unsigned_type>(static_cast<common_type>(static_cast<V>(rhs))));
+	}
+	else if (__builtin_mul_overflow(static_cast<U>(lhs), static_cast<V>(rhs), &result))
+	{
+		SignalOverflowError<common_type>(nullptr, std::string("bounded op* overflow: ") + std::to_string(static_cast<U>(lhs)) + "*" +
+			std::to_string(static_cast<V>(rhs)) + " does not fit in " + typeid(common_type).name());
+	}
+	return info::type::from_unchecked(result);
+}
+
+// Quotient extremes are at the numerator endpoints divided by the divisor endpoints, or by the divisors nearest
+// to zero (+-1) when the divisor range crosses zero.
+// A divisor range containing 0 costs a runtime zero test, reported like an overflow.
+template <typename U, U L1, U H1, typename V, V L2, V H2>
+auto operator/ (bounded<U, L1, H1> lhs, bounded<V, L2, H2> rhs)
+{
+	using common_type = INTO_common_t<U, V>;
+	using R = detail::BoundedRange_t;
+	constexpr R lo = detail::QuotientExtreme(R(L1), R(H1), R(L2), R(H2), false);
+	constexpr R hi = detail::QuotientExtreme(R(L1), R(H1), R(L2), R(H2), true);
+	using info = detail::BoundedResult<common_type, lo, hi>;
+	if constexpr (R(L2) <= 0 && R(H2) >= 0)
+	{
+		if (static_cast<V>(rhs) == 0)
+			SignalOverflowError<common_type>(nullptr, std::string("bounded op/ division by zero: ") + std::to_string(static_cast<U>(lhs)) + "/0");
+	}
+	if constexpr (info::NEEDS_CHECK)
+	{
+		// the exact quotient leaves the common type only for MIN / -1, or a negative operand with an unsigned common type
+		const R exact = R(static_cast<U>(lhs)) / R(static_cast<V>(rhs));
+		if (exact < detail::TypeMin<common_type>() || exact > detail::TypeMax<common_type>())
+		{
+			SignalOverflowError<common_type>(nullptr, std::string("bounded op/ overflow: ") + std::to_string(static_cast<U>(lhs)) + "/" +
+				std::to_string(static_cast<V>(rhs)) + " does not fit in " + typeid(common_type).name());
+		}
+		return info::type::from_unchecked(static_cast<common_type>(exact));
+	}
+	else
+		return info::type::from_unchecked(static_cast<common_type>(static_cast<common_type>(static_cast<U>(lhs)) / static_cast<common_type>(static_cast<V>(rhs))));
+}
+
+#ifdef __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE
+} // namespace __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE
+#endif
@@ -0,0 +1,264 @@
+#pragma once
+
+// INTO::constant<V> -- compile-time constant operands for overflowchecked arithmetic.
+//
+// The general operators in INTO.h don't know anything about their operands, so x * 1000 costs a trial division
+// and x + offset two ordering checks. With one operand known at compile time, the valid range of the other one
+// can be precomputed, and the overflow test becomes a single compare (for signed types one unsigned compare
+// against the width of the range), no division at all:
+//
+//		using namespace INTO::literals;
+//		into ms = seconds * 1000_ic;				// overflow iff seconds is outside [INT_MIN/1000, INT_MAX/1000]
+//		into y = x + INTO::constant<kOffset>();		// overflow iff x > INT_MAX - kOffset
+//
+// The literal's type follows the rules for decimal literals: int, long or long long, whichever fits first
+// (hexadecimal/binary literals may be unsigned). For other types spell out the constant: INTO::constant<1000u>().
+// Results have the same type as the general operators would produce, INTO_common_t<U, decltype(V)>.
+
+#include "INTO.h"
+
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
+
+#ifdef __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE
+namespace __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE {
+#endif
+
+namespace INTO
+{
+	template <auto V>
+	struct constant {
+		static_assert(std::is_integral<decltype(V)>::value, "INTO::constant<V> is for integer constants");
+		typedef decltype(V) value_type;
+		static constexpr value_type value = V;
+		constexpr operator value_type () const { return V; }
+		template <auto W = V, typename std::enable_if<std::is_signed<decltype(W)>::value, int>::type = 0>
+		constexpr constant<-W> operator- () const
+		{
+			static_assert(W != std::numeric_limits<decltype(W)>::min(), "negating INTO::constant overflows");
+			return {};
+		}
+	};
+
+	namespace details
+	{
+		using ConstAccess = detail::OverflowcheckedAccess;
+
+		// The valid range of x for each operation, in the common type: lo <= x <= hi.
+		template <typename C, C K> struct MulRange
+		{
+			static_assert(K != 0, "MulRange is not used for 0");
+			// C++ division truncates towards zero, which is the rounding each bound needs (ceil for the
+			// negative bound, floor for the positive one); K == -1 would overflow MIN / K
+			static constexpr C lo = K > 0 ? std::numeric_limits<C>::min() / K : std::numeric_limits<C>::max() / K;
+			static constexpr C hi = K > 0 ? std::numeric_limits<C>::max() / K : (K == C(-1) ? std::numeric_limits<C>::max() : std::numeric_limits<C>::min() / K);
+		};
+		template <typename C, C K> struct AddRange
+		{
+			static constexpr C lo = K < 0 ? C(std::numeric_limits<C>::min() - K) : std::numeric_limits<C>::min();
+			static constexpr C hi = K > 0 ? C(std::numeric_limits<C>::max() - K) : std::numeric_limits<C>::max();
+		};
+		template <typename C, C K> struct SubRange		// x - K
+		{
+			static constexpr C lo = K > 0 ? C(std::numeric_limits<C>::min() + K) : std::numeric_limits<C>::min();
+			static constexpr C hi = K < 0 ? C(std::numeric_limits<C>::max() + K) : std::numeric_limits<C>::max();
+		};
+		template <typename C, C K> struct RevSubRange	// K - x
+		{
+			// K >= 0: K - x can only go above MAX; K < 0: only below MIN (K == -1 can't overflow at all)
+			static constexpr C lo = std::is_signed<C>::value && K >= 0 ? C(K - std::numeric_limits<C>::max()) : std::numeric_limits<C>::min();
+			static constexpr C hi = std::is_signed<C>::value ? (K < 0 ? C(K - std::numeric_limits<C>::min()) : std::numeric_limits<C>::max()) : K;
+		};
+
+		// one compare: x - lo wraps around to a huge unsigned value if x < lo
+		template <typename C, C lo, C hi> constexpr bool OutOfRange(C x)
+		{
+			using unsigned_type = std::make_unsigned_t<C>;
+			if constexpr (lo == std::numeric_limits<C>::min() && hi == std::numeric_limits<C>::max())
+				return false;
+			else if constexpr (lo == std::numeric_limits<C>::min())
+				return x > hi;
+			else if constexpr (hi == std::numeric_limits<C>::max())
+				return x < lo;
+			else
+				return static_cast<unsigned_type>(static_cast<unsigned_type>(x) - static_cast<unsigned_type>(lo)) >
+					static_cast<unsigned_type>(static_cast<unsigned_type>(hi) - static_cast<unsigned_type>(lo));
+		}
+
+		// the constant has to survive the conversion to the common type (e.g. no -1 with unsigned operands)
+		template <typename C, auto V> constexpr C ConstantAs()
+		{
+			static_assert(static_cast<decltype(V)>(static_cast<C>(V)) == V && (static_cast<C>(V) < 0) == (V < 0),
+				"INTO::constant does not fit in the common type of the operation");
+			return static_cast<C>(V);
+		}
+
+		// the operand as common type; a negative value converted to an unsigned common type is an overflow itself
+		template <typename C, typename U> inline bool ConvertOperand(const overflowchecked<U>& x, C& result)
+		{
+			const U value = ConstAccess::Value(x);
+			result = static_cast<C>(value);
+			if constexpr (std::is_signed<U>::value && std::is_unsigned<C>::value)
+				return value < 0;
+			else
+				return false;
+		}
+
+		template <typename C, typename U> [[noreturn]] void SignalConstantOverflow(const overflowchecked<U>& x,
+			const char* op, std::string expression, C lo, C hi)
+		{
+			SignalOverflowError(&x, (std::is_same<U, C>::value ?
+				std::string(typeid(U).name()) :
+				std::string(typeid(U).name()) + " [common:" + typeid(C).name() + "]") +
+				" op" + op + " overflow: " + expression + " does not fit in range " +
+				std::to_string(std::numeric_limits<C>::min()) + ".." + std::to_string(std::numeric_limits<C>::max()) +
+				" (operand range " + std::to_string(lo) + ".." + std::to_string(hi) + ")");
+		}
+
+		// literal parsing: decimal, 0x, 0b, 0 (octal) and ' separators
+		template <char... Cs> constexpr unsigned long long ParseLiteral()
+		{
+			constexpr char digits[] = { Cs..., '\0' };
+			unsigned long long base = 10, result = 0;
+			int i = 0;
+			if (digits[0] == '0' && (digits[1] == 'x' || digits[1] == 'X'))		{ base = 16; i = 2; }
+			else if (digits[0] == '0' && (digits[1] == 'b' || digits[1] == 'B'))	{ base = 2; i = 2; }
+			else if (digits[0] == '0' && digits[1] != '\0')						{ base = 8; i = 1; }
+			for (; digits[i] != '\0'; ++i)
+			{
+				const char c = digits[i];
+				if (c == '\'')
+					continue;
+				const unsigned long long digit =
+					c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : c - 'A' + 10;
+				if (result > (std::numeric_limits<unsigned long long>::max() - digit) / base)
+					throw std::overflow_error("INTO literal does not fit in unsigned long long");	// compile time error
+				result = result * base + digit;
+			}
+			return result;
+		}
+		template <char... Cs> constexpr bool IsDecimalLiteral()
+		{
+			constexpr char digits[] = { Cs..., '\0' };
+			return digits[0] != '0' || digits[1] == '\0';
+		}
+		template <unsigned long long N, bool decimal> constexpr auto LiteralValue()
+		{
+			if constexpr (N <= static_cast<unsigned long long>(std::numeric_limits<int>::max()))			return static_cast<int>(N);
+			else if constexpr (!decimal && N <= std::numeric_limits<unsigned int>::max())					return static_cast<unsigned int>(N);
+			else if constexpr (N <= static_cast<unsigned long long>(std::numeric_limits<long>::max()))		return static_cast<long>(N);
+			else if constexpr (!decimal && N <= std::numeric_limits<unsigned long>::max())					return static_cast<unsigned long>(N);
+			else if constexpr (N <= static_cast<unsigned long long>(std::numeric_limits<long long>::max()))	return static_cast<long long>(N);
+			else
+			{
+				static_assert(!decimal, "decimal INTO literal does not fit in long long");
+				return N;
+			}
+		}
+	}
+
+	namespace literals
+	{
+		template <char... Cs> constexpr auto operator"" _ic()
+		{
+			return constant<details::LiteralValue<details::ParseLiteral<Cs...>(), details::IsDecimalLiteral<Cs...>()>()>{};
+		}
+	}
+
+	// x * K: 0 and 1 are free, everything else is one compare against the precomputed range
+	template <typename U, auto V> const overflowchecked<INTO_common_t<U, decltype(V)>> operator* (overflowchecked<U> lhs, constant<V>)
+	{
+		using common_type = INTO_common_t<U, decltype(V)>;
+		constexpr common_type k = details::ConstantAs<common_type, V>();
+		common_type x;
+		const bool bNegativeToUnsigned = details::ConvertOperand(lhs, x);
+		if constexpr (k == 0)
+			return details::ConstAccess::FromUnchecked<common_type>(0);
+		else
+		{
+			using range = details::MulRange<common_type, k>;
+			if (details::ConstAccess::IsCheckActive<U>() && (bNegativeToUnsigned || details::OutOfRange<common_type, range::lo, range::hi>(x)))
+				details::SignalConstantOverflow<common_type>(lhs, "*", std::to_string(details::ConstAccess::Value(lhs)) + "*" + std::to_string(k), range::lo, range::hi);
+			using unsigned_type = std::make_unsigned_t<common_type>;
+			return details::ConstAccess::FromUnchecked<common_type>(static_cast<common_type>(static_cast<unsigned_type>(x) * static_cast<unsigned_type>(k)));
+		}
+	}
+	template <typename U, auto V> const overflowchecked<INTO_common_t<U, decltype(V)>> operator* (constant<V> lhs, overflowchecked<U> rhs)
+	{
+		return rhs * lhs;
+	}
+
+	template <typename U, auto V> const overflowchecked<INTO_common_t<U, decltype(V)>> operator+ (overflowchecked<U> lhs, constant<V>)
+	{
+		using common_type = INTO_common_t<U, decltype(V)>;
+		constexpr common_type k = details::ConstantAs<common_type, V>();
+		using range = details::AddRange<common_type, k>;
+		common_type x;
+		const bool bNegativeToUnsigned = details::ConvertOperand(lhs, x);
+		if (details::ConstAccess::IsCheckActive<U>() && (bNegativeToUnsigned || details::OutOfRange<common_type, range::lo, range::hi>(x)))
+			details::SignalConstantOverflow<common_type>(lhs, "+", std::to_string(details::ConstAccess::Value(lhs)) + "+" + std::to_string(k), range::lo, range::hi);
+		using unsigned_type = std::make_unsigned_t<common_type>;
+		return details::ConstAccess::FromUnchecked<common_type>(static_cast<common_type>(static_cast<unsigned_type>(x) + static_cast<unsigned_type>(k)));
+	}
+	template <typename U, auto V> const overflowchecked<INTO_common_t<U, decltype(V)>> operator+ (constant<V> lhs, overflowchecked<U> rhs)
+	{
+		return rhs + lhs;
+	}
+
+	template <typename U, auto V> const overflowchecked<INTO_common_t<U, decltype(V)>> operator- (overflowchecked<U> lhs, constant<V>)
+	{
+		using common_type = INTO_common_t<U, decltype(V)>;
+		constexpr common_type k = details::ConstantAs<common_type, V>();
+		using range = details::SubRange<common_type, k>;
+		common_type x;
+		const bool bNegativeToUnsigned = details::ConvertOperand(lhs, x);
+		if (details::ConstAccess::IsCheckActive<U>() && (bNegativeToUnsigned || details::OutOfRange<common_type, range::lo, range::hi>(x)))
+			details::SignalConstantOverflow<common_type>(lhs, "-", std::to_string(details::ConstAccess::Value(lhs)) + "-" + std::to_string(k), range::lo, range::hi);
+		using unsigned_type = std::make_unsigned_t<common_type>;
+		return details::ConstAccess::FromUnchecked<common_type>(static_cast<common_type>(static_cast<unsigned_type>(x) - static_cast<unsigned_type>(k)));
+	}
+	template <typename U, auto V> const overflowchecked<INTO_common_t<U, decltype(V)>> operator- (constant<V>, overflowchecked<U> rhs)
+	{
+		using common_type = INTO_common_t<U, decltype(V)>;
+		constexpr common_type k = details::ConstantAs<common_type, V>();
+		using range = details::RevSubRange<common_type, k>;
+		common_type x;
+		const bool bNegativeToUnsigned = details::ConvertOperand(rhs, x);
+		if (details::ConstAccess::IsCheckActive<U>() && (bNegativeToUnsigned || details::OutOfRange<common_type, range::lo, range::hi>(x)))
+			details::SignalConstantOverflow<common_type>(rhs, "-", std::to_string(k) + "-" + std::to_string(details::ConstAccess::Value(rhs)), range::lo, range::hi);
+		using unsigned_type = std::make_unsigned_t<common_type>;
+		return details::ConstAccess::FromUnchecked<common_type>(static_cast<common_type>(static_cast<unsigned_type>(k) - static_cast<unsigned_type>(x)));
+	}
+
+	// x / K: only MIN / -1 can overflow, everything else needs no check at all
+	template <typename U, auto V> const overflowchecked<INTO_common_t<U, decltype(V)>> operator/ (overflowchecked<U> lhs, constant<V>)
+	{
+		using common_type = INTO_common_t<U, decltype(V)>;
+		constexpr common_type k = details::ConstantAs<common_type, V>();
+		static_assert(k != 0, "division by INTO::constant<0>");
+		common_type x;
+		const bool bNegativeToUnsigned = details::ConvertOperand(lhs, x);
+		constexpr common_type lo = std::is_signed<common_type>::value && k == common_type(-1) ? common_type(std::numeric_limits<common_type>::min() + 1) : std::numeric_limits<common_type>::min();
+		if (details::ConstAccess::IsCheckActive<U>() && (bNegativeToUnsigned || details::OutOfRange<common_type, lo, std::numeric_limits<common_type>::max()>(x)))
+			details::SignalConstantOverflow<common_type>(lhs, "/", std::to_string(details::ConstAccess::Value(lhs)) + "/" + std::to_string(k), lo, std::numeric_limits<common_type>::max());
+		return details::ConstAccess::FromUnchecked<common_type>(static_cast<common_type>(x / k));
+	}
+	// K / x: overflows only for K == MIN and x == -1; division by zero is left to the hardware, like in INTO.h
+	template <typename U, auto V> const overflowchecked<INTO_common_t<U, decltype(V)>> operator/ (constant<V>, overflowchecked<U> rhs)
+	{
+		using common_type = INTO_common_t<U, decltype(V)>;
+		constexpr common_type k = details::ConstantAs<common_type, V>();
+		common_type x;
+		const bool bNegativeToUnsigned = details::ConvertOperand(rhs, x);
+		constexpr bool bMinDividend = std::is_signed<common_type>::value && k == std::numeric_limits<common_type>::min();
+		if (details::ConstAccess::IsCheckActive<U>() && (bNegativeToUnsigned || (bMinDividend && x == common_type(-1))))
+			details::SignalConstantOverflow<common_type>(rhs, "/", std::to_string(k) + "/" + std::to_string(details::ConstAccess::Value(rhs)), std::numeric_limits<common_type>::min(), std::numeric_limits<common_type>::max());
+		return details::ConstAccess::FromUnchecked<common_type>(static_cast<common_type>(k / x));
+	}
+}
+
+#ifdef __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE
+} // namespace __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE
+#endif
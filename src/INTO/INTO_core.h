@@ -0,0 +1,616 @@
+#pragma once
+
+//TODO implement __DEBUG_CHECK_INTEGER_OVERFLOW_USE_X86_64_ASM routines for mixed types
+//TODO integrate __DEBUG_CHECK_INTEGER_OVERFLOW_USE_X86_64_ASM into operators
+//TODO make static_assert overflow check work on non-MSVC compilers
+//TODO implement other operators & operator members
+
+// The core of INTO: overflowchecked<T>, the checks and the operators, with as few includes as possible.
+// Everything that builds messages or throws (INTO_exception, SignalOverflowError, the message formatting) is
+// in INTO_report.h; the operators only call the non-template detail::Report... functions declared here.
+// By default those are defined inline and INTO_report.h is included at the end of this file, as before.
+// With __DEBUG_CHECK_INTEGER_OVERFLOW_PRECOMPILED defined project-wide, INTO.cpp has to be compiled and
+// linked in: it holds the reporting code and the explicit instantiations for the alias types (unsignedo,
+// into, llongo, ...), which are declared extern template here, so TUs including only this header don't
+// see <string>/<stdexcept> at all and don't instantiate the operators for those types themselves.
+
+#include <type_traits>
+#include <typeinfo>
+#include <limits>
+#include <cstdint>
+
+#ifdef __DEBUG_CHECK_INTEGER_OVERFLOW_PRECOMPILED
+#define INTO_REPORT_INLINE
+#else
+#define INTO_REPORT_INLINE		inline
+#endif
+
+// sampled checking (INTO_sampled.h): the Report... functions return when a handler took the report
+#ifdef __DEBUG_CHECK_INTEGER_OVERFLOW_SAMPLED
+#include "INTO_sampled.h"
+#define INTO_REPORT_NORETURN
+#else
+#define INTO_REPORT_NORETURN	[[noreturn]]
+#endif
+
+#ifdef __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE
+namespace __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE {
+#endif
+
+template<typename T, typename U> using INTO_common_t = std::common_type_t<T, U>;
+
+#ifdef __DEBUG_CHECK_INTEGER_OVERFLOW
+#define CREATE_TYPE_ALIAS_WITHNAME(type,aliasprefix)	typedef overflowchecked<type> aliasprefix##o;
+#else
+#define CREATE_TYPE_ALIAS_WITHNAME(type,aliasprefix)	typedef type aliasprefix##o;
+#endif
+#define CREATE_TYPE_ALIAS(type)		CREATE_TYPE_ALIAS_WITHNAME(type,type)
+
+inline constexpr bool OVERFLOWCHECK_ON_BY_DEFAULT = true;
+inline constexpr bool SKIP_INITIALIZATION_CHECK = false;
+
+template <typename T>
+class overflowchecked;
+
+namespace detail
+{
+	template<typename T, bool = std::is_signed<T>::value>
+	struct MaximumEncloser_ { typedef intmax_t type; };
+	template <typename T>
+	struct MaximumEncloser_<T, false> { typedef uintmax_t type; };
+
+	// back door for the headers built on overflowchecked (INTO_constant.h, ...), defined below the class
+	struct OverflowcheckedAccess;
+}
+
+template <typename T>
+using MaximumEncloser_t = typename detail::MaximumEncloser_<T>::type;
+
+namespace detail
+{
+	// an operand of a failed check, as the (non-template) reporting code gets it: the type and the value
+	// widened to MaximumEncloser_t, stored as unsigned
+	struct ReportedOperand
+	{
+		const std::type_info* type;
+		bool bSigned;
+		uintmax_t bits;
+	};
+
+	template <typename T> inline ReportedOperand Reported(T value)
+	{
+		return { &typeid(T), std::is_signed<T>::value, static_cast<uintmax_t>(static_cast<MaximumEncloser_t<T>>(value)) };
+	}
+
+	// which side of the common type's range the exact result is on, if the check tells
+	enum class OverflowDirection { Above, Below, Unknown };
+
+	// defined in INTO_report.h (or INTO.cpp), build the message and throw INTO_exception
+	INTO_REPORT_NORETURN INTO_REPORT_INLINE void ReportInitializationOverflow(ReportedOperand initval, ReportedOperand lowerBound, ReportedOperand upperBound);
+	INTO_REPORT_NORETURN INTO_REPORT_INLINE void ReportOperatorOverflow(const char* op, ReportedOperand lhs, ReportedOperand rhs,
+		ReportedOperand lowerBound, ReportedOperand upperBound, OverflowDirection direction);
+
+	// sign-correct a < b for integers of any signedness (std::cmp_less is C++20)
+	template <typename A, typename B> constexpr bool CmpLess(A a, B b)
+	{
+		if constexpr (std::is_signed<A>::value == std::is_signed<B>::value)
+			return a < b;
+		else if constexpr (std::is_signed<A>::value)
+			return a < 0 || static_cast<std::make_unsigned_t<A>>(a) < b;
+		else
+			return b >= 0 && a < static_cast<std::make_unsigned_t<B>>(b);
+	}
+
+	// true if value has no T representation; integers are compared sign-correctly, anything else through MaximumEncloser_t<T>
+	template <typename T, typename S> constexpr bool OutOfRange(S value)
+	{
+		if constexpr (std::is_integral<S>::value)
+		{
+			return CmpLess(value, std::numeric_limits<T>::min()) || CmpLess(std::numeric_limits<T>::max(), value);
+		}
+		else
+		{
+			const auto extended = static_cast<MaximumEncloser_t<T>>(value);
+			return value != extended || extended < static_cast<MaximumEncloser_t<T>>(std::numeric_limits<T>::min()) ||
+				extended > static_cast<MaximumEncloser_t<T>>(std::numeric_limits<T>::max());
+		}
+	}
+
+#ifndef __DEBUG_CHECK_INTEGER_OVERFLOW_SAMPLED
+	template <char Op, typename U, typename V> constexpr bool SampleThis() { return true; }		// every operation is checked
+#endif
+}
+
+template <typename T>
+class overflowchecked {
+private:
+	T m_value;
+	static bool s_bOverflowCheckActive;
+	bool IsOverflowCheckActive() { return s_bOverflowCheckActive; }
+	bool SkipInitializationCheck() { return SKIP_INITIALIZATION_CHECK; }
+public:
+	overflowchecked() = default;
+	template <typename U> overflowchecked(U initval) {
+		if (!SkipInitializationCheck() && IsOverflowCheckActive())
+		{
+			const auto _initval_source = +initval;					// class types (bounded, ...) through their conversion
+			if (detail::OutOfRange<T>(_initval_source))
+			{
+				detail::ReportInitializationOverflow(detail::Reported(_initval_source),
+					detail::Reported(std::numeric_limits<T>::min()), detail::Reported(std::numeric_limits<T>::max()));
+			}
+		}
+		m_value = static_cast<T>(initval);
+	}
+	operator T () const { return m_value; }
+	template <typename U, typename V> friend inline const overflowchecked<INTO_common_t<U, V>> operator+ (overflowchecked<U> lhs, overflowchecked<V> rhs);
+	template <typename U, typename V> friend inline const overflowchecked<INTO_common_t<U, V>> operator- (overflowchecked<U> lhs, overflowchecked<V> rhs);
+	template <typename U, typename V> friend inline const overflowchecked<INTO_common_t<U, V>> operator* (overflowchecked<U> lhs, overflowchecked<V> rhs);
+	template <typename U, typename V> friend inline const overflowchecked<INTO_common_t<U, V>> operator/ (overflowchecked<U> lhs, overflowchecked<V> rhs);
+	friend struct detail::OverflowcheckedAccess;
+};
+
+#ifdef __DEBUG_CHECK_INTEGER_OVERFLOW_USE_X86_64_ASM
+#ifdef _MSC_VER
+
+#if UINTPTR_MAX == 0xffff'ffff'ffff'ffff    // 64-bit mode, assumably
+#error Can't do __asm on MSVC/x64
+#elif UINTPTR_MAX != 0xffff'ffff			// but not 32-bit mode
+#error Strange ptr size
+#else
+inline bool add_with_oc(uint8_t a, uint8_t b, uint8_t& c)
+{
+	__asm {
+		mov cl, [a]
+		mov dl, [b]
+		add cl, dl
+		setc al
+		mov edx, [c]
+		mov byte ptr[edx], cl
+	}
+}
+inline bool add_with_oc(int8_t a, int8_t b, int8_t& c)
+{
+	__asm {
+		mov cl, [a]
+		mov dl, [b]
+		add cl, dl
+		seto al
+		mov edx, [c]
+		mov byte ptr[edx], cl
+	}
+}
+inline bool add_with_oc(uint16_t a, uint16_t b, uint16_t& c)
+{
+	__asm {
+		mov cx, [a]
+		mov dx, [b]
+		add cx, dx
+		setc al
+		mov edx, [c]
+		mov word ptr[edx], cx
+	}
+}
+inline bool add_with_oc(int16_t a, int16_t b, int16_t& c)
+{
+	__asm {
+		mov cx, [a]
+		mov dx, [b]
+		add cx, dx
+		seto al
+		mov edx, [c]
+		mov word ptr[edx], cx
+	}
+}
+inline bool add_with_oc(uint32_t a, uint32_t b, uint32_t& c)
+{
+	__asm {
+		mov ecx, [a]
+		mov edx, [b]
+		add ecx, edx
+		setc al
+		mov edx, [c]
+		mov[edx], ecx
+	}
+}
+inline bool add_with_oc(int32_t a, int32_t b, int32_t& c)
+{
+	__asm {
+		mov ecx, [a]
+		mov edx, [b]
+		add ecx, edx
+		seto al
+		mov edx, [c]
+		mov[edx], ecx
+	}
+}
+inline bool add_with_oc(uint64_t a, uint64_t b, uint64_t& c)
+{
+	__asm {
+		push esi
+		push edi
+		mov eax, dword ptr[a]
+		mov edx, dword ptr[a + 4]
+		mov esi, dword ptr[b]
+		mov edi, dword ptr[b + 4]
+		add eax, esi
+		adc edx, edi
+		setc cl
+		mov esi, [c]
+		mov dword ptr[esi], eax
+		mov dword ptr[esi + 4], edx
+		pop edi
+		pop esi
+		mov al, cl
+	}
+}
+inline bool add_with_oc(int64_t a, int64_t b, int64_t& c)
+{
+	__asm {
+		push esi
+		push edi
+		mov eax, dword ptr[a]
+		mov edx, dword ptr[a + 4]
+		mov esi, dword ptr[b]
+		mov edi, dword ptr[b + 4]
+		add eax, esi
+		adc edx, edi
+		seto cl
+		mov esi, [c]
+		mov dword ptr[esi], eax
+		mov dword ptr[esi + 4], edx
+		pop edi
+		pop esi
+		mov al, cl
+	}
+}
+#endif //UINTPTR_MAX == 0xffff'ffff / 32-bit mode
+#else //!_MSC_VER
+inline bool add_with_oc(uint8_t a, uint8_t b, uint8_t& c)
+{
+	bool retval;
+	__asm__ volatile (
+		"addb %%dl, %%cl    \n"
+		"setc %%al          \n"
+		: "=c" (c), "=a" (retval)
+		: "c" (a), "d" (b)
+		: );
+	return retval;
+}
+inline bool add_with_oc(int8_t a, int8_t b, int8_t& c)
+{
+	bool retval;
+	__asm__ volatile (
+		"addb %%dl, %%cl    \n"
+		"seto %%al          \n"
+		: "=c" (c), "=a" (retval)
+		: "c" (a), "d" (b)
+		: );
+	return retval;
+}
+inline bool add_with_oc(uint16_t a, uint16_t b, uint16_t& c)
+{
+	bool retval;
+	__asm__ volatile (
+		"addw %%dx, %%cx    \n"
+		"setc %%al          \n"
+		: "=c" (c), "=a" (retval)
+		: "c" (a), "d" (b)
+		: );
+	return retval;
+}
+inline bool add_with_oc(int16_t a, int16_t b, int16_t& c)
+{
+	bool retval;
+	__asm__ volatile (
+		"addw %%dx, %%cx    \n"
+		"seto %%al          \n"
+		: "=c" (c), "=a" (retval)
+		: "c" (a), "d" (b)
+		: );
+	return retval;
+}
+inline bool add_with_oc(uint32_t a, uint32_t b, uint32_t& c)
+{
+	bool retval;
+	__asm__ volatile (
+		"addl %%edx, %%ecx  \n"
+		"setc %%al          \n"
+		: "=c" (c), "=a" (retval)
+		: "c" (a), "d" (b)
+		: );
+	return retval;
+}
+inline bool add_with_oc(int32_t a, int32_t b, int32_t& c)
+{
+	bool retval;
+	__asm__ volatile (
+		"addl %%edx, %%ecx  \n"
+		"seto %%al          \n"
+		: "=c" (c), "=a" (retval)
+		: "c" (a), "d" (b)
+		: );
+	return retval;
+}
+inline bool add_with_oc(uint64_t a, uint64_t b, uint64_t& c)
+{
+	bool retval;
+#if UINTPTR_MAX == 0xffff'ffff'ffff'ffff    // 64-bit mode, assumably
+	{
+		__asm__ volatile (
+			"addq %%rdx, %%rcx  \n"
+			"setc %%al          \n"
+			: "=c" (c), "=a" (retval)
+			: "c" (a), "d" (b)
+			: );
+	}
+#elif UINTPTR_MAX == 0xffff'ffff    // 32-bit mode
+	{
+		__asm__ volatile (
+			"addl %%esi, %%eax   \n"
+			"adcl %%edi, %%edx   \n"
+			"setc %%cl           \n"
+			: "=A" (c), "=c" (retval)
+			: "a" ((uint32_t)a), "d" ((uint32_t)(a >> 32)),
+			  "S" ((uint32_t)b), "D" ((uint32_t)(b >> 32))
+			: );
+	}
+#else
+#error Strange ptr size
+#endif
+	return retval;
+}
+
+inline bool add_with_oc(int64_t a, int64_t b, int64_t& c)
+{
+	bool retval;
+#if UINTPTR_MAX == 0xffff'ffff'ffff'ffff    // 64-bit mode, assumably
+	{
+		__asm__ volatile (
+			"addq %%rdx, %%rcx  \n"
+			"seto %%al          \n"
+			: "=c" (c), "=a" (retval)
+			: "c" (a), "d" (b)
+			: );
+	}
+#elif UINTPTR_MAX == 0xffff'ffff    // 32-bit mode
+	{
+		__asm__ volatile (
+			"addl %%esi, %%eax   \n"
+			"adcl %%edi, %%edx   \n"
+			"seto %%cl           \n"
+			: "=A" (c), "=c" (retval)
+			: "a" ((uint32_t)a), "d" ((uint32_t)(a >> 32)),
+			  "S" ((uint32_t)b), "D" ((uint32_t)(b >> 32))
+			: );
+	}
+#else
+#error Strange ptr size
+#endif
+	return retval;
+}
+
+#endif //!_MSC_VER
+#endif //__DEBUG_CHECK_INTEGER_OVERFLOW_USE_X86_ASM
+
+template <typename T> bool overflowchecked<T>::s_bOverflowCheckActive = OVERFLOWCHECK_ON_BY_DEFAULT;
+
+// overflowchecked<T> is a T in memory, so buffers of T can be viewed as buffers of overflowchecked<T> without
+// copying (INTO_span.h). These are the guarantees that relies on; the common types are checked right here.
+template <typename T> constexpr bool OVERFLOWCHECKED_LAYOUT_COMPATIBLE =
+	sizeof(overflowchecked<T>) == sizeof(T) && alignof(overflowchecked<T>) == alignof(T) &&
+	std::is_trivially_copyable<overflowchecked<T>>::value && std::is_standard_layout<overflowchecked<T>>::value;
+
+static_assert(OVERFLOWCHECKED_LAYOUT_COMPATIBLE<int8_t> && OVERFLOWCHECKED_LAYOUT_COMPATIBLE<uint8_t>, "overflowchecked<T> must have the layout of T");
+static_assert(OVERFLOWCHECKED_LAYOUT_COMPATIBLE<int16_t> && OVERFLOWCHECKED_LAYOUT_COMPATIBLE<uint16_t>, "overflowchecked<T> must have the layout of T");
+static_assert(OVERFLOWCHECKED_LAYOUT_COMPATIBLE<int32_t> && OVERFLOWCHECKED_LAYOUT_COMPATIBLE<uint32_t>, "overflowchecked<T> must have the layout of T");
+static_assert(OVERFLOWCHECKED_LAYOUT_COMPATIBLE<int64_t> && OVERFLOWCHECKED_LAYOUT_COMPATIBLE<uint64_t>, "overflowchecked<T> must have the layout of T");
+
+namespace detail
+{
+	struct OverflowcheckedAccess
+	{
+		template <typename T> static T Value(const overflowchecked<T>& object) { return object.m_value; }
+		template <typename T> static bool IsCheckActive() { return overflowchecked<T>::s_bOverflowCheckActive; }
+		// for results that are already known to be in range: skips the initialization check
+		template <typename T> static overflowchecked<T> FromUnchecked(T value) { overflowchecked<T> result; result.m_value = value; return result; }
+	};
+}
+
+namespace detail
+{
+	// the wrap-around arithmetic below is done in an unsigned type of at least int's width, where it's defined
+	// (narrower unsigned types would be promoted to int, where it isn't)
+	template <typename C> using WrapUnsigned_t = std::common_type_t<unsigned int, std::make_unsigned_t<C>>;
+
+	template <typename C> inline C WrapAdd(C lhs, C rhs) { return static_cast<C>(static_cast<WrapUnsigned_t<C>>(lhs) + static_cast<WrapUnsigned_t<C>>(rhs)); }
+	template <typename C> inline C WrapSub(C lhs, C rhs) { return static_cast<C>(static_cast<WrapUnsigned_t<C>>(lhs) - static_cast<WrapUnsigned_t<C>>(rhs)); }
+	template <typename C> inline C WrapMul(C lhs, C rhs) { return static_cast<C>(static_cast<WrapUnsigned_t<C>>(lhs) * static_cast<WrapUnsigned_t<C>>(rhs)); }
+}
+
+// Non-throwing checks, the core of the operators below. Both operands are taken as converted to the common
+// type (as the built-in operators do), result receives the (wrapped) result, and the return value tells
+// whether the exact result of the operation on them does not fit in the common type.
+// Division by zero is not checked, that's left to the hardware.
+
+// The method for checking addition and subtraction overflow here exploits the fact that multiple overflows 
+// cannot occur in these operations, thus, the distance between the exact algebraic sum/difference
+// is never greater than the total range of the type, so, if an overflow occurs, the (truncated) result will 
+// be on the wrong side of the addend/minuend (in the sense of standard ordering). 
+// It is range-agnostic, but relies on modulo wrap-around overflow behavior, which is defined only in case of
+// unsigned integers, so the operation itself is carried out in the unsigned counterpart of the common type.
+template <typename U, typename V> inline bool AddOverflows(U lhs, V rhs, INTO_common_t<U, V>& result)
+{
+	using common_type = INTO_common_t<U, V>;
+	const auto l = static_cast<common_type>(lhs);
+	const auto r = static_cast<common_type>(rhs);
+	result = detail::WrapAdd(l, r);
+	return r >= 0 ? result < l : result >= l;
+}
+
+template <typename U, typename V> inline bool SubOverflows(U lhs, V rhs, INTO_common_t<U, V>& result)
+{
+	using common_type = INTO_common_t<U, V>;
+	const auto l = static_cast<common_type>(lhs);
+	const auto r = static_cast<common_type>(rhs);
+	result = detail::WrapSub(l, r);
+	return r >= 0 ? result > l : result <= l;
+}
+
+// The technique that's been used here is based on the irreversibility of a multiplication in the presence 
+// of an overflow (with one exception: the case of signed INT_MIN * (-1) == INT_MIN can be reversed).
+// This is not true though for addition/subtraction in the usual wrap-around overflow scenario, so it can't
+// be used there. Despite its superficial simpleness, this method is usually slower thean than the one used 
+// in the addition/subtraction case, caused mainly by the div/idiv instruction involved in the check requiring 
+// an order of magnitude more CPU cycles to execute than ordinary arithmetic or comparison instructions.
+// However, the ordering-based approach that has proven useful in the addition/subtraction case cannot be used 
+// here: e.g. 32*10==64 holds for the usual 8-bit signed char type, obviously because of overflow, but the result 
+// is on the right side of both the multipliers (in fact multiple overflows occurred here, and that's why the 
+// result can be greater than both 32 and 10 in this case).
+template <typename U, typename V> inline bool MulOverflows(U lhs, V rhs, INTO_common_t<U, V>& result)
+{
+	using common_type = INTO_common_t<U, V>;
+	const auto l = static_cast<common_type>(lhs);
+	const auto r = static_cast<common_type>(rhs);
+	result = detail::WrapMul(l, r);
+	if constexpr (std::is_signed<common_type>::value)
+	{
+		constexpr auto lowerBound = std::numeric_limits<common_type>::min();
+		// the reversible exception (and the only case where the trial division below would trap)
+		if ((l == common_type(-1) && r == lowerBound) || (r == common_type(-1) && l == lowerBound))
+			return true;
+	}
+	return r != 0 && result / r != l;
+}
+
+// An easy case: overflow can only occur in one case: if INT_MIN / (-1) < INT_MAX
+// (and it has to be caught before dividing, it traps on x86)
+template <typename U, typename V> inline bool DivOverflows(U lhs, V rhs, INTO_common_t<U, V>& result)
+{
+	using common_type = INTO_common_t<U, V>;
+	const auto l = static_cast<common_type>(lhs);
+	const auto r = static_cast<common_type>(rhs);
+	if constexpr (std::is_signed<common_type>::value)
+	{
+		if (l == std::numeric_limits<common_type>::min() && r == common_type(-1))
+		{
+			result = l;
+			return true;
+		}
+	}
+	result = static_cast<common_type>(l / r);
+	return false;
+}
+
+template <typename U, typename V> inline const overflowchecked<INTO_common_t<U, V>> operator+ (overflowchecked<U> lhs, overflowchecked<V> rhs)
+{
+	using common_type = INTO_common_t<U, V>;
+	if (!detail::SampleThis<'+', U, V>())
+		return detail::OverflowcheckedAccess::FromUnchecked(detail::WrapAdd(static_cast<common_type>(lhs.m_value), static_cast<common_type>(rhs.m_value)));
+	const bool bBothCheckActive = lhs.IsOverflowCheckActive() && rhs.IsOverflowCheckActive();
+	common_type nakedResult;
+	if (AddOverflows(lhs.m_value, rhs.m_value, nakedResult) && bBothCheckActive)
+	{
+		detail::ReportOperatorOverflow("+", detail::Reported(lhs.m_value), detail::Reported(rhs.m_value),
+			detail::Reported(std::numeric_limits<common_type>::min()), detail::Reported(std::numeric_limits<common_type>::max()),
+			static_cast<common_type>(rhs.m_value) >= 0 ? detail::OverflowDirection::Above : detail::OverflowDirection::Below);
+	}
+	return detail::OverflowcheckedAccess::FromUnchecked(nakedResult);
+}
+
+template <typename U, typename V> inline const overflowchecked<INTO_common_t<U, V>> operator- (overflowchecked<U> lhs, overflowchecked<V> rhs)
+{
+	using common_type = INTO_common_t<U, V>;
+	if (!detail::SampleThis<'-', U, V>())
+		return detail::OverflowcheckedAccess::FromUnchecked(detail::WrapSub(static_cast<common_type>(lhs.m_value), static_cast<common_type>(rhs.m_value)));
+	const bool bBothCheckActive = lhs.IsOverflowCheckActive() && rhs.IsOverflowCheckActive();
+	common_type nakedResult;
+	if (SubOverflows(lhs.m_value, rhs.m_value, nakedResult) && bBothCheckActive)
+	{
+		detail::ReportOperatorOverflow("-", detail::Reported(lhs.m_value), detail::Reported(rhs.m_value),
+			detail::Reported(std::numeric_limits<common_type>::min()), detail::Reported(std::numeric_limits<common_type>::max()),
+			static_cast<common_type>(rhs.m_value) < 0 ? detail::OverflowDirection::Above : detail::OverflowDirection::Below);
+	}
+	return detail::OverflowcheckedAccess::FromUnchecked(nakedResult);
+}
+
+template <typename U, typename V> inline const overflowchecked<INTO_common_t<U, V>> operator* (overflowchecked<U> lhs, overflowchecked<V> rhs)
+{
+	using common_type = INTO_common_t<U, V>;
+	if (!detail::SampleThis<'*', U, V>())
+		return detail::OverflowcheckedAccess::FromUnchecked(detail::WrapMul(static_cast<common_type>(lhs.m_value), static_cast<common_type>(rhs.m_value)));
+	const bool bBothCheckActive = lhs.IsOverflowCheckActive() && rhs.IsOverflowCheckActive();
+	common_type nakedResult;
+	if (MulOverflows(lhs.m_value, rhs.m_value, nakedResult) && bBothCheckActive)
+	{
+		detail::ReportOperatorOverflow("*", detail::Reported(lhs.m_value), detail::Reported(rhs.m_value),
+			detail::Reported(std::numeric_limits<common_type>::min()), detail::Reported(std::numeric_limits<common_type>::max()),
+			detail::OverflowDirection::Unknown);
+	}
+	return detail::OverflowcheckedAccess::FromUnchecked(nakedResult);
+}
+
+template <typename U, typename V> inline const overflowchecked<INTO_common_t<U, V>> operator/ (overflowchecked<U> lhs, overflowchecked<V> rhs)
+{
+	using common_type = INTO_common_t<U, V>;
+	const bool bBothCheckActive = lhs.IsOverflowCheckActive() && rhs.IsOverflowCheckActive();
+	common_type nakedResult;
+	if (DivOverflows(lhs.m_value, rhs.m_value, nakedResult) && bBothCheckActive)
+	{
+		detail::ReportOperatorOverflow("/", detail::Reported(lhs.m_value), detail::Reported(rhs.m_value),
+			detail::Reported(std::numeric_limits<common_type>::min()), detail::Reported(std::numeric_limits<common_type>::max()),
+			detail::OverflowDirection::Unknown);
+	}
+	return detail::OverflowcheckedAccess::FromUnchecked(nakedResult);
+}
+
+// The types behind the aliases below, and what INTO.cpp instantiates for each of them: the class, and the checks
+// and operators on two operands of the same type (mixed pairs are still instantiated where they're used).
+#define INTO_FOR_EACH_ALIAS_TYPE(X)		X(char) X(signed char) X(unsigned char) X(short) X(unsigned short) \
+	X(int) X(unsigned) X(long) X(unsigned long) X(long long) X(unsigned long long)
+
+#define INTO_INSTANTIATE_FOR_TYPE(prefix, type)	\
+	prefix template class overflowchecked<type>;	\
+	prefix template bool AddOverflows(type lhs, type rhs, type& result);	\
+	prefix template bool SubOverflows(type lhs, type rhs, type& result);	\
+	prefix template bool MulOverflows(type lhs, type rhs, type& result);	\
+	prefix template bool DivOverflows(type lhs, type rhs, type& result);	\
+	prefix template const overflowchecked<type> operator+ (overflowchecked<type> lhs, overflowchecked<type> rhs);	\
+	prefix template const overflowchecked<type> operator- (overflowchecked<type> lhs, overflowchecked<type> rhs);	\
+	prefix template const overflowchecked<type> operator* (overflowchecked<type> lhs, overflowchecked<type> rhs);	\
+	prefix template const overflowchecked<type> operator/ (overflowchecked<type> lhs, overflowchecked<type> rhs);
+
+#ifdef __DEBUG_CHECK_INTEGER_OVERFLOW_PRECOMPILED
+#define INTO_DECLARE_EXTERN_FOR_TYPE(type)		INTO_INSTANTIATE_FOR_TYPE(extern, type)
+INTO_FOR_EACH_ALIAS_TYPE(INTO_DECLARE_EXTERN_FOR_TYPE)
+#undef INTO_DECLARE_EXTERN_FOR_TYPE
+#endif
+
+#ifdef __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE
+} // namespace __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE
+#endif
+
+// namespace ends here, the followings are typedefs in global namespace (if enabled)
+
+#ifdef __DEBUG_CHECK_INTEGER_OVERFLOW_ALIAS
+CREATE_TYPE_ALIAS(unsigned);								// this one creates unsignedo
+CREATE_TYPE_ALIAS(signed);								//		...signedo
+CREATE_TYPE_ALIAS(char);
+CREATE_TYPE_ALIAS(short);
+CREATE_TYPE_ALIAS(int);
+CREATE_TYPE_ALIAS(long);								//		...longo
+CREATE_TYPE_ALIAS_WITHNAME(signed char,			schar);				//		...scharo
+CREATE_TYPE_ALIAS_WITHNAME(unsigned char,		uchar);				//		...ucharo
+CREATE_TYPE_ALIAS_WITHNAME(unsigned short,		ushort);
+CREATE_TYPE_ALIAS_WITHNAME(unsigned int,		uint);
+CREATE_TYPE_ALIAS_WITHNAME(unsigned long,		ulong);
+CREATE_TYPE_ALIAS_WITHNAME(long long,			llong);
+CREATE_TYPE_ALIAS_WITHNAME(unsigned long long,	ullong);				//		...ullongo
+#endif //__DEBUG_CHECK_INTEGER_OVERFLOW_ALIAS
+
+#undef CREATE_TYPE_ALIAS
+#undef CREATE_TYPE_ALIAS_WITHNAME
+
+#ifndef __DEBUG_CHECK_INTEGER_OVERFLOW_PRECOMPILED
+#include "INTO_report.h"
+#endif
@@ -0,0 +1,375 @@
+#pragma once
+
+// fixedo<T, Scale, Rounding> -- checked decimal fixed point, for money arithmetic.
+//
+// The value is an integer count of 10^-Scale units (fixedo<int64_t, 2> counts cents), so addition and
+// subtraction are exact and cost one overflow-checked integer operation (AddOverflows/SubOverflows from INTO.h).
+// Multiplication and division go through a 128-bit intermediate and are rescaled with one integer division,
+// rounded as the Rounding parameter says (banker's rounding by default), or as asked per call:
+//
+//		typedef fixedo<int64_t, 2> money;
+//		money price = money::parse("19.99");
+//		money total = price * 3 + money::parse("0.015");		// 0.015 is rounded half to even: 59.97 + 0.02
+//		money vat = INTO::mul<INTO::RoundingMode::HalfUp>(total, fixedo<int64_t, 4>::parse("0.2700"));
+//
+// Nothing overflows silently: a result that doesn't fit in T is reported through SignalOverflowError.
+// Text conversion follows std::to_chars/std::from_chars (no locale, no allocation, errors as std::errc).
+
+#include "INTO.h"
+
+#include <cstdint>
+#include <cmath>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <typeinfo>
+
+#if !defined(__SIZEOF_INT128__)
+#error INTO_fixed.h needs __int128 (GCC/Clang)
+#endif
+
+#ifdef __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE
+namespace __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE {
+#endif
+
+namespace INTO
+{
+	enum class RoundingMode {
+		HalfEven,			// banker's rounding: ties go to the even neighbour (the default)
+		HalfUp,				// ties away from zero (commercial rounding)
+		TowardZero,			// truncation
+		Floor,				// toward -infinity
+		Ceiling				// toward +infinity
+	};
+
+	// to_chars/from_chars results, like std::to_chars_result/std::from_chars_result
+	struct fixed_to_chars_result { char* ptr; std::errc ec; };
+	struct fixed_from_chars_result { const char* ptr; std::errc ec; };
+
+	namespace details
+	{
+		typedef __int128 FixedWide_t;
+
+		constexpr FixedWide_t Pow10(unsigned n)
+		{
+			FixedWide_t result = 1;
+			for (unsigned i = 0; i < n; ++i)
+				result *= 10;
+			return result;
+		}
+
+		// numerator / denominator rounded as told, in W (int64_t or the 128-bit type); numerator has to be
+		// below half of W's range, which is the case for the products of two 64-bit values in 128 bits
+		template <RoundingMode Mode, typename W> constexpr W RoundedDiv(W numerator, W denominator)
+		{
+			const W quotient = numerator / denominator;
+			const W remainder = numerator % denominator;
+			if (remainder == 0)
+				return quotient;
+			const bool bNegative = (numerator < 0) != (denominator < 0);
+			const W awayFromZero = bNegative ? quotient - 1 : quotient + 1;
+			if constexpr (Mode == RoundingMode::TowardZero)	return quotient;
+			else if constexpr (Mode == RoundingMode::Floor)	return bNegative ? awayFromZero : quotient;
+			else if constexpr (Mode == RoundingMode::Ceiling)	return bNegative ? quotient : awayFromZero;
+			else
+			{
+				// |remainder| vs |denominator| - |remainder| instead of 2 * |remainder| vs |denominator|: can't overflow
+				const W absRemainder = remainder < 0 ? -remainder : remainder;
+				const W rest = (denominator < 0 ? -denominator : denominator) - absRemainder;
+				if constexpr (Mode == RoundingMode::HalfUp)	return absRemainder >= rest ? awayFromZero : quotient;
+				else											return absRemainder > rest || (absRemainder == rest && (quotient & 1) != 0) ? awayFromZero : quotient;
+			}
+		}
+
+		// dividing by the constant 10^N: in 64 bits when the numerator fits (the compiler turns that into a
+		// multiplication), the 128-bit division is a library call
+		template <RoundingMode Mode, unsigned N> inline FixedWide_t RoundedDivPow10(FixedWide_t numerator)
+		{
+			if constexpr (Pow10(N) <= FixedWide_t(std::numeric_limits<int64_t>::max()))
+			{
+				if (numerator >= std::numeric_limits<int64_t>::min() && numerator <= std::numeric_limits<int64_t>::max())
+					return RoundedDiv<Mode, int64_t>(static_cast<int64_t>(numerator), static_cast<int64_t>(Pow10(N)));
+			}
+			return RoundedDiv<Mode, FixedWide_t>(numerator, Pow10(N));
+		}
+
+		template <typename T> bool FitsIn(FixedWide_t value)
+		{
+			return value >= static_cast<FixedWide_t>(std::numeric_limits<T>::min()) && value <= static_cast<FixedWide_t>(std::numeric_limits<T>::max());
+		}
+	}
+}
+
+template <typename T, unsigned Scale, INTO::RoundingMode Rounding = INTO::RoundingMode::HalfEven>
+class fixedo;
+
+namespace INTO
+{
+	template <RoundingMode Mode, typename T, unsigned S1, RoundingMode R1, unsigned S2, RoundingMode R2>
+	fixedo<T, S1, R1> mul(fixedo<T, S1, R1> lhs, fixedo<T, S2, R2> rhs);
+	template <RoundingMode Mode, typename T, unsigned S1, RoundingMode R1, unsigned S2, RoundingMode R2>
+	fixedo<T, S1, R1> div(fixedo<T, S1, R1> lhs, fixedo<T, S2, R2> rhs);
+}
+
+template <typename T, unsigned Scale, INTO::RoundingMode Rounding>
+class fixedo {
+	static_assert(std::is_integral<T>::value && std::is_signed<T>::value && sizeof(T) <= 8, "fixedo<T, Scale> is for signed integers up to 64 bits");
+	static_assert(INTO::details::Pow10(Scale) <= static_cast<INTO::details::FixedWide_t>(std::numeric_limits<T>::max()), "fixedo: 10^Scale does not fit in T");
+private:
+	T m_raw;
+
+	[[noreturn]] static void SignalFixedOverflow(const std::string& what)
+	{
+		SignalOverflowError<T>(nullptr, std::string("fixedo<") + typeid(T).name() + "," + std::to_string(Scale) + "> " + what);
+	}
+	// op is the operation as reported: "op*", "from_double", ...
+	static fixedo FromWide(INTO::details::FixedWide_t value, const char* op)
+	{
+		if (!INTO::details::FitsIn<T>(value))
+			SignalFixedOverflow(std::string(op) + " overflow: result does not fit in " + typeid(T).name());
+		return from_raw(static_cast<T>(value));
+	}
+
+public:
+	typedef T raw_type;
+	static constexpr unsigned scale = Scale;
+	static constexpr T one = static_cast<T>(INTO::details::Pow10(Scale));
+	static constexpr INTO::RoundingMode rounding = Rounding;
+
+	fixedo() = default;
+	// from whole units, checked
+	template <typename I, typename std::enable_if<std::is_integral<I>::value, int>::type = 0>
+	fixedo(I units)
+	{
+		T raw;
+		if (!INTO::details::FitsIn<T>(static_cast<INTO::details::FixedWide_t>(units)) || __builtin_mul_overflow(static_cast<T>(units), one, &raw))
+			SignalFixedOverflow("initialization overflow: " + std::to_string(units) + " units");
+		m_raw = raw;
+	}
+	template <typename U>
+	fixedo(overflowchecked<U> units) : fixedo(static_cast<U>(units)) {}
+	static fixedo from_raw(T raw) { fixedo result; result.m_raw = raw; return result; }
+	// from floating point, for migrating existing code: value * 10^Scale (rounded in double) rounded to an integer, checked
+	static fixedo from_double(double value)
+	{
+		const double scaled = value * static_cast<double>(one);
+		if (!(scaled > -9.3e18 && scaled < 9.3e18))			// NaN too
+			SignalFixedOverflow("conversion overflow: " + std::to_string(value));
+		// nearbyint rounds half to even in the default FP rounding mode
+		const double rounded = Rounding == INTO::RoundingMode::HalfEven ? std::nearbyint(scaled) :
+			Rounding == INTO::RoundingMode::HalfUp ? std::round(scaled) :
+			Rounding == INTO::RoundingMode::TowardZero ? std::trunc(scaled) :
+			Rounding == INTO::RoundingMode::Floor ? std::floor(scaled) : std::ceil(scaled);
+		return FromWide(static_cast<INTO::details::FixedWide_t>(rounded), "from_double");
+	}
+	// throwing counterpart of from_chars: the whole string has to be a number
+	static fixedo parse(std::string_view text);
+
+	T raw() const { return m_raw; }
+	double to_double() const { return static_cast<double>(m_raw) / static_cast<double>(one); }
+	std::string to_string() const;
+
+	// a different scale (and/or rounding), rounding when digits are dropped, checked when digits are added
+	template <unsigned NewScale, INTO::RoundingMode NewRounding = Rounding>
+	fixedo<T, NewScale, NewRounding> rescale() const
+	{
+		using INTO::details::FixedWide_t;
+		if constexpr (NewScale >= Scale)
+			return fixedo<T, NewScale, NewRounding>::from_raw(FromWide(FixedWide_t(m_raw) * INTO::details::Pow10(NewScale - Scale), "rescale").raw());
+		else
+			return fixedo<T, NewScale, NewRounding>::from_raw(static_cast<T>(INTO::details::RoundedDivPow10<NewRounding, Scale - NewScale>(m_raw)));
+	}
+
+	friend fixedo operator+ (fixedo lhs, fixedo rhs)
+	{
+		T result;
+		if (AddOverflows(lhs.m_raw, rhs.m_raw, result))
+			SignalFixedOverflow("op+ overflow: " + lhs.to_string() + "+" + rhs.to_string());
+		return from_raw(result);
+	}
+	friend fixedo operator- (fixedo lhs, fixedo rhs)
+	{
+		T result;
+		if (SubOverflows(lhs.m_raw, rhs.m_raw, result))
+			SignalFixedOverflow("op- overflow: " + lhs.to_string() + "-" + rhs.to_string());
+		return from_raw(result);
+	}
+	fixedo operator- () const { return fixedo(0) - *this; }
+
+	// by a plain integer (quantities): exact, checked
+	template <typename I, typename std::enable_if<std::is_integral<I>::value, int>::type = 0>
+	friend fixedo operator* (fixedo lhs, I rhs) { return FromWide(INTO::details::FixedWide_t(lhs.m_raw) * rhs, "op*"); }
+	template <typename I, typename std::enable_if<std::is_integral<I>::value, int>::type = 0>
+	friend fixedo operator* (I lhs, fixedo rhs) { return rhs * lhs; }
+	// by a plain integer (splitting): rounded
+	template <typename I, typename std::enable_if<std::is_integral<I>::value, int>::type = 0>
+	friend fixedo operator/ (fixedo lhs, I rhs)
+	{
+		if (rhs == 0)
+			SignalFixedOverflow("op/ division by zero: " + lhs.to_string() + "/0");
+		return FromWide(INTO::details::RoundedDiv<Rounding, INTO::details::FixedWide_t>(lhs.m_raw, rhs), "op/");
+	}
+
+	// fixed * fixed (any scale): the exact product has Scale + S2 decimals, rounded back to Scale
+	template <unsigned S2, INTO::RoundingMode R2>
+	friend fixedo operator* (fixedo lhs, fixedo<T, S2, R2> rhs) { return INTO::mul<Rounding>(lhs, rhs); }
+	template <unsigned S2, INTO::RoundingMode R2>
+	friend fixedo operator/ (fixedo lhs, fixedo<T, S2, R2> rhs) { return INTO::div<Rounding>(lhs, rhs); }
+
+	fixedo& operator+= (fixedo rhs) { return *this = *this + rhs; }
+	fixedo& operator-= (fixedo rhs) { return *this = *this - rhs; }
+	template <typename R> fixedo& operator*= (R rhs) { return *this = *this * rhs; }
+	template <typename R> fixedo& operator/= (R rhs) { return *this = *this / rhs; }
+
+	friend bool operator== (fixedo lhs, fixedo rhs) { return lhs.m_raw == rhs.m_raw; }
+	friend bool operator!= (fixedo lhs, fixedo rhs) { return lhs.m_raw != rhs.m_raw; }
+	friend bool operator< (fixedo lhs, fixedo rhs) { return lhs.m_raw < rhs.m_raw; }
+	friend bool operator> (fixedo lhs, fixedo rhs) { return lhs.m_raw > rhs.m_raw; }
+	friend bool operator<= (fixedo lhs, fixedo rhs) { return lhs.m_raw <= rhs.m_raw; }
+	friend bool operator>= (fixedo lhs, fixedo rhs) { return lhs.m_raw >= rhs.m_raw; }
+
+	template <INTO::RoundingMode Mode, typename U, unsigned S1, INTO::RoundingMode R1, unsigned S2, INTO::RoundingMode R2>
+	friend fixedo<U, S1, R1> INTO::mul(fixedo<U, S1, R1> lhs, fixedo<U, S2, R2> rhs);
+	template <INTO::RoundingMode Mode, typename U, unsigned S1, INTO::RoundingMode R1, unsigned S2, INTO::RoundingMode R2>
+	friend fixedo<U, S1, R1> INTO::div(fixedo<U, S1, R1> lhs, fixedo<U, S2, R2> rhs);
+};
+
+namespace INTO
+{
+	// multiplication/division with the rounding given explicitly; the result has the scale of lhs
+	template <RoundingMode Mode, typename T, unsigned S1, RoundingMode R1, unsigned S2, RoundingMode R2>
+	fixedo<T, S1, R1> mul(fixedo<T, S1, R1> lhs, fixedo<T, S2, R2> rhs)
+	{
+		// |a*b| < 2^126, so the 128-bit product can't overflow
+		const details::FixedWide_t product = details::FixedWide_t(lhs.raw()) * rhs.raw();
+		return fixedo<T, S1, R1>::FromWide(details::RoundedDivPow10<Mode, S2>(product), "op*");
+	}
+
+	template <RoundingMode Mode, typename T, unsigned S1, RoundingMode R1, unsigned S2, RoundingMode R2>
+	fixedo<T, S1, R1> div(fixedo<T, S1, R1> lhs, fixedo<T, S2, R2> rhs)
+	{
+		// lhs * 10^S2 < 2^63 * 10^18 < 2^123
+		if (rhs.raw() == 0)
+			fixedo<T, S1, R1>::SignalFixedOverflow("op/ division by zero: " + lhs.to_string() + "/0");
+		return fixedo<T, S1, R1>::FromWide(details::RoundedDiv<Mode, details::FixedWide_t>(details::FixedWide_t(lhs.raw()) * details::Pow10(S2), rhs.raw()), "op/");
+	}
+
+	// "-123.45", always Scale decimals; no allocation, std::errc::value_too_large if it doesn't fit
+	template <typename T, unsigned Scale, RoundingMode R>
+	fixed_to_chars_result to_chars(char* first, char* last, fixedo<T, Scale, R> value)
+	{
+		char digits[24 + Scale];
+		char* p = digits + sizeof(digits);
+		const bool bNegative = value.raw() < 0;
+		uint64_t magnitude = bNegative ? 0 - static_cast<uint64_t>(value.raw()) : static_cast<uint64_t>(value.raw());
+		for (unsigned i = 0; i < Scale; ++i)
+		{
+			*--p = static_cast<char>('0' + magnitude % 10);
+			magnitude /= 10;
+		}
+		if (Scale > 0)
+			*--p = '.';
+		do
+		{
+			*--p = static_cast<char>('0' + magnitude % 10);
+			magnitude /= 10;
+		} while (magnitude != 0);
+		if (bNegative)
+			*--p = '-';
+		const size_t length = static_cast<size_t>(digits + sizeof(digits) - p);
+		if (static_cast<size_t>(last - first) < length)
+			return { last, std::errc::value_too_large };
+		for (size_t i = 0; i < length; ++i)
+			first[i] = p[i];
+		return { first + length, std::errc() };
+	}
+
+	// [-+]digits[.digits]; more decimals than Scale are rounded as the type's rounding mode says.
+	// std::errc::invalid_argument if there's no number at first, std::errc::result_out_of_range if it doesn't
+	// fit (value is left unchanged then); ptr points past the last character used, like std::from_chars.
+	template <typename T, unsigned Scale, RoundingMode R>
+	fixed_from_chars_result from_chars(const char* first, const char* last, fixedo<T, Scale, R>& value)
+	{
+		const char* p = first;
+		const bool bNegative = p != last && *p == '-';
+		if (p != last && (*p == '-' || *p == '+'))
+			++p;
+		// magnitude in 10^-Scale units; the integer part is capped, anything above 2^64 units is out of range anyway
+		details::FixedWide_t units = 0;
+		bool bAnyDigit = false, bOutOfRange = false;
+		for (; p != last && *p >= '0' && *p <= '9'; ++p)
+		{
+			bAnyDigit = true;
+			units = units * 10 + (*p - '0');
+			if (units > (details::FixedWide_t(1) << 64))
+				bOutOfRange = true, units = details::FixedWide_t(1) << 64;
+		}
+		details::FixedWide_t magnitude = units * details::Pow10(Scale);
+		// the first Scale decimals are exact, the next one and whether any non-zero follows decide the rounding
+		int roundingDigit = 0;
+		bool bSticky = false;
+		if (p != last && *p == '.' && p + 1 != last && p[1] >= '0' && p[1] <= '9')
+		{
+			unsigned decimals = 0;
+			for (++p; p != last && *p >= '0' && *p <= '9'; ++p, ++decimals)
+			{
+				bAnyDigit = true;
+				if (decimals < Scale)
+					magnitude += details::Pow10(Scale - 1 - decimals) * (*p - '0');
+				else if (decimals == Scale)
+					roundingDigit = *p - '0';
+				else if (*p != '0')
+					bSticky = true;
+			}
+		}
+		if (!bAnyDigit)
+			return { first, std::errc::invalid_argument };
+		const bool bInexact = roundingDigit != 0 || bSticky;
+		bool bIncrement;
+		if constexpr (R == RoundingMode::TowardZero)	bIncrement = false;
+		else if constexpr (R == RoundingMode::Floor)	bIncrement = bInexact && bNegative;
+		else if constexpr (R == RoundingMode::Ceiling)	bIncrement = bInexact && !bNegative;
+		else if constexpr (R == RoundingMode::HalfUp)	bIncrement = roundingDigit >= 5;
+		else											bIncrement = roundingDigit > 5 || (roundingDigit == 5 && (bSticky || (magnitude & 1) != 0));
+		if (bIncrement)
+			++magnitude;
+		const details::FixedWide_t raw = bNegative ? -magnitude : magnitude;
+		if (bOutOfRange || !details::FitsIn<T>(raw))
+			return { p, std::errc::result_out_of_range };
+		value = fixedo<T, Scale, R>::from_raw(static_cast<T>(raw));
+		return { p, std::errc() };
+	}
+}
+
+template <typename T, unsigned Scale, INTO::RoundingMode Rounding>
+fixedo<T, Scale, Rounding> fixedo<T, Scale, Rounding>::parse(std::string_view text)
+{
+	fixedo result;
+	const auto parsed = INTO::from_chars(text.data(), text.data() + text.size(), result);
+	if (parsed.ec == std::errc::result_out_of_range)
+		SignalFixedOverflow("parse overflow: \"" + std::string(text) + "\" does not fit");
+	if (parsed.ec != std::errc() || parsed.ptr != text.data() + text.size())
+		throw std::invalid_argument("fixedo parse: \"" + std::string(text) + "\" is not a decimal number");
+	return result;
+}
+
+template <typename T, unsigned Scale, INTO::RoundingMode Rounding>
+std::string fixedo<T, Scale, Rounding>::to_string() const
+{
+	char buffer[32 + Scale];
+	const auto written = INTO::to_chars(buffer, buffer + sizeof(buffer), *this);
+	return std::string(buffer, written.ptr);
+}
+
+template <typename T, unsigned Scale, INTO::RoundingMode Rounding>
+std::ostream& operator<< (std::ostream& os, fixedo<T, Scale, Rounding> value)
+{
+	return os << value.to_string();
+}
+
+#ifdef __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE
+} // namespace __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE
+#endif
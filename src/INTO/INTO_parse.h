@@ -0,0 +1,309 @@
+#pragma once
+
+// INTO::parse / INTO::parse_column -- checked integer parsing for ingest, straight into T or overflowchecked<T>.
+//
+// Parsing into long long and narrowing through overflowchecked's constructor formats an exception when the value
+// doesn't fit; these return std::errc instead and check the range of the target type exactly:
+//
+//		INTO::parse_value_result<into> r = INTO::parse<into>("123456");
+//		if (r.ec == std::errc::result_out_of_range) ...
+//
+//		std::vector<llongo> column(rowCount);
+//		INTO::parse_column_result c = INTO::parse_column(text, ',', column.data(), column.size());
+//		// c.count values written; on error c.ptr is the start of the field that failed
+//
+// The syntax is std::from_chars's: optional '-' (signed types only), decimal digits, nothing else. Digits are
+// decoded eight at a time from 64-bit loads (SWAR): a few masks find the length of the digit run, a shift aligns
+// a short run, three multiplications turn it into its value; numbers up to 15 digits take two loads and no loop.
+// 19 significant digits always fit in uint64_t, so the range is checked once per number, not per digit.
+// Little-endian only for the SWAR path, big-endian targets go digit by digit.
+
+#include "INTO.h"
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+
+#if defined(__has_include)
+#if __has_include(<span>) && __cplusplus >= 202002L
+#include <span>
+#define INTO_PARSE_HAS_SPAN
+#endif
+#endif
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#define INTO_PARSE_NO_SWAR
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#define INTO_PARSE_INLINE	__forceinline
+#else
+#define INTO_PARSE_INLINE	inline __attribute__((always_inline))
+#endif
+
+#ifdef __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE
+namespace __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE {
+#endif
+
+namespace INTO
+{
+	// like std::from_chars_result
+	struct parse_chars_result { const char* ptr; std::errc ec; };
+
+	template <typename T> struct parse_value_result
+	{
+		T value;
+		std::errc ec;
+		explicit operator bool() const { return ec == std::errc(); }
+	};
+
+	// count values were written; ec != std::errc(): ptr is the start of the field that failed
+	struct parse_column_result { size_t count; const char* ptr; std::errc ec; };
+
+	namespace details
+	{
+		// T for T, T for overflowchecked<T>
+		template <typename T> struct ParseTarget { typedef T type; };
+		template <typename T> struct ParseTarget<overflowchecked<T>> { typedef T type; };
+
+		template <typename T> T ParseStore(typename ParseTarget<T>::type value, T*) { return value; }
+		template <typename T> overflowchecked<T> ParseStore(T value, overflowchecked<T>*) { return detail::OverflowcheckedAccess::FromUnchecked(value); }
+
+		constexpr uint64_t ParseOnes = 0x0101010101010101ull;
+		constexpr uint64_t ParsePow10[9] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000 };
+
+		inline unsigned CountTrailingZeros(uint64_t x)
+		{
+#ifdef _MSC_VER
+			unsigned long index;
+			_BitScanForward64(&index, x);
+			return static_cast<unsigned>(index);
+#else
+			return static_cast<unsigned>(__builtin_ctzll(x));
+#endif
+		}
+
+		// eight digit values (0..9, first digit in the lowest byte) -> their value
+		inline uint64_t DecodeEightDigits(uint64_t digits)
+		{
+			digits = digits * 10 + (digits >> 8);												// pairs
+			return (((digits & 0x000000FF000000FFull) * (100 + (1000000ull << 32))) +
+				(((digits >> 16) & 0x000000FF000000FFull) * (1 + (10000ull << 32)))) >> 32;	// quads, then all eight
+		}
+
+		// one more run of digits (run of them, decoded) after magnitude; false if the value no longer fits in uint64_t.
+		// significant counts the digits so far, there are no leading zeros among them
+		inline bool AppendDigits(uint64_t& magnitude, unsigned& significant, uint64_t decoded, unsigned run)
+		{
+			significant += run;
+			// below 10^19 it always fits; the 20 digit case is the only one that needs a real check
+			if (significant > 20 || (significant == 20 && magnitude > (std::numeric_limits<uint64_t>::max() - decoded) / ParsePow10[run]))
+				return false;
+			magnitude = magnitude * ParsePow10[run] + decoded;
+			return true;
+		}
+
+		// the 8 bytes at p, first one in the lowest byte; past last it's zeros, which are not digits
+		inline uint64_t LoadChunk(const char* p, const char* last)
+		{
+			uint64_t chunk = 0;
+			if (last - p >= 8)
+				std::memcpy(&chunk, p, 8);
+			else
+				for (unsigned i = 0; p + i != last; ++i)
+					chunk |= static_cast<uint64_t>(static_cast<unsigned char>(p[i])) << (8 * i);
+			return chunk;
+		}
+
+		// values: the 8 bytes ^ '0', which is 0..9 exactly for digits; the number of digits at the start of them
+		inline unsigned DigitRun(uint64_t values)
+		{
+			// the high bit of each byte says "not a digit"
+			const uint64_t notDigit = (((values & (ParseOnes * 0x7F)) + ParseOnes * (0x80 - 10)) | values) & (ParseOnes * 0x80);
+			return notDigit == 0 ? 8 : CountTrailingZeros(notDigit) / 8;
+		}
+
+		// the first run digits of values moved to the top, the bytes below them read as leading zeros
+		inline uint64_t AlignRun(uint64_t values, unsigned run)
+		{
+			return run == 0 ? 0 : values << (64 - 8 * run);
+		}
+
+		// ParseDigits for any length, any position in the buffer
+		inline const char* ParseLongDigits(const char* p, const char* last, uint64_t& magnitude, bool& bFits)
+		{
+			magnitude = 0;
+			bFits = true;
+			unsigned significant = 0;
+			// leading zeros: the last one is parsed as a digit, so that "0" is still a number
+			while (last - p >= 2 && p[0] == '0' && p[1] == '0')
+				++p;
+			if (last - p >= 2 && p[0] == '0' && p[1] >= '1' && p[1] <= '9')
+				++p;
+#ifndef INTO_PARSE_NO_SWAR
+			for (;;)
+			{
+				const uint64_t values = LoadChunk(p, last) ^ (ParseOnes * '0');
+				const unsigned run = DigitRun(values);
+				if (run == 0)
+					return p;
+				const uint64_t decoded = DecodeEightDigits(AlignRun(values, run));
+				bFits = bFits && AppendDigits(magnitude, significant, decoded, run);
+				p += run;
+				if (run < 8)
+					return p;
+			}
+#else
+			for (; p != last && *p >= '0' && *p <= '9'; ++p)
+				bFits = bFits && AppendDigits(magnitude, significant, static_cast<uint64_t>(*p - '0'), 1);
+			return p;
+#endif
+		}
+
+		// the digit run at p; returns its end. bFits is false if the value is above uint64_t's range
+		// (magnitude is meaningless then)
+		INTO_PARSE_INLINE const char* ParseDigits(const char* p, const char* last, uint64_t& magnitude, bool& bFits)
+		{
+#ifndef INTO_PARSE_NO_SWAR
+			// the common case, up to 15 digits and 16 bytes to load: two chunks, no loop, and no branch on the length
+			// that could be mispredicted. Leading zeros decode as zeros, 15 digits can't overflow.
+			if (last - p >= 16)
+			{
+				uint64_t chunks[2];
+				std::memcpy(chunks, p, 16);
+				const uint64_t high = chunks[0] ^ (ParseOnes * '0'), low = chunks[1] ^ (ParseOnes * '0');
+				const unsigned highRun = DigitRun(high);
+				const unsigned lowRun = highRun == 8 ? DigitRun(low) : 0;
+				if (lowRun < 8)
+				{
+					bFits = true;
+					magnitude = DecodeEightDigits(AlignRun(high, highRun)) * ParsePow10[lowRun] + DecodeEightDigits(AlignRun(low, lowRun));
+					return p + highRun + lowRun;
+				}
+			}
+#endif
+			return ParseLongDigits(p, last, magnitude, bFits);
+		}
+	}
+
+	// [-]digits at first into T or overflowchecked<T>. std::errc::invalid_argument if there's no number at first,
+	// std::errc::result_out_of_range if it doesn't fit in T (value is left unchanged then); ptr points past the
+	// digits, like std::from_chars.
+	template <typename T>
+	INTO_PARSE_INLINE parse_chars_result parse(const char* first, const char* last, T& value)
+	{
+		typedef typename details::ParseTarget<T>::type target_type;
+		static_assert(std::is_integral<target_type>::value && !std::is_same<target_type, bool>::value, "INTO::parse is for integer types");
+		typedef std::make_unsigned_t<target_type> unsigned_type;
+		const char* p = first;
+		const bool bNegative = std::is_signed<target_type>::value && p != last && *p == '-';
+		p += bNegative;
+		uint64_t magnitude;
+		bool bFits;
+		const char* end = details::ParseDigits(p, last, magnitude, bFits);
+		if (end == p)
+			return { first, std::errc::invalid_argument };
+		// |min| is max + 1
+		const uint64_t limit = static_cast<uint64_t>(std::numeric_limits<target_type>::max()) + (bNegative ? 1 : 0);
+		if (!bFits || magnitude > limit)
+			return { end, std::errc::result_out_of_range };
+		const unsigned_type bits = static_cast<unsigned_type>(bNegative ? 0 - magnitude : magnitude);
+		value = details::ParseStore(static_cast<target_type>(bits), static_cast<T*>(nullptr));
+		return { end, std::errc() };
+	}
+
+	// the whole of text has to be the number, anything after it is std::errc::invalid_argument
+	template <typename T>
+	parse_value_result<T> parse(std::string_view text)
+	{
+		parse_value_result<T> result{ T(), std::errc() };
+		const parse_chars_result parsed = parse(text.data(), text.data() + text.size(), result.value);
+		result.ec = parsed.ec == std::errc() && parsed.ptr != text.data() + text.size() ? std::errc::invalid_argument : parsed.ec;
+		return result;
+	}
+
+	namespace details
+	{
+		// high bit set in the bytes of word that equal the byte of pattern (pattern is that byte times ParseOnes)
+		inline uint64_t ByteEqualMask(uint64_t word, uint64_t pattern)
+		{
+			const uint64_t x = word ^ pattern;
+			return ~(((x & (ParseOnes * 0x7F)) + ParseOnes * 0x7F) | x) & (ParseOnes * 0x80);
+		}
+
+		// the field [first, end) has to be exactly a number, optionally followed by '\r' if end is at a '\n';
+		// the digits are parsed up to last, the separator stops them anyway and the fast path needs the bytes
+		template <typename T>
+		INTO_PARSE_INLINE std::errc ParseField(const char* first, const char* end, const char* last, T& value)
+		{
+			const parse_chars_result parsed = parse(first, last, value);
+			if (parsed.ec != std::errc())
+				return parsed.ec;
+			if (parsed.ptr == end || (parsed.ptr + 1 == end && *parsed.ptr == '\r' && end != last && *end == '\n'))
+				return std::errc();
+			return std::errc::invalid_argument;
+		}
+	}
+
+	// Fields of text separated by delimiter or line ends ("\n" or "\r\n"), one number each, into out[0..capacity).
+	// Stops at the first field that isn't exactly a number (std::errc::invalid_argument, empty fields too) or
+	// doesn't fit (std::errc::result_out_of_range), or when out is full and fields are left
+	// (std::errc::value_too_large). A line end after the last field is fine.
+	// The separators are found 8 bytes at a time ahead of the parsing, so where a field starts doesn't depend on
+	// parsing the one before it, and consecutive fields are parsed in parallel by the CPU.
+	template <typename T>
+	parse_column_result parse_column(std::string_view text, char delimiter, T* out, size_t capacity)
+	{
+		const char* fieldStart = text.data();
+		const char* const last = fieldStart + text.size();
+		const uint64_t delimiters = details::ParseOnes * static_cast<unsigned char>(delimiter), newlines = details::ParseOnes * '\n';
+		size_t count = 0;
+		for (const char* word = fieldStart; word < last; word += 8)
+		{
+			const size_t available = static_cast<size_t>(last - word);
+			const uint64_t chunk = details::LoadChunk(word, last);
+			uint64_t separators = details::ByteEqualMask(chunk, delimiters) | details::ByteEqualMask(chunk, newlines);
+			if (available < 8)
+				separators &= (uint64_t(1) << (8 * available)) - 1;						// a zero delimiter would match the padding
+			for (; separators != 0; separators &= separators - 1)
+			{
+				const char* fieldEnd = word + details::CountTrailingZeros(separators) / 8;
+				if (count == capacity)
+					return { count, fieldStart, std::errc::value_too_large };
+				const std::errc ec = details::ParseField(fieldStart, fieldEnd, last, out[count]);
+				if (ec != std::errc())
+					return { count, fieldStart, ec };
+				++count;
+				fieldStart = fieldEnd + 1;
+			}
+		}
+		if (fieldStart < last)
+		{
+			if (count == capacity)
+				return { count, fieldStart, std::errc::value_too_large };
+			const std::errc ec = details::ParseField(fieldStart, last, last, out[count]);
+			if (ec != std::errc())
+				return { count, fieldStart, ec };
+			++count;
+		}
+		else if (fieldStart == last && last != text.data() && last[-1] == delimiter && delimiter != '\n')
+			return { count, last, std::errc::invalid_argument };					// a delimiter right before the end leaves an empty field
+		return { count, last, std::errc() };
+	}
+
+#ifdef INTO_PARSE_HAS_SPAN
+	template <typename T, size_t Extent>
+	parse_column_result parse_column(std::string_view text, char delimiter, std::span<T, Extent> out)
+	{
+		return parse_column(text, delimiter, out.data(), out.size());
+	}
+#endif
+}
+
+#ifdef __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE
+} // namespace __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE
+#endif
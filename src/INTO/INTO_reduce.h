@@ -0,0 +1,159 @@
+#pragma once
+
+// INTO::checked_reduce / INTO::checked_transform_reduce -- parallel sums with exact overflow semantics.
+//
+// Summing element by element with overflowchecked<T> is both slow (a check per element, one thread) and too
+// strict: it throws when an intermediate sum leaves T even if the final sum fits (100 + 100 - 150 in int8_t).
+// Here the range is split into contiguous chunks, one per thread, each one accumulated in __int128 without
+// any check -- 2^64 elements of 64 bits can't overflow 128 bits -- and the partials are combined (checked)
+// at the end. The result is overflowchecked<T>, and it's an overflow iff the exact sum doesn't fit in T.
+//
+//		llongo total = INTO::checked_reduce(values.begin(), values.end(), llongo(0));
+//		llongo bytes = INTO::checked_transform_reduce(files.begin(), files.end(), llongo(0), [](const File& f) { return f.size; });
+//
+// Threads are started per call (std::thread, one per hardware thread by default), so small ranges
+// (below INTO_REDUCE_MIN_PER_THREAD elements per thread) are done on the calling thread. Non random access
+// ranges are always done on the calling thread.
+
+#include "INTO.h"
+
+#include <algorithm>
+#include <exception>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <typeinfo>
+#include <vector>
+
+#if !defined(__SIZEOF_INT128__)
+#error INTO_reduce.h needs __int128 (GCC/Clang)
+#endif
+
+#ifndef INTO_REDUCE_MIN_PER_THREAD
+#define INTO_REDUCE_MIN_PER_THREAD	65536
+#endif
+
+#ifdef __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE
+namespace __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE {
+#endif
+
+namespace INTO
+{
+	namespace details
+	{
+		typedef __int128 ReduceAccumulator_t;
+
+		template <typename T> struct ReduceValue { typedef T type; };
+		template <typename T> struct ReduceValue<overflowchecked<T>> { typedef T type; };
+		template <typename T> using ReduceValue_t = typename ReduceValue<std::decay_t<T>>::type;
+
+		template <typename V> inline ReduceAccumulator_t ToAccumulator(const V& value)
+		{
+			static_assert(std::is_integral<ReduceValue_t<V>>::value && sizeof(ReduceValue_t<V>) <= 8,
+				"checked_reduce sums integers (or overflowchecked integers) up to 64 bits");
+			return static_cast<ReduceAccumulator_t>(static_cast<ReduceValue_t<V>>(value));
+		}
+
+		// the hot loop, no checks at all
+		template <typename It, typename Transform> ReduceAccumulator_t ReduceChunk(It first, It last, Transform& transform)
+		{
+			ReduceAccumulator_t sum = 0;
+			for (; first != last; ++first)
+				sum += ToAccumulator(transform(*first));
+			return sum;
+		}
+
+		inline std::string AccumulatorToString(ReduceAccumulator_t value)
+		{
+			unsigned __int128 magnitude = value < 0 ? 0 - static_cast<unsigned __int128>(value) : static_cast<unsigned __int128>(value);
+			std::string digits;
+			do
+			{
+				digits.insert(digits.begin(), static_cast<char>('0' + static_cast<int>(magnitude % 10)));
+				magnitude /= 10;
+			} while (magnitude != 0);
+			return value < 0 ? "-" + digits : digits;
+		}
+
+		template <typename T> overflowchecked<T> ReduceResult(ReduceAccumulator_t sum, const char* what)
+		{
+			if (sum < static_cast<ReduceAccumulator_t>(std::numeric_limits<T>::min()) || sum > static_cast<ReduceAccumulator_t>(std::numeric_limits<T>::max()))
+			{
+				SignalOverflowError<T>(nullptr, std::string(typeid(T).name()) + " " + what + " overflow: exact sum " + AccumulatorToString(sum) +
+					" does not fit in range " + std::to_string(std::numeric_limits<T>::min()) + ".." + std::to_string(std::numeric_limits<T>::max()));
+			}
+			return overflowchecked<T>(static_cast<T>(sum));
+		}
+
+		template <typename T, typename It, typename Transform>
+		overflowchecked<T> Reduce(It first, It last, ReduceAccumulator_t init, Transform transform, unsigned threads, const char* what)
+		{
+			ReduceAccumulator_t total = init;
+			if constexpr (std::is_base_of<std::random_access_iterator_tag, typename std::iterator_traits<It>::iterator_category>::value)
+			{
+				const auto count = static_cast<size_t>(last - first);
+				if (threads == 0)
+					threads = std::max(1u, std::thread::hardware_concurrency());
+				threads = static_cast<unsigned>(std::min<size_t>(threads, std::max<size_t>(1, count / INTO_REDUCE_MIN_PER_THREAD)));
+				if (threads > 1)
+				{
+					// contiguous chunks, the calling thread takes the last one; each partial is written once
+					std::vector<ReduceAccumulator_t> partials(threads);
+					std::vector<std::exception_ptr> errors(threads);
+					std::vector<std::thread> workers;
+					workers.reserve(threads - 1);
+					const size_t perThread = count / threads;
+					auto work = [&](unsigned index) {
+						const It chunkFirst = first + static_cast<ptrdiff_t>(index * perThread);
+						const It chunkLast = index + 1 == threads ? last : chunkFirst + static_cast<ptrdiff_t>(perThread);
+						try { partials[index] = ReduceChunk(chunkFirst, chunkLast, transform); }
+						catch (...) { errors[index] = std::current_exception(); }
+					};
+					for (unsigned i = 0; i + 1 < threads; ++i)
+						workers.emplace_back(work, i);
+					work(threads - 1);
+					for (auto& worker : workers)
+						worker.join();
+					for (unsigned i = 0; i < threads; ++i)
+					{
+						if (errors[i])
+							std::rethrow_exception(errors[i]);
+						// each partial is below 2^127 in magnitude, but the sum of many of them might not be
+						if (__builtin_add_overflow(total, partials[i], &total))
+							SignalOverflowError<T>(nullptr, std::string(typeid(T).name()) + " " + what + " overflow: exact sum exceeds 128 bits");
+					}
+					return ReduceResult<T>(total, what);
+				}
+			}
+			if (__builtin_add_overflow(total, ReduceChunk(first, last, transform), &total))
+				SignalOverflowError<T>(nullptr, std::string(typeid(T).name()) + " " + what + " overflow: exact sum exceeds 128 bits");
+			return ReduceResult<T>(total, what);
+		}
+
+		struct ReduceIdentity
+		{
+			template <typename V> const V& operator() (const V& value) const { return value; }
+		};
+	}
+
+	// Sum of [first, last) plus init, exact; overflow iff the exact result doesn't fit in T.
+	// threads == 0: one per hardware thread.
+	template <typename It, typename Init>
+	overflowchecked<details::ReduceValue_t<Init>> checked_reduce(It first, It last, Init init, unsigned threads = 0)
+	{
+		return details::Reduce<details::ReduceValue_t<Init>>(first, last, details::ToAccumulator(init), details::ReduceIdentity(), threads, "checked_reduce");
+	}
+
+	// Sum of transform(element) over [first, last) plus init; transform is called concurrently from several threads.
+	template <typename It, typename Init, typename Transform>
+	overflowchecked<details::ReduceValue_t<Init>> checked_transform_reduce(It first, It last, Init init, Transform transform, unsigned threads = 0)
+	{
+		return details::Reduce<details::ReduceValue_t<Init>>(first, last, details::ToAccumulator(init), transform, threads, "checked_transform_reduce");
+	}
+}
+
+#ifdef __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE
+} // namespace __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE
+#endif
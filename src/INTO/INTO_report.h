@@ -0,0 +1,74 @@
+#pragma once
+
+// The reporting part of INTO: the exception thrown on overflow, SignalOverflowError for the headers built on
+// overflowchecked (INTO_bounded.h, INTO_widening.h, ...), and the message building behind the
+// detail::Report... functions the core operators call. Included by INTO.h (and, unless
+// __DEBUG_CHECK_INTEGER_OVERFLOW_PRECOMPILED is defined, by INTO_core.h); with the switch defined, the
+// Report... functions are compiled once, in INTO.cpp.
+
+#include "INTO_core.h"
+
+#include <string>
+#include <stdexcept>
+#include <typeinfo>
+
+#ifdef __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE
+namespace __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE {
+#endif
+
+class INTO_exception : public std::overflow_error {
+public:
+	INTO_exception(const char* message) :
+		std::overflow_error(message) {}
+};
+
+template <typename T> [[noreturn]] inline void SignalOverflowError(const overflowchecked<T>* object, std::string errorMsg)
+{
+	throw INTO_exception(errorMsg.c_str());
+}
+
+#if !defined(__DEBUG_CHECK_INTEGER_OVERFLOW_PRECOMPILED) || defined(__DEBUG_CHECK_INTEGER_OVERFLOW_INTO_CPP)
+namespace detail
+{
+	INTO_REPORT_INLINE std::string ReportedToString(ReportedOperand operand)
+	{
+		return operand.bSigned ? std::to_string(static_cast<intmax_t>(operand.bits)) : std::to_string(operand.bits);
+	}
+
+	INTO_REPORT_INLINE void ReportInitializationOverflow(ReportedOperand initval, ReportedOperand lowerBound, ReportedOperand upperBound)
+	{
+		const std::string message = std::string(lowerBound.type->name()) + " initialization overflow: " + ReportedToString(initval) +
+			" is not in range " + ReportedToString(lowerBound) + ".." + ReportedToString(upperBound);
+#ifdef __DEBUG_CHECK_INTEGER_OVERFLOW_SAMPLED
+		if (SampledOverflowReported(message.c_str()))
+			return;
+#endif
+		throw INTO_exception(message.c_str());
+	}
+
+	// the bounds are of the common type
+	INTO_REPORT_INLINE void ReportOperatorOverflow(const char* op, ReportedOperand lhs, ReportedOperand rhs,
+		ReportedOperand lowerBound, ReportedOperand upperBound, OverflowDirection direction)
+	{
+		std::string message = *lhs.type == *rhs.type ?
+			std::string(lhs.type->name()) :
+			std::string(lhs.type->name()) + ", " + rhs.type->name() + " [common:" + lowerBound.type->name() + "]";
+		message += std::string(" op") + op + " overflow: " + ReportedToString(lhs) + op + ReportedToString(rhs);
+		if (direction == OverflowDirection::Above)
+			message += " > " + ReportedToString(upperBound);
+		else if (direction == OverflowDirection::Below)
+			message += " < " + ReportedToString(lowerBound);
+		else
+			message += " does not fit in range " + ReportedToString(lowerBound) + ".." + ReportedToString(upperBound);
+#ifdef __DEBUG_CHECK_INTEGER_OVERFLOW_SAMPLED
+		if (SampledOverflowReported(message.c_str()))
+			return;
+#endif
+		throw INTO_exception(message.c_str());
+	}
+}
+#endif
+
+#ifdef __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE
+} // namespace __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE
+#endif
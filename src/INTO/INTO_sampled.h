@@ -0,0 +1,245 @@
+#pragma once
+
+// Sampled overflow checking, for production canaries: overflowchecked<T> checks one in N of its additions,
+// subtractions and multiplications at each site instead of all of them, with N set at runtime.
+//
+// Enabled project-wide with __DEBUG_CHECK_INTEGER_OVERFLOW_SAMPLED next to __DEBUG_CHECK_INTEGER_OVERFLOW; the
+// aliases (into, llongo, ...) stay overflowchecked<T>, INTO_core.h includes this header. Every site has a countdown
+// per thread, and the unchecked path of an operation is its decrement and a branch. When it runs out the operation
+// is checked and the next countdown is drawn uniformly from 1..2N-1, so a rarely executed site is sampled at 1/N
+// of its own executions, not starved by a hot one. A site is an operator with its operand types (operator+ of two
+// into's is one, wherever it's written), as C++17 operators can't tell where they're called from; to give a block
+// a countdown of its own, put INTO_SAMPLING_SITE() at its start:
+//
+//		INTO::set_sampling_period(100);							// 1: check everything, 0: nothing
+//		INTO::set_sampled_overflow_handler([](const char* message) { canaryLog.Write(message); });
+//		...
+//		llongo Total(const std::vector<llongo>& values)
+//		{
+//			INTO_SAMPLING_SITE();								// the operations up to the end of the block
+//			...
+//		}
+//
+// An INTO::sampled_scope overrides the countdowns: placed where a unit of work starts (a request, a batch), it
+// steps the thread's scope countdown once and the operations up to its end are either all checked or all plain
+// wrap-around arithmetic, which keeps related operations together in a sample. Nested scopes follow the outermost.
+// A detected overflow goes to the handler and the operation returns the wrapped result, or without a handler
+// it's thrown (INTO_exception) like an unsampled overflow. Initializations are always checked, their check costs
+// no more than the sampling test would. So is division: its check is a compare next to a division, and skipping
+// it would let INT_MIN / -1 trap. The other INTO types (bounded, widening, atomic_overflowchecked, ...) are not
+// sampled. Can be included without the switch: the sites and scopes compile to nothing and the settings aren't read.
+
+#include <atomic>
+#include <cstdint>
+
+#ifndef INTO_SAMPLING_PERIOD_DEFAULT
+#define INTO_SAMPLING_PERIOD_DEFAULT	64
+#endif
+
+#ifdef __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE
+namespace __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE {
+#endif
+
+namespace INTO
+{
+	typedef void (*sampled_overflow_handler)(const char* message);
+}
+
+namespace detail
+{
+	inline std::atomic<uint32_t>& SamplingPeriod()
+	{
+		static std::atomic<uint32_t> period{ INTO_SAMPLING_PERIOD_DEFAULT };
+		return period;
+	}
+
+	inline std::atomic<INTO::sampled_overflow_handler>& SampledOverflowHandler()
+	{
+		static std::atomic<INTO::sampled_overflow_handler> handler{ nullptr };
+		return handler;
+	}
+
+	inline std::atomic<uint64_t>& SampledOverflowCount()
+	{
+		static std::atomic<uint64_t> count{ 0 };
+		return count;
+	}
+
+	enum SampleMode : uint8_t { SampleByPeriod, SampleAlways, SampleNever };
+
+	// a countdown, or a sampled scope's decision; constant-initialized, so a thread_local one needs no guard on access
+	struct SampleSite
+	{
+		uint32_t countdown = 1;
+		SampleMode mode = SampleByPeriod;
+	};
+
+	struct SampleState
+	{
+		SampleSite* active = nullptr;		// an INTO_SAMPLING_SITE's or a sampled scope's, instead of the operation's own
+		SampleSite scopes;					// the countdown of the sampled scopes
+		SampleSite checkedScope{ 0, SampleAlways };
+		SampleSite uncheckedScope{ 0, SampleNever };
+		uint32_t random = 0;
+		uint32_t depth = 0;					// sampled scopes entered
+	};
+
+	inline SampleState& ThreadSampleState()
+	{
+		static thread_local SampleState state;
+		return state;
+	}
+
+	// the countdown ran out: draw the next one, and tell whether this operation (or scope) is checked
+	inline bool Resample(SampleState& state, SampleSite& site)
+	{
+		const uint32_t period = SamplingPeriod().load(std::memory_order_relaxed);
+		if (state.random == 0)
+			state.random = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(&state) >> 4) | 1;
+		state.random ^= state.random << 13;
+		state.random ^= state.random >> 17;
+		state.random ^= state.random << 5;
+		if (period == 0)
+		{
+			site.countdown = 1u << 16;			// look at the period again from time to time
+			return false;
+		}
+		// 1..2N-1 by multiply and shift, a division would be most of the cost of a resample
+		site.countdown = period == 1 ? 1 : static_cast<uint32_t>(1 + ((uint64_t(state.random) * (2 * uint64_t(period) - 1)) >> 32));
+		return true;
+	}
+
+#ifdef __DEBUG_CHECK_INTEGER_OVERFLOW_SAMPLED
+	// Op, U, V: the site, each instantiation has its own countdown per thread; a scope's decision is only read
+	template <char Op, typename U, typename V> inline bool SampleThis()
+	{
+		static thread_local SampleSite own;
+		SampleState& state = ThreadSampleState();
+		SampleSite* site = state.active;
+		if (!site)
+			site = &own;
+		else if (site->mode != SampleByPeriod)
+			return site->mode == SampleAlways;
+		if (--site->countdown != 0)
+			return false;
+		return Resample(state, *site);
+	}
+#endif
+
+	// called by the Report... functions (INTO_report.h) with the message; false: no handler, throw it
+	inline bool SampledOverflowReported(const char* message)
+	{
+		SampledOverflowCount().fetch_add(1, std::memory_order_relaxed);
+		const INTO::sampled_overflow_handler handler = SampledOverflowHandler().load(std::memory_order_acquire);
+		if (!handler)
+			return false;
+		handler(message);
+		return true;
+	}
+}
+
+namespace INTO
+{
+	// Threads pick up a new period at a site when its current countdown runs out (period 0: within 65536 operations).
+	inline void set_sampling_period(uint32_t period) { detail::SamplingPeriod().store(period, std::memory_order_relaxed); }
+	inline uint32_t sampling_period() { return detail::SamplingPeriod().load(std::memory_order_relaxed); }
+
+	// nullptr: throw INTO_exception, as unsampled checks do. The handler may be called from any thread.
+	inline void set_sampled_overflow_handler(sampled_overflow_handler handler) { detail::SampledOverflowHandler().store(handler, std::memory_order_release); }
+
+	// overflows detected so far, handled or thrown
+	inline uint64_t sampled_overflow_count() { return detail::SampledOverflowCount().load(std::memory_order_relaxed); }
+
+	// What INTO_SAMPLING_SITE() puts in a block: the operations up to its end use the given countdown instead of
+	// their own, unless a sampled scope decides for them. Not to be moved to another thread.
+	class sampling_site
+	{
+	public:
+		typedef detail::SampleSite countdown;
+
+		explicit sampling_site(countdown& site)
+		{
+#ifdef __DEBUG_CHECK_INTEGER_OVERFLOW_SAMPLED
+			detail::SampleState& state = detail::ThreadSampleState();
+			if (state.depth != 0)
+				return;
+			m_previous = state.active;
+			state.active = &site;
+			m_bActive = true;
+#else
+			(void)site;
+#endif
+		}
+		~sampling_site()
+		{
+#ifdef __DEBUG_CHECK_INTEGER_OVERFLOW_SAMPLED
+			if (m_bActive)
+				detail::ThreadSampleState().active = m_previous;
+#endif
+		}
+		sampling_site(const sampling_site&) = delete;
+		sampling_site& operator= (const sampling_site&) = delete;
+
+	private:
+#ifdef __DEBUG_CHECK_INTEGER_OVERFLOW_SAMPLED
+		countdown* m_previous = nullptr;
+		bool m_bActive = false;
+#endif
+	};
+
+	// One step of the thread's scope countdown when it's the outermost on the thread: the operations up to its end
+	// are all checked if the countdown ran out, none of them otherwise. Not to be moved to another thread.
+	class sampled_scope
+	{
+	public:
+		sampled_scope()
+		{
+#ifdef __DEBUG_CHECK_INTEGER_OVERFLOW_SAMPLED
+			detail::SampleState& state = detail::ThreadSampleState();
+			if (state.depth++ != 0)
+				return;
+			m_previous = state.active;
+			const bool bChecked = --state.scopes.countdown == 0 && detail::Resample(state, state.scopes);
+			state.active = bChecked ? &state.checkedScope : &state.uncheckedScope;
+#endif
+		}
+		~sampled_scope()
+		{
+#ifdef __DEBUG_CHECK_INTEGER_OVERFLOW_SAMPLED
+			detail::SampleState& state = detail::ThreadSampleState();
+			if (--state.depth == 0)
+				state.active = m_previous;
+#endif
+		}
+		sampled_scope(const sampled_scope&) = delete;
+		sampled_scope& operator= (const sampled_scope&) = delete;
+
+		// whether the operations in it are checked (always, without the switch)
+		bool checked() const
+		{
+#ifdef __DEBUG_CHECK_INTEGER_OVERFLOW_SAMPLED
+			detail::SampleState& state = detail::ThreadSampleState();
+			return state.active == &state.checkedScope;
+#else
+			return true;
+#endif
+		}
+
+	private:
+#ifdef __DEBUG_CHECK_INTEGER_OVERFLOW_SAMPLED
+		detail::SampleSite* m_previous = nullptr;
+#endif
+	};
+}
+
+#ifdef __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE
+} // namespace __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE
+#endif
+
+// a countdown of its own for the operations in the rest of the enclosing block
+#ifdef __DEBUG_CHECK_INTEGER_OVERFLOW_SAMPLED
+#define INTO_SAMPLING_SITE()	static thread_local INTO::sampling_site::countdown INTO_sampling_site_countdown; \
+	INTO::sampling_site INTO_sampling_site(INTO_sampling_site_countdown)
+#else
+#define INTO_SAMPLING_SITE()	((void)0)
+#endif
@@ -0,0 +1,76 @@
+#pragma once
+
+// INTO::checked_view / INTO::raw_view -- zero-copy reinterpretation between buffers of T and of overflowchecked<T>.
+//
+// overflowchecked<T> has exactly the layout of T (see OVERFLOWCHECKED_LAYOUT_COMPATIBLE in INTO.h), so a mmapped
+// column or a network buffer of int64_t can be processed with the checked operators in place:
+//
+//		std::span<const int64_t> column = ...;					// e.g. over an mmapped file
+//		for (llongo value : INTO::checked_view(column))
+//			total = total + value;
+//
+// Values read through a checked view are not checked on the way in (the bit pattern of any T is a valid T),
+// only the operations on them are. Writing through a view stores the plain value.
+// Needs C++20 <span>.
+
+#include "INTO.h"
+
+#if defined(__has_include)
+#if __has_include(<span>) && __cplusplus >= 202002L
+#include <span>
+#define INTO_HAS_SPAN
+#endif
+#endif
+
+#ifdef INTO_HAS_SPAN
+
+#include <type_traits>
+
+#ifdef __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE
+namespace __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE {
+#endif
+
+namespace INTO
+{
+	// span<T> -> span<overflowchecked<T>>, const is kept
+	template <typename T, size_t Extent>
+	std::span<std::conditional_t<std::is_const<T>::value, const overflowchecked<std::remove_const_t<T>>, overflowchecked<T>>, Extent>
+		checked_view(std::span<T, Extent> raw)
+	{
+		using value_type = std::remove_const_t<T>;
+		using checked_type = std::conditional_t<std::is_const<T>::value, const overflowchecked<value_type>, overflowchecked<value_type>>;
+		static_assert(std::is_integral<value_type>::value, "checked_view is for integer buffers");
+		static_assert(OVERFLOWCHECKED_LAYOUT_COMPATIBLE<value_type>, "overflowchecked<T> must have the layout of T");
+		return std::span<checked_type, Extent>(reinterpret_cast<checked_type*>(raw.data()), raw.size());
+	}
+
+	// span<overflowchecked<T>> -> span<T>, for handing checked data to code that takes plain buffers
+	template <typename C, size_t Extent>
+	auto raw_view(std::span<C, Extent> checked)
+	{
+		using checked_type = std::remove_const_t<C>;
+		using value_type = decltype(detail::OverflowcheckedAccess::Value(std::declval<const checked_type&>()));
+		using raw_type = std::conditional_t<std::is_const<C>::value, const value_type, value_type>;
+		static_assert(std::is_same<checked_type, overflowchecked<value_type>>::value, "raw_view is for spans of overflowchecked<T>");
+		static_assert(OVERFLOWCHECKED_LAYOUT_COMPATIBLE<value_type>, "overflowchecked<T> must have the layout of T");
+		return std::span<raw_type, Extent>(reinterpret_cast<raw_type*>(checked.data()), checked.size());
+	}
+
+	// containers and arrays, deduced through std::span
+	template <typename Container>
+	auto checked_view(Container& raw) -> decltype(checked_view(std::span(raw)))
+	{
+		return checked_view(std::span(raw));
+	}
+	template <typename Container>
+	auto raw_view(Container& checked) -> decltype(raw_view(std::span(checked)))
+	{
+		return raw_view(std::span(checked));
+	}
+}
+
+#ifdef __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE
+} // namespace __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE
+#endif
+
+#endif // INTO_HAS_SPAN
@@ -0,0 +1,506 @@
+#pragma once
+
+// widening<T> -- an integer that keeps computing exactly instead of throwing when T overflows.
+//
+// The value is held as a 128-bit integer (16 bytes, so a vector of them stays dense), but as long as both
+// operands fit in T, the operators work on T with the same builtin overflow detection overflowchecked<T> has,
+// so the common path is one add/mul plus the overflow branch (and two compares telling that both operands are
+// small). When that fires, the operation is redone in 128 bits and the value simply stays wide from then on
+// (it becomes small again when a result fits in T). Unsigned T works the same way, 3u - 5u is -2.
+//
+// 128 bits is as far as 16 bytes go: if a 128-bit result overflows too, the value is promoted to an
+// INTO::bignum<> (fixed-capacity, 256 bits) kept out of line. The upper half of the 16 bytes is then a marker,
+// the lower half points to the bignum, so the 2^64 values from the 128-bit minimum up are never stored inline,
+// they are promoted as well. That's one allocation per promoted value (and per copy of it), freed when the
+// value goes back to 128 bits. Only overflowing the bignum is reported, through SignalOverflowError like
+// overflowchecked does.
+
+#include "INTO.h"
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
+
+#if !defined(__SIZEOF_INT128__)
+#error INTO_widening.h needs __int128 and __builtin_*_overflow (GCC/Clang)
+#endif
+
+#ifdef __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE
+namespace __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE {
+#endif
+
+namespace detail
+{
+	typedef __int128 Widening_t;
+	typedef unsigned __int128 UWidening_t;
+
+	// upper half of a widening that holds a bignum pointer in its lower half
+	constexpr uint64_t WIDENING_PROMOTED = uint64_t(1) << 63;
+
+	inline bool IsPromotionMarker(Widening_t value)
+	{
+		return static_cast<uint64_t>(static_cast<UWidening_t>(value) >> 64) == WIDENING_PROMOTED;
+	}
+
+	inline std::string Int128ToString(Widening_t value)
+	{
+		UWidening_t magnitude = value < 0 ? UWidening_t(0) - static_cast<UWidening_t>(value) : static_cast<UWidening_t>(value);
+		char buffer[48];
+		char* p = buffer + sizeof(buffer);
+		*--p = '\0';
+		do
+		{
+			*--p = static_cast<char>('0' + static_cast<int>(magnitude % 10));
+			magnitude /= 10;
+		} while (magnitude != 0);
+		if (value < 0)
+			*--p = '-';
+		return std::string(p);
+	}
+}
+
+template <typename T>
+class widening;
+
+namespace INTO
+{
+	// Fixed-capacity two's complement integer of Limbs * 64 bits, heap-free. Overflowing the capacity is
+	// reported through SignalOverflowError. widening<T> promotes to bignum<> when 128 bits aren't enough.
+	template <unsigned Limbs = 4>
+	class bignum {
+		static_assert(Limbs >= 2, "bignum has to be at least 128 bits");
+	private:
+		uint64_t m_limbs[Limbs];								// little endian
+
+		bool IsNegative() const { return (m_limbs[Limbs - 1] >> 63) != 0; }
+		void Negate()
+		{
+			unsigned carry = 1;
+			for (unsigned i = 0; i < Limbs; ++i)
+			{
+				const uint64_t inverted = ~m_limbs[i];
+				m_limbs[i] = inverted + carry;
+				carry = carry && m_limbs[i] == 0;
+			}
+		}
+		bignum Magnitude() const { bignum result = *this; if (IsNegative()) result.Negate(); return result; }
+
+		// shift-subtract long division of the magnitudes, read as unsigned (so MIN's magnitude is fine too)
+		static void DivideMagnitudes(const bignum& a, const bignum& b, bignum& quotient, bignum& remainder)
+		{
+			quotient = bignum();
+			remainder = bignum();
+			for (unsigned bit = Limbs * 64; bit-- > 0;)
+			{
+				for (unsigned i = Limbs; i-- > 1;)
+					remainder.m_limbs[i] = (remainder.m_limbs[i] << 1) | (remainder.m_limbs[i - 1] >> 63);
+				remainder.m_limbs[0] = (remainder.m_limbs[0] << 1) | ((a.m_limbs[bit / 64] >> (bit % 64)) & 1);
+				bool bLess = false;
+				for (unsigned i = Limbs; i-- > 0;)
+				{
+					if (remainder.m_limbs[i] != b.m_limbs[i])
+					{
+						bLess = remainder.m_limbs[i] < b.m_limbs[i];
+						break;
+					}
+				}
+				if (!bLess)
+				{
+					bool borrow = false;
+					for (unsigned i = 0; i < Limbs; ++i)
+					{
+						const bool borrow1 = __builtin_sub_overflow(remainder.m_limbs[i], b.m_limbs[i], &remainder.m_limbs[i]);
+						const bool borrow2 = __builtin_sub_overflow(remainder.m_limbs[i], uint64_t(borrow), &remainder.m_limbs[i]);
+						borrow = borrow1 || borrow2;
+					}
+					quotient.m_limbs[bit / 64] |= uint64_t(1) << (bit % 64);
+				}
+			}
+		}
+
+		[[noreturn]] static void SignalBignumOverflow(const char* op, const bignum& lhs, const bignum& rhs)
+		{
+			SignalOverflowError<int64_t>(nullptr, "bignum<" + std::to_string(Limbs) + "> op" + op + " overflow: " +
+				lhs.to_string() + op + rhs.to_string() + " exceeds " + std::to_string(Limbs * 64) + " bits");
+		}
+
+		template <unsigned OtherLimbs> friend class bignum;
+
+	public:
+		bignum() : m_limbs() {}
+		bignum(detail::Widening_t value)
+		{
+			m_limbs[0] = static_cast<uint64_t>(value);
+			m_limbs[1] = static_cast<uint64_t>(static_cast<detail::UWidening_t>(value) >> 64);
+			for (unsigned i = 2; i < Limbs; ++i)
+				m_limbs[i] = value < 0 ? ~uint64_t(0) : 0;
+		}
+		template <typename I, typename std::enable_if<std::is_integral<I>::value, int>::type = 0>
+		bignum(I value) : bignum(static_cast<detail::Widening_t>(value)) {}
+		template <typename T>
+		bignum(const widening<T>& value) : bignum(value.to_bignum()) {}
+		// sign extended, or checked when it's narrower
+		template <unsigned OtherLimbs, typename std::enable_if<OtherLimbs != Limbs, int>::type = 0>
+		explicit bignum(const bignum<OtherLimbs>& other)
+		{
+			const uint64_t extension = other.IsNegative() ? ~uint64_t(0) : 0;
+			for (unsigned i = 0; i < Limbs; ++i)
+				m_limbs[i] = i < OtherLimbs ? other.m_limbs[i] : extension;
+			bool bFits = IsNegative() == other.IsNegative();
+			for (unsigned i = Limbs; i < OtherLimbs; ++i)
+				bFits = bFits && other.m_limbs[i] == extension;
+			if (!bFits)
+			{
+				SignalOverflowError<int64_t>(nullptr, "bignum<" + std::to_string(Limbs) + "> conversion overflow: " +
+					other.to_string() + " exceeds " + std::to_string(Limbs * 64) + " bits");
+			}
+		}
+
+		bool is_zero() const
+		{
+			for (unsigned i = 0; i < Limbs; ++i)
+				if (m_limbs[i] != 0)
+					return false;
+			return true;
+		}
+		// the upper limbs are just the sign extension of the lower two
+		bool fits_int128() const
+		{
+			const uint64_t extension = (m_limbs[1] >> 63) ? ~uint64_t(0) : 0;
+			for (unsigned i = 2; i < Limbs; ++i)
+				if (m_limbs[i] != extension)
+					return false;
+			return true;
+		}
+		detail::Widening_t to_int128() const
+		{
+			return static_cast<detail::Widening_t>((static_cast<detail::UWidening_t>(m_limbs[1]) << 64) | m_limbs[0]);
+		}
+
+		friend bignum operator+ (const bignum& lhs, const bignum& rhs)
+		{
+			bignum result;
+			bool carry = false;
+			for (unsigned i = 0; i < Limbs; ++i)
+			{
+				uint64_t sum;
+				const bool carry1 = __builtin_add_overflow(lhs.m_limbs[i], rhs.m_limbs[i], &sum);
+				const bool carry2 = __builtin_add_overflow(sum, uint64_t(carry), &result.m_limbs[i]);
+				carry = carry1 || carry2;
+			}
+			// signed overflow: both operands have the same sign and the result has the other one
+			if (lhs.IsNegative() == rhs.IsNegative() && result.IsNegative() != lhs.IsNegative())
+				SignalBignumOverflow("+", lhs, rhs);
+			return result;
+		}
+		bignum operator- () const
+		{
+			bignum result = *this;
+			result.Negate();
+			if (IsNegative() && result.IsNegative())			// MIN
+				SignalBignumOverflow("-", bignum(), *this);
+			return result;
+		}
+		friend bignum operator- (const bignum& lhs, const bignum& rhs)
+		{
+			bignum result;
+			bool borrow = false;
+			for (unsigned i = 0; i < Limbs; ++i)
+			{
+				uint64_t difference;
+				const bool borrow1 = __builtin_sub_overflow(lhs.m_limbs[i], rhs.m_limbs[i], &difference);
+				const bool borrow2 = __builtin_sub_overflow(difference, uint64_t(borrow), &result.m_limbs[i]);
+				borrow = borrow1 || borrow2;
+			}
+			if (lhs.IsNegative() != rhs.IsNegative() && result.IsNegative() != lhs.IsNegative())
+				SignalBignumOverflow("-", lhs, rhs);
+			return result;
+		}
+		friend bignum operator* (const bignum& lhs, const bignum& rhs)
+		{
+			// schoolbook on the magnitudes, 64x64->128 bit limb products
+			const bignum a = lhs.Magnitude(), b = rhs.Magnitude();
+			bignum result;
+			bool bOverflow = a.IsNegative() || b.IsNegative();		// MIN has no magnitude
+			for (unsigned i = 0; i < Limbs && !bOverflow; ++i)
+			{
+				uint64_t carry = 0;
+				for (unsigned j = 0; j < Limbs; ++j)
+				{
+					// can't overflow: (2^64-1)^2 + 2*(2^64-1) == 2^128-1
+					const uint64_t existing = i + j < Limbs ? result.m_limbs[i + j] : 0;
+					const detail::UWidening_t product = static_cast<detail::UWidening_t>(a.m_limbs[i]) * b.m_limbs[j] + existing + carry;
+					if (i + j < Limbs)
+						result.m_limbs[i + j] = static_cast<uint64_t>(product);
+					else if (static_cast<uint64_t>(product) != 0)
+						bOverflow = true;
+					carry = static_cast<uint64_t>(product >> 64);
+				}
+				if (carry != 0)
+					bOverflow = true;
+			}
+			if (bOverflow || result.IsNegative())
+				SignalBignumOverflow("*", lhs, rhs);
+			if (lhs.IsNegative() != rhs.IsNegative())
+				result.Negate();
+			return result;
+		}
+		// truncating, like the built-in operators; only MIN / -1 overflows, division by zero is reported too
+		friend bignum operator/ (const bignum& lhs, const bignum& rhs)
+		{
+			if (rhs.is_zero())
+				SignalBignumOverflow("/", lhs, rhs);
+			bignum quotient, remainder;
+			DivideMagnitudes(lhs.Magnitude(), rhs.Magnitude(), quotient, remainder);
+			if (lhs.IsNegative() != rhs.IsNegative())
+				quotient.Negate();
+			else if (quotient.IsNegative())
+				SignalBignumOverflow("/", lhs, rhs);
+			return quotient;
+		}
+		friend bignum operator% (const bignum& lhs, const bignum& rhs)
+		{
+			if (rhs.is_zero())
+				SignalBignumOverflow("%", lhs, rhs);
+			bignum quotient, remainder;
+			DivideMagnitudes(lhs.Magnitude(), rhs.Magnitude(), quotient, remainder);
+			if (lhs.IsNegative())
+				remainder.Negate();
+			return remainder;
+		}
+		bignum& operator+= (const bignum& rhs) { return *this = *this + rhs; }
+		bignum& operator-= (const bignum& rhs) { return *this = *this - rhs; }
+		bignum& operator*= (const bignum& rhs) { return *this = *this * rhs; }
+		bignum& operator/= (const bignum& rhs) { return *this = *this / rhs; }
+		bignum& operator%= (const bignum& rhs) { return *this = *this % rhs; }
+
+		friend bool operator== (const bignum& lhs, const bignum& rhs)
+		{
+			for (unsigned i = 0; i < Limbs; ++i)
+				if (lhs.m_limbs[i] != rhs.m_limbs[i])
+					return false;
+			return true;
+		}
+		friend bool operator!= (const bignum& lhs, const bignum& rhs) { return !(lhs == rhs); }
+		friend bool operator< (const bignum& lhs, const bignum& rhs)
+		{
+			if (lhs.IsNegative() != rhs.IsNegative())
+				return lhs.IsNegative();
+			for (unsigned i = Limbs; i-- > 0;)
+				if (lhs.m_limbs[i] != rhs.m_limbs[i])
+					return lhs.m_limbs[i] < rhs.m_limbs[i];
+			return false;
+		}
+		friend bool operator> (const bignum& lhs, const bignum& rhs) { return rhs < lhs; }
+		friend bool operator<= (const bignum& lhs, const bignum& rhs) { return !(rhs < lhs); }
+		friend bool operator>= (const bignum& lhs, const bignum& rhs) { return !(lhs < rhs); }
+
+		std::string to_string() const
+		{
+			// repeated division of the magnitude by 10^19, the largest power of ten in a limb
+			constexpr uint64_t CHUNK = 10000000000000000000ull;
+			uint64_t magnitude[Limbs];
+			bool bNegative = IsNegative();
+			bignum m = *this;
+			if (bNegative)
+				m.Negate();									// MIN stays "negative", but reads fine as unsigned
+			for (unsigned i = 0; i < Limbs; ++i)
+				magnitude[i] = m.m_limbs[i];
+			std::string result;
+			for (;;)
+			{
+				uint64_t remainder = 0;
+				bool bZero = true;
+				for (unsigned i = Limbs; i-- > 0;)
+				{
+					const detail::UWidening_t current = (static_cast<detail::UWidening_t>(remainder) << 64) | magnitude[i];
+					magnitude[i] = static_cast<uint64_t>(current / CHUNK);
+					remainder = static_cast<uint64_t>(current % CHUNK);
+					bZero = bZero && magnitude[i] == 0;
+				}
+				std::string chunk = std::to_string(remainder);
+				if (!bZero)
+					chunk.insert(0, 19 - chunk.size(), '0');
+				result.insert(0, chunk);
+				if (bZero)
+					break;
+			}
+			return bNegative ? "-" + result : result;
+		}
+	};
+}
+
+template <typename T>
+class widening {
+	static_assert(std::is_integral<T>::value && sizeof(T) <= 8, "widening<T> is for integer types up to 64 bits");
+private:
+	detail::Widening_t m_value;								// or the promotion marker and a bignum pointer
+	static constexpr detail::Widening_t s_min = std::numeric_limits<T>::min();
+	struct raw_tag {};
+	widening(detail::Widening_t value, raw_tag) : m_value(value) {}
+	explicit widening(INTO::bignum<>* promoted) : m_value(Marker(promoted)) {}
+
+	static detail::Widening_t Marker(INTO::bignum<>* promoted)
+	{
+		return static_cast<detail::Widening_t>((static_cast<detail::UWidening_t>(detail::WIDENING_PROMOTED) << 64) | reinterpret_cast<uintptr_t>(promoted));
+	}
+
+	INTO::bignum<>* Promoted() const { return reinterpret_cast<INTO::bignum<>*>(static_cast<uintptr_t>(static_cast<uint64_t>(m_value))); }
+
+	// back inline when it fits in 128 bits (and isn't a marker); out of line, like Promote, to keep the
+	// operators' fast path small
+	__attribute__((noinline)) static widening FromBignum(const INTO::bignum<>& value)
+	{
+		if (value.fits_int128() && !detail::IsPromotionMarker(value.to_int128()))
+			return widening(value.to_int128(), raw_tag());
+		return widening(new INTO::bignum<>(value));
+	}
+
+	// the operation beyond 128 bits, or with a promoted operand
+	__attribute__((noinline)) static widening Promote(char op, const widening& lhs, const widening& rhs)
+	{
+		const INTO::bignum<> a = lhs.to_bignum(), b = rhs.to_bignum();
+		switch (op)
+		{
+		case '+':	return FromBignum(a + b);
+		case '-':	return FromBignum(a - b);
+		case '*':	return FromBignum(a * b);
+		case '/':	return FromBignum(a / b);
+		default:	return FromBignum(a % b);
+		}
+	}
+
+public:
+	typedef T value_type;
+
+	widening() : m_value(0) {}
+	widening(T initval) : m_value(initval) {}
+	template <typename U, typename std::enable_if<std::is_integral<U>::value && sizeof(U) <= 8, int>::type = 0>
+	widening(U initval) : m_value(initval) {}
+	widening(overflowchecked<T> initval) : m_value(static_cast<T>(initval)) {}
+	static widening from_int128(detail::Widening_t value)
+	{
+		return detail::IsPromotionMarker(value) ? FromBignum(INTO::bignum<>(value)) : widening(value, raw_tag());
+	}
+
+	widening(const widening& other) : m_value(other.m_value)
+	{
+		if (other.is_bignum())
+			m_value = Marker(new INTO::bignum<>(*other.Promoted()));
+	}
+	widening(widening&& other) noexcept : m_value(other.m_value) { other.m_value = 0; }
+	widening& operator= (widening&& other) noexcept
+	{
+		if (this != &other)
+		{
+			if (is_bignum())
+				delete Promoted();
+			m_value = other.m_value;
+			other.m_value = 0;
+		}
+		return *this;
+	}
+	widening& operator= (const widening& other) { return *this = widening(other); }
+	~widening()
+	{
+		if (is_bignum())
+			delete Promoted();
+	}
+
+	// truncate and extend back: for 64-bit T that's one shift and compare on the upper half
+	bool is_wide() const { return static_cast<detail::Widening_t>(static_cast<T>(m_value)) != m_value; }
+	bool is_bignum() const { return detail::IsPromotionMarker(m_value); }
+	// a promoted value is an overflow here
+	detail::Widening_t value() const
+	{
+		if (is_bignum())
+			SignalOverflowError<T>(nullptr, std::string("widening<") + typeid(T).name() + "> conversion overflow: " + to_string() + " exceeds 128 bits");
+		return m_value;
+	}
+	INTO::bignum<> to_bignum() const { return is_bignum() ? *Promoted() : INTO::bignum<>(m_value); }
+	std::string to_string() const { return is_bignum() ? Promoted()->to_string() : detail::Int128ToString(m_value); }
+
+	// back to T (or overflowchecked<T>): checked, a wide value is an overflow here
+	explicit operator T () const
+	{
+		if (is_wide())
+		{
+			SignalOverflowError<T>(nullptr, std::string("widening<") + typeid(T).name() + "> conversion overflow: " +
+				to_string() + " is not in range " + std::to_string(std::numeric_limits<T>::min()) + ".." + std::to_string(std::numeric_limits<T>::max()));
+		}
+		return static_cast<T>(m_value);
+	}
+	explicit operator overflowchecked<T> () const { return overflowchecked<T>(static_cast<T>(*this)); }
+
+	// a promoted operand is wide, so the small paths below never see one
+	friend widening operator+ (const widening& lhs, const widening& rhs)
+	{
+		T small;
+		if (!lhs.is_wide() && !rhs.is_wide() && !__builtin_add_overflow(static_cast<T>(lhs.m_value), static_cast<T>(rhs.m_value), &small))
+			return widening(small);
+		detail::Widening_t wide;
+		if (lhs.is_bignum() || rhs.is_bignum() || __builtin_add_overflow(lhs.m_value, rhs.m_value, &wide))
+			return Promote('+', lhs, rhs);
+		return from_int128(wide);
+	}
+	friend widening operator- (const widening& lhs, const widening& rhs)
+	{
+		T small;
+		if (!lhs.is_wide() && !rhs.is_wide() && !__builtin_sub_overflow(static_cast<T>(lhs.m_value), static_cast<T>(rhs.m_value), &small))
+			return widening(small);
+		detail::Widening_t wide;
+		if (lhs.is_bignum() || rhs.is_bignum() || __builtin_sub_overflow(lhs.m_value, rhs.m_value, &wide))
+			return Promote('-', lhs, rhs);
+		return from_int128(wide);
+	}
+	friend widening operator* (const widening& lhs, const widening& rhs)
+	{
+		T small;
+		if (!lhs.is_wide() && !rhs.is_wide() && !__builtin_mul_overflow(static_cast<T>(lhs.m_value), static_cast<T>(rhs.m_value), &small))
+			return widening(small);
+		detail::Widening_t wide;
+		if (lhs.is_bignum() || rhs.is_bignum() || __builtin_mul_overflow(lhs.m_value, rhs.m_value, &wide))
+			return Promote('*', lhs, rhs);
+		return from_int128(wide);
+	}
+	// the 128-bit minimum is never inline, so MIN / -1 can't happen in 128 bits; division by zero is left
+	// to the hardware, like in INTO.h (the bignum reports it)
+	friend widening operator/ (const widening& lhs, const widening& rhs)
+	{
+		if (!lhs.is_wide() && !rhs.is_wide() && !(std::is_signed<T>::value && lhs.m_value == s_min && rhs.m_value == -1))
+			return widening(static_cast<T>(static_cast<T>(lhs.m_value) / static_cast<T>(rhs.m_value)));
+		if (lhs.is_bignum() || rhs.is_bignum())
+			return Promote('/', lhs, rhs);
+		return from_int128(lhs.m_value / rhs.m_value);
+	}
+	friend widening operator% (const widening& lhs, const widening& rhs)
+	{
+		if (!lhs.is_wide() && !rhs.is_wide() && !(std::is_signed<T>::value && rhs.m_value == -1))
+			return widening(static_cast<T>(static_cast<T>(lhs.m_value) % static_cast<T>(rhs.m_value)));
+		if (lhs.is_bignum() || rhs.is_bignum())
+			return Promote('%', lhs, rhs);
+		return from_int128(rhs.m_value == -1 ? 0 : lhs.m_value % rhs.m_value);
+	}
+	widening operator- () const { return widening(T(0)) - *this; }
+
+	widening& operator+= (const widening& rhs) { return *this = *this + rhs; }
+	widening& operator-= (const widening& rhs) { return *this = *this - rhs; }
+	widening& operator*= (const widening& rhs) { return *this = *this * rhs; }
+	widening& operator/= (const widening& rhs) { return *this = *this / rhs; }
+	widening& operator%= (const widening& rhs) { return *this = *this % rhs; }
+
+	friend bool operator== (const widening& lhs, const widening& rhs) { return lhs.is_bignum() || rhs.is_bignum() ? lhs.to_bignum() == rhs.to_bignum() : lhs.m_value == rhs.m_value; }
+	friend bool operator!= (const widening& lhs, const widening& rhs) { return !(lhs == rhs); }
+	friend bool operator< (const widening& lhs, const widening& rhs) { return lhs.is_bignum() || rhs.is_bignum() ? lhs.to_bignum() < rhs.to_bignum() : lhs.m_value < rhs.m_value; }
+	friend bool operator> (const widening& lhs, const widening& rhs) { return rhs < lhs; }
+	friend bool operator<= (const widening& lhs, const widening& rhs) { return !(rhs < lhs); }
+	friend bool operator>= (const widening& lhs, const widening& rhs) { return !(lhs < rhs); }
+};
+
+static_assert(sizeof(widening<int64_t>) <= 16, "widening<T> has to stay within 16 bytes");
+
+#ifdef __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE
+} // namespace __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE
+#endif
@@ -0,0 +1,540 @@
+#pragma once
+
+// Fast path of classdecl_modifier: finds the class definitions of one source file and the closing brace of
+// each body from tokens alone, without preprocessing, include paths or semantic analysis.
+//
+// The built-in lexer knows comments, string/character literals (escapes, encoding prefixes, raw strings,
+// digit separators) and preprocessor lines; the rest is identifiers and punctuation. A `class` token starts
+// a class head, which is a definition if it reaches `{` with nothing in it that can't be in a class head
+// (`;` `)` `=` `*` `>`... mean a forward declaration, a template parameter, an elaborated type specifier);
+// the body ends at the balancing `}`. Whatever can't be decided this way makes the whole file ambiguous, and
+// the caller falls back to the libclang parse:
+// - more than one identifier before the name (`class EXPORT_MACRO Name`, or `class X x{...}`)
+// - `>>` or a directive inside a class head, a function-like macro in it
+// - a #define whose body has `class` and `{` in it (a macro that produces classes)
+// - #if/#elif/#else alternatives with unbalanced braces, unbalanced braces in general
+// - unterminated literals and comments
+// Like the libclang visitor it only takes `class`, not `struct`/`union`.
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace classdecl_fastscan
+{
+	enum class TokenKind { Identifier, Punctuator, Literal, Directive };
+
+	struct Token
+	{
+		TokenKind	kind;
+		size_t		offset;
+		size_t		len;
+	};
+
+	struct ClassBody
+	{
+		size_t		keywordOffset;		// the `class` keyword
+		size_t		closeBraceOffset;	// the `}` closing the body
+		unsigned	keywordLine, keywordColumn, closeLine, closeColumn;			// 1-based, as libclang reports them
+	};
+
+	struct ScanResult
+	{
+		std::vector<ClassBody>	classes;		// in order of appearance (outer class before the nested ones)
+		bool		bAmbiguous = false;
+		std::string	ambiguity;				// why, and where
+	};
+
+	class Lexer
+	{
+	public:
+		Lexer(const char* text, size_t len) : m_text(text), m_len(len) {}
+
+		// false if the file can't be tokenized reliably (m_error tells why)
+		bool Tokenize(std::vector<Token>& tokens)
+		{
+			bool bLineStart = true;
+			while (m_pos < m_len)
+			{
+				const char c = m_text[m_pos];
+				if (c == '\n')
+				{
+					bLineStart = true;
+					++m_pos;
+				}
+				else if (IsSpace(c))
+					++m_pos;
+				else if (c == '\\' && m_pos + 1 < m_len && (m_text[m_pos + 1] == '\n' || m_text[m_pos + 1] == '\r'))
+					SkipLineSplice();
+				else if (c == '/' && Peek(1) == '/')
+					SkipLineComment();
+				else if (c == '/' && Peek(1) == '*')
+				{
+					if (!SkipBlockComment())
+						return Fail("unterminated comment");
+				}
+				else if (c == '#' && bLineStart)
+				{
+					const size_t start = m_pos;
+					if (!SkipDirective())
+						return false;
+					tokens.push_back({ TokenKind::Directive, start, m_pos - start });
+					bLineStart = true;
+					continue;
+				}
+				else if (IsIdentifierStart(c))
+				{
+					const size_t start = m_pos;
+					while (m_pos < m_len && IsIdentifierChar(m_text[m_pos]))
+						++m_pos;
+					if (m_pos < m_len && (m_text[m_pos] == '"' || m_text[m_pos] == '\''))
+					{
+						const std::string prefix(m_text + start, m_pos - start);
+						if (prefix == "R" || prefix == "LR" || prefix == "uR" || prefix == "UR" || prefix == "u8R")
+						{
+							if (m_text[m_pos] == '"' && !SkipRawString())
+								return false;
+							tokens.push_back({ TokenKind::Literal, start, m_pos - start });
+						}
+						else if (prefix == "L" || prefix == "u" || prefix == "U" || prefix == "u8")
+						{
+							if (!SkipQuoted(m_text[m_pos]))
+								return false;
+							tokens.push_back({ TokenKind::Literal, start, m_pos - start });
+						}
+						else
+							tokens.push_back({ TokenKind::Identifier, start, m_pos - start });
+					}
+					else
+						tokens.push_back({ TokenKind::Identifier, start, m_pos - start });
+				}
+				else if (IsDigit(c) || (c == '.' && IsDigit(Peek(1))))
+				{
+					const size_t start = m_pos;
+					SkipNumber();
+					tokens.push_back({ TokenKind::Literal, start, m_pos - start });
+				}
+				else if (c == '"' || c == '\'')
+				{
+					const size_t start = m_pos;
+					if (!SkipQuoted(c))
+						return false;
+					tokens.push_back({ TokenKind::Literal, start, m_pos - start });
+				}
+				else
+				{
+					tokens.push_back({ TokenKind::Punctuator, m_pos, PunctuatorLength() });
+					m_pos += tokens.back().len;
+				}
+				if (c != '\n' && c != '\\' && !IsSpace(c))
+					bLineStart = false;
+			}
+			return true;
+		}
+
+		const std::string& Error() const { return m_error; }
+		size_t ErrorOffset() const { return m_errorOffset; }
+
+	private:
+		const char*	m_text;
+		size_t		m_len;
+		size_t		m_pos = 0;
+		std::string	m_error;
+		size_t		m_errorOffset = 0;
+
+		static bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+		static bool IsIdentifierStart(char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == '$' || static_cast<unsigned char>(c) >= 0x80; }
+		static bool IsIdentifierChar(char c) { return IsIdentifierStart(c) || IsDigit(c); }
+		static bool IsSpace(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v'; }
+		char Peek(size_t ahead) const { return m_pos + ahead < m_len ? m_text[m_pos + ahead] : '\0'; }
+
+		// offset of the first occurrence of needle at or after from, m_len if there's none
+		size_t Find(size_t from, const char* needle, size_t needleLen) const
+		{
+			if (from >= m_len)
+				return m_len;
+			return static_cast<size_t>(std::search(m_text + from, m_text + m_len, needle, needle + needleLen) - m_text);
+		}
+
+		bool Fail(const char* error)
+		{
+			m_error = error;
+			m_errorOffset = m_pos;
+			return false;
+		}
+
+		void SkipLineSplice()
+		{
+			++m_pos;
+			if (m_text[m_pos] == '\r')
+				++m_pos;
+			if (m_pos < m_len && m_text[m_pos] == '\n')
+				++m_pos;
+		}
+
+		// up to the end of line, which a backslash right before it continues (even in a // comment)
+		void SkipLineComment()
+		{
+			while (m_pos < m_len && m_text[m_pos] != '\n')
+			{
+				if (m_text[m_pos] == '\\' && (Peek(1) == '\n' || (Peek(1) == '\r' && Peek(2) == '\n')))
+					SkipLineSplice();
+				else
+					++m_pos;
+			}
+		}
+
+		bool SkipBlockComment()
+		{
+			const size_t end = Find(m_pos + 2, "*/", 2);
+			if (end == m_len)
+				return false;
+			m_pos = end + 2;
+			return true;
+		}
+
+		// "..." or '...' with escapes; a newline before the closing quote is an error, as in the compiler
+		bool SkipQuoted(char quote)
+		{
+			const size_t start = m_pos++;
+			while (m_pos < m_len && m_text[m_pos] != quote)
+			{
+				if (m_text[m_pos] == '\\')
+					++m_pos;
+				else if (m_text[m_pos] == '\n')
+					break;
+				++m_pos;
+			}
+			if (m_pos >= m_len || m_text[m_pos] != quote)
+			{
+				m_pos = start;
+				return Fail(quote == '"' ? "unterminated string literal" : "unterminated character literal");
+			}
+			++m_pos;
+			return true;
+		}
+
+		// R"delim( ... )delim", nothing is special inside
+		bool SkipRawString()
+		{
+			const size_t start = m_pos++;
+			const size_t delimStart = m_pos;
+			while (m_pos < m_len && m_text[m_pos] != '(' && m_pos - delimStart <= 16)
+				++m_pos;
+			if (m_pos >= m_len || m_text[m_pos] != '(')
+			{
+				m_pos = start;
+				return Fail("malformed raw string literal");
+			}
+			const std::string closing = ")" + std::string(m_text + delimStart, m_pos - delimStart) + "\"";
+			const size_t end = Find(m_pos, closing.data(), closing.size());
+			if (end == m_len)
+			{
+				m_pos = start;
+				return Fail("unterminated raw string literal");
+			}
+			m_pos = end + closing.size();
+			return true;
+		}
+
+		// pp-number: digits, letters, '.', digit separators and exponent signs
+		void SkipNumber()
+		{
+			while (m_pos < m_len)
+			{
+				const char c = m_text[m_pos];
+				if ((c == 'e' || c == 'E' || c == 'p' || c == 'P') && (Peek(1) == '+' || Peek(1) == '-'))
+					m_pos += 2;
+				else if (c == '\'' && IsIdentifierChar(Peek(1)))
+					m_pos += 2;
+				else if (IsIdentifierChar(c) || c == '.')
+					++m_pos;
+				else
+					break;
+			}
+		}
+
+		// a whole directive, continuation lines included; comments and literals in it are skipped as such
+		// (a "/*" in an #include path is not a comment, but it's not worth telling those apart)
+		bool SkipDirective()
+		{
+			while (m_pos < m_len && m_text[m_pos] != '\n')
+			{
+				const char c = m_text[m_pos];
+				if (c == '\\' && (Peek(1) == '\n' || (Peek(1) == '\r' && Peek(2) == '\n')))
+					SkipLineSplice();
+				else if (c == '/' && Peek(1) == '/')
+					SkipLineComment();
+				else if (c == '/' && Peek(1) == '*')
+				{
+					if (!SkipBlockComment())
+						return Fail("unterminated comment");
+				}
+				else if ((c == '"' || c == '\'') && !(m_pos > 0 && IsIdentifierChar(m_text[m_pos - 1]) && c == '\''))
+				{
+					if (!SkipQuoted(c))
+						return false;
+				}
+				else
+					++m_pos;
+			}
+			return true;
+		}
+
+		size_t PunctuatorLength() const
+		{
+			static const char* const multi[] = { "...", "::", ">>", "->", "<<", "<=", ">=", "==", "!=", "&&", "||" };
+			for (const char* p : multi)
+			{
+				const size_t n = strlen(p);
+				if (m_pos + n <= m_len && memcmp(m_text + m_pos, p, n) == 0)
+					return n;
+			}
+			return 1;
+		}
+	};
+
+	class Scanner
+	{
+	public:
+		Scanner(const char* text, size_t len) : m_text(text), m_len(len) {}
+
+		ScanResult Scan()
+		{
+			ScanResult result;
+			Lexer lexer(m_text, m_len);
+			if (!lexer.Tokenize(m_tokens))
+				return Ambiguous(result, lexer.Error(), lexer.ErrorOffset());
+
+			struct OpenClass { ClassBody body; int depth; };
+			std::vector<OpenClass> openClasses;
+			struct Conditional { int depth; bool bAlternatives; };
+			std::vector<Conditional> conditionals;		// brace depth at each open #if, and whether it has #else/#elif
+			size_t pendingBrace = SIZE_MAX;			// the `{` of the class head just seen
+			size_t pendingKeyword = 0;
+			int depth = 0;
+			for (size_t i = 0; i < m_tokens.size(); ++i)
+			{
+				const Token& t = m_tokens[i];
+				if (t.kind == TokenKind::Directive)
+				{
+					const std::string name = DirectiveName(t);
+					// All the branches are lexed. A lone #if(def) may open or close braces (namespace NS { in
+					// #ifdef NS, closed the same way), both ways give the same nesting. Alternatives can't: each
+					// branch has to be balanced on its own.
+					if (name == "if" || name == "ifdef" || name == "ifndef")
+						conditionals.push_back({ depth, false });
+					else if (name == "elif" || name == "else" || name == "elifdef" || name == "elifndef" || name == "endif")
+					{
+						if (conditionals.empty())
+							return Ambiguous(result, "#" + name + " without #if", t.offset);
+						const bool bAlternative = name != "endif";
+						if ((bAlternative || conditionals.back().bAlternatives) && conditionals.back().depth != depth)
+							return Ambiguous(result, "braces not balanced in a preprocessor conditional branch", t.offset);
+						if (bAlternative)
+							conditionals.back().bAlternatives = true;
+						else
+							conditionals.pop_back();
+					}
+					else if (name == "define" && DefinesClass(t))
+						return Ambiguous(result, "macro definition producing a class", t.offset);
+				}
+				else if (t.kind == TokenKind::Identifier && Is(t, "class") && !(i > 0 && Is(m_tokens[i - 1], "enum")))
+				{
+					size_t brace;
+					std::string ambiguity;
+					if (!ClassHead(i, brace, ambiguity))
+						return Ambiguous(result, ambiguity, t.offset);
+					if (brace != SIZE_MAX)
+					{
+						pendingBrace = brace;
+						pendingKeyword = t.offset;
+					}
+				}
+				else if (Is(t, "{"))
+				{
+					if (i == pendingBrace)
+					{
+						openClasses.push_back({ ClassBody{ pendingKeyword, 0, 0, 0, 0, 0 }, depth });
+						pendingBrace = SIZE_MAX;
+					}
+					++depth;
+				}
+				else if (Is(t, "}"))
+				{
+					if (--depth < 0)
+						return Ambiguous(result, "unbalanced '}'", t.offset);
+					if (!openClasses.empty() && openClasses.back().depth == depth)
+					{
+						ClassBody body = openClasses.back().body;
+						body.closeBraceOffset = t.offset;
+						result.classes.push_back(body);
+						openClasses.pop_back();
+					}
+				}
+			}
+			if (depth != 0 || !openClasses.empty() || !conditionals.empty())
+				return Ambiguous(result, "unbalanced braces or preprocessor conditionals at end of file", m_len);
+
+			std::sort(result.classes.begin(), result.classes.end(), [](const ClassBody& a, const ClassBody& b) { return a.keywordOffset < b.keywordOffset; });
+			for (ClassBody& body : result.classes)
+			{
+				LineColumn(body.keywordOffset, body.keywordLine, body.keywordColumn);
+				LineColumn(body.closeBraceOffset, body.closeLine, body.closeColumn);
+			}
+			return result;
+		}
+
+	private:
+		const char*	m_text;
+		size_t		m_len;
+		std::vector<Token>	m_tokens;
+		std::vector<size_t>	m_lineStarts;
+
+		bool Is(const Token& t, const char* text) const
+		{
+			return t.kind != TokenKind::Literal && t.len == strlen(text) && memcmp(m_text + t.offset, text, t.len) == 0;
+		}
+
+		ScanResult& Ambiguous(ScanResult& result, const std::string& why, size_t offset)
+		{
+			unsigned line, column;
+			LineColumn(offset, line, column);
+			result.classes.clear();
+			result.bAmbiguous = true;
+			result.ambiguity = why + " at line " + std::to_string(line);
+			return result;
+		}
+
+		void LineColumn(size_t offset, unsigned& line, unsigned& column)
+		{
+			if (m_lineStarts.empty())
+			{
+				m_lineStarts.push_back(0);
+				for (const char* p = m_text; (p = static_cast<const char*>(memchr(p, '\n', m_len - (p - m_text)))) != nullptr; ++p)
+					m_lineStarts.push_back(static_cast<size_t>(p - m_text) + 1);
+			}
+			const auto next = std::upper_bound(m_lineStarts.begin(), m_lineStarts.end(), offset);
+			line = static_cast<unsigned>(next - m_lineStarts.begin());
+			column = static_cast<unsigned>(offset - *(next - 1)) + 1;
+		}
+
+		std::string DirectiveName(const Token& t) const
+		{
+			size_t p = t.offset + 1;
+			const size_t end = t.offset + t.len;
+			while (p < end && (m_text[p] == ' ' || m_text[p] == '\t'))
+				++p;
+			const size_t start = p;
+			while (p < end && ((m_text[p] >= 'a' && m_text[p] <= 'z') || m_text[p] == '_'))
+				++p;
+			return std::string(m_text + start, p - start);
+		}
+
+		// the body of a #define has the `class` keyword and a `{` after it
+		bool DefinesClass(const Token& t) const
+		{
+			std::vector<Token> body;
+			const char* directive = m_text + t.offset + 1;
+			Lexer lexer(directive, t.len - 1);
+			if (!lexer.Tokenize(body))
+				return true;
+			const auto keyword = std::find_if(body.begin(), body.end(), [&](const Token& b) {
+				return b.kind == TokenKind::Identifier && b.len == 5 && memcmp(directive + b.offset, "class", 5) == 0;
+			});
+			return std::any_of(keyword, body.end(), [&](const Token& b) {
+				return b.kind == TokenKind::Punctuator && directive[b.offset] == '{';
+			});
+		}
+
+		// Follows the head of the class starting at m_tokens[keyword] (the `class` token).
+		// brace: the index of the `{` opening the body, SIZE_MAX if it's not a definition.
+		// false: can't tell, ambiguity says why.
+		bool ClassHead(size_t keyword, size_t& brace, std::string& ambiguity) const
+		{
+			brace = SIZE_MAX;
+			int angles = 0, parens = 0, brackets = 0, names = 0;
+			bool bBaseClause = false;
+			for (size_t i = keyword + 1; i < m_tokens.size(); ++i)
+			{
+				const Token& t = m_tokens[i];
+				const Token& prev = m_tokens[i - 1];
+				if (t.kind == TokenKind::Directive)
+				{
+					ambiguity = "preprocessor directive inside a class head";
+					return false;
+				}
+				if (parens > 0 || brackets > 0)		// alignas(...), decltype(...), [[...]], template arguments in parentheses
+				{
+					parens += Is(t, "(") ? 1 : Is(t, ")") ? -1 : 0;
+					brackets += Is(t, "[") ? 1 : Is(t, "]") ? -1 : 0;
+					continue;
+				}
+				if (t.kind == TokenKind::Identifier)
+				{
+					if (!bBaseClause && angles == 0 && !Is(t, "final") && !Is(t, "alignas") && !Is(t, "__attribute__") && !Is(t, "__declspec"))
+						++names;
+				}
+				else if (t.kind == TokenKind::Literal)
+				{
+					if (angles == 0)
+						return true;					// not a definition
+				}
+				else if (Is(t, "("))
+				{
+					if (angles == 0 && !Is(prev, "alignas") && !Is(prev, "decltype") && !Is(prev, "__attribute__") && !Is(prev, "__declspec"))
+					{
+						ambiguity = "function-like macro or function declarator in a class head";
+						return false;
+					}
+					++parens;
+				}
+				else if (Is(t, "["))
+					++brackets;
+				else if (Is(t, "<"))
+					++angles;
+				else if (Is(t, ">"))
+				{
+					if (angles == 0)
+						return true;					// template <class T>
+					--angles;
+				}
+				else if (Is(t, ">>"))
+				{
+					if (angles == 0)
+						return true;
+					ambiguity = "'>>' in the template arguments of a class head";
+					return false;
+				}
+				else if (Is(t, ":"))
+					bBaseClause = bBaseClause || angles == 0;
+				else if (Is(t, "{"))
+				{
+					if (angles > 0)
+					{
+						ambiguity = "'{' in the template arguments of a class head";
+						return false;
+					}
+					if (names > 1)
+					{
+						ambiguity = "more than one identifier before the class name";
+						return false;
+					}
+					brace = i;
+					return true;
+				}
+				else if (Is(t, "::") || (Is(t, ",") && (bBaseClause || angles > 0)))
+					;
+				else if (angles == 0)
+					return true;						// ; ) = * & ... , and the rest: a declaration, not a definition
+			}
+			return true;
+		}
+	};
+
+	inline ScanResult ScanClassBodies(const char* text, size_t len)
+	{
+		return Scanner(text, len).Scan();
+	}
+}
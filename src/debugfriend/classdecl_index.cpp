@@ -0,0 +1,73 @@
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "classdecl_index.h"
+
+void printClass(const classdecl_index::ClassIndex& index, uint32_t i, bool bMembers)
+{
+	const classdecl_index::ClassInfo info = index.Class(i);
+	const classdecl_index::ClassRecord& record = *info.record;
+	std::cout << info.name << " at " << info.file << ":" << record.fromLine << ":" << record.fromColumn << ".." << record.toLine << ":" << record.toColumn
+		<< " [" << record.fromOffset << ".." << record.toOffset << "] " << info.usr << "\n";
+	if (bMembers)
+	{
+		for (uint32_t m = 0; m < record.memberCount; ++m)
+			std::cout << "\t" << index.Member(info, m) << "\n";
+	}
+}
+
+// answers questions from a class index written by classdecl_modifier --index
+int main(int argc, char* argv[])
+{
+	if (argc < 3 || (strcmp(argv[2], "--list") != 0 && argc < 4))
+	{
+		std::cout << "Usage: " << argv[0] << " <indexfile> --class <qualified name> | --usr <usr> | --file <path> | --list\n";
+		return -1;
+	}
+	classdecl_index::ClassIndex index;
+	std::string error;
+	if (!index.Open(argv[1], error))
+	{
+		std::cout << error << "\n";
+		return -2;
+	}
+	const std::string query = argv[2];
+	const auto start = std::chrono::steady_clock::now();
+	size_t found = 0;
+	if (query == "--class")
+	{
+		const auto range = index.FindByName(argv[3]);
+		for (uint32_t i = range.first; i < range.second; ++i, ++found)
+			printClass(index, i, true);
+	}
+	else if (query == "--usr")
+	{
+		const uint32_t i = index.FindByUsr(argv[3]);
+		if (i != classdecl_index::NOT_FOUND)
+		{
+			printClass(index, i, true);
+			++found;
+		}
+	}
+	else if (query == "--file")
+	{
+		const auto range = index.ClassesInFile(argv[3]);
+		for (const uint32_t* i = range.first; i != range.second; ++i, ++found)
+			printClass(index, *i, false);
+	}
+	else if (query == "--list")
+	{
+		for (uint32_t i = 0; i < index.ClassCount(); ++i, ++found)
+			printClass(index, i, false);
+	}
+	else
+	{
+		std::cout << "Unknown query " << query << "\n";
+		return -1;
+	}
+	const double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+	std::cout << found << " of " << index.ClassCount() << " classes in " << index.FileCount() << " files, " << us << " us\n";
+	return found > 0 ? 0 : 1;
+}
@@ -0,0 +1,293 @@
+#pragma once
+
+// The class definitions classdecl_modifier --index found, saved into a file that is memory-mapped as it is
+// when queried: where is class X defined, which class has this USR, which classes are in file Y, and what
+// their members are, by binary search, without reparsing anything.
+// Later runs on other files add to the same index (the classes of the file processed are replaced).
+//
+// Layout: IndexHeader, then the sections in this order (everything 4-aligned, native byte order):
+//		ClassRecord[classCount]		sorted by name, then file, then offset
+//		uint32_t[classCount]		class indices sorted by USR
+//		FileRecord[fileCount]		sorted by path
+//		uint32_t[classCount]		class indices sorted by file, then offset (FileRecord::firstClass points into it)
+//		StringRef[memberCount]		member names, each class' ones contiguous
+//		char[stringPoolSize]		all the strings, deduplicated, no terminators
+
+#include "debugfriend_common.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace classdecl_index {
+
+const char INDEX_MAGIC[8] = { 'D', 'F', 'C', 'L', 'S', 'I', 'D', 'X' };
+const uint32_t INDEX_VERSION = 1;
+const uint32_t NOT_FOUND = 0xffffffffu;
+
+struct IndexHeader {
+	char		magic[8];
+	uint32_t	version;
+	uint32_t	classCount;
+	uint32_t	fileCount;
+	uint32_t	memberCount;
+	uint32_t	stringPoolSize;
+	uint32_t	reserved;
+};
+
+struct StringRef {
+	uint32_t	offset;
+	uint32_t	length;
+};
+
+struct ClassRecord {
+	StringRef	name;				// qualified, without leading ::
+	StringRef	usr;
+	uint32_t	file;				// index of its FileRecord
+	uint32_t	fromLine, fromColumn, toLine, toColumn;
+	uint32_t	fromOffset, toOffset;		// [class keyword .. closing brace], as classdecl_modifier sees them
+	uint32_t	firstMember, memberCount;
+};
+
+struct FileRecord {
+	StringRef	path;
+	uint32_t	firstClass;
+	uint32_t	classCount;
+};
+
+// a class definition as the builder gets it
+struct ClassEntry {
+	std::string					name;
+	std::string					usr;
+	std::string					file;
+	uint32_t					fromLine = 0, fromColumn = 0, toLine = 0, toColumn = 0;
+	uint32_t					fromOffset = 0, toOffset = 0;
+	std::vector<std::string>	members;
+};
+
+// a class of an opened index; the string_views point into the mapping
+struct ClassInfo {
+	uint32_t			index;
+	std::string_view	name;
+	std::string_view	usr;
+	std::string_view	file;
+	const ClassRecord*	record;
+};
+
+class ClassIndex {
+public:
+	ClassIndex() = default;
+	ClassIndex(const ClassIndex&) = delete;
+	ClassIndex& operator= (const ClassIndex&) = delete;
+
+	bool Open(const std::string& path, std::string& error)
+	{
+		m_file = std::make_unique<MappedFile>(path);
+		if (!m_file->IsOpen() || m_file->Size() < sizeof(IndexHeader))
+		{
+			error = "unable to open " + path;
+			m_file.reset();
+			return false;
+		}
+		const char* data = m_file->Data();
+		m_header = reinterpret_cast<const IndexHeader*>(data);
+		const uint64_t expectedSize = sizeof(IndexHeader) + uint64_t(m_header->classCount) * (sizeof(ClassRecord) + 2 * sizeof(uint32_t)) +
+			uint64_t(m_header->fileCount) * sizeof(FileRecord) + uint64_t(m_header->memberCount) * sizeof(StringRef) + m_header->stringPoolSize;
+		if (std::memcmp(m_header->magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0 || m_header->version != INDEX_VERSION || expectedSize != m_file->Size())
+		{
+			error = path + " isn't a class index of this version";
+			m_file.reset();
+			return false;
+		}
+		const char* p = data + sizeof(IndexHeader);
+		m_classes = reinterpret_cast<const ClassRecord*>(p);
+		p += m_header->classCount * sizeof(ClassRecord);
+		m_byUsr = reinterpret_cast<const uint32_t*>(p);
+		p += m_header->classCount * sizeof(uint32_t);
+		m_files = reinterpret_cast<const FileRecord*>(p);
+		p += m_header->fileCount * sizeof(FileRecord);
+		m_byFile = reinterpret_cast<const uint32_t*>(p);
+		p += m_header->classCount * sizeof(uint32_t);
+		m_members = reinterpret_cast<const StringRef*>(p);
+		p += m_header->memberCount * sizeof(StringRef);
+		m_strings = p;
+		return true;
+	}
+
+	bool IsOpen() const { return m_file != nullptr; }
+	uint32_t ClassCount() const { return m_header ? m_header->classCount : 0; }
+	uint32_t FileCount() const { return m_header ? m_header->fileCount : 0; }
+
+	std::string_view Text(const StringRef& ref) const { return std::string_view(m_strings + ref.offset, ref.length); }
+
+	ClassInfo Class(uint32_t index) const
+	{
+		const ClassRecord& record = m_classes[index];
+		return ClassInfo{ index, Text(record.name), Text(record.usr), Text(m_files[record.file].path), &record };
+	}
+	std::string_view Member(const ClassInfo& info, uint32_t member) const { return Text(m_members[info.record->firstMember + member]); }
+	std::string_view FilePath(uint32_t file) const { return Text(m_files[file].path); }
+
+	// the classes with this qualified name (more than one if it's defined differently in different files): [first, last)
+	std::pair<uint32_t, uint32_t> FindByName(std::string_view name) const
+	{
+		const ClassRecord* begin = m_classes;
+		const ClassRecord* end = m_classes + ClassCount();
+		const ClassRecord* first = std::lower_bound(begin, end, name, [this](const ClassRecord& record, std::string_view key) { return Text(record.name) < key; });
+		const ClassRecord* last = std::upper_bound(first, end, name, [this](std::string_view key, const ClassRecord& record) { return key < Text(record.name); });
+		return { static_cast<uint32_t>(first - begin), static_cast<uint32_t>(last - begin) };
+	}
+
+	uint32_t FindByUsr(std::string_view usr) const
+	{
+		const uint32_t* end = m_byUsr + ClassCount();
+		const uint32_t* found = std::lower_bound(m_byUsr, end, usr, [this](uint32_t index, std::string_view key) { return Text(m_classes[index].usr) < key; });
+		return found != end && Text(m_classes[*found].usr) == usr ? *found : NOT_FOUND;
+	}
+
+	// the indices of the classes defined in the file, in the order of their offsets: [first, last)
+	std::pair<const uint32_t*, const uint32_t*> ClassesInFile(std::string_view path) const
+	{
+		const uint32_t file = FindFile(path);
+		if (file == NOT_FOUND)
+			return { m_byFile, m_byFile };
+		return { m_byFile + m_files[file].firstClass, m_byFile + m_files[file].firstClass + m_files[file].classCount };
+	}
+
+	uint32_t FindFile(std::string_view path) const
+	{
+		const FileRecord* end = m_files + FileCount();
+		const FileRecord* found = std::lower_bound(m_files, end, path, [this](const FileRecord& record, std::string_view key) { return Text(record.path) < key; });
+		return found != end && Text(found->path) == path ? static_cast<uint32_t>(found - m_files) : NOT_FOUND;
+	}
+
+private:
+	std::unique_ptr<MappedFile>	m_file;
+	const IndexHeader*	m_header = nullptr;
+	const ClassRecord*	m_classes = nullptr;
+	const uint32_t*		m_byUsr = nullptr;
+	const FileRecord*	m_files = nullptr;
+	const uint32_t*		m_byFile = nullptr;
+	const StringRef*	m_members = nullptr;
+	const char*			m_strings = nullptr;
+};
+
+class IndexBuilder {
+public:
+	void Add(ClassEntry entry) { m_entries.push_back(std::move(entry)); }
+
+	// the classes of an existing index, except those of skipFile (which is being processed again)
+	void Add(const ClassIndex& index, std::string_view skipFile = std::string_view())
+	{
+		for (uint32_t i = 0; i < index.ClassCount(); ++i)
+		{
+			const ClassInfo info = index.Class(i);
+			if (!skipFile.empty() && info.file == skipFile)
+				continue;
+			ClassEntry entry{ std::string(info.name), std::string(info.usr), std::string(info.file), info.record->fromLine, info.record->fromColumn,
+				info.record->toLine, info.record->toColumn, info.record->fromOffset, info.record->toOffset, {} };
+			for (uint32_t m = 0; m < info.record->memberCount; ++m)
+				entry.members.emplace_back(index.Member(info, m));
+			m_entries.push_back(std::move(entry));
+		}
+	}
+
+	size_t Size() const { return m_entries.size(); }
+
+	// written into a temporary file first, which then replaces path: whoever has the old one mapped keeps it
+	bool Write(const std::string& path)
+	{
+		std::sort(m_entries.begin(), m_entries.end(), [](const ClassEntry& lhs, const ClassEntry& rhs) {
+			return std::tie(lhs.name, lhs.file, lhs.fromOffset) < std::tie(rhs.name, rhs.file, rhs.fromOffset);
+		});
+		std::vector<std::string> paths;
+		for (const ClassEntry& entry : m_entries)
+			paths.push_back(entry.file);
+		std::sort(paths.begin(), paths.end());
+		paths.erase(std::unique(paths.begin(), paths.end()), paths.end());
+
+		std::vector<ClassRecord> classes;
+		std::vector<StringRef> members;
+		for (const ClassEntry& entry : m_entries)
+		{
+			const uint32_t file = static_cast<uint32_t>(std::lower_bound(paths.begin(), paths.end(), entry.file) - paths.begin());
+			classes.push_back(ClassRecord{ Intern(entry.name), Intern(entry.usr), file, entry.fromLine, entry.fromColumn, entry.toLine, entry.toColumn,
+				entry.fromOffset, entry.toOffset, static_cast<uint32_t>(members.size()), static_cast<uint32_t>(entry.members.size()) });
+			for (const std::string& member : entry.members)
+				members.push_back(Intern(member));
+		}
+		std::vector<uint32_t> byUsr(classes.size()), byFile(classes.size());
+		for (uint32_t i = 0; i < classes.size(); ++i)
+			byUsr[i] = byFile[i] = i;
+		std::stable_sort(byUsr.begin(), byUsr.end(), [this](uint32_t lhs, uint32_t rhs) { return m_entries[lhs].usr < m_entries[rhs].usr; });
+		std::sort(byFile.begin(), byFile.end(), [&classes](uint32_t lhs, uint32_t rhs) {
+			return std::tie(classes[lhs].file, classes[lhs].fromOffset, lhs) < std::tie(classes[rhs].file, classes[rhs].fromOffset, rhs);
+		});
+		std::vector<FileRecord> files;
+		for (uint32_t i = 0; i < paths.size(); ++i)
+			files.push_back(FileRecord{ Intern(paths[i]), 0, 0 });
+		for (uint32_t i = 0; i < byFile.size(); ++i)
+		{
+			FileRecord& file = files[classes[byFile[i]].file];
+			if (file.classCount++ == 0)
+				file.firstClass = i;
+		}
+		m_pool.resize((m_pool.size() + 3) & ~size_t(3));
+
+		const IndexHeader header{ {}, INDEX_VERSION, static_cast<uint32_t>(classes.size()), static_cast<uint32_t>(files.size()),
+			static_cast<uint32_t>(members.size()), static_cast<uint32_t>(m_pool.size()), 0 };
+		const std::string tempPath = path + ".tmp";
+		{
+			std::ofstream ofs(tempPath, std::ios::binary | std::ios::trunc | std::ios::out);
+			if (!ofs.good())
+				return false;
+			IndexHeader magicHeader = header;
+			std::memcpy(magicHeader.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+			WriteArray(ofs, &magicHeader, 1);
+			WriteArray(ofs, classes.data(), classes.size());
+			WriteArray(ofs, byUsr.data(), byUsr.size());
+			WriteArray(ofs, files.data(), files.size());
+			WriteArray(ofs, byFile.data(), byFile.size());
+			WriteArray(ofs, members.data(), members.size());
+			WriteArray(ofs, m_pool.data(), m_pool.size());
+			if (!ofs.good())
+				return false;
+		}
+		std::error_code ec;
+		std::filesystem::rename(tempPath, path, ec);
+		return !ec;
+	}
+
+private:
+	std::vector<ClassEntry>						m_entries;
+	std::string									m_pool;
+	std::unordered_map<std::string, StringRef>	m_interned;
+
+	StringRef Intern(const std::string& text)
+	{
+		auto found = m_interned.find(text);
+		if (found != m_interned.end())
+			return found->second;
+		const StringRef ref{ static_cast<uint32_t>(m_pool.size()), static_cast<uint32_t>(text.size()) };
+		m_pool += text;
+		m_interned.emplace(text, ref);
+		return ref;
+	}
+
+	template <typename T> static void WriteArray(std::ofstream& ofs, const T* items, size_t count)
+	{
+		ofs.write(reinterpret_cast<const char*>(items), static_cast<std::streamsize>(count * sizeof(T)));
+	}
+};
+
+}
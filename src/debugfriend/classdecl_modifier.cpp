@@ -6,8 +6,12 @@
 #include <memory>
 #include <cstring>
 #include <set>
+#include <vector>
 #include <algorithm>
 #include <iterator>
+#include "classdecl_fastscan.h"
+#include "classdecl_index.h"
+#include "debugfriend_common.h"
 #pragma comment(lib, "libclang.lib")
 #define VERBOSE_OUTPUT
 #define USE_RELEASE_ASSERTIONS
@@ -25,8 +29,9 @@
 #endif
 
 const bool VERBOSE = false;
-const char INSERT_THIS[] = "\r\nfriend DEBUGXRAY::DEBUGCLASS;\r\n";
 std::string searchForFile;
+std::string xrayFile;					// --xray: where to write the DEBUGCLASS field tables of searchForFile's classes
+std::string indexFile;					// --index: the class index to update with searchForFile's classes
 
 std::string unwrapCXString(const CXString& str)
 {
@@ -129,9 +134,202 @@ bool file_get_excerpt(const std::string& filename, int64_t startOff, int64_t end
 
 std::set<InterleaveBlock> interleaves;
 
+// a class definition found in searchForFile, [fromOffs..toOffs) being the class from its keyword to its closing brace
+void addClassDefinition(const std::string& filename, unsigned fromLine, unsigned fromCol, unsigned toLine, unsigned toCol, unsigned fromOffs, unsigned toOffs)
+{
+	InterleaveBlock ivb{ toOffs - 1, INSERT_THIS, sizeof(INSERT_THIS)-1 };
+	AUTOBUF classdecl;
+	bool result = file_get_excerpt(filename, fromOffs, toOffs, classdecl);
+	if (result)
+	{
+		if (strstr(classdecl.first.get(), INSERT_THIS) == nullptr)
+		{
+			std::cout << "Found class definition at " << filename << ":" << fromLine << ":" << fromCol << ".." << toLine << ":" << toCol << " [" << fromOffs << ".." << toOffs << "]";
+			VERBOSE(" insertion point: " << ivb.offset);
+			std::cout << "\n";
+			interleaves.insert(ivb);
+		}
+		else
+		{
+			std::cout << "Class definition already modified at " << filename << ":" << fromLine << ":" << fromCol << ".." << toLine << ":" << toCol << " [" << fromOffs << ".." << toOffs << "]\n";
+		}
+	}
+	else
+		std::cout << "\n[[error]]\n";
+}
+
+struct XrayField
+{
+	std::string	name;
+	std::string	type;
+	long long	offsetBits;				// as libclang tells, negative if it can't
+};
+
+struct XrayClass
+{
+	std::string				qualifiedName;		// with leading ::
+	std::vector<XrayField>	fields;
+};
+
+std::vector<XrayClass> xrayClasses;
+
+// the name the generated code can refer to the class with, empty if there's none: local classes, classes in
+// anonymous namespaces or anonymous classes, class templates (their fields depend on the arguments)
+std::string xrayQualifiedName(CXCursor c)
+{
+	std::string name;
+	for (CXCursor p = c; clang_getCursorKind(p) != CXCursor_TranslationUnit; p = clang_getCursorSemanticParent(p))
+	{
+		const CXCursorKind kind = clang_getCursorKind(p);
+		if (kind == CXCursor_LinkageSpec)
+			continue;
+		if (kind != CXCursor_ClassDecl && kind != CXCursor_StructDecl && kind != CXCursor_Namespace)
+			return "";
+		const std::string part = unwrapCXString(clang_getCursorSpelling(p));
+		if (part.empty())
+			return "";
+		name = "::" + part + name;
+	}
+	return name;
+}
+
+// non-static data members, except bit-fields (no address) and references (nothing to copy)
+CXChildVisitResult xrayFieldVisitor(CXCursor c, CXCursor parent, CXClientData client_data)
+{
+	if (clang_getCursorKind(c) != CXCursor_FieldDecl || clang_Cursor_isBitField(c))
+		return CXChildVisit_Continue;
+	const CXType type = clang_getCursorType(c);
+	if (type.kind == CXType_LValueReference || type.kind == CXType_RValueReference)
+		return CXChildVisit_Continue;
+	std::string name = unwrapCXString(clang_getCursorSpelling(c));
+	if (!name.empty())
+		static_cast<XrayClass*>(client_data)->fields.push_back({ name, unwrapCXString(clang_getTypeSpelling(type)), clang_Cursor_getOffsetOfField(c) });
+	return CXChildVisit_Continue;
+}
+
+void addXrayClass(CXCursor c)
+{
+	XrayClass xrayClass{ xrayQualifiedName(c), {} };
+	if (xrayClass.qualifiedName.empty())
+		return;
+	clang_visitChildren(c, &xrayFieldVisitor, &xrayClass);
+	xrayClasses.push_back(xrayClass);
+}
+
+std::string cStringLiteral(const std::string& text)
+{
+	std::string literal = "\"";
+	for (char ch : text)
+	{
+		if (ch == '"' || ch == '\\')
+			literal += '\\';
+		literal += ch;
+	}
+	return literal + "\"";
+}
+
+// the DEBUGCLASS::Fields<T> / DEBUGCLASS::Snapshot<T> specializations for debugxray_snapshot.h
+bool writeXrayHeader(const std::string& filename)
+{
+	std::ofstream ofs(filename.c_str(), std::ios::binary | std::ios::trunc | std::ios::out);
+	if (!ofs.good())
+		return false;
+	ofs << "// DEBUGXRAY field tables of the classes in " << searchForFile << ", generated by classdecl_modifier --xray\r\n";
+	ofs << "// include it after the class definitions, before the first snapshot of them\r\n";
+	ofs << "#pragma once\r\n#include \"debugxray_snapshot.h\"\r\n\r\nnamespace DEBUGXRAY {\r\n";
+	for (const XrayClass& xrayClass : xrayClasses)
+	{
+		const std::string& cls = xrayClass.qualifiedName;
+		ofs << "\r\ntemplate <> inline const ClassFields& DEBUGCLASS::Fields<" << cls << ">()\r\n{\r\n";
+		if (xrayClass.fields.empty())
+			ofs << "\tstatic const ClassFields table = { " << cStringLiteral(cls.substr(2)) << ", sizeof(" << cls << "), nullptr, 0, 0 };\r\n";
+		else
+		{
+			ofs << "\tstatic const FieldInfo fields[] = {\r\n";
+			for (const XrayField& field : xrayClass.fields)
+			{
+				ofs << "\t\tDEBUGXRAY_FIELD(" << cls << ", " << field.name << ", " << cStringLiteral(field.type) << ", ";
+				if (field.offsetBits >= 0)
+					ofs << field.offsetBits / 8;
+				else
+					ofs << "DEBUGXRAY_UNKNOWN_OFFSET";
+				ofs << "),\r\n";
+			}
+			ofs << "\t};\r\n\tstatic const ClassFields table = MakeClassFields(" << cStringLiteral(cls.substr(2)) << ", sizeof(" << cls << "), fields);\r\n";
+		}
+		ofs << "\treturn table;\r\n}\r\n";
+		ofs << "template <> inline void DEBUGCLASS::Snapshot<" << cls << ">(const " << cls << "& object, char* out)\r\n{\r\n";
+		for (const XrayField& field : xrayClass.fields)
+			ofs << "\tout = CaptureField(out, object." << field.name << ");\r\n";
+		ofs << "\t(void)object;\r\n\t(void)out;\r\n}\r\n";
+	}
+	ofs << "\r\n}\r\n";
+	return ofs.good();
+}
+
+classdecl_index::IndexBuilder indexBuilder;
+
+// the name of any class, for the index: templates and local classes included, anonymous parts as (anonymous)
+std::string indexQualifiedName(CXCursor c)
+{
+	std::string name;
+	for (CXCursor p = c; clang_getCursorKind(p) != CXCursor_TranslationUnit && !clang_Cursor_isNull(p); p = clang_getCursorSemanticParent(p))
+	{
+		if (clang_getCursorKind(p) == CXCursor_LinkageSpec)
+			continue;
+		std::string part = unwrapCXString(clang_getCursorSpelling(p));
+		if (part.empty())
+			part = "(anonymous)";
+		name = name.empty() ? part : part + "::" + name;
+	}
+	return name;
+}
+
+// data members and member functions, static ones too
+CXChildVisitResult indexMemberVisitor(CXCursor c, CXCursor parent, CXClientData client_data)
+{
+	switch (clang_getCursorKind(c))
+	{
+	case CXCursor_FieldDecl:
+	case CXCursor_VarDecl:
+	case CXCursor_CXXMethod:
+	case CXCursor_Constructor:
+	case CXCursor_Destructor:
+	case CXCursor_ConversionFunction:
+	case CXCursor_FunctionTemplate:
+		static_cast<classdecl_index::ClassEntry*>(client_data)->members.push_back(unwrapCXString(clang_getCursorSpelling(c)));
+		break;
+	default:
+		break;
+	}
+	return CXChildVisit_Continue;
+}
+
+void addIndexClass(CXCursor c, const std::string& filename, unsigned fromLine, unsigned fromCol, unsigned toLine, unsigned toCol, unsigned fromOffs, unsigned toOffs)
+{
+	classdecl_index::ClassEntry entry{ indexQualifiedName(c), unwrapCXString(clang_getCursorUSR(c)), filename, fromLine, fromCol, toLine, toCol, fromOffs, toOffs, {} };
+	clang_visitChildren(c, &indexMemberVisitor, &entry);
+	indexBuilder.Add(std::move(entry));
+}
+
+// the classes of the other files already in the index, searchForFile's ones from this run
+bool writeIndex(const std::string& filename)
+{
+	classdecl_index::ClassIndex previous;
+	std::string error;
+	if (previous.Open(filename, error))
+		indexBuilder.Add(previous, searchForFile);
+	else if (std::ifstream(filename).good())
+		std::cout << error << ", replacing it\n";
+	return indexBuilder.Write(filename);
+}
+
 CXChildVisitResult visitor(CXCursor c, CXCursor parent, CXClientData client_data)
 {
-	if (clang_getCursorKind(c) != 4) return CXChildVisit_Recurse;					// only interested in class declarations
+	const CXCursorKind kind = clang_getCursorKind(c);
+	const bool bClassTemplate = (kind == CXCursor_ClassTemplate || kind == CXCursor_ClassTemplatePartialSpecialization) && clang_getTemplateCursorKind(c) == CXCursor_ClassDecl;
+	if (kind != CXCursor_ClassDecl && !bClassTemplate) return CXChildVisit_Recurse;		// only interested in class declarations
+	if (!clang_isCursorDefinition(c)) return CXChildVisit_Recurse;
 	auto location = clang_getCursorLocation(c);
 	auto extent = clang_getCursorExtent(c);
 	auto loc_from = clang_getRangeStart(extent);
@@ -153,25 +351,11 @@ CXChildVisitResult visitor(CXCursor c, CXCursor parent, CXClientData client_data
 	auto filename = unwrapCXString(clang_getFileName(cxfile));
 	if (filename == searchForFile)
 	{
-		InterleaveBlock ivb{ toOffs - 1, INSERT_THIS, sizeof(INSERT_THIS)-1 };
-		AUTOBUF classdecl;
-		bool result = file_get_excerpt(filename, fromOffs, toOffs, classdecl);
-		if (result)
-		{
-			if (strstr(classdecl.first.get(), INSERT_THIS) == nullptr)
-			{
-				std::cout << "Found class definition at " << filename << ":" << fromLine << ":" << fromCol << ".." << toLine << ":" << toCol << " [" << fromOffs << ".." << toOffs << "]";
-				VERBOSE(" insertion point: " << ivb.offset);
-				std::cout << "\n";
-				interleaves.insert(ivb);
-			}
-			else
-			{
-				std::cout << "Class definition already modified at " << filename << ":" << fromLine << ":" << fromCol << ".." << toLine << ":" << toCol << " [" << fromOffs << ".." << toOffs << "]\n";
-			}
-		}
-		else
-			std::cout << "\n[[error]]\n";
+		addClassDefinition(filename, fromLine, fromCol, toLine, toCol, fromOffs, toOffs);
+		if (!xrayFile.empty())
+			addXrayClass(c);
+		if (!indexFile.empty())
+			addIndexClass(c, filename, fromLine, fromCol, toLine, toCol, fromOffs, toOffs);
 	}
 
 	return CXChildVisit_Recurse;
@@ -186,26 +370,75 @@ bool file_put_contents(const std::string& filename, const char* bufferptr, size_
 	return ofs.good();
 }
 
-int main(int argc, char* argv[])
+// the class bodies from tokens only (classdecl_fastscan.h), no compile flags needed;
+// false if the file is ambiguous that way, then it's up to libclang
+bool fastScan(const AUTOBUF& contents)
 {
-	if (argc < 3)
+	const classdecl_fastscan::ScanResult scan = classdecl_fastscan::ScanClassBodies(contents.first.get(), contents.second);
+	if (scan.bAmbiguous)
 	{
-		std::cout << "Usage: " << argv[0] << " <inputfile> <outputfile>\n";
-		exit(-1);
+		std::cout << "Fast scan not conclusive (" << scan.ambiguity << "), falling back to full parse\n";
+		return false;
+	}
+	for (const classdecl_fastscan::ClassBody& body : scan.classes)
+	{
+		addClassDefinition(searchForFile, body.keywordLine, body.keywordColumn, body.closeLine, body.closeColumn + 1,
+			static_cast<unsigned>(body.keywordOffset), static_cast<unsigned>(body.closeBraceOffset + 1));
 	}
-	searchForFile = argv[1];
-	std::string saveFile = argv[2];
+	return true;
+}
+
+bool fullParse()
+{
 	CXIndex index = clang_createIndex(0, 0);
 	CXTranslationUnit unit = clang_parseTranslationUnit(index, searchForFile.c_str(), nullptr, 0, nullptr, 0, CXTranslationUnit_None);
-	CXCursor cursor = clang_getTranslationUnitCursor(unit);
-	clang_visitChildren(cursor, &visitor, nullptr);
 	if (!unit)
 	{
-		std::cout << "Unable to parse translation unit." << std::endl;
-		exit(-2);
+		clang_disposeIndex(index);
+		return false;
 	}
+	CXCursor cursor = clang_getTranslationUnitCursor(unit);
+	clang_visitChildren(cursor, &visitor, nullptr);
 	clang_disposeTranslationUnit(unit);
 	clang_disposeIndex(index);
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	bool bFast = false;
+	int arg = 1;
+	for (; arg < argc && argv[arg][0] == '-' && argv[arg][1] == '-'; ++arg)
+	{
+		if (strcmp(argv[arg], "--fast") == 0)
+			bFast = true;
+		else if (strcmp(argv[arg], "--xray") == 0 && arg + 1 < argc)
+			xrayFile = argv[++arg];
+		else if (strcmp(argv[arg], "--index") == 0 && arg + 1 < argc)
+			indexFile = argv[++arg];
+		else
+			break;
+	}
+	if (argc - arg < 2)
+	{
+		std::cout << "Usage: " << argv[0] << " [--fast] [--xray <headerfile>] [--index <indexfile>] <inputfile> <outputfile>\n";
+		std::cout << "  --fast: find class bodies by tokens only, full parse only if that's ambiguous\n";
+		std::cout << "  --xray: write the DEBUGXRAY field tables of the classes into headerfile (needs the full parse)\n";
+		std::cout << "  --index: add the classes to indexfile (classdecl_index.h), replacing the ones of inputfile (needs the full parse)\n";
+		exit(-1);
+	}
+	searchForFile = argv[arg];
+	std::string saveFile = argv[arg + 1];
+	if (bFast && !xrayFile.empty())
+	{
+		std::cout << "--xray needs the field types and offsets, --fast ignored\n";
+		bFast = false;
+	}
+	if (bFast && !indexFile.empty())
+	{
+		std::cout << "--index needs the class names and members, --fast ignored\n";
+		bFast = false;
+	}
 	AUTOBUF contents;
 	bool result = file_get_excerpt(searchForFile, 0, -1, contents, false);
 	if (!result) 
@@ -213,6 +446,27 @@ int main(int argc, char* argv[])
 		std::cout << "File read error\n";
 		exit(-3);
 	}
+	if (!(bFast && fastScan(contents)) && !fullParse())
+	{
+		std::cout << "Unable to parse translation unit." << std::endl;
+		exit(-2);
+	}
+
+	if (!xrayFile.empty())
+	{
+		if (writeXrayHeader(xrayFile))
+			std::cout << "Field tables of " << xrayClasses.size() << " classes saved to " << xrayFile << "\n";
+		else
+			std::cout << "Error saving " << xrayFile << "\n";
+	}
+
+	if (!indexFile.empty())
+	{
+		if (writeIndex(indexFile))
+			std::cout << "Class index saved to " << indexFile << "\n";
+		else
+			std::cout << "Error saving " << indexFile << "\n";
+	}
 
 	AUTOBUF mixed = InsertInterleaves(contents.first.get(), contents.second, interleaves);
 	if (file_put_contents(saveFile, mixed.first.get(), mixed.second))
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// What classdecl_modifier injects into each class body (right before its closing brace), and what
+// debugfriend_strip removes; they have to agree byte for byte
+const char INSERT_THIS[] = "\r\nfriend DEBUGXRAY::DEBUGCLASS;\r\n";
+
+// the declaration itself, without the line breaks around it: any of these left in a file is reported by
+// debugfriend_strip --verify, injected or not
+const char FRIEND_DECLARATION[] = "friend DEBUGXRAY::DEBUGCLASS;";
+
+// the whole file, read-only; memory-mapped where possible (bSequential: read once from the beginning to the end)
+class MappedFile {
+public:
+	explicit MappedFile(const std::string& path, bool bSequential = false)
+	{
+#if !defined(_WIN32)
+		const int fd = open(path.c_str(), O_RDONLY);
+		if (fd < 0)
+			return;
+		struct stat info;
+		if (fstat(fd, &info) == 0)
+		{
+			m_size = size_t(info.st_size);
+			if (m_size == 0)
+				m_bOpen = true;
+			else
+			{
+				void* memory = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+				if (memory != MAP_FAILED)
+				{
+					m_data = static_cast<const char*>(memory);
+					m_bOpen = true;
+					if (bSequential)
+						madvise(memory, m_size, MADV_SEQUENTIAL);
+				}
+			}
+		}
+		close(fd);
+#else
+		std::ifstream ifs(path, std::ios::binary);
+		if (!ifs.good())
+			return;
+		m_copy.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+		m_data = m_copy.data();
+		m_size = m_copy.size();
+		m_bOpen = true;
+		(void)bSequential;
+#endif
+	}
+	~MappedFile()
+	{
+#if !defined(_WIN32)
+		if (m_data)
+			munmap(const_cast<char*>(m_data), m_size);
+#endif
+	}
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator= (const MappedFile&) = delete;
+
+	bool IsOpen() const { return m_bOpen; }
+	const char* Data() const { return m_data; }
+	size_t Size() const { return m_size; }
+
+private:
+	const char*	m_data = nullptr;
+	size_t		m_size = 0;
+	bool		m_bOpen = false;
+#if defined(_WIN32)
+	std::vector<char>	m_copy;
+#endif
+};
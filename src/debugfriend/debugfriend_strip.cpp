@@ -0,0 +1,58 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "debugfriend_strip.h"
+
+// removes the friend declarations classdecl_modifier injected from the files given and from the source files
+// under the directories given, then reports whatever friend declarations are left (exit code 1 if any);
+// --verify only reports, it doesn't change anything
+int main(int argc, char* argv[])
+{
+	bool bStrip = true;
+	unsigned jobs = 0;
+	int arg = 1;
+	for (; arg < argc && argv[arg][0] == '-' && argv[arg][1] == '-'; ++arg)
+	{
+		if (strcmp(argv[arg], "--verify") == 0)
+			bStrip = false;
+		else if (strcmp(argv[arg], "--jobs") == 0 && arg + 1 < argc)
+			jobs = static_cast<unsigned>(std::strtoul(argv[++arg], nullptr, 10));
+		else
+			break;
+	}
+	if (arg >= argc)
+	{
+		std::cout << "Usage: " << argv[0] << " [--verify] [--jobs <n>] <file or directory>...\n";
+		std::cout << "  --verify: only report the friend declarations, don't strip them\n";
+		std::cout << "  --jobs: number of threads, all cores by default\n";
+		return -1;
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	const std::vector<std::string> files = debugfriend_strip::CollectSourceFiles(std::vector<std::string>(argv + arg, argv + argc));
+	const std::vector<debugfriend_strip::FileResult> results = debugfriend_strip::StripFiles(files, bStrip, jobs);
+	size_t stripped = 0, rewritten = 0, remaining = 0, errors = 0;
+	for (const debugfriend_strip::FileResult& result : results)
+	{
+		if (!result.error.empty())
+		{
+			std::cout << result.path << ": " << result.error << "\n";
+			++errors;
+		}
+		if (result.bRewritten)
+			std::cout << result.path << ": " << result.stripped << " removed\n";
+		for (size_t line : result.remainingLines)
+			std::cout << result.path << ":" << line << ": " << FRIEND_DECLARATION << "\n";
+		stripped += result.stripped;
+		rewritten += result.bRewritten ? 1 : 0;
+		remaining += result.remainingLines.size();
+	}
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::cout << files.size() << " files, " << stripped << (bStrip ? " injected declarations removed from " : " injected declarations found, ")
+		<< (bStrip ? std::to_string(rewritten) + " files, " : std::string()) << remaining << " friend declarations left, " << seconds << " s\n";
+	return errors > 0 ? -2 : remaining > 0 ? 1 : 0;
+}
@@ -0,0 +1,255 @@
+#pragma once
+
+// Removing what classdecl_modifier injected (INSERT_THIS), without libclang: the files are memory-mapped,
+// searched for the friend declaration (SSE2 first/last byte filter, memcmp on the candidates), and only the
+// files that have any are rewritten, streaming the bytes between the injected sequences into a temporary
+// file that replaces the original. Files are processed on all cores.
+// An injected sequence is INSERT_THIS byte for byte right before a closing brace, where classdecl_modifier inserts.
+// In a file whose line endings were converted to "\n" since (no "\r\n" left in it), the converted form counts too,
+// also only before a closing brace. Removing exactly those bytes gives back the file as it was
+// before the injection. Any other friend declaration, including one written by hand on a line of its own,
+// is left alone and reported as remaining.
+
+#include "debugfriend_common.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DEBUGFRIEND_STRIP_SSE2
+#endif
+
+namespace debugfriend_strip {
+
+inline unsigned LowestSetBit(unsigned mask)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return static_cast<unsigned>(index);
+#else
+	return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+
+// the first occurrence of needle in [begin, end), or nullptr
+inline const char* FindBytes(const char* begin, const char* end, const char* needle, size_t needleLen)
+{
+	if (needleLen == 0)
+		return begin;
+	const char* p = begin;
+#ifdef DEBUGFRIEND_STRIP_SSE2
+	// 16 candidate positions at a time: those where both the first and the last byte of the needle match
+	if (needleLen >= 2)
+	{
+		const __m128i first = _mm_set1_epi8(needle[0]);
+		const __m128i last = _mm_set1_epi8(needle[needleLen - 1]);
+		for (; size_t(end - p) >= needleLen - 1 + 16; p += 16)
+		{
+			const __m128i blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+			const __m128i blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + needleLen - 1));
+			unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(first, blockFirst), _mm_cmpeq_epi8(last, blockLast))));
+			for (; mask != 0; mask &= mask - 1)
+			{
+				const char* candidate = p + LowestSetBit(mask);
+				if (std::memcmp(candidate + 1, needle + 1, needleLen - 2) == 0)
+					return candidate;
+			}
+		}
+	}
+#endif
+	for (; size_t(end - p) >= needleLen; ++p)
+	{
+		if (*p == needle[0] && std::memcmp(p, needle, needleLen) == 0)
+			return p;
+	}
+	return nullptr;
+}
+
+// a friend declaration in a file: offset/length of the bytes to remove if injected, of the declaration if not
+struct Occurrence {
+	size_t	offset;
+	size_t	length;
+	size_t	declaration;		// offset of the declaration itself
+	bool	bInjected;
+};
+
+inline std::vector<Occurrence> FindOccurrences(const char* data, size_t len)
+{
+	std::vector<Occurrence> occurrences;
+	const size_t declLen = sizeof(FRIEND_DECLARATION) - 1;
+	const char* const end = data + len;
+	int converted = -1;										// whether the file has no "\r\n", looked at on the first "\n" candidate
+	for (const char* p = data; (p = FindBytes(p, end, FRIEND_DECLARATION, declLen)) != nullptr; p += declLen)
+	{
+		const size_t offset = size_t(p - data);
+		const size_t after = offset + declLen;
+		bool bConvertedForm = offset >= 1 && p[-1] == '\n' && after + 2 <= len && p[declLen] == '\n' && p[declLen + 1] == '}';
+		if (bConvertedForm && converted < 0)
+			converted = FindBytes(data, end, "\r\n", 2) == nullptr ? 1 : 0;
+		bConvertedForm = bConvertedForm && converted == 1;
+		if (offset >= 2 && std::memcmp(p - 2, "\r\n", 2) == 0 && after + 3 <= len && std::memcmp(p + declLen, "\r\n", 2) == 0 && p[declLen + 2] == '}')
+			occurrences.push_back(Occurrence{ offset - 2, declLen + 4, offset, true });
+		else if (bConvertedForm)
+			occurrences.push_back(Occurrence{ offset - 1, declLen + 2, offset, true });
+		else
+			occurrences.push_back(Occurrence{ offset, declLen, offset, false });
+	}
+	return occurrences;
+}
+
+// 1-based line of offset, for the reports only
+inline size_t LineOf(const char* data, size_t offset)
+{
+	return size_t(std::count(data, data + offset, '\n')) + 1;
+}
+
+// calls write(ptr, len) with the bytes of the file without the injected sequences, returns how many were left out
+template <typename Write> size_t StripInjected(const char* data, size_t len, const std::vector<Occurrence>& occurrences, Write&& write)
+{
+	size_t from = 0, stripped = 0;
+	for (const Occurrence& occurrence : occurrences)
+	{
+		// injected sequences end at a brace, so they can't overlap; this only guards the stream position
+		if (!occurrence.bInjected || occurrence.offset < from)
+			continue;
+		write(data + from, occurrence.offset - from);
+		from = occurrence.offset + occurrence.length;
+		++stripped;
+	}
+	write(data + from, len - from);
+	return stripped;
+}
+
+struct FileResult {
+	std::string			path;
+	size_t				stripped = 0;			// injected sequences removed (or found, when only verifying)
+	std::vector<size_t>	remainingLines;			// friend declarations left in the file
+	bool				bRewritten = false;
+	std::string			error;
+};
+
+// bStrip false: only counts and reports, writes nothing
+inline FileResult StripFile(const std::string& path, bool bStrip)
+{
+	FileResult result;
+	result.path = path;
+	MappedFile file(path, true);
+	if (!file.IsOpen())
+	{
+		result.error = "unable to open";
+		return result;
+	}
+	const std::vector<Occurrence> occurrences = FindOccurrences(file.Data(), file.Size());
+	const size_t injected = size_t(std::count_if(occurrences.begin(), occurrences.end(), [](const Occurrence& occurrence) { return occurrence.bInjected; }));
+	if (!bStrip || injected == 0)
+	{
+		result.stripped = injected;
+		for (const Occurrence& occurrence : occurrences)
+			result.remainingLines.push_back(LineOf(file.Data(), occurrence.declaration));
+		return result;
+	}
+
+	const std::string tempPath = path + ".debugfriend_strip.tmp";
+	std::FILE* out = std::fopen(tempPath.c_str(), "wb");
+	if (!out)
+	{
+		result.error = "unable to create " + tempPath;
+		return result;
+	}
+	std::vector<char> buffer(1 << 20);
+	std::setvbuf(out, buffer.data(), _IOFBF, buffer.size());
+	bool bWritten = true;
+	result.stripped = StripInjected(file.Data(), file.Size(), occurrences, [out, &bWritten](const char* bytes, size_t len) {
+		bWritten = bWritten && std::fwrite(bytes, 1, len, out) == len;
+	});
+	bWritten = std::fclose(out) == 0 && bWritten;
+
+	// what's left: the plain declarations, and the second of two adjacent injected ones; lines of the stripped file
+	size_t removedLines = 0, from = 0;
+	for (const Occurrence& occurrence : occurrences)
+	{
+		if (occurrence.bInjected && occurrence.offset >= from)
+		{
+			removedLines += size_t(std::count(file.Data() + occurrence.offset, file.Data() + occurrence.offset + occurrence.length, '\n'));
+			from = occurrence.offset + occurrence.length;
+		}
+		else
+			result.remainingLines.push_back(LineOf(file.Data(), occurrence.declaration) - removedLines);
+	}
+
+	std::error_code ec;
+	if (bWritten)
+	{
+		std::filesystem::permissions(tempPath, std::filesystem::status(path, ec).permissions(), ec);
+		std::filesystem::rename(tempPath, path, ec);
+	}
+	if (!bWritten || ec)
+	{
+		result.error = "unable to write " + tempPath;
+		std::filesystem::remove(tempPath, ec);
+		return result;
+	}
+	result.bRewritten = true;
+	return result;
+}
+
+inline bool IsSourceFile(const std::filesystem::path& path)
+{
+	static const char* const extensions[] = { ".h", ".hh", ".hpp", ".hxx", ".inl", ".ipp", ".c", ".cc", ".cpp", ".cxx" };
+	const std::string extension = path.extension().string();
+	return std::any_of(std::begin(extensions), std::end(extensions), [&extension](const char* ext) { return extension == ext; });
+}
+
+// the files given, and the source files under the directories given
+inline std::vector<std::string> CollectSourceFiles(const std::vector<std::string>& roots)
+{
+	std::vector<std::string> files;
+	for (const std::string& root : roots)
+	{
+		std::error_code ec;
+		if (!std::filesystem::is_directory(root, ec))
+		{
+			files.push_back(root);
+			continue;
+		}
+		for (auto it = std::filesystem::recursive_directory_iterator(root, std::filesystem::directory_options::skip_permission_denied, ec);
+			it != std::filesystem::recursive_directory_iterator(); it.increment(ec))
+		{
+			if (it->is_regular_file(ec) && IsSourceFile(it->path()))
+				files.push_back(it->path().string());
+		}
+	}
+	return files;
+}
+
+// StripFile for each file, on jobs threads (0: as many as cores); results in the order of files
+inline std::vector<FileResult> StripFiles(const std::vector<std::string>& files, bool bStrip, unsigned jobs = 0)
+{
+	std::vector<FileResult> results(files.size());
+	if (jobs == 0)
+		jobs = std::max(1u, std::thread::hardware_concurrency());
+	jobs = static_cast<unsigned>(std::min<size_t>(jobs, std::max<size_t>(files.size(), 1)));
+	std::atomic<size_t> next{ 0 };
+	auto work = [&]() {
+		for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < files.size(); )
+			results[i] = StripFile(files[i], bStrip);
+	};
+	std::vector<std::thread> workers;
+	for (unsigned i = 1; i < jobs; ++i)
+		workers.emplace_back(work);
+	work();
+	for (auto& worker : workers)
+		worker.join();
+	return results;
+}
+
+}
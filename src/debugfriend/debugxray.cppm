@@ -0,0 +1,17 @@
+// lsct.debugxray -- debugxray.h as a C++20 named module: import lsct.debugxray; instead of #include "debugxray.h".
+// The classes still befriend DEBUGXRAY::DEBUGCLASS, and the generated field tables specialize its members, in
+// the importing TUs. Build it and include lsct_config.h like the other lsct modules.
+
+module;
+
+#include "../lsct_config.h"
+
+#include <cstddef>
+#include <cstdint>
+
+export module lsct.debugxray;
+
+export
+{
+#include "debugxray.h"
+}
@@ -1,8 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
 namespace DEBUGXRAY {
 
+// one non-static data member, as classdecl_modifier --xray found it (name, type spelling, offset from libclang),
+// size and whether snapshots capture it (trivially copyable) as the compiler sees it
+struct FieldInfo {
+	const char*	name;
+	const char*	type;
+	uint32_t	offset;
+	uint32_t	size;
+	bool		bCaptured;
+};
+
+struct ClassFields {
+	const char*			name;
+	uint32_t			size;
+	const FieldInfo*	fields;
+	uint32_t			count;
+	uint32_t			capturedSize;		// the sum of the captured fields' sizes: the payload of a snapshot
+};
+
+template <size_t N> inline ClassFields MakeClassFields(const char* name, size_t size, const FieldInfo (&fields)[N])
+{
+	uint32_t capturedSize = 0;
+	for (const FieldInfo& field : fields)
+		capturedSize += field.bCaptured ? field.size : 0;
+	return ClassFields{ name, static_cast<uint32_t>(size), fields, static_cast<uint32_t>(N), capturedSize };
+}
+
 class DEBUGCLASS {
 public:
+	// Specialized per class by classdecl_modifier --xray (in the generated header, which has to be included after
+	// the class definitions and before the first snapshot of them): the field table, and the capture of the
+	// trivially copyable fields into out, in table order (debugxray_snapshot.h)
+	template <typename T> static const ClassFields& Fields();
+	template <typename T> static void Snapshot(const T& object, char* out);
+
 	// here you can add methods that have access to all private fields of all seeable classes
 };
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,31 @@
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "debugxray_decode.h"
+
+// prints the snapshots of a DEBUGXRAY::SnapshotRing::Dump() file, oldest first
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		std::cout << "Usage: " << argv[0] << " <dumpfile>\n";
+		return -1;
+	}
+	std::ifstream ifs(argv[1], std::ios::binary | std::ios::in);
+	if (!ifs.good())
+	{
+		std::cout << "Unable to open " << argv[1] << "\n";
+		return -2;
+	}
+	DEBUGXRAY::SnapshotDump dump;
+	std::string error;
+	if (!DEBUGXRAY::ReadSnapshotDump(ifs, dump, error))
+	{
+		std::cout << argv[1] << ": " << error << "\n";
+		return -3;
+	}
+	std::cout << dump.classes.size() << " classes, " << dump.head << " bytes written into a ring of " << dump.capacity << "\n";
+	DEBUGXRAY::PrintSnapshotRecords(dump, std::cout);
+	return 0;
+}
@@ -0,0 +1,244 @@
+#pragma once
+
+// Offline decoding of SnapshotRing::Dump() files (debugxray_snapshot.h): the complete records still in the
+// ring, oldest first, each field formatted by its type spelling (integers, bool, floating point, pointers;
+// anything else as hex bytes).
+
+#include "debugxray_snapshot.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace DEBUGXRAY {
+
+struct DecodedField {
+	std::string	name;
+	std::string	type;
+	uint32_t	offset;
+	uint32_t	size;
+	bool		bCaptured;
+};
+
+struct DecodedClass {
+	std::string					name;
+	uint32_t					size;
+	std::vector<DecodedField>	fields;
+	uint32_t					capturedSize = 0;
+};
+
+struct SnapshotDump {
+	uint64_t					capacity = 0;
+	uint64_t					head = 0;
+	double						ticksPerSecond = 0;
+	std::vector<DecodedClass>	classes;
+	std::vector<char>			buffer;
+};
+
+namespace detail {
+	template <typename P> inline bool ReadPod(std::istream& in, P& value) { return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(P))); }
+
+	inline bool ReadString(std::istream& in, std::string& text)
+	{
+		uint32_t len;
+		if (!ReadPod(in, len) || len > (1u << 20))
+			return false;
+		text.resize(len);
+		return len == 0 || static_cast<bool>(in.read(&text[0], len));
+	}
+
+	inline std::string NormalizedType(std::string type)
+	{
+		for (const char* prefix : { "const ", "volatile ", "std::" })
+		{
+			if (type.compare(0, strlen(prefix), prefix) == 0)
+				type.erase(0, strlen(prefix));
+		}
+		return type;
+	}
+
+	template <typename V> inline V Load(const char* bytes) { V value; std::memcpy(&value, bytes, sizeof(V)); return value; }
+
+	inline std::string FormatSigned(const char* bytes, uint32_t size)
+	{
+		switch (size)
+		{
+		case 1: return std::to_string(Load<int8_t>(bytes));
+		case 2: return std::to_string(Load<int16_t>(bytes));
+		case 4: return std::to_string(Load<int32_t>(bytes));
+		default: return std::to_string(Load<int64_t>(bytes));
+		}
+	}
+
+	inline std::string FormatUnsigned(const char* bytes, uint32_t size)
+	{
+		switch (size)
+		{
+		case 1: return std::to_string(Load<uint8_t>(bytes));
+		case 2: return std::to_string(Load<uint16_t>(bytes));
+		case 4: return std::to_string(Load<uint32_t>(bytes));
+		default: return std::to_string(Load<uint64_t>(bytes));
+		}
+	}
+
+	inline std::string FormatHex(const char* bytes, uint32_t size)
+	{
+		std::string text;
+		char digits[4];
+		for (uint32_t i = 0; i < size; ++i)
+		{
+			snprintf(digits, sizeof(digits), "%02x", static_cast<unsigned char>(bytes[i]));
+			text += (i ? " " : "") + std::string(digits);
+		}
+		return text;
+	}
+
+	inline std::string FormatField(const std::string& spelledType, const char* bytes, uint32_t size)
+	{
+		static const char* const signedTypes[] = { "char", "signed char", "short", "int", "long", "long long", "wchar_t",
+			"int8_t", "int16_t", "int32_t", "int64_t", "ptrdiff_t", "intptr_t", "ssize_t", "intmax_t" };
+		static const char* const unsignedTypes[] = { "unsigned char", "unsigned short", "unsigned int", "unsigned", "unsigned long",
+			"unsigned long long", "char16_t", "char32_t", "uint8_t", "uint16_t", "uint32_t", "uint64_t", "size_t", "uintptr_t", "uintmax_t" };
+		const std::string type = NormalizedType(spelledType);
+		const bool bIntegerSize = size == 1 || size == 2 || size == 4 || size == 8;
+		if (type == "bool" && size == 1)
+			return bytes[0] ? "true" : "false";
+		if (type == "float" && size == sizeof(float))
+			return std::to_string(Load<float>(bytes));
+		if (type == "double" && size == sizeof(double))
+			return std::to_string(Load<double>(bytes));
+		if (!type.empty() && type.back() == '*' && bIntegerSize)
+		{
+			char text[24];
+			snprintf(text, sizeof(text), "0x%llx", static_cast<unsigned long long>(size == 8 ? Load<uint64_t>(bytes) : Load<uint32_t>(bytes)));
+			return text;
+		}
+		if (bIntegerSize && std::find(std::begin(signedTypes), std::end(signedTypes), type) != std::end(signedTypes))
+			return FormatSigned(bytes, size);
+		if (bIntegerSize && std::find(std::begin(unsignedTypes), std::end(unsignedTypes), type) != std::end(unsignedTypes))
+			return FormatUnsigned(bytes, size);
+		return "{" + FormatHex(bytes, size) + "}";
+	}
+}
+
+// a field table written by WriteClassFields (debugxray_snapshot.h)
+inline bool ReadClassFields(std::istream& in, DecodedClass& decoded)
+{
+	uint32_t fieldCount;
+	if (!detail::ReadString(in, decoded.name) || !detail::ReadPod(in, decoded.size) || !detail::ReadPod(in, fieldCount) || fieldCount > 65536)
+		return false;
+	decoded.fields.resize(fieldCount);
+	decoded.capturedSize = 0;
+	for (DecodedField& field : decoded.fields)
+	{
+		uint8_t bCaptured;
+		if (!detail::ReadString(in, field.name) || !detail::ReadString(in, field.type) || !detail::ReadPod(in, field.offset) ||
+			!detail::ReadPod(in, field.size) || !detail::ReadPod(in, bCaptured))
+			return false;
+		field.bCaptured = bCaptured != 0;
+		decoded.capturedSize += field.bCaptured ? field.size : 0;
+	}
+	return true;
+}
+
+// the fields of a captured payload, one per line
+inline void PrintFields(const DecodedClass& decoded, const char* bytes, std::ostream& out)
+{
+	for (const DecodedField& field : decoded.fields)
+	{
+		out << "\t" << field.type << " " << field.name;
+		if (field.bCaptured)
+		{
+			out << " = " << detail::FormatField(field.type, bytes, field.size) << "\n";
+			bytes += field.size;
+		}
+		else
+			out << " (not captured)\n";
+	}
+}
+
+inline bool ReadSnapshotDump(std::istream& in, SnapshotDump& dump, std::string& error)
+{
+	char magic[sizeof(SNAPSHOT_DUMP_MAGIC)];
+	uint32_t version, classCount;
+	if (!in.read(magic, sizeof(magic)) || memcmp(magic, SNAPSHOT_DUMP_MAGIC, sizeof(magic)) != 0)
+	{
+		error = "not a snapshot dump";
+		return false;
+	}
+	if (!detail::ReadPod(in, version) || version != SNAPSHOT_DUMP_VERSION)
+	{
+		error = "unsupported snapshot dump version";
+		return false;
+	}
+	if (!detail::ReadPod(in, classCount) || !detail::ReadPod(in, dump.capacity) || !detail::ReadPod(in, dump.head) || !detail::ReadPod(in, dump.ticksPerSecond))
+	{
+		error = "truncated header";
+		return false;
+	}
+	if (dump.capacity < sizeof(SnapshotRecord) || (dump.capacity & (dump.capacity - 1)) != 0 || dump.capacity > (uint64_t(1) << 40))
+	{
+		error = "bad ring capacity";
+		return false;
+	}
+	dump.classes.resize(classCount);
+	for (DecodedClass& decoded : dump.classes)
+	{
+		if (!ReadClassFields(in, decoded))
+		{
+			error = "truncated field tables";
+			return false;
+		}
+	}
+	dump.buffer.resize(static_cast<size_t>(dump.capacity));
+	if (!in.read(dump.buffer.data(), static_cast<std::streamsize>(dump.capacity)))
+	{
+		error = "truncated ring buffer";
+		return false;
+	}
+	return true;
+}
+
+// the complete records of the ring, oldest first
+inline std::vector<const SnapshotRecord*> SnapshotRecords(const SnapshotDump& dump)
+{
+	std::vector<const SnapshotRecord*> records;
+	const uint64_t oldest = dump.head > dump.capacity ? dump.head - dump.capacity : 0;
+	for (uint64_t offset = 0; offset + sizeof(SnapshotRecord) <= dump.capacity; offset += 8)
+	{
+		const SnapshotRecord* record = reinterpret_cast<const SnapshotRecord*>(dump.buffer.data() + offset);
+		if (record->position == 0)
+			continue;
+		const uint64_t position = record->position - 1;
+		const bool bValid = (position & (dump.capacity - 1)) == offset && position >= oldest && record->size % 8 == 0 &&
+			record->size >= sizeof(SnapshotRecord) && offset + record->size <= dump.capacity && position + record->size <= dump.head &&
+			(record->classIndex == PADDING_CLASS || (record->classIndex < dump.classes.size() &&
+				record->size == ((sizeof(SnapshotRecord) + dump.classes[record->classIndex].capturedSize + 7) & ~uint64_t(7))));
+		if (!bValid)
+			continue;
+		if (record->classIndex != PADDING_CLASS)
+			records.push_back(record);
+		offset += record->size - 8;
+	}
+	std::sort(records.begin(), records.end(), [](const SnapshotRecord* a, const SnapshotRecord* b) { return a->position < b->position; });
+	return records;
+}
+
+inline void PrintSnapshotRecords(const SnapshotDump& dump, std::ostream& out)
+{
+	const std::vector<const SnapshotRecord*> records = SnapshotRecords(dump);
+	const uint64_t firstTicks = records.empty() ? 0 : records.front()->ticks;
+	for (const SnapshotRecord* record : records)
+	{
+		const DecodedClass& decoded = dump.classes[record->classIndex];
+		char time[32];
+		snprintf(time, sizeof(time), "%.3f", double(record->ticks - firstTicks) / dump.ticksPerSecond * 1e6);
+		out << "@" << record->position - 1 << " +" << time << " us " << decoded.name << "\n";
+		PrintFields(decoded, reinterpret_cast<const char*>(record) + sizeof(SnapshotRecord), out);
+	}
+}
+
+}
@@ -0,0 +1,38 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "debugxray_live_reader.h"
+
+// prints the objects a running process publishes into its live region (debugxray_live.h), once or every
+// <ms> milliseconds; the process isn't stopped or slowed down by it
+int main(int argc, char* argv[])
+{
+	if (argc != 2 && !(argc == 4 && std::strcmp(argv[2], "--watch") == 0))
+	{
+		std::cout << "Usage: " << argv[0] << " <pid> [--watch <ms>]\n";
+		return -1;
+	}
+	const uint64_t pid = std::strtoull(argv[1], nullptr, 10);
+	const long watchMs = argc == 4 ? std::strtol(argv[3], nullptr, 10) : 0;
+	DEBUGXRAY::LiveReader reader;
+	std::string error;
+	if (!reader.Open(pid, error))
+	{
+		std::cout << error << "\n";
+		return -2;
+	}
+	do
+	{
+		const std::vector<DEBUGXRAY::LiveObject> objects = reader.Read();
+		std::cout << objects.size() << " objects published by " << pid << "\n";
+		reader.Print(objects, std::cout);
+		std::cout.flush();
+		if (watchMs > 0)
+			std::this_thread::sleep_for(std::chrono::milliseconds(watchMs));
+	} while (watchMs > 0);
+	return 0;
+}
@@ -0,0 +1,269 @@
+#pragma once
+
+// Live inspection of private state, without stopping the process: objects get a slot in a POSIX shared memory
+// region (/debugxray.<pid>) and publish their captured fields into it (DEBUGCLASS::Snapshot<T>, generated by
+// classdecl_modifier --xray, see debugxray_snapshot.h), from their own thread, whenever it suits them.
+// debugxray_live <pid> reads the region from another process and prints the objects.
+//
+//		DEBUGXRAY::LiveHandle live = DEBUGXRAY::LiveRegion::Instance().Register(book);		// once
+//		...
+//		live.MaybePublish(book);		// in the hot loop: at most every 100 ms (LiveRegion::SetPublishInterval)
+//
+// Each slot is a seqlock: the sequence is odd while the owner writes it, the reader copies the slot and keeps
+// the copy only if the sequence was even and unchanged around it. Publishing takes no lock and allocates
+// nothing, it's two stores of the sequence and a memcpy per captured field, into the slot of fixed size;
+// MaybePublish is a TSC read and a compare when it's not due. Registering a class the first time and getting
+// a slot are the slow operations (a mutex, a linear search for a free slot).
+// One writer per slot: an object has to be published from one thread at a time.
+
+#include "debugxray_snapshot.h"
+
+#if !defined(__unix__) && !defined(__APPLE__)
+#error debugxray_live.h needs POSIX shared memory
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace DEBUGXRAY {
+
+const char LIVE_REGION_MAGIC[8] = { 'D', 'X', 'R', 'A', 'Y', 'L', 'I', 'V' };
+const uint32_t LIVE_REGION_VERSION = 1;
+const uint32_t NO_LIVE_SLOT = 0xffffffffu;
+
+// The region: this header, the field tables (WriteClassFields, one after the other, published by
+// classCount/schemaBytes), then the slots. All offsets and sizes are fixed when the region is created.
+struct LiveRegionHeader {
+	char					magic[8];
+	uint32_t				version;
+	uint32_t				slotCount;
+	uint32_t				slotSize;			// slot header included
+	uint32_t				schemaCapacity;
+	std::atomic<uint32_t>	schemaBytes;
+	std::atomic<uint32_t>	classCount;
+	double					ticksPerSecond;
+	uint64_t				pid;
+};
+
+struct LiveSlotHeader {
+	std::atomic<uint32_t>	sequence;			// odd while being written
+	std::atomic<uint32_t>	bTaken;
+	uint32_t				classIndex;
+	uint32_t				payloadSize;
+	uint64_t				objectAddress;
+	uint64_t				ticks;				// of the last publish
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "the seqlock in shared memory needs lock-free atomics");
+
+inline std::string LiveRegionName(uint64_t pid)
+{
+	return "/debugxray." + std::to_string(pid);
+}
+
+inline size_t LiveSlotOffset(const LiveRegionHeader& header, uint32_t index)
+{
+	return sizeof(LiveRegionHeader) + header.schemaCapacity + size_t(index) * header.slotSize;
+}
+
+class LiveRegion;
+
+// an object's slot; move-only, gives the slot back when destroyed
+class LiveHandle {
+public:
+	LiveHandle() = default;
+	LiveHandle(LiveHandle&& other) noexcept { *this = std::move(other); }
+	LiveHandle& operator= (LiveHandle&& other) noexcept;
+	~LiveHandle();
+
+	bool Valid() const { return m_slot != nullptr; }
+
+	template <typename T> void Publish(const T& object);
+	// publishes if the last one was at least the region's publish interval ago
+	template <typename T> void MaybePublish(const T& object)
+	{
+		if (m_slot && SnapshotTicks() - m_lastTicks >= m_intervalTicks)
+			Publish(object);
+	}
+
+private:
+	friend class LiveRegion;
+	LiveSlotHeader*	m_slot = nullptr;
+	uint64_t		m_lastTicks = 0;
+	uint64_t		m_intervalTicks = 0;
+};
+
+class LiveRegion {
+public:
+	// the region of this process, created on first use with the default size
+	static LiveRegion& Instance()
+	{
+		static LiveRegion region(4096, 256, 65536);
+		return region;
+	}
+
+	// slotSize: slot header included, it limits the captured size of the classes that can be registered
+	LiveRegion(uint32_t slotCount, uint32_t slotSize, uint32_t schemaCapacity)
+	{
+		slotSize = (std::max<uint32_t>(slotSize, sizeof(LiveSlotHeader) + 8) + 7) & ~7u;
+		schemaCapacity = (schemaCapacity + 7) & ~7u;
+		m_size = sizeof(LiveRegionHeader) + schemaCapacity + size_t(slotCount) * slotSize;
+		m_name = LiveRegionName(static_cast<uint64_t>(getpid()));
+		const int fd = shm_open(m_name.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0600);
+		if (fd < 0)
+			return;
+		void* memory = ftruncate(fd, static_cast<off_t>(m_size)) == 0 ? mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+		close(fd);
+		if (memory == MAP_FAILED)
+		{
+			shm_unlink(m_name.c_str());
+			return;
+		}
+		m_memory = static_cast<char*>(memory);
+		LiveRegionHeader* header = new (m_memory) LiveRegionHeader{ {}, LIVE_REGION_VERSION, slotCount, slotSize, schemaCapacity, { 0 }, { 0 }, SnapshotTicksPerSecond(), static_cast<uint64_t>(getpid()) };
+		for (uint32_t i = 0; i < slotCount; ++i)
+			new (Slot(i)) LiveSlotHeader{ { 0 }, { 0 }, 0, 0, 0, 0 };
+		m_publishIntervalTicks = static_cast<uint64_t>(header->ticksPerSecond / 10);
+		std::atomic_thread_fence(std::memory_order_release);
+		std::memcpy(header->magic, LIVE_REGION_MAGIC, sizeof(LIVE_REGION_MAGIC));		// last: the reader checks it
+	}
+
+	~LiveRegion()
+	{
+		if (m_memory)
+		{
+			munmap(m_memory, m_size);
+			shm_unlink(m_name.c_str());
+		}
+	}
+
+	LiveRegion(const LiveRegion&) = delete;
+	LiveRegion& operator= (const LiveRegion&) = delete;
+
+	bool Valid() const { return m_memory != nullptr; }
+	const std::string& Name() const { return m_name; }
+
+	// MaybePublish's minimum interval for the handles registered afterwards (100 ms by default)
+	void SetPublishInterval(double seconds) { m_publishIntervalTicks = static_cast<uint64_t>(Header()->ticksPerSecond * seconds); }
+
+	// an invalid handle if the region couldn't be created, is full, or T's captured fields don't fit in a slot
+	template <typename T> LiveHandle Register(const T& object)
+	{
+		LiveHandle handle;
+		if (!m_memory)
+			return handle;
+		const ClassFields& fields = DEBUGCLASS::Fields<T>();
+		if (sizeof(LiveSlotHeader) + fields.capturedSize > Header()->slotSize)
+			return handle;
+		const uint32_t classIndex = ClassIndex(fields);
+		if (classIndex == NO_LIVE_SLOT)
+			return handle;
+		for (uint32_t i = 0; i < Header()->slotCount; ++i)
+		{
+			LiveSlotHeader* slot = Slot(i);
+			uint32_t bTaken = 0;
+			if (slot->bTaken.load(std::memory_order_relaxed) == 0 && slot->bTaken.compare_exchange_strong(bTaken, 1, std::memory_order_acquire))
+			{
+				// odd before the slot header is touched, whether the slot is fresh (even) or was given back (odd already),
+				// and it stays odd until the first publish, so the reader skips the slot till then
+				slot->sequence.fetch_or(1, std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_release);
+				slot->classIndex = classIndex;
+				slot->payloadSize = fields.capturedSize;
+				slot->objectAddress = reinterpret_cast<uint64_t>(&object);
+				handle.m_slot = slot;
+				handle.m_intervalTicks = m_publishIntervalTicks;
+				return handle;
+			}
+		}
+		return handle;
+	}
+
+private:
+	char*		m_memory = nullptr;
+	size_t		m_size = 0;
+	std::string	m_name;
+	std::mutex	m_schemaLock;
+	std::vector<const ClassFields*>	m_classes;		// in the order of the field tables in the region
+	uint64_t	m_publishIntervalTicks = 0;
+
+	LiveRegionHeader* Header() const { return reinterpret_cast<LiveRegionHeader*>(m_memory); }
+	LiveSlotHeader* Slot(uint32_t index) const
+	{
+		return reinterpret_cast<LiveSlotHeader*>(m_memory + LiveSlotOffset(*Header(), index));
+	}
+
+	// the index of the class' field table in the region, appended the first time; NO_LIVE_SLOT if it doesn't fit
+	uint32_t ClassIndex(const ClassFields& fields)
+	{
+		std::lock_guard<std::mutex> guard(m_schemaLock);
+		for (size_t i = 0; i < m_classes.size(); ++i)
+		{
+			if (m_classes[i] == &fields)
+				return static_cast<uint32_t>(i);
+		}
+		std::ostringstream table;
+		WriteClassFields(table, fields);
+		const std::string bytes = table.str();
+		LiveRegionHeader* header = Header();
+		const uint32_t schemaBytes = header->schemaBytes.load(std::memory_order_relaxed);
+		if (schemaBytes + bytes.size() > header->schemaCapacity)
+			return NO_LIVE_SLOT;
+		std::memcpy(m_memory + sizeof(LiveRegionHeader) + schemaBytes, bytes.data(), bytes.size());
+		header->schemaBytes.store(schemaBytes + static_cast<uint32_t>(bytes.size()), std::memory_order_release);
+		header->classCount.store(static_cast<uint32_t>(m_classes.size() + 1), std::memory_order_release);
+		m_classes.push_back(&fields);
+		return static_cast<uint32_t>(m_classes.size() - 1);
+	}
+};
+
+template <typename T> inline void LiveHandle::Publish(const T& object)
+{
+	if (!m_slot)
+		return;
+	const uint32_t sequence = m_slot->sequence.load(std::memory_order_relaxed) | 1;		// odd already before the first publish
+	m_slot->sequence.store(sequence, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	DEBUGCLASS::Snapshot(object, reinterpret_cast<char*>(m_slot + 1));
+	m_lastTicks = SnapshotTicks();
+	m_slot->ticks = m_lastTicks;
+	m_slot->objectAddress = reinterpret_cast<uint64_t>(&object);
+	m_slot->sequence.store(sequence + 1, std::memory_order_release);
+}
+
+inline LiveHandle& LiveHandle::operator= (LiveHandle&& other) noexcept
+{
+	if (this != &other)
+	{
+		this->~LiveHandle();
+		m_slot = other.m_slot;
+		m_lastTicks = other.m_lastTicks;
+		m_intervalTicks = other.m_intervalTicks;
+		other.m_slot = nullptr;
+	}
+	return *this;
+}
+
+inline LiveHandle::~LiveHandle()
+{
+	if (m_slot)
+	{
+		// odd again: the reader drops it, the next owner's first publish makes it even
+		m_slot->sequence.store(m_slot->sequence.load(std::memory_order_relaxed) | 1, std::memory_order_release);
+		m_slot->bTaken.store(0, std::memory_order_release);
+		m_slot = nullptr;
+	}
+}
+
+}
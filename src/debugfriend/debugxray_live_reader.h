@@ -0,0 +1,156 @@
+#pragma once
+
+// The reading side of debugxray_live.h: maps another process' (or this process') live region read-only and
+// copies the published objects out of it, seqlock style, without ever blocking the writers.
+
+#include "debugxray_live.h"
+#include "debugxray_decode.h"
+
+#include <cstdio>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace DEBUGXRAY {
+
+struct LiveObject {
+	uint32_t			slot;
+	uint32_t			classIndex;
+	uint64_t			objectAddress;
+	uint64_t			ticks;
+	std::vector<char>	payload;
+};
+
+class LiveReader {
+public:
+	LiveReader() = default;
+	LiveReader(const LiveReader&) = delete;
+	LiveReader& operator= (const LiveReader&) = delete;
+	~LiveReader() { Close(); }
+
+	bool Open(uint64_t pid, std::string& error)
+	{
+		Close();
+		const std::string name = LiveRegionName(pid);
+		const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+		if (fd < 0)
+		{
+			error = "no live region " + name;
+			return false;
+		}
+		struct stat info;
+		void* memory = fstat(fd, &info) == 0 && size_t(info.st_size) >= sizeof(LiveRegionHeader) ?
+			mmap(nullptr, size_t(info.st_size), PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+		close(fd);
+		if (memory == MAP_FAILED)
+		{
+			error = "unable to map " + name;
+			return false;
+		}
+		m_memory = static_cast<const char*>(memory);
+		m_size = size_t(info.st_size);
+		const LiveRegionHeader& header = Header();
+		if (std::memcmp(header.magic, LIVE_REGION_MAGIC, sizeof(LIVE_REGION_MAGIC)) != 0 || header.version != LIVE_REGION_VERSION ||
+			LiveSlotOffset(header, header.slotCount) > m_size)
+		{
+			error = name + " isn't a live region of this version (or it's still being created)";
+			Close();
+			return false;
+		}
+		return true;
+	}
+
+	void Close()
+	{
+		if (m_memory)
+			munmap(const_cast<char*>(m_memory), m_size);
+		m_memory = nullptr;
+		m_classes.clear();
+	}
+
+	double TicksPerSecond() const { return Header().ticksPerSecond; }
+	const std::vector<DecodedClass>& Classes() const { return m_classes; }
+
+	// the objects published so far, each one a consistent copy; a slot being written is retried a few times,
+	// then left out of this round
+	std::vector<LiveObject> Read()
+	{
+		std::vector<LiveObject> objects;
+		if (!m_memory || !UpdateClasses())
+			return objects;
+		const LiveRegionHeader& header = Header();
+		const uint32_t payloadCapacity = header.slotSize - sizeof(LiveSlotHeader);
+		for (uint32_t i = 0; i < header.slotCount; ++i)
+		{
+			const LiveSlotHeader& slot = *reinterpret_cast<const LiveSlotHeader*>(m_memory + LiveSlotOffset(header, i));
+			if (slot.bTaken.load(std::memory_order_relaxed) == 0)
+				continue;
+			LiveObject object;
+			for (int attempt = 0; attempt < 8; ++attempt)
+			{
+				const uint32_t before = slot.sequence.load(std::memory_order_acquire);
+				if (before & 1)
+				{
+					std::this_thread::yield();
+					continue;
+				}
+				object.slot = i;
+				object.classIndex = slot.classIndex;
+				object.objectAddress = slot.objectAddress;
+				object.ticks = slot.ticks;
+				const uint32_t payloadSize = std::min(slot.payloadSize, payloadCapacity);
+				object.payload.assign(reinterpret_cast<const char*>(&slot + 1), reinterpret_cast<const char*>(&slot + 1) + payloadSize);
+				std::atomic_thread_fence(std::memory_order_acquire);
+				if (slot.sequence.load(std::memory_order_relaxed) == before)
+				{
+					if (object.classIndex < m_classes.size() && object.payload.size() == m_classes[object.classIndex].capturedSize)
+						objects.push_back(std::move(object));
+					break;
+				}
+			}
+		}
+		return objects;
+	}
+
+	void Print(const std::vector<LiveObject>& objects, std::ostream& out) const
+	{
+		for (const LiveObject& object : objects)
+		{
+			const DecodedClass& decoded = m_classes[object.classIndex];
+			char address[32];
+			snprintf(address, sizeof(address), "0x%llx", static_cast<unsigned long long>(object.objectAddress));
+			out << "[" << object.slot << "] " << decoded.name << " at " << address << "\n";
+			PrintFields(decoded, object.payload.data(), out);
+		}
+	}
+
+private:
+	const char*					m_memory = nullptr;
+	size_t						m_size = 0;
+	std::vector<DecodedClass>	m_classes;
+
+	const LiveRegionHeader& Header() const { return *reinterpret_cast<const LiveRegionHeader*>(m_memory); }
+
+	// the field tables are only ever appended to: parses the ones registered since the last call
+	bool UpdateClasses()
+	{
+		const LiveRegionHeader& header = Header();
+		const uint32_t classCount = header.classCount.load(std::memory_order_acquire);
+		if (classCount == m_classes.size())
+			return true;
+		const uint32_t schemaBytes = std::min(header.schemaBytes.load(std::memory_order_acquire), header.schemaCapacity);
+		std::istringstream in(std::string(m_memory + sizeof(LiveRegionHeader), schemaBytes));
+		std::vector<DecodedClass> classes(classCount);
+		for (DecodedClass& decoded : classes)
+		{
+			if (!ReadClassFields(in, decoded))
+				return false;
+		}
+		m_classes = std::move(classes);
+		return true;
+	}
+};
+
+}
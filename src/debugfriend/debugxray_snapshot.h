@@ -0,0 +1,238 @@
+#pragma once
+
+// Binary snapshots of objects for hot code paths: DEBUGXRAY::SnapshotRing::Capture(object) copies the trivially
+// copyable fields of the object (private ones too, through DEBUGCLASS and the field tables classdecl_modifier
+// --xray generates) into a ring buffer, with a TSC timestamp. No formatting, no allocation, no lock: a CAS on
+// the ring's head and a memcpy per field. Dump() writes the ring and the field tables into a file, which
+// debugxray_decode turns into text offline.
+//
+//		DEBUGXRAY::SnapshotRing ring(1 << 24);
+//		ring.Capture(order);					// in the hot path
+//		ring.Dump("orders.dxray");				// later, when nothing captures any more
+//
+// The ring is shared by all threads; a record never straddles the end of the buffer (the rest of the buffer
+// is skipped with a padding record), old records are overwritten. Each record carries its own position, written
+// last, so the decoder finds the complete, not yet overwritten ones without any other bookkeeping.
+
+#include "debugxray.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <ostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace DEBUGXRAY {
+
+// used by the generated field tables: size and capture from the compiler, offset from libclang
+#define DEBUGXRAY_FIELD(cls, field, type, offset)	\
+	{ #field, type, offset, static_cast<uint32_t>(sizeof(cls::field)), std::is_trivially_copyable<decltype(cls::field)>::value }
+
+const uint32_t DEBUGXRAY_UNKNOWN_OFFSET = 0xffffffffu;
+
+// used by the generated DEBUGCLASS::Snapshot<T>, has to skip exactly the fields the table says aren't captured
+template <typename F> inline char* CaptureField(char* out, const F& field)
+{
+	if constexpr (std::is_trivially_copyable<F>::value)
+	{
+		std::memcpy(out, &field, sizeof(F));
+		return out + sizeof(F);
+	}
+	else
+		return out;
+}
+
+struct SnapshotRecord {
+	uint32_t	size;			// the whole record, header included, a multiple of 8
+	uint32_t	classIndex;		// into SnapshotSchema(), PADDING_CLASS for the filler before the end of the buffer
+	uint64_t	ticks;			// SnapshotTicks()
+	uint64_t	position;		// ring position of the record + 1, written last: 0 while it's being written
+};
+
+const uint32_t PADDING_CLASS = 0xffffffffu;
+const char SNAPSHOT_DUMP_MAGIC[8] = { 'D', 'X', 'R', 'A', 'Y', 'S', 'N', 'P' };
+const uint32_t SNAPSHOT_DUMP_VERSION = 1;
+
+inline uint64_t SnapshotTicks()
+{
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+inline double SnapshotTicksPerSecond()
+{
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+	const auto t0 = std::chrono::steady_clock::now();
+	const uint64_t c0 = __rdtsc();
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	const uint64_t c1 = __rdtsc();
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+	return double(c1 - c0) / seconds;
+#else
+	return 1e9;
+#endif
+}
+
+// the classes snapshotted so far, process-wide; a record refers to its class by index
+struct SnapshotClasses {
+	std::mutex lock;
+	std::vector<const ClassFields*> classes;
+};
+
+inline SnapshotClasses& SnapshotSchema()
+{
+	static SnapshotClasses schema;
+	return schema;
+}
+
+template <typename T> inline uint32_t SnapshotClassIndex()
+{
+	static const uint32_t index = []() {
+		SnapshotClasses& schema = SnapshotSchema();
+		std::lock_guard<std::mutex> guard(schema.lock);
+		schema.classes.push_back(&DEBUGCLASS::Fields<T>());
+		return static_cast<uint32_t>(schema.classes.size() - 1);
+	}();
+	return index;
+}
+
+namespace detail {
+	template <typename P> inline void WritePod(std::ostream& out, const P& value) { out.write(reinterpret_cast<const char*>(&value), sizeof(P)); }
+
+	inline void WriteString(std::ostream& out, const char* text)
+	{
+		const uint32_t len = static_cast<uint32_t>(std::strlen(text));
+		WritePod(out, len);
+		out.write(text, len);
+	}
+}
+
+// the field table as the decoders read it back (ReadClassFields in debugxray_decode.h)
+inline void WriteClassFields(std::ostream& out, const ClassFields& fields)
+{
+	detail::WriteString(out, fields.name);
+	detail::WritePod(out, fields.size);
+	detail::WritePod(out, fields.count);
+	for (uint32_t i = 0; i < fields.count; ++i)
+	{
+		const FieldInfo& field = fields.fields[i];
+		detail::WriteString(out, field.name);
+		detail::WriteString(out, field.type);
+		detail::WritePod(out, field.offset);
+		detail::WritePod(out, field.size);
+		detail::WritePod(out, static_cast<uint8_t>(field.bCaptured));
+	}
+}
+
+class SnapshotRing {
+public:
+	// capacity in bytes, rounded up to a power of two
+	explicit SnapshotRing(size_t capacity = size_t(1) << 24)
+	{
+		m_capacity = 64;
+		while (m_capacity < capacity)
+			m_capacity <<= 1;
+		m_buffer = std::make_unique<uint64_t[]>(m_capacity / sizeof(uint64_t));
+	}
+	SnapshotRing(const SnapshotRing&) = delete;
+	SnapshotRing& operator= (const SnapshotRing&) = delete;
+
+	template <typename T> void Capture(const T& object)
+	{
+		static const ClassFields& fields = DEBUGCLASS::Fields<T>();
+		static const uint32_t classIndex = SnapshotClassIndex<T>();
+		const uint32_t recordSize = static_cast<uint32_t>((sizeof(SnapshotRecord) + fields.capturedSize + 7) & ~size_t(7));
+		if (recordSize > m_capacity)
+		{
+			m_dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		uint64_t position;
+		char* record = Reserve(recordSize, position);
+		DEBUGCLASS::Snapshot(object, record + sizeof(SnapshotRecord));
+		Commit(record, recordSize, classIndex, position);
+	}
+
+	size_t Capacity() const { return m_capacity; }
+	uint64_t BytesWritten() const { return m_head.load(std::memory_order_acquire); }
+	uint64_t Dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+	// the field tables and the buffer as it is; records being written meanwhile are left out by the decoder,
+	// but records overwritten meanwhile may come out torn, so it's meant for when nothing captures
+	bool Dump(const std::string& filename) const
+	{
+		std::ofstream ofs(filename, std::ios::binary | std::ios::trunc | std::ios::out);
+		if (!ofs.good())
+			return false;
+		std::vector<const ClassFields*> classes;
+		{
+			SnapshotClasses& schema = SnapshotSchema();
+			std::lock_guard<std::mutex> guard(schema.lock);
+			classes = schema.classes;
+		}
+		const uint64_t head = BytesWritten();
+		const uint64_t capacity = m_capacity;
+		const double ticksPerSecond = SnapshotTicksPerSecond();
+		ofs.write(SNAPSHOT_DUMP_MAGIC, sizeof(SNAPSHOT_DUMP_MAGIC));
+		detail::WritePod(ofs, SNAPSHOT_DUMP_VERSION);
+		detail::WritePod(ofs, static_cast<uint32_t>(classes.size()));
+		detail::WritePod(ofs, capacity);
+		detail::WritePod(ofs, head);
+		detail::WritePod(ofs, ticksPerSecond);
+		for (const ClassFields* fields : classes)
+			WriteClassFields(ofs, *fields);
+		ofs.write(Bytes(), static_cast<std::streamsize>(m_capacity));
+		return ofs.good();
+	}
+
+private:
+	std::unique_ptr<uint64_t[]>	m_buffer;		// 8-aligned
+	size_t						m_capacity;
+	std::atomic<uint64_t>		m_head{ 0 };
+	std::atomic<uint64_t>		m_dropped{ 0 };
+
+	char* Bytes() const { return reinterpret_cast<char*>(m_buffer.get()); }
+
+	// position: where the record goes; if it wouldn't fit before the end of the buffer, the rest of the buffer
+	// is reserved too (and marked as padding if a record header fits in it) and the record goes to the beginning
+	char* Reserve(uint32_t recordSize, uint64_t& position)
+	{
+		uint64_t head = m_head.load(std::memory_order_relaxed);
+		uint64_t padding;
+		do
+		{
+			const uint64_t offset = head & (m_capacity - 1);
+			padding = offset + recordSize > m_capacity ? m_capacity - offset : 0;
+		} while (!m_head.compare_exchange_weak(head, head + padding + recordSize, std::memory_order_relaxed));
+		if (padding >= sizeof(SnapshotRecord))
+			Commit(Bytes() + (head & (m_capacity - 1)), static_cast<uint32_t>(padding), PADDING_CLASS, head);
+		position = head + padding;
+		return Bytes() + (position & (m_capacity - 1));
+	}
+
+	static void Commit(char* record, uint32_t recordSize, uint32_t classIndex, uint64_t position)
+	{
+		SnapshotRecord header{ recordSize, classIndex, SnapshotTicks(), 0 };
+		std::memcpy(record, &header, offsetof(SnapshotRecord, position));
+		std::atomic_thread_fence(std::memory_order_release);
+		const uint64_t committed = position + 1;
+		std::memcpy(record + offsetof(SnapshotRecord, position), &committed, sizeof(committed));
+	}
+};
+
+}
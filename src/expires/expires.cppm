@@ -0,0 +1,17 @@
+// lsct.expires -- expires.h as a C++20 named module: import lsct.expires; instead of #include "expires.h".
+// Modules can't export macros, __EXPIRES__ comes from lsct_config.h, which importers include; it checks against
+// the importer's __DATE__, as the module itself is compiled only when it changes.
+
+module;
+
+#include "../lsct_config.h"
+
+#include <cstddef>
+#include <limits>
+
+export module lsct.expires;
+
+export
+{
+#include "expires.h"
+}
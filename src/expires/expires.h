@@ -1,7 +1,16 @@
 #pragma once
 
+#include <cstddef>
 #include <limits>
 
+// namespace scope constants get external linkage where the language allows it, so that the module build
+// (expires.cppm) can export the constexpr functions using them
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#define EXPIRES_INLINE	inline
+#else
+#define EXPIRES_INLINE
+#endif
+
 namespace CodeExpiresFeature { namespace details {
 
 // For the following two literals all that matters is the place and number 
@@ -14,19 +23,19 @@ namespace CodeExpiresFeature { namespace details {
 // - or by a space-padded number (mm),
 // - and the same for days (DD or dd).
 
-constexpr char DATE_FORMAT__COMPILER[] = "MMM dd YYYY";			// date format the compiler uses in __DATE__ precomp. directive
-constexpr char DATE_FORMAT__ARGUMENTS[] = "YYYYMMDD";			// date format that will be used in arguments to __EXPIRES__ calls
+EXPIRES_INLINE constexpr char DATE_FORMAT__COMPILER[] = "MMM dd YYYY";			// date format the compiler uses in __DATE__ precomp. directive
+EXPIRES_INLINE constexpr char DATE_FORMAT__ARGUMENTS[] = "YYYYMMDD";			// date format that will be used in arguments to __EXPIRES__ calls
 
 static_assert(sizeof(__DATE__) == sizeof(DATE_FORMAT__COMPILER), "CodeExpiresFeature::details::DATE_FORMAT__COMPILER should reflect date format used by __DATE__ precompiler macro, but they've got different lengths");
 
 // would be nicer with constexpr std::initializer_list<long> YEAR_CONSTRAINTS, but not everyone has N3471, even though it's dating back to 2012
-constexpr long DATES_ARE_NEVER_BEFORE_YEAR_SAFETYCHECK = 2000;
-constexpr long DATES_ARE_NEVER_AFTER_YEAR_SAFETYCHECK = 2100;
+EXPIRES_INLINE constexpr long DATES_ARE_NEVER_BEFORE_YEAR_SAFETYCHECK = 2000;
+EXPIRES_INLINE constexpr long DATES_ARE_NEVER_AFTER_YEAR_SAFETYCHECK = 2100;
 
-constexpr long ASSUMED_CENTURY_OF_TWODIGIT_YEARS = 2000;			// MM-DD-YY: 05-30-19 will be 05-30-2019 with this setting
-constexpr long YEAR_MULTIPLIER = 10'000;							// These help generating from (year, month, day) tuple a number 
-constexpr long MONTH_MULTIPLIER = 100;								//		which can be compared using operator< preserving later-than 
-constexpr long DAY_MULTIPLIER = 1;									//		relation -- you can leave them this way
+EXPIRES_INLINE constexpr long ASSUMED_CENTURY_OF_TWODIGIT_YEARS = 2000;			// MM-DD-YY: 05-30-19 will be 05-30-2019 with this setting
+EXPIRES_INLINE constexpr long YEAR_MULTIPLIER = 10'000;							// These help generating from (year, month, day) tuple a number 
+EXPIRES_INLINE constexpr long MONTH_MULTIPLIER = 100;								//		which can be compared using operator< preserving later-than 
+EXPIRES_INLINE constexpr long DAY_MULTIPLIER = 1;									//		relation -- you can leave them this way
 
 constexpr long ce_strlen(const char* str)
 {
@@ -115,7 +124,7 @@ constexpr long ExtractNum(const char* fromWhat, long offset, bool zeroPadded)
 	return
 		zeroPadded ?
 		(fromWhat[offset] - '0') * 10 + (fromWhat[offset + 1] - '0') :
-		(fromWhat[offset] != ' ' ? fromWhat[offset] : 0) * 10 + (fromWhat[offset + 1] - '0');
+		(fromWhat[offset] != ' ' ? fromWhat[offset] - '0' : 0) * 10 + (fromWhat[offset + 1] - '0');
 
 }
 
@@ -174,10 +183,10 @@ constexpr bool IsInvalidFormat(const char(&dateformat)[arrayLen])
 	return
 		arrayLen < 6																						||	// shortest possible valid format
 		arrayLen > 32768																					||	// suspiciously long and could lead to signed overflow
-		FindFirst_s(dateformat, arrayLen, 'Y') < 0) 														||	// must have YY part
-		((FindFirst_s(dateformat, arrayLen, 'M') >= 0) != (FindFirst_s(dateformat, arrayLen, 'm') >= 0))	||	// must have MM xor mm part
-		((FindFirst_s(dateformat, arrayLen, 'D') >= 0) != (FindFirst_s(dateformat, arrayLen, 'd') >= 0))	||	// must have DD xor dd part
-		FindFirst_s(dateformat, arrayLen, 'y') >= 0) 														||	// small y not allowed
+		FindFirst_s(dateformat, arrayLen, 'Y') < 0 														||	// must have YY part
+		((FindFirst_s(dateformat, arrayLen, 'M') >= 0) == (FindFirst_s(dateformat, arrayLen, 'm') >= 0))	||	// must have MM xor mm part
+		((FindFirst_s(dateformat, arrayLen, 'D') >= 0) == (FindFirst_s(dateformat, arrayLen, 'd') >= 0))	||	// must have DD xor dd part
+		FindFirst_s(dateformat, arrayLen, 'y') >= 0 														||	// small y not allowed
 		((FindLast_s(dateformat, arrayLen, 'Y') - FindFirst_s(dateformat, arrayLen, 'Y') != 1) &&
 		 (FindLast_s(dateformat, arrayLen, 'Y') - FindFirst_s(dateformat, arrayLen, 'Y') != 3))				||	// year part (YY) must be of size 2 or 4
 		((FindLast_s(dateformat, arrayLen, 'M') - FindFirst_s(dateformat, arrayLen, 'M') != 1) &&
@@ -189,23 +198,34 @@ constexpr bool IsInvalidFormat(const char(&dateformat)[arrayLen])
 }
 
 // some precalc values -- may speed up compilation and ease debugging
-constexpr long	DATE_FORMAT_ARG_YEARSTART = GetYearStartIdx(DATE_FORMAT__ARGUMENTS);			constexpr long	DATE_FORMAT_COMPILER_YEARSTART = GetYearStartIdx(DATE_FORMAT__COMPILER);
-constexpr long	DATE_FORMAT_ARG_MONTHSTART = GetMonthStartIdx(DATE_FORMAT__ARGUMENTS);			constexpr long	DATE_FORMAT_COMPILER_MONTHSTART = GetMonthStartIdx(DATE_FORMAT__COMPILER);
-constexpr long	DATE_FORMAT_ARG_DAYSTART = GetDayStartIdx(DATE_FORMAT__ARGUMENTS);				constexpr long	DATE_FORMAT_COMPILER_DAYSTART = GetDayStartIdx(DATE_FORMAT__COMPILER);
-constexpr bool	DATE_FORMAT_ARG_Y2DIGITS = IsYearTwoDigitsLong(DATE_FORMAT__ARGUMENTS);			constexpr bool	DATE_FORMAT_COMPILER_Y2DIGITS = IsYearTwoDigitsLong(DATE_FORMAT__COMPILER);
-constexpr bool	DATE_FORMAT_ARG_MONTHNUMERIC = IsMonthNumeric(DATE_FORMAT__ARGUMENTS);			constexpr bool	DATE_FORMAT_COMPILER_MONTHNUMERIC = IsMonthNumeric(DATE_FORMAT__COMPILER);
-constexpr bool	DATE_FORMAT_ARG_MONTH0PADDED = IsMonthZeroPadded(DATE_FORMAT__ARGUMENTS);		constexpr bool	DATE_FORMAT_COMPILER_MONTH0PADDED = IsMonthZeroPadded(DATE_FORMAT__COMPILER);
-constexpr bool	DATE_FORMAT_ARG_DAY0PADDED = IsDayZeroPadded(DATE_FORMAT__ARGUMENTS);			constexpr bool	DATE_FORMAT_COMPILER_DAY0PADDED = IsDayZeroPadded(DATE_FORMAT__COMPILER);
-constexpr bool	DATE_FORMAT_ARG_VALID = !IsInvalidFormat(DATE_FORMAT__ARGUMENTS);				constexpr bool	DATE_FORMAT_COMPILER_VALID = !IsInvalidFormat(DATE_FORMAT__COMPILER);
-
-constexpr long	COMPILE_YEAR = ExtractYear(__DATE__, DATE_FORMAT_COMPILER_YEARSTART, DATE_FORMAT_COMPILER_Y2DIGITS);
-constexpr long	COMPILE_MONTH = ExtractMonth(__DATE__, DATE_FORMAT_COMPILER_MONTHSTART, DATE_FORMAT_COMPILER_MONTHNUMERIC, DATE_FORMAT_COMPILER_MONTH0PADDED);
-constexpr long	COMPILE_DAY = ExtractDay(__DATE__, DATE_FORMAT_COMPILER_DAYSTART, DATE_FORMAT_COMPILER_DAY0PADDED);
-
-constexpr auto	COMPILE_DATE_SUSPICIOUS_VAL = std::numeric_limits<long>::max();
-constexpr auto	ARG_DATE_SUSPICIOUS_VAL = std::numeric_limits<long>::min();
-
-constexpr long	COMPILE_DATE = CompileDateNumber(COMPILE_YEAR, COMPILE_MONTH, COMPILE_DAY, COMPILE_DATE_SUSPICIOUS_VAL);
+EXPIRES_INLINE constexpr long	DATE_FORMAT_ARG_YEARSTART = GetYearStartIdx(DATE_FORMAT__ARGUMENTS);			EXPIRES_INLINE constexpr long	DATE_FORMAT_COMPILER_YEARSTART = GetYearStartIdx(DATE_FORMAT__COMPILER);
+EXPIRES_INLINE constexpr long	DATE_FORMAT_ARG_MONTHSTART = GetMonthStartIdx(DATE_FORMAT__ARGUMENTS);			EXPIRES_INLINE constexpr long	DATE_FORMAT_COMPILER_MONTHSTART = GetMonthStartIdx(DATE_FORMAT__COMPILER);
+EXPIRES_INLINE constexpr long	DATE_FORMAT_ARG_DAYSTART = GetDayStartIdx(DATE_FORMAT__ARGUMENTS);				EXPIRES_INLINE constexpr long	DATE_FORMAT_COMPILER_DAYSTART = GetDayStartIdx(DATE_FORMAT__COMPILER);
+EXPIRES_INLINE constexpr bool	DATE_FORMAT_ARG_Y2DIGITS = IsYearTwoDigitsLong(DATE_FORMAT__ARGUMENTS);			EXPIRES_INLINE constexpr bool	DATE_FORMAT_COMPILER_Y2DIGITS = IsYearTwoDigitsLong(DATE_FORMAT__COMPILER);
+EXPIRES_INLINE constexpr bool	DATE_FORMAT_ARG_MONTHNUMERIC = IsMonthNumeric(DATE_FORMAT__ARGUMENTS);			EXPIRES_INLINE constexpr bool	DATE_FORMAT_COMPILER_MONTHNUMERIC = IsMonthNumeric(DATE_FORMAT__COMPILER);
+EXPIRES_INLINE constexpr bool	DATE_FORMAT_ARG_MONTH0PADDED = IsMonthZeroPadded(DATE_FORMAT__ARGUMENTS);		EXPIRES_INLINE constexpr bool	DATE_FORMAT_COMPILER_MONTH0PADDED = IsMonthZeroPadded(DATE_FORMAT__COMPILER);
+EXPIRES_INLINE constexpr bool	DATE_FORMAT_ARG_DAY0PADDED = IsDayZeroPadded(DATE_FORMAT__ARGUMENTS);			EXPIRES_INLINE constexpr bool	DATE_FORMAT_COMPILER_DAY0PADDED = IsDayZeroPadded(DATE_FORMAT__COMPILER);
+EXPIRES_INLINE constexpr bool	DATE_FORMAT_ARG_VALID = !IsInvalidFormat(DATE_FORMAT__ARGUMENTS);				EXPIRES_INLINE constexpr bool	DATE_FORMAT_COMPILER_VALID = !IsInvalidFormat(DATE_FORMAT__COMPILER);
+
+EXPIRES_INLINE constexpr long	COMPILE_YEAR = ExtractYear(__DATE__, DATE_FORMAT_COMPILER_YEARSTART, DATE_FORMAT_COMPILER_Y2DIGITS);
+EXPIRES_INLINE constexpr long	COMPILE_MONTH = ExtractMonth(__DATE__, DATE_FORMAT_COMPILER_MONTHSTART, DATE_FORMAT_COMPILER_MONTHNUMERIC, DATE_FORMAT_COMPILER_MONTH0PADDED);
+EXPIRES_INLINE constexpr long	COMPILE_DAY = ExtractDay(__DATE__, DATE_FORMAT_COMPILER_DAYSTART, DATE_FORMAT_COMPILER_DAY0PADDED);
+
+EXPIRES_INLINE constexpr auto	COMPILE_DATE_SUSPICIOUS_VAL = std::numeric_limits<long>::max();
+EXPIRES_INLINE constexpr auto	ARG_DATE_SUSPICIOUS_VAL = std::numeric_limits<long>::min();
+
+EXPIRES_INLINE constexpr long	COMPILE_DATE = CompileDateNumber(COMPILE_YEAR, COMPILE_MONTH, COMPILE_DAY, COMPILE_DATE_SUSPICIOUS_VAL);
+
+// the same for any __DATE__ string, not only the one of the TU this header is compiled in
+constexpr long CompilerDate(const char* date)
+{
+	return CompileDateNumber(
+		ExtractYear(date, DATE_FORMAT_COMPILER_YEARSTART, DATE_FORMAT_COMPILER_Y2DIGITS),
+		ExtractMonth(date, DATE_FORMAT_COMPILER_MONTHSTART, DATE_FORMAT_COMPILER_MONTHNUMERIC, DATE_FORMAT_COMPILER_MONTH0PADDED),
+		ExtractDay(date, DATE_FORMAT_COMPILER_DAYSTART, DATE_FORMAT_COMPILER_DAY0PADDED),
+		COMPILE_DATE_SUSPICIOUS_VAL
+	);
+}
 
 constexpr long ArgDate(const char* argument)
 {
@@ -232,6 +252,18 @@ constexpr bool ExpiresConditionCheck(const char* expiresOnDate)
 		details::COMPILE_DATE < details::ArgDate(expiresOnDate);
 }
 
+// compileDate is a __DATE__ string: the check as of that day. The module build (lsct.expires, see lsct_config.h)
+// is compiled once, its COMPILE_DATE is the day of that build, so its __EXPIRES__ passes the importer's __DATE__.
+constexpr bool ExpiresConditionCheck(const char* expiresOnDate, const char* compileDate)
+{
+	return
+		details::DATE_FORMAT_ARG_VALID && details::DATE_FORMAT_COMPILER_VALID &&
+		details::CheckArg(expiresOnDate) &&
+		details::CompilerDate(compileDate) < details::ArgDate(expiresOnDate);
+}
+
 }	// namespace CodeExpiresFeature
 
+#ifndef __EXPIRES__
 #define __EXPIRES__(expiresOnDate)		static_assert(CodeExpiresFeature::ExpiresConditionCheck(expiresOnDate), "code expired");
+#endif
@@ -0,0 +1,31 @@
+#pragma once
+
+// The switches of the module builds of the tools (import lsct.into; import lsct.expires; import lsct.debugxray;).
+//
+// Macros don't cross an import: a module interface is compiled with the switches it sees, and the TUs that import
+// it have to see the same ones, for their own #ifdefs and for the macros a module can't export (__EXPIRES__). So
+// this header is included by the module interface units (INTO/INTO.cppm, expires/expires.cppm,
+// debugfriend/debugxray.cppm) and by every TU that imports them; set the switches below or project-wide with -D,
+// but the same way for both. The header versions (INTO.h, expires.h, debugxray.h) don't need it.
+//
+//		#include "lsct_config.h"
+//		import lsct.into;
+//		import lsct.expires;
+//
+//		__EXPIRES__("20270101");
+//		into counter = 0;
+
+// INTO, see INTO/INTO_core.h and INTO/INTO_sampled.h
+//#define __DEBUG_CHECK_INTEGER_OVERFLOW
+//#define __DEBUG_CHECK_INTEGER_OVERFLOW_ALIAS
+//#define __DEBUG_CHECK_INTEGER_OVERFLOW_SAMPLED
+//#define __DEBUG_CHECK_INTEGER_OVERFLOW_NAMESPACE	into_checked
+
+// the operators' messages use typeid in templates instantiated by the importer, and GCC wants <typeinfo> seen
+// there; it's small
+#include <typeinfo>
+
+// expires: the check is made as of the importing TU's __DATE__, the module's own is the day it was built
+#ifndef __EXPIRES__
+#define __EXPIRES__(expiresOnDate)		static_assert(CodeExpiresFeature::ExpiresConditionCheck(expiresOnDate, __DATE__), "code expired");
+#endif
@@ -0,0 +1,452 @@
+#pragma once
+
+// Instrumented runtime for OPNEW_REPLACER-rewritten allocations, enabled by defining __LSCT_MEMMANAGER_INSTRUMENT
+// (project-wide, before including memmanager.h). Every LSCT_NEW/LSCT_NEW_ARRAY site gets a site ID and each
+// allocation is accounted to it: count, bytes, frees, lifetime histogram and the allocating threads.
+// Results can be written as a flat profile (DumpFlatProfile) or as a legacy pprof heap profile (WritePprofHeapProfile),
+// which `pprof -top <binary> <file>` understands.
+//
+// Site IDs are either baked in by the replacer (LSCT_NEW_AT(id, T, ...), ids 1..FIRST_DYNAMIC_SITE-1)
+// or handed out on the first execution of an LSCT_NEW(T, ...) site (a function-local static, so the hot path
+// pays one initialized-guard check for it). Counters live in per-thread shards that only their owner thread writes,
+// so an update is a relaxed load + store, no lock prefix; dumping may run concurrently with the program.
+//
+// Instrumented blocks carry a second 16-byte record after the block header with the site ID and the birth time,
+// so memory overhead is 16 bytes per allocation on top of the non-instrumented runtime.
+
+#ifndef __LSCT_MEMMANAGER_INSTRUMENT
+#define __LSCT_MEMMANAGER_INSTRUMENT
+#endif
+#include "memmanager.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+#if defined(__x86_64__) || defined(_M_X64)
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+namespace MemoryManager { namespace AllocSites {
+
+constexpr uint32_t MAX_SITES = 16384;
+constexpr uint32_t FIRST_DYNAMIC_SITE = MAX_SITES / 2;				// baked IDs must stay below this
+constexpr unsigned LIFETIME_BUCKETS = 32;							// bucket i: lifetime in [2^i, 2^(i+1)) clock ticks
+
+struct SiteTag
+{
+	uint32_t	id;
+	const char*	file;
+	unsigned	line;
+	const char*	typeName;
+};
+
+namespace details {
+
+struct SiteInfo
+{
+	std::atomic<const char*>	file;
+	std::atomic<unsigned>		line;
+	std::atomic<const char*>	typeName;
+	std::atomic<void*>			pc;					// return address of the first allocation, for pprof symbolization
+};
+
+struct SiteCounters
+{
+	std::atomic<uint64_t>	allocs;
+	std::atomic<uint64_t>	allocBytes;
+	std::atomic<uint64_t>	frees;
+	std::atomic<uint64_t>	freeBytes;
+	std::atomic<uint32_t>	lifetime[LIFETIME_BUCKETS];
+};
+
+struct Shard
+{
+	std::thread::id	thread;
+	SiteCounters*	counters;						// MAX_SITES entries, calloc'd: only pages of sites the thread uses get committed
+};
+
+inline SiteInfo* Sites()
+{
+	static SiteInfo sites[MAX_SITES] = {};
+	return sites;
+}
+
+inline std::mutex& ShardLock()
+{
+	static std::mutex lock;
+	return lock;
+}
+
+// shards are never freed, so counters of exited threads stay in the profile; the list itself is never destroyed
+// either, so a dump from an atexit handler still finds it
+inline std::vector<Shard>& Shards()
+{
+	static std::vector<Shard>* shards = new std::vector<Shard>();
+	return *shards;
+}
+
+inline SiteCounters* LocalShard()
+{
+	static thread_local SiteCounters* local = nullptr;
+	if (!local)
+	{
+		local = static_cast<SiteCounters*>(std::calloc(MAX_SITES, sizeof(SiteCounters)));
+		if (!local)
+			throw std::bad_alloc();
+		std::lock_guard<std::mutex> guard(ShardLock());
+		Shards().push_back(Shard{ std::this_thread::get_id(), local });
+	}
+	return local;
+}
+
+// single writer per shard: no need for a locked read-modify-write
+template <typename C> inline void Bump(std::atomic<C>& counter, C by)
+{
+	counter.store(counter.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+}
+
+// coarse ticks, only differences matter; 32 bits of TSC/1024 wrap after ~20 minutes at 3GHz,
+// longer-living objects land in a random bucket (they are rare in the allocation-heavy paths this is for)
+inline uint32_t Now()
+{
+#if defined(__x86_64__) || defined(_M_X64)
+	return static_cast<uint32_t>(__rdtsc() >> 10);
+#else
+	return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+inline double TicksPerSecond()
+{
+#if defined(__x86_64__) || defined(_M_X64)
+	static const double ticksPerSecond = []() {
+		const auto t0 = std::chrono::steady_clock::now();
+		const uint64_t c0 = __rdtsc();
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		const uint64_t c1 = __rdtsc();
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+		return double(c1 - c0) / 1024.0 / seconds;
+	}();
+	return ticksPerSecond;
+#else
+	return 1e6;
+#endif
+}
+
+inline std::atomic<uint32_t>& NextDynamicSite()
+{
+	static std::atomic<uint32_t> next{ FIRST_DYNAMIC_SITE };
+	return next;
+}
+
+// racing first allocations at the same site may both get here, they store the same values
+inline void DescribeSite(const SiteTag& tag, void* pc)
+{
+	SiteInfo& info = Sites()[tag.id];
+	if (!info.file.load(std::memory_order_relaxed))
+	{
+		info.line.store(tag.line, std::memory_order_relaxed);
+		info.typeName.store(tag.typeName, std::memory_order_relaxed);
+		info.file.store(tag.file, std::memory_order_release);
+	}
+	if (pc)
+		info.pc.store(pc, std::memory_order_relaxed);
+}
+
+#if defined(_MSC_VER)
+#define LSCT_ALLOCSITES_NOINLINE	__declspec(noinline)
+#define LSCT_ALLOCSITES_CALLER_PC	_ReturnAddress()
+#else
+#define LSCT_ALLOCSITES_NOINLINE	__attribute__((noinline))
+#define LSCT_ALLOCSITES_CALLER_PC	__builtin_return_address(0)
+#endif
+
+// outer block: [BlockHeader: class, -, requested size][site record: SITE_RECORD, count, site<<32|birth][payload]
+LSCT_ALLOCSITES_NOINLINE inline void* AllocateAt(const SiteTag& tag, size_t size, uint32_t count)
+{
+	if (tag.id == 0 || tag.id >= MAX_SITES)
+		std::abort();
+	void* outer = MemoryManager::Allocate(size + MemoryManager::details::HEADER_SIZE);
+	MemoryManager::details::HeaderOf(outer)->reserved = size;
+	MemoryManager::details::BlockHeader* record = static_cast<MemoryManager::details::BlockHeader*>(outer);
+	record->sizeClass = MemoryManager::details::SITE_RECORD;
+	record->count = count;
+	record->reserved = (uint64_t(tag.id) << 32) | Now();
+	if (!Sites()[tag.id].pc.load(std::memory_order_relaxed))
+		DescribeSite(tag, LSCT_ALLOCSITES_CALLER_PC);
+	SiteCounters& counters = LocalShard()[tag.id];
+	Bump<uint64_t>(counters.allocs, 1);
+	Bump<uint64_t>(counters.allocBytes, size);
+	return record + 1;
+}
+
+inline void AccountFree(void* payload)
+{
+	MemoryManager::details::BlockHeader* record = MemoryManager::details::HeaderOf(payload);
+	if (record->sizeClass != MemoryManager::details::SITE_RECORD)
+		return;												// pooled/arena block from a non-instrumented path
+	const uint32_t site = static_cast<uint32_t>(record->reserved >> 32);
+	const uint32_t lifetime = Now() - static_cast<uint32_t>(record->reserved);
+	const uint64_t size = MemoryManager::details::HeaderOf(record)->reserved;
+	SiteCounters& counters = LocalShard()[site];
+	Bump<uint64_t>(counters.frees, 1);
+	Bump<uint64_t>(counters.freeBytes, size);
+	Bump<uint32_t>(counters.lifetime[lifetime ? MemoryManager::details::FloorLog2(lifetime) : 0], 1);
+}
+
+} // namespace details
+
+// baked IDs share the table with the dynamic ones, an ID from the dynamic half would merge two sites' counters
+inline uint32_t BakedSite(uint32_t id)
+{
+	if (id == 0 || id >= FIRST_DYNAMIC_SITE)
+		std::abort();
+	return id;
+}
+
+inline uint32_t RegisterSite(const char* file, unsigned line, const char* typeName)
+{
+	const uint32_t id = details::NextDynamicSite().fetch_add(1, std::memory_order_relaxed);
+	if (id >= MAX_SITES)
+		return MAX_SITES - 1;								// overflow site: everything beyond the table is lumped here
+	details::DescribeSite(SiteTag{ id, file, line, typeName }, nullptr);
+	return id;
+}
+
+template <typename T, typename... Args> T* New(const SiteTag& tag, Args&&... args)
+{
+	static_assert(alignof(T) <= MemoryManager::details::HEADER_SIZE, "over-aligned types are not supported by LSCT_NEW, exclude them from the replacement");
+	void* memory = details::AllocateAt(tag, sizeof(T), 1);
+	try
+	{
+		return ::new (memory) T(std::forward<Args>(args)...);
+	}
+	catch (...)
+	{
+		details::AccountFree(memory);
+		MemoryManager::Deallocate(memory);
+		throw;
+	}
+}
+
+template <typename T> T* NewArray(const SiteTag& tag, size_t count)
+{
+	static_assert(alignof(T) <= MemoryManager::details::HEADER_SIZE, "over-aligned types are not supported by LSCT_NEW_ARRAY, exclude them from the replacement");
+	if (count > (SIZE_MAX - 2 * MemoryManager::details::HEADER_SIZE) / (sizeof(T) ? sizeof(T) : 1) || count > UINT32_MAX)
+		throw std::bad_array_new_length();
+	void* memory = details::AllocateAt(tag, count * sizeof(T), static_cast<uint32_t>(count));
+	T* first = static_cast<T*>(memory);
+	size_t constructed = 0;
+	try
+	{
+		for (; constructed < count; ++constructed)
+			::new (static_cast<void*>(first + constructed)) T;
+	}
+	catch (...)
+	{
+		while (constructed)
+			first[--constructed].~T();
+		details::AccountFree(memory);
+		MemoryManager::Deallocate(memory);
+		throw;
+	}
+	return first;
+}
+
+template <typename T> void Delete(T* object)
+{
+	if (!object)
+		return;
+	void* memory;
+	if constexpr (std::is_polymorphic<T>::value)
+		memory = dynamic_cast<void*>(object);
+	else
+		memory = object;
+	object->~T();
+	details::AccountFree(memory);
+	MemoryManager::Deallocate(memory);
+}
+
+template <typename T> void DeleteArray(T* first)
+{
+	if (!first)
+		return;
+	size_t count = MemoryManager::details::HeaderOf(first)->count;
+	while (count)
+		first[--count].~T();
+	details::AccountFree(first);
+	MemoryManager::Deallocate(first);
+}
+
+struct SiteSummary
+{
+	uint32_t	id;
+	const char*	file;
+	unsigned	line;
+	const char*	typeName;
+	void*		pc;
+	uint64_t	allocs, allocBytes, frees, freeBytes;
+	uint64_t	lifetime[LIFETIME_BUCKETS];
+	unsigned	threads;						// number of threads that allocated at this site
+	std::thread::id	topThread;					// ...and the one that allocated the most
+	uint64_t	topThreadAllocs;
+};
+
+// aggregates all shards; safe to call while other threads keep allocating (counts are then approximate)
+inline std::vector<SiteSummary> Collect()
+{
+	std::vector<SiteSummary> summaries;
+	std::lock_guard<std::mutex> guard(details::ShardLock());
+	const uint32_t used = std::min(details::NextDynamicSite().load(), MAX_SITES);
+	for (uint32_t id = 1; id < used; ++id)
+	{
+		const details::SiteInfo& info = details::Sites()[id];
+		SiteSummary s{};
+		s.id = id;
+		for (const details::Shard& shard : details::Shards())
+		{
+			const details::SiteCounters& c = shard.counters[id];
+			const uint64_t allocs = c.allocs.load(std::memory_order_relaxed);
+			s.allocs += allocs;
+			s.allocBytes += c.allocBytes.load(std::memory_order_relaxed);
+			s.frees += c.frees.load(std::memory_order_relaxed);
+			s.freeBytes += c.freeBytes.load(std::memory_order_relaxed);
+			for (unsigned b = 0; b < LIFETIME_BUCKETS; ++b)
+				s.lifetime[b] += c.lifetime[b].load(std::memory_order_relaxed);
+			if (allocs)
+			{
+				s.threads++;
+				if (allocs > s.topThreadAllocs)
+				{
+					s.topThreadAllocs = allocs;
+					s.topThread = shard.thread;
+				}
+			}
+		}
+		if (!s.allocs && !s.frees)
+			continue;
+		s.file = info.file.load(std::memory_order_acquire);
+		s.line = info.line.load(std::memory_order_relaxed);
+		s.typeName = info.typeName.load(std::memory_order_relaxed);
+		s.pc = info.pc.load(std::memory_order_relaxed);
+		summaries.push_back(s);
+	}
+	std::sort(summaries.begin(), summaries.end(), [](const SiteSummary& a, const SiteSummary& b) { return a.allocBytes > b.allocBytes; });
+	return summaries;
+}
+
+namespace details {
+
+inline std::string FormatDuration(double seconds)
+{
+	char buf[32];
+	if (seconds < 1e-6)			std::snprintf(buf, sizeof(buf), "%.0fns", seconds * 1e9);
+	else if (seconds < 1e-3)	std::snprintf(buf, sizeof(buf), "%.1fus", seconds * 1e6);
+	else if (seconds < 1.0)		std::snprintf(buf, sizeof(buf), "%.1fms", seconds * 1e3);
+	else						std::snprintf(buf, sizeof(buf), "%.1fs", seconds);
+	return buf;
+}
+
+// upper bound of the bucket that contains the given fraction of the frees
+inline std::string LifetimePercentile(const SiteSummary& s, double fraction)
+{
+	uint64_t total = 0;
+	for (uint64_t n : s.lifetime) total += n;
+	if (!total)
+		return "-";
+	uint64_t seen = 0;
+	for (unsigned b = 0; b < LIFETIME_BUCKETS; ++b)
+	{
+		seen += s.lifetime[b];
+		if (seen >= fraction * total)
+			return "<" + FormatDuration(double(uint64_t(2) << b) / TicksPerSecond());
+	}
+	return "-";
+}
+
+} // namespace details
+
+// One line per site, heaviest (by allocated bytes) first. The p50/p90 lifetime columns are bucket upper bounds.
+inline void DumpFlatProfile(std::ostream& os)
+{
+	const std::vector<SiteSummary> summaries = Collect();
+	uint64_t totalBytes = 0;
+	for (const SiteSummary& s : summaries) totalBytes += s.allocBytes;
+	os << "# site\tallocs\tbytes\t%bytes\tavg\tlive_objs\tlive_bytes\tlife_p50\tlife_p90\tthreads\ttop_thread_share\tlocation\n";
+	for (const SiteSummary& s : summaries)
+	{
+		char pct[16];
+		std::snprintf(pct, sizeof(pct), "%.2f%%", totalBytes ? 100.0 * s.allocBytes / totalBytes : 0.0);
+		char share[16];
+		std::snprintf(share, sizeof(share), "%.0f%%", s.allocs ? 100.0 * s.topThreadAllocs / s.allocs : 0.0);
+		os << s.id << "\t" << s.allocs << "\t" << s.allocBytes << "\t" << pct << "\t" << (s.allocs ? s.allocBytes / s.allocs : 0) << "\t"
+			<< s.allocs - s.frees << "\t" << s.allocBytes - s.freeBytes << "\t"
+			<< details::LifetimePercentile(s, 0.5) << "\t" << details::LifetimePercentile(s, 0.9) << "\t"
+			<< s.threads << "\t" << share << "\t"
+			<< (s.file ? s.file : "?") << ":" << s.line << " " << (s.typeName ? s.typeName : "") << "\n";
+	}
+}
+
+// Legacy text heap profile ("heap_v2" with sampling period 1, i.e. exact counts), one single-frame stack per site.
+// The frame is the return address recorded at the first allocation of the site; /proc/self/maps is appended
+// so pprof can symbolize it against the binary.
+inline void WritePprofHeapProfile(std::ostream& os)
+{
+	const std::vector<SiteSummary> summaries = Collect();
+	uint64_t inuseObjs = 0, inuseBytes = 0, allocObjs = 0, allocBytes = 0;
+	for (const SiteSummary& s : summaries)
+	{
+		inuseObjs += s.allocs - s.frees;	inuseBytes += s.allocBytes - s.freeBytes;
+		allocObjs += s.allocs;				allocBytes += s.allocBytes;
+	}
+	os << "heap profile: " << inuseObjs << ": " << inuseBytes << " [" << allocObjs << ": " << allocBytes << "] @ heap_v2/1\n";
+	for (const SiteSummary& s : summaries)
+	{
+		// sites registered without a return address get a synthetic one, unique per site
+		const uintptr_t frame = s.pc ? reinterpret_cast<uintptr_t>(s.pc) : uintptr_t(s.id);
+		char addr[24];
+		std::snprintf(addr, sizeof(addr), "0x%llx", static_cast<unsigned long long>(frame));
+		os << " " << s.allocs - s.frees << ": " << s.allocBytes - s.freeBytes << " [" << s.allocs << ": " << s.allocBytes << "] @ " << addr << "\n";
+	}
+	os << "\nMAPPED_LIBRARIES:\n";
+	std::ifstream maps("/proc/self/maps");
+	os << maps.rdbuf();
+}
+
+// writes the profiles on normal exit; the arguments must outlive the program (string literals, getenv results)
+inline void DumpAtExit(const char* flatProfilePath, const char* pprofPath)
+{
+	static const char* s_flat = flatProfilePath;
+	static const char* s_pprof = pprofPath;
+	std::atexit([]() {
+		if (s_flat) { std::ofstream ofs(s_flat); DumpFlatProfile(ofs); }
+		if (s_pprof) { std::ofstream ofs(s_pprof); WritePprofHeapProfile(ofs); }
+	});
+}
+
+} } // namespace MemoryManager::AllocSites
+
+#define LSCT_ALLOCSITES_DYNAMIC_TAG(T)			::MemoryManager::AllocSites::SiteTag{ \
+	[]() { static const uint32_t id = ::MemoryManager::AllocSites::RegisterSite(__FILE__, __LINE__, #T); return id; }(), __FILE__, __LINE__, #T }
+#define LSCT_ALLOCSITES_BAKED_TAG(site, T)		::MemoryManager::AllocSites::SiteTag{ ::MemoryManager::AllocSites::BakedSite(site), __FILE__, __LINE__, #T }
+
+#define LSCT_NEW(T, ...)				(::MemoryManager::AllocSites::New<T>(LSCT_ALLOCSITES_DYNAMIC_TAG(T), ##__VA_ARGS__))
+#define LSCT_NEW_AT(site, T, ...)		(::MemoryManager::AllocSites::New<T>(LSCT_ALLOCSITES_BAKED_TAG(site, T), ##__VA_ARGS__))
+#define LSCT_ARENA_NEW(T, ...)			(::MemoryManager::ArenaNew<T>(__VA_ARGS__))
+#define LSCT_DELETE(p)					(::MemoryManager::AllocSites::Delete(p))
+#define LSCT_NEW_ARRAY(T, n)			(::MemoryManager::AllocSites::NewArray<T>(LSCT_ALLOCSITES_DYNAMIC_TAG(T), n))
+#define LSCT_NEW_ARRAY_AT(site, T, n)	(::MemoryManager::AllocSites::NewArray<T>(LSCT_ALLOCSITES_BAKED_TAG(site, T), n))
+#define LSCT_DELETE_ARRAY(p)			(::MemoryManager::AllocSites::DeleteArray(p))
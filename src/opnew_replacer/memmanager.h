@@ -0,0 +1,589 @@
+#pragma once
+
+// Allocator runtime for code rewritten by OPNEW_REPLACER. The replacer turns
+//		new T(args...)		into	LSCT_NEW(T, args...)
+//		delete p			into	LSCT_DELETE(p)
+//		new T[n]			into	LSCT_NEW_ARRAY(T, n)
+//		delete[] p			into	LSCT_DELETE_ARRAY(p)
+// and these macros end up here. Three allocators are provided:
+// - a size-class pool with per-thread caches (what LSCT_NEW uses),
+// - bump-pointer arenas with marker/rewind and an RAII scope (LSCT_ARENA_NEW),
+// - fixed-size per-type object pools (ObjectPool<T>), owned by the caller.
+// Every block handed out by the macros carries a 16-byte header in front of it that tells
+// LSCT_DELETE where the block came from, so an LSCT_DELETE never needs to know which allocator
+// was used, and blocks may be freed on a different thread than the one that allocated them.
+// Define __LSCT_MEMMANAGER_DISABLE to make the macros expand to plain new/delete again
+// (handy for A/B measurements and for running under ASan/valgrind).
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <mutex>
+#include <utility>
+#include <type_traits>
+
+namespace MemoryManager {
+
+namespace details {
+
+constexpr size_t HEADER_SIZE = 16;									// keeps payloads aligned to alignof(std::max_align_t) on common ABIs
+constexpr size_t SMALL_CLASS_STEP = 16;								// classes 16, 32 ... 256 are spaced by this
+constexpr size_t SMALL_CLASS_LIMIT = 256;
+constexpr size_t MAX_POOLED_SIZE = 32768;							// above this (header included) blocks go straight to malloc
+constexpr size_t SUBCLASSES_PER_DOUBLING = 4;						// 256..32768: four classes per power of two (<= 25% internal waste)
+constexpr uint32_t NUM_SIZE_CLASSES = 16 + 7 * 4;
+constexpr uint32_t LARGE_BLOCK = 0xFFFF'FFF0;						// sizeClass tags for blocks that are not pool-owned
+constexpr uint32_t ARENA_BLOCK = 0xFFFF'FFF1;
+constexpr uint32_t SITE_RECORD = 0xFFFF'FFF2;						// instrumented blocks: a second header-shaped record follows the real header
+
+constexpr uint32_t THREAD_CACHE_BATCH = 32;						// blocks moved between thread cache and central list at once
+constexpr uint32_t THREAD_CACHE_LIMIT = 2 * THREAD_CACHE_BATCH;		// thread cache gives back a batch above this
+constexpr size_t SLAB_SIZE = 64 * 1024;							// central list refills carve slabs of (at least) this size
+
+struct BlockHeader
+{
+	uint32_t	sizeClass;			// size class index, LARGE_BLOCK, ARENA_BLOCK or SITE_RECORD
+	uint32_t	count;				// number of elements for LSCT_NEW_ARRAY blocks, 1 otherwise
+	uint64_t	reserved;			// used by the instrumented runtime (see allocsites.h)
+};
+static_assert(sizeof(BlockHeader) == HEADER_SIZE, "BlockHeader must be exactly HEADER_SIZE bytes");
+
+inline unsigned FloorLog2(size_t value)
+{
+#ifdef _MSC_VER
+	unsigned long idx;
+	_BitScanReverse64(&idx, value);
+	return static_cast<unsigned>(idx);
+#else
+	return static_cast<unsigned>(63 - __builtin_clzll(value));
+#endif
+}
+
+// size here always includes the header, so it's never below HEADER_SIZE
+inline uint32_t SizeToClass(size_t size)
+{
+	if (size <= SMALL_CLASS_LIMIT)
+		return static_cast<uint32_t>((size + SMALL_CLASS_STEP - 1) / SMALL_CLASS_STEP - 1);
+	const unsigned lg = FloorLog2(size - 1);						// 8..14
+	const size_t sub = ((size - 1) >> (lg - 2)) & (SUBCLASSES_PER_DOUBLING - 1);
+	return static_cast<uint32_t>(16 + (lg - 8) * SUBCLASSES_PER_DOUBLING + sub);
+}
+
+constexpr size_t ClassToSize(uint32_t sizeClass)
+{
+	return
+		sizeClass < 16 ?
+		(sizeClass + 1) * SMALL_CLASS_STEP :
+		(size_t(1) << (8 + (sizeClass - 16) / 4)) + ((sizeClass - 16) % 4 + 1) * (size_t(1) << (6 + (sizeClass - 16) / 4));
+}
+static_assert(ClassToSize(NUM_SIZE_CLASSES - 1) == MAX_POOLED_SIZE, "size class table does not end at MAX_POOLED_SIZE");
+
+struct FreeNode { FreeNode* next; };
+
+// One per size class, shared by all threads. Only touched when a thread cache runs dry or overflows,
+// and then always a whole batch at a time, so the mutex is taken once per THREAD_CACHE_BATCH operations at most.
+struct CentralList
+{
+	std::mutex	lock;
+	FreeNode*	head = nullptr;
+	size_t		count = 0;
+};
+
+inline CentralList* CentralLists()
+{
+	static CentralList lists[NUM_SIZE_CLASSES];
+	return lists;
+}
+
+// Slabs are never returned to the system: the pool is sized by the peak, like most thread-caching allocators.
+inline FreeNode* CarveSlab(uint32_t sizeClass, size_t& carvedCount)
+{
+	const size_t blockSize = ClassToSize(sizeClass);
+	const size_t blocks = SLAB_SIZE / blockSize > THREAD_CACHE_BATCH ? SLAB_SIZE / blockSize : THREAD_CACHE_BATCH;
+	char* slab = static_cast<char*>(std::malloc(blocks * blockSize));
+	if (!slab)
+		throw std::bad_alloc();
+	for (size_t i = 0; i < blocks - 1; ++i)
+		reinterpret_cast<FreeNode*>(slab + i * blockSize)->next = reinterpret_cast<FreeNode*>(slab + (i + 1) * blockSize);
+	reinterpret_cast<FreeNode*>(slab + (blocks - 1) * blockSize)->next = nullptr;
+	carvedCount = blocks;
+	return reinterpret_cast<FreeNode*>(slab);
+}
+
+struct ThreadCache
+{
+	FreeNode*	heads[NUM_SIZE_CLASSES] = {};
+	uint32_t	counts[NUM_SIZE_CLASSES] = {};
+
+	FreeNode* Refill(uint32_t sizeClass)
+	{
+		CentralList& central = CentralLists()[sizeClass];
+		std::lock_guard<std::mutex> guard(central.lock);
+		if (!central.head)
+		{
+			size_t carved;
+			central.head = CarveSlab(sizeClass, carved);
+			central.count = carved;
+		}
+		FreeNode* first = central.head;
+		FreeNode* last = first;
+		uint32_t taken = 1;
+		while (taken < THREAD_CACHE_BATCH && last->next)
+		{
+			last = last->next;
+			++taken;
+		}
+		central.head = last->next;
+		central.count -= taken;
+		last->next = nullptr;
+		counts[sizeClass] = taken;
+		return first;
+	}
+
+	void Release(uint32_t sizeClass, uint32_t howMany)
+	{
+		FreeNode* first = heads[sizeClass];
+		FreeNode* last = first;
+		for (uint32_t i = 1; i < howMany; ++i)
+			last = last->next;
+		heads[sizeClass] = last->next;
+		counts[sizeClass] -= howMany;
+		CentralList& central = CentralLists()[sizeClass];
+		std::lock_guard<std::mutex> guard(central.lock);
+		last->next = central.head;
+		central.head = first;
+		central.count += howMany;
+	}
+
+	~ThreadCache()
+	{
+		for (uint32_t c = 0; c < NUM_SIZE_CLASSES; ++c)
+			if (counts[c])
+				Release(c, counts[c]);
+	}
+};
+
+// Set once the thread's cache has been destroyed: allocations made from later-running thread_local
+// destructors then go through the central lists directly (slow, but correct).
+inline bool& ThreadCacheGone()
+{
+	static thread_local bool gone = false;
+	return gone;
+}
+
+struct ThreadCacheOwner
+{
+	ThreadCache cache;
+	~ThreadCacheOwner() { ThreadCacheGone() = true; }
+};
+
+inline ThreadCache* GetThreadCache()
+{
+	if (ThreadCacheGone())
+		return nullptr;
+	static thread_local ThreadCacheOwner owner;
+	return &owner.cache;
+}
+
+inline void* PopBlock(uint32_t sizeClass)
+{
+	ThreadCache* cache = GetThreadCache();
+	if (!cache)
+	{
+		ThreadCache transient;
+		FreeNode* node = transient.Refill(sizeClass);
+		transient.heads[sizeClass] = node->next;
+		transient.counts[sizeClass]--;
+		return node;												// rest of the batch goes back in ~ThreadCache
+	}
+	FreeNode* node = cache->heads[sizeClass];
+	if (!node)
+		node = cache->Refill(sizeClass);
+	cache->heads[sizeClass] = node->next;
+	cache->counts[sizeClass]--;
+	return node;
+}
+
+inline void PushBlock(uint32_t sizeClass, void* block)
+{
+	FreeNode* node = static_cast<FreeNode*>(block);
+	ThreadCache* cache = GetThreadCache();
+	if (!cache)
+	{
+		CentralList& central = CentralLists()[sizeClass];
+		std::lock_guard<std::mutex> guard(central.lock);
+		node->next = central.head;
+		central.head = node;
+		central.count++;
+		return;
+	}
+	node->next = cache->heads[sizeClass];
+	cache->heads[sizeClass] = node;
+	if (++cache->counts[sizeClass] > THREAD_CACHE_LIMIT)
+		cache->Release(sizeClass, THREAD_CACHE_BATCH);
+}
+
+inline BlockHeader* HeaderOf(void* payload)
+{
+	return static_cast<BlockHeader*>(payload) - 1;
+}
+
+} // namespace details
+
+// Raw interface of the size-class pool. Returned memory is aligned to details::HEADER_SIZE.
+inline void* Allocate(size_t size)
+{
+	const size_t total = size + details::HEADER_SIZE;
+	details::BlockHeader* header;
+	if (total <= details::MAX_POOLED_SIZE && total > size)
+	{
+		const uint32_t sizeClass = details::SizeToClass(total);
+		header = static_cast<details::BlockHeader*>(details::PopBlock(sizeClass));
+		header->sizeClass = sizeClass;
+	}
+	else
+	{
+		if (total < size)
+			throw std::bad_alloc();
+		header = static_cast<details::BlockHeader*>(std::malloc(total));
+		if (!header)
+			throw std::bad_alloc();
+		header->sizeClass = details::LARGE_BLOCK;
+	}
+	header->count = 1;
+	header->reserved = 0;
+	return header + 1;
+}
+
+inline void Deallocate(void* payload)
+{
+	if (!payload)
+		return;
+	details::BlockHeader* header = details::HeaderOf(payload);
+	switch (header->sizeClass)
+	{
+	case details::LARGE_BLOCK:
+		std::free(header);
+		break;
+	case details::ARENA_BLOCK:										// released together with the arena (or its scope)
+		break;
+	case details::SITE_RECORD:										// the real block header is the one before
+		Deallocate(header);
+		break;
+	default:
+		details::PushBlock(header->sizeClass, header);
+	}
+}
+
+// Bump-pointer arena. Memory is given back only by RewindTo()/Reset() or on destruction;
+// chunks are kept across rewinds, so a warmed-up arena that is reset per request does not call malloc at all.
+// Not thread-safe: one arena per thread (or per request) is the intended use.
+class Arena {
+public:
+	struct Marker
+	{
+		void*	chunk;
+		char*	cursor;
+	};
+
+	explicit Arena(size_t chunkSize = 64 * 1024) :
+		m_chunkSize(chunkSize) {}
+	Arena(const Arena&) = delete;
+	Arena& operator= (const Arena&) = delete;
+	~Arena()
+	{
+		Chunk* chunk = m_first;
+		while (chunk)
+		{
+			Chunk* next = chunk->next;
+			std::free(chunk);
+			chunk = next;
+		}
+	}
+
+	void* Allocate(size_t size, size_t align = alignof(std::max_align_t))
+	{
+		char* aligned = AlignUp(m_cursor, align);
+		if (!m_current || aligned + size > m_end || aligned < m_cursor)
+		{
+			NextChunk(size + align);
+			aligned = AlignUp(m_cursor, align);
+		}
+		m_cursor = aligned + size;
+		return aligned;
+	}
+
+	// object lifetimes are the caller's business: destructors are not run on rewind
+	template <typename T, typename... Args> T* New(Args&&... args)
+	{
+		return ::new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+	}
+
+	Marker GetMarker() const { return Marker{ m_current, m_cursor }; }
+	void RewindTo(const Marker& marker)
+	{
+		m_current = static_cast<Chunk*>(marker.chunk);
+		m_cursor = marker.cursor;
+		m_end = m_current ? m_current->End() : nullptr;
+	}
+	void Reset()
+	{
+		m_current = m_first;
+		m_cursor = m_current ? m_current->Begin() : nullptr;
+		m_end = m_current ? m_current->End() : nullptr;
+	}
+
+private:
+	struct Chunk
+	{
+		Chunk*	next;
+		size_t	size;
+		char* Begin() { return reinterpret_cast<char*>(this) + sizeof(Chunk); }
+		char* End() { return Begin() + size; }
+	};
+	static_assert(sizeof(Chunk) % alignof(std::max_align_t) == 0, "chunk payload would be misaligned");
+
+	static char* AlignUp(char* ptr, size_t align)
+	{
+		return reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(ptr) + align - 1) & ~(uintptr_t(align) - 1));
+	}
+
+	// moves to the next retained chunk if it's big enough, otherwise links a fresh one in after the current
+	void NextChunk(size_t atLeast)
+	{
+		Chunk* next = m_current ? m_current->next : m_first;
+		if (!next || next->size < atLeast)
+		{
+			const size_t size = atLeast > m_chunkSize ? atLeast : m_chunkSize;
+			Chunk* fresh = static_cast<Chunk*>(std::malloc(sizeof(Chunk) + size));
+			if (!fresh)
+				throw std::bad_alloc();
+			fresh->size = size;
+			fresh->next = next;
+			if (m_current)
+				m_current->next = fresh;
+			else
+				m_first = fresh;
+			next = fresh;
+		}
+		m_current = next;
+		m_cursor = next->Begin();
+		m_end = next->End();
+	}
+
+	size_t	m_chunkSize;
+	Chunk*	m_first = nullptr;
+	Chunk*	m_current = nullptr;
+	char*	m_cursor = nullptr;
+	char*	m_end = nullptr;
+};
+
+namespace details {
+
+inline Arena*& CurrentArena()
+{
+	static thread_local Arena* current = nullptr;
+	return current;
+}
+
+} // namespace details
+
+// Makes `arena` the target of LSCT_ARENA_NEW on this thread and rewinds it to the entry state on exit.
+// Scopes nest; typical use is one scope per handled request around a thread-local arena.
+class ArenaScope {
+public:
+	explicit ArenaScope(Arena& arena) :
+		m_arena(arena), m_marker(arena.GetMarker()), m_previous(details::CurrentArena())
+	{
+		details::CurrentArena() = &arena;
+	}
+	ArenaScope(const ArenaScope&) = delete;
+	ArenaScope& operator= (const ArenaScope&) = delete;
+	~ArenaScope()
+	{
+		m_arena.RewindTo(m_marker);
+		details::CurrentArena() = m_previous;
+	}
+private:
+	Arena&			m_arena;
+	Arena::Marker	m_marker;
+	Arena*			m_previous;
+};
+
+// Fixed-size pool for one type. Not thread-safe and not header-tagged: objects must go back to the
+// pool they came from (Destroy), on the owning thread. Memory is released when the pool is destroyed.
+template <typename T, size_t SlotsPerChunk = 256>
+class ObjectPool {
+public:
+	ObjectPool() = default;
+	ObjectPool(const ObjectPool&) = delete;
+	ObjectPool& operator= (const ObjectPool&) = delete;
+	~ObjectPool()
+	{
+		while (m_chunks)
+		{
+			ChunkLink* next = m_chunks->next;
+			::operator delete(static_cast<void*>(m_chunks), std::align_val_t(ALIGN));
+			m_chunks = next;
+		}
+	}
+
+	template <typename... Args> T* Create(Args&&... args)
+	{
+		if (!m_free)
+			Grow();
+		Slot* slot = m_free;
+		m_free = slot->next;
+		try
+		{
+			return ::new (static_cast<void*>(slot)) T(std::forward<Args>(args)...);
+		}
+		catch (...)
+		{
+			slot->next = m_free;
+			m_free = slot;
+			throw;
+		}
+	}
+
+	void Destroy(T* object)
+	{
+		if (!object)
+			return;
+		object->~T();
+		Slot* slot = reinterpret_cast<Slot*>(object);
+		slot->next = m_free;
+		m_free = slot;
+	}
+
+private:
+	union Slot
+	{
+		Slot* next;
+		alignas(T) unsigned char storage[sizeof(T)];
+	};
+	struct ChunkLink { ChunkLink* next; };
+	static constexpr size_t ALIGN = alignof(Slot) > alignof(ChunkLink) ? alignof(Slot) : alignof(ChunkLink);
+	static constexpr size_t LINK_SPACE = (sizeof(ChunkLink) + alignof(Slot) - 1) / alignof(Slot) * alignof(Slot);
+
+	void Grow()
+	{
+		void* raw = ::operator new(LINK_SPACE + SlotsPerChunk * sizeof(Slot), std::align_val_t(ALIGN));
+		ChunkLink* link = static_cast<ChunkLink*>(raw);
+		link->next = m_chunks;
+		m_chunks = link;
+		Slot* slots = reinterpret_cast<Slot*>(static_cast<char*>(raw) + LINK_SPACE);
+		for (size_t i = 0; i < SlotsPerChunk; ++i)
+		{
+			slots[i].next = m_free;
+			m_free = &slots[i];
+		}
+	}
+
+	ChunkLink*	m_chunks = nullptr;
+	Slot*		m_free = nullptr;
+};
+
+// typed entry points used by the macros
+
+template <typename T, typename... Args> T* New(Args&&... args)
+{
+	static_assert(alignof(T) <= details::HEADER_SIZE, "over-aligned types are not supported by LSCT_NEW, exclude them from the replacement");
+	void* memory = Allocate(sizeof(T));
+	try
+	{
+		return ::new (memory) T(std::forward<Args>(args)...);
+	}
+	catch (...)
+	{
+		Deallocate(memory);
+		throw;
+	}
+}
+
+// Uses the arena of the innermost ArenaScope on this thread, falls back to the pool when there's none.
+// The block is header-tagged, so an LSCT_DELETE on it runs the destructor and leaves the memory to the arena.
+template <typename T, typename... Args> T* ArenaNew(Args&&... args)
+{
+	static_assert(alignof(T) <= details::HEADER_SIZE, "over-aligned types are not supported by LSCT_ARENA_NEW, exclude them from the replacement");
+	Arena* arena = details::CurrentArena();
+	if (!arena)
+		return New<T>(std::forward<Args>(args)...);
+	details::BlockHeader* header = static_cast<details::BlockHeader*>(arena->Allocate(details::HEADER_SIZE + sizeof(T), details::HEADER_SIZE));
+	header->sizeClass = details::ARENA_BLOCK;
+	header->count = 1;
+	header->reserved = 0;
+	return ::new (static_cast<void*>(header + 1)) T(std::forward<Args>(args)...);
+}
+
+template <typename T> void Delete(T* object)
+{
+	if (!object)
+		return;
+	void* memory;
+	if constexpr (std::is_polymorphic<T>::value)
+		memory = dynamic_cast<void*>(object);						// deleting through a (non-first) base pointer
+	else
+		memory = object;
+	object->~T();
+	Deallocate(memory);
+}
+
+template <typename T> T* NewArray(size_t count)
+{
+	static_assert(alignof(T) <= details::HEADER_SIZE, "over-aligned types are not supported by LSCT_NEW_ARRAY, exclude them from the replacement");
+	if (count > (SIZE_MAX - details::HEADER_SIZE) / (sizeof(T) ? sizeof(T) : 1) || count > UINT32_MAX)
+		throw std::bad_array_new_length();
+	void* memory = Allocate(count * sizeof(T));
+	details::HeaderOf(memory)->count = static_cast<uint32_t>(count);
+	T* first = static_cast<T*>(memory);
+	size_t constructed = 0;
+	try
+	{
+		for (; constructed < count; ++constructed)
+			::new (static_cast<void*>(first + constructed)) T;
+	}
+	catch (...)
+	{
+		while (constructed)
+			first[--constructed].~T();
+		Deallocate(memory);
+		throw;
+	}
+	return first;
+}
+
+template <typename T> void DeleteArray(T* first)
+{
+	if (!first)
+		return;
+	size_t count = details::HeaderOf(first)->count;
+	while (count)
+		first[--count].~T();
+	Deallocate(first);
+}
+
+} // namespace MemoryManager
+
+// The *_AT variants are what the replacer emits when it bakes a static site ID into each rewritten call;
+// the ID only matters for the instrumented runtime, see allocsites.h.
+#if defined(__LSCT_MEMMANAGER_DISABLE)
+#define LSCT_NEW(T, ...)				(new T(__VA_ARGS__))
+#define LSCT_NEW_AT(site, T, ...)		(new T(__VA_ARGS__))
+#define LSCT_ARENA_NEW(T, ...)			(new T(__VA_ARGS__))
+#define LSCT_DELETE(p)					(delete (p))
+#define LSCT_NEW_ARRAY(T, n)			(new T[n])
+#define LSCT_NEW_ARRAY_AT(site, T, n)	(new T[n])
+#define LSCT_DELETE_ARRAY(p)			(delete[] (p))
+#elif defined(__LSCT_MEMMANAGER_INSTRUMENT)
+#include "allocsites.h"														// defines the LSCT_* macros with per-site accounting
+#else
+#define LSCT_NEW(T, ...)				(::MemoryManager::New<T>(__VA_ARGS__))
+#define LSCT_NEW_AT(site, T, ...)		(::MemoryManager::New<T>(__VA_ARGS__))
+#define LSCT_ARENA_NEW(T, ...)			(::MemoryManager::ArenaNew<T>(__VA_ARGS__))
+#define LSCT_DELETE(p)					(::MemoryManager::Delete(p))
+#define LSCT_NEW_ARRAY(T, n)			(::MemoryManager::NewArray<T>(n))
+#define LSCT_NEW_ARRAY_AT(site, T, n)	(::MemoryManager::NewArray<T>(n))
+#define LSCT_DELETE_ARRAY(p)			(::MemoryManager::DeleteArray(p))
+#endif
@@ -0,0 +1,474 @@
+#include <iostream>
+#include <clang-c/Index.h>
+#include <string>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+#pragma comment(lib, "libclang.lib")
+
+// Classifies the new-expressions of a file, to see which allocations are worth taking away from the global heap
+// before replacing them (memmanager.h), and where to. Each site gets
+// - its static loop depth: the for/while/do loops around it in its function (a lambda counts as part of it),
+// - a kind: freed in scope (`T* p = new T(...)`, p only dereferenced, null-tested and deleted exactly once, unconditionally,
+//   in the block declaring it), local unique_ptr (`std::unique_ptr<T> p(new T(...))`, p only dereferenced),
+//   or escaping (everything else: returned, stored, passed on, reassigned, deleted elsewhere or conditionally),
+// - a suggestion: stack for local objects, arena for local arrays and objects too big for the stack, pool for
+//   escaping ones.
+// Sites are listed deepest loop first. --apply moves the local objects to the stack where that keeps the program's
+// behaviour: `T pObject(...); T* p = &pObject;` and the delete removed. That's every local unique_ptr of its own
+// type, and the freed in scope pointers whose delete is the last statement of the block with nothing declared
+// in between (so the destructors run in the same order). Only a leak on an early return becomes a destruction.
+
+const long long MAX_STACK_OBJECT = 4096;			// bigger local objects go to the arena instead
+
+std::string searchForFile;
+std::string contents;
+CXTranslationUnit unit;
+
+struct Replacement
+{
+	unsigned	length;
+	std::string	text;
+};
+std::map<unsigned, Replacement> edits;				// offset in searchForFile -> what replaces length bytes there
+
+std::string unwrapCXString(const CXString& str)
+{
+	auto charptr = clang_getCString(str);
+	std::string retval = charptr ? charptr : "";
+	clang_disposeString(str);
+	return retval;
+}
+
+struct Position
+{
+	std::string	file;
+	unsigned	line, column, offset;
+};
+
+Position position(CXSourceLocation location)
+{
+	CXFile cxfile;
+	Position pos;
+	clang_getExpansionLocation(location, &cxfile, &pos.line, &pos.column, &pos.offset);
+	pos.file = cxfile ? unwrapCXString(clang_getFileName(cxfile)) : "";
+	return pos;
+}
+
+bool inSearchedFile(CXCursor c)
+{
+	return position(clang_getCursorLocation(c)).file == searchForFile;
+}
+
+struct Token
+{
+	std::string	spelling;
+	unsigned	offset, endOffset;
+};
+
+std::vector<Token> tokensOf(CXCursor c)
+{
+	CXToken* tokens = nullptr;
+	unsigned count = 0;
+	clang_tokenize(unit, clang_getCursorExtent(c), &tokens, &count);
+	std::vector<Token> result;
+	for (unsigned i = 0; i < count; ++i)
+	{
+		const CXSourceRange extent = clang_getTokenExtent(unit, tokens[i]);
+		result.push_back({ unwrapCXString(clang_getTokenSpelling(unit, tokens[i])),
+			position(clang_getRangeStart(extent)).offset, position(clang_getRangeEnd(extent)).offset });
+	}
+	clang_disposeTokens(unit, tokens, count);
+	return result;
+}
+
+// index of the bracket closing the one at open ( ( [ { < ), tokens.size() if there's none
+size_t matchingClose(const std::vector<Token>& tokens, size_t open)
+{
+	const std::string opening = tokens[open].spelling;
+	const std::string closing = opening == "(" ? ")" : opening == "[" ? "]" : opening == "{" ? "}" : ">";
+	int depth = 0;
+	for (size_t i = open; i < tokens.size(); ++i)
+	{
+		const std::string& s = tokens[i].spelling;
+		if (s == opening)
+			++depth;
+		else if (s == closing)
+			--depth;
+		else if (closing == ">" && s == ">>")
+			depth -= 2;
+		if (depth <= 0)
+			return i;
+	}
+	return tokens.size();
+}
+
+std::string canonicalSpelling(CXType type)
+{
+	return unwrapCXString(clang_getTypeSpelling(clang_getCanonicalType(type)));
+}
+
+bool isFunction(CXCursor c)
+{
+	const CXCursorKind kind = clang_getCursorKind(c);
+	return kind == CXCursor_FunctionDecl || kind == CXCursor_CXXMethod || kind == CXCursor_Constructor || kind == CXCursor_Destructor ||
+		kind == CXCursor_ConversionFunction || kind == CXCursor_FunctionTemplate;
+}
+
+bool isLoop(CXCursor c)
+{
+	const CXCursorKind kind = clang_getCursorKind(c);
+	return kind == CXCursor_ForStmt || kind == CXCursor_WhileStmt || kind == CXCursor_DoStmt || kind == CXCursor_CXXForRangeStmt;
+}
+
+// implicit conversions and parentheses between an expression and what uses it
+bool isTransparent(CXCursor c)
+{
+	return clang_getCursorKind(c) == CXCursor_UnexposedExpr || clang_getCursorKind(c) == CXCursor_ParenExpr;
+}
+
+std::vector<CXCursor> childrenOf(CXCursor c)
+{
+	std::vector<CXCursor> children;
+	clang_visitChildren(c, [](CXCursor child, CXCursor, CXClientData data) {
+		static_cast<std::vector<CXCursor>*>(data)->push_back(child);
+		return CXChildVisit_Continue;
+	}, &children);
+	return children;
+}
+
+enum class SiteKind { FreedInScope, LocalUniquePtr, Escaping };
+const char* const SITE_KIND_NAMES[] = { "freed in scope", "local unique_ptr", "escaping" };
+
+struct Site
+{
+	Position	pos;
+	int			loopDepth = 0;
+	SiteKind	kind = SiteKind::Escaping;
+	bool		bArray = false;
+	std::string	type;
+	long long	size = -1;				// of one object, -1 if unknown (incomplete or dependent type)
+	std::string	suggestion;
+	std::string	note;					// why it escapes, or why it's not applied
+	bool		bApplied = false;
+};
+std::vector<Site> sites;
+size_t placementNews = 0;
+
+// the references to a local pointer or unique_ptr in its block, and whether they all keep the object local
+struct UseScan
+{
+	CXCursor				var;
+	CXCursor				block;
+	bool					bUniquePtr;
+	std::vector<CXCursor>	path;
+	std::vector<CXCursor>	deletes;
+	bool					bDeleteAtTop = true;
+	bool					bArrayDelete = false;
+	std::string				escape;
+};
+
+CXChildVisitResult useVisitor(CXCursor c, CXCursor parent, CXClientData client_data)
+{
+	UseScan* scan = static_cast<UseScan*>(client_data);
+	if (clang_getCursorKind(c) == CXCursor_DeclRefExpr && clang_equalCursors(clang_getCursorReferenced(c), scan->var))
+	{
+		size_t up = scan->path.size();
+		while (up > 0 && isTransparent(scan->path[up - 1]))
+			--up;
+		const CXCursor user = up > 0 ? scan->path[up - 1] : scan->block;
+		const CXCursorKind kind = clang_getCursorKind(user);
+		const std::vector<Token> tokens = tokensOf(user);
+		const std::string first = tokens.empty() ? "" : tokens[0].spelling;
+		const std::string name = unwrapCXString(clang_getCursorSpelling(user));
+		const unsigned refOffset = position(clang_getCursorLocation(c)).offset;
+		if (scan->bUniquePtr)
+		{
+			if (kind != CXCursor_CallExpr || (name != "operator->" && name != "operator*" && name != "operator[]"))
+				scan->escape = "the unique_ptr is used as a whole (moved, released, compared, passed on)";
+		}
+		else if (kind == CXCursor_CXXDeleteExpr)
+		{
+			scan->deletes.push_back(user);
+			scan->bArrayDelete = tokens.size() > 1 && tokens[1].spelling == "[";
+			scan->bDeleteAtTop = scan->bDeleteAtTop && up == 1;			// a statement of the block itself
+		}
+		else if (kind != CXCursor_MemberRefExpr && kind != CXCursor_IfStmt && !(kind == CXCursor_UnaryOperator && (first == "*" || first == "!")) &&
+			!(kind == CXCursor_ArraySubscriptExpr && !tokens.empty() && tokens[0].offset == refOffset))
+			scan->escape = "the pointer is copied (returned, stored, passed on, reassigned or its address taken)";
+	}
+	scan->path.push_back(c);
+	clang_visitChildren(c, &useVisitor, client_data);
+	scan->path.pop_back();
+	return CXChildVisit_Continue;
+}
+
+// the text of tokens [from, to)
+std::string textOf(const std::vector<Token>& tokens, size_t from, size_t to)
+{
+	return from < to ? contents.substr(tokens[from].offset, tokens[to - 1].endOffset - tokens[from].offset) : "";
+}
+
+// T* p = new T(...); -> T pObject(...); T* p = &pObject; with delete p; removed if there's one
+void applyStack(Site& site, CXCursor newExpr, const std::vector<Token>& newTokens, size_t typeFrom, size_t typeTo, size_t init,
+	CXCursor var, CXCursor declStmt, CXCursor deleteExpr)
+{
+	const std::string varName = unwrapCXString(clang_getCursorSpelling(var));
+	const std::string object = varName + "Object";
+	if (contents.find(object) != std::string::npos)
+	{
+		site.note = object + " is taken";
+		return;
+	}
+	const std::string type = textOf(newTokens, typeFrom, typeTo);
+	const CXCursor typeDecl = clang_getTypeDeclaration(clang_getCanonicalType(clang_getPointeeType(clang_getCursorType(newExpr))));
+	const bool bRecord = clang_getCursorKind(typeDecl) == CXCursor_ClassDecl || clang_getCursorKind(typeDecl) == CXCursor_StructDecl;
+	std::string objectDecl;
+	if (init >= newTokens.size())
+		objectDecl = type + " " + object;											// default-initialized, as new T did
+	else if (newTokens[init].spelling == "(" && init + 2 == newTokens.size())
+		objectDecl = type + " " + object + "{}";									// value-initialized, T pObject() would declare a function
+	else if (bRecord)
+		objectDecl = "auto " + object + " = " + textOf(newTokens, typeFrom, newTokens.size());	// no vexing parse, no copy (C++17)
+	else
+		objectDecl = type + " " + object + textOf(newTokens, init, newTokens.size());
+
+	const std::vector<Token> declTokens = tokensOf(declStmt);
+	const unsigned nameOffset = position(clang_getCursorLocation(var)).offset;
+	size_t nameToken = 0;
+	while (nameToken < declTokens.size() && declTokens[nameToken].offset != nameOffset)
+		++nameToken;
+	const bool bUniquePtr = clang_Cursor_isNull(deleteExpr);
+	const std::string pointerDecl = bUniquePtr ? type + "* " + varName : textOf(declTokens, 0, nameToken + 1);
+
+	// the declaration statement up to its semicolon
+	const unsigned from = declTokens.front().offset;
+	size_t end = contents.find(';', position(clang_getRangeEnd(clang_getCursorExtent(var))).offset);
+	if (end == std::string::npos)
+		return;
+	const size_t lineStart = contents.rfind('\n', from) == std::string::npos ? 0 : contents.rfind('\n', from) + 1;
+	const std::string indentation = contents.substr(lineStart, contents.find_first_not_of(" \t", lineStart) - lineStart);
+	const std::string newline = contents.find("\r\n") != std::string::npos ? "\r\n" : "\n";
+	edits[from] = Replacement{ static_cast<unsigned>(end + 1 - from), objectDecl + ";" + newline + indentation + pointerDecl + " = &" + object + ";" };
+
+	if (!bUniquePtr)
+	{
+		// the whole line of the delete if it's alone there
+		size_t deleteFrom = position(clang_getRangeStart(clang_getCursorExtent(deleteExpr))).offset;
+		size_t deleteEnd = contents.find(';', position(clang_getRangeEnd(clang_getCursorExtent(deleteExpr))).offset);
+		if (deleteEnd == std::string::npos)
+			return;
+		++deleteEnd;
+		const size_t before = contents.find_last_not_of(" \t", deleteFrom - 1);
+		const size_t after = contents.find_first_not_of(" \t\r", deleteEnd);
+		if ((before == std::string::npos || contents[before] == '\n') && (after == std::string::npos || contents[after] == '\n'))
+		{
+			deleteFrom = before == std::string::npos ? 0 : before + 1;
+			deleteEnd = after == std::string::npos ? contents.size() : after + 1;
+		}
+		edits[static_cast<unsigned>(deleteFrom)] = Replacement{ static_cast<unsigned>(deleteEnd - deleteFrom), "" };
+	}
+	site.bApplied = true;
+}
+
+void classify(CXCursor newExpr, const std::vector<CXCursor>& path, bool bApply)
+{
+	const std::vector<Token> tokens = tokensOf(newExpr);
+	size_t typeFrom = (!tokens.empty() && tokens[0].spelling == "::") ? 2 : 1;
+	if (typeFrom >= tokens.size())
+		return;
+	if (tokens[typeFrom].spelling == "(")
+	{
+		const size_t close = matchingClose(tokens, typeFrom);
+		if (textOf(tokens, typeFrom + 1, close).find("nothrow") == std::string::npos)
+		{
+			++placementNews;			// not an allocation (new (T) is taken for one too, it's rare enough)
+			return;
+		}
+		typeFrom = close + 1;
+		if (typeFrom >= tokens.size())
+			return;
+	}
+	Site site;
+	site.pos = position(clang_getCursorLocation(newExpr));
+	for (size_t i = path.size(); i > 0 && !isFunction(path[i - 1]); --i)
+		site.loopDepth += isLoop(path[i - 1]) ? 1 : 0;
+	size_t typeTo = typeFrom;
+	for (; typeTo < tokens.size() && tokens[typeTo].spelling != "(" && tokens[typeTo].spelling != "{" && tokens[typeTo].spelling != "["; ++typeTo)
+	{
+		if (tokens[typeTo].spelling == "<")
+			typeTo = matchingClose(tokens, typeTo);
+	}
+	site.bArray = typeTo < tokens.size() && tokens[typeTo].spelling == "[";
+	site.type = textOf(tokens, typeFrom, std::min(typeTo, tokens.size()));
+	const CXType pointee = clang_getPointeeType(clang_getCursorType(newExpr));
+	site.size = clang_Type_getSizeOf(pointee);
+	const size_t init = site.bArray ? tokens.size() : typeTo;
+
+	// new T ... as the initializer of a local: T* p = new T..., std::unique_ptr<T> p(new T...)
+	size_t up = path.size();
+	while (up > 0 && isTransparent(path[up - 1]))
+		--up;
+	bool bUniquePtr = false;
+	if (up > 0 && clang_getCursorKind(path[up - 1]) == CXCursor_CallExpr && unwrapCXString(clang_getCursorSpelling(path[up - 1])) == "unique_ptr")
+	{
+		bUniquePtr = true;
+		for (--up; up > 0 && isTransparent(path[up - 1]); --up)
+			;
+	}
+	CXCursor var = up > 0 ? path[up - 1] : clang_getTranslationUnitCursor(unit);
+	const bool bLocal = up >= 3 && clang_getCursorKind(var) == CXCursor_VarDecl && clang_getCursorKind(path[up - 2]) == CXCursor_DeclStmt &&
+		clang_getCursorKind(path[up - 3]) == CXCursor_CompoundStmt && clang_Cursor_getStorageClass(var) != CX_SC_Static &&
+		clang_Cursor_getStorageClass(var) != CX_SC_Extern;
+	const std::string heldType = canonicalSpelling(clang_getCursorType(var));
+	if (!bLocal)
+		site.note = "not the initializer of a local";
+	else if (bUniquePtr && heldType.find("default_delete") == std::string::npos)
+		site.note = "unique_ptr with its own deleter";
+	else
+	{
+		UseScan scan{ var, path[up - 3], bUniquePtr };
+		clang_visitChildren(scan.block, &useVisitor, &scan);
+		if (!scan.escape.empty())
+			site.note = scan.escape;
+		else if (bUniquePtr)
+			site.kind = SiteKind::LocalUniquePtr;
+		else if (scan.deletes.empty())
+			site.note = "not deleted in its block";
+		else if (scan.deletes.size() > 1 || !scan.bDeleteAtTop)
+			site.note = "deleted conditionally or more than once";
+		else if (scan.bArrayDelete != site.bArray)
+			site.note = "new and delete forms don't match";
+		else
+			site.kind = SiteKind::FreedInScope;
+
+		if (site.kind != SiteKind::Escaping && !site.bArray && site.size > 0 && site.size <= MAX_STACK_OBJECT && bApply)
+		{
+			// the object is what p points to, not a derived one through a base pointer
+			const CXType held = bUniquePtr ? clang_Type_getTemplateArgumentAsType(clang_getCanonicalType(clang_getCursorType(var)), 0) :
+				clang_getPointeeType(clang_getCursorType(var));
+			const std::vector<CXCursor> statements = childrenOf(scan.block);
+			const std::vector<CXCursor> declared = childrenOf(path[up - 2]);
+			auto declaration = std::find_if(statements.begin(), statements.end(), [&](CXCursor s) { return clang_equalCursors(s, path[up - 2]) != 0; });
+			bool bInOrder = bUniquePtr || (!statements.empty() && clang_equalCursors(statements.back(), scan.deletes.front()));
+			for (auto s = declaration; !bUniquePtr && s != statements.end(); ++s)
+				bInOrder = bInOrder && (s == declaration || clang_getCursorKind(*s) != CXCursor_DeclStmt);
+			if (canonicalSpelling(held) != canonicalSpelling(pointee))
+				site.note = "held through another type";
+			else if (declared.size() != 1)
+				site.note = "declared together with other variables";
+			else if (!bInOrder)
+				site.note = "not deleted as the last statement of its block, the destructor would run later";
+			else
+				applyStack(site, newExpr, tokens, typeFrom, typeTo, init, var, path[up - 2], bUniquePtr ? clang_getNullCursor() : scan.deletes.front());
+		}
+	}
+
+	if (site.kind == SiteKind::Escaping)
+		site.suggestion = site.bArray ? "pool (LSCT_NEW_ARRAY)" : "pool (LSCT_NEW, or an ObjectPool<T> for a hot type)";
+	else if (site.bArray || site.size < 0 || site.size > MAX_STACK_OBJECT)
+		site.suggestion = "arena (LSCT_ARENA_NEW in an ArenaScope)";
+	else
+		site.suggestion = "stack";
+	sites.push_back(site);
+}
+
+struct Walk
+{
+	std::vector<CXCursor>	path;
+	bool					bApply;
+};
+
+CXChildVisitResult siteVisitor(CXCursor c, CXCursor parent, CXClientData client_data)
+{
+	Walk* walk = static_cast<Walk*>(client_data);
+	if (!inSearchedFile(c))
+		return CXChildVisit_Continue;
+	if (clang_getCursorKind(c) == CXCursor_CXXNewExpr)
+		classify(c, walk->path, walk->bApply);
+	walk->path.push_back(c);
+	clang_visitChildren(c, &siteVisitor, client_data);
+	walk->path.pop_back();
+	return CXChildVisit_Continue;
+}
+
+int main(int argc, char* argv[])
+{
+	int arg = 1;
+	std::string saveFile;
+	if (arg + 1 < argc && strcmp(argv[arg], "--apply") == 0)
+	{
+		saveFile = argv[arg + 1];
+		arg += 2;
+	}
+	if (argc - arg < 1)
+	{
+		std::cout << "Usage: " << argv[0] << " [--apply <outputfile>] <inputfile> [-- <compiler arguments>]\n";
+		std::cout << "  --apply: move the provably local objects to the stack, save the result to outputfile\n";
+		exit(-1);
+	}
+	searchForFile = argv[arg];
+	std::vector<const char*> clangArgs;
+	if (arg + 1 < argc && strcmp(argv[arg + 1], "--") == 0)
+		clangArgs.assign(argv + arg + 2, argv + argc);
+
+	std::ifstream ifs(searchForFile, std::ios::binary);
+	if (!ifs.good())
+	{
+		std::cout << "File read error\n";
+		exit(-3);
+	}
+	contents.assign((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+
+	CXIndex index = clang_createIndex(0, 0);
+	unit = clang_parseTranslationUnit(index, searchForFile.c_str(), clangArgs.data(), static_cast<int>(clangArgs.size()), nullptr, 0, CXTranslationUnit_None);
+	if (!unit)
+	{
+		std::cout << "Unable to parse translation unit." << std::endl;
+		clang_disposeIndex(index);
+		exit(-2);
+	}
+	Walk walk{ {}, !saveFile.empty() };
+	clang_visitChildren(clang_getTranslationUnitCursor(unit), &siteVisitor, &walk);
+	clang_disposeTranslationUnit(unit);
+	clang_disposeIndex(index);
+
+	// hottest first: the deeper the loop, the more often the site runs
+	std::stable_sort(sites.begin(), sites.end(), [](const Site& a, const Site& b) { return a.loopDepth > b.loopDepth; });
+	size_t counts[3] = {}, inLoops = 0, applied = 0;
+	for (const Site& site : sites)
+	{
+		std::cout << site.pos.file << ":" << site.pos.line << ":" << site.pos.column << ": loop depth " << site.loopDepth << ", "
+			<< SITE_KIND_NAMES[static_cast<int>(site.kind)] << ", new " << site.type << (site.bArray ? "[]" : "");
+		if (site.size >= 0)
+			std::cout << " (" << site.size << " bytes" << (site.bArray ? " each" : "") << ")";
+		std::cout << " -> " << site.suggestion << (site.bApplied ? ", applied" : "") << (site.note.empty() ? "" : " (" + site.note + ")") << "\n";
+		++counts[static_cast<int>(site.kind)];
+		inLoops += site.loopDepth > 0 ? 1 : 0;
+		applied += site.bApplied ? 1 : 0;
+	}
+	std::cout << sites.size() << " new-expressions: " << inLoops << " in loops, " << counts[0] << " freed in scope, " << counts[1] << " local unique_ptr, "
+		<< counts[2] << " escaping; " << placementNews << " placement new left out\n";
+	if (saveFile.empty())
+		return 0;
+
+	std::string rewritten;
+	size_t from = 0;
+	for (const auto& edit : edits)
+	{
+		rewritten.append(contents, from, edit.first - from);
+		rewritten += edit.second.text;
+		from = edit.first + edit.second.length;
+	}
+	rewritten.append(contents, from, std::string::npos);
+	std::cout << applied << " sites moved to the stack\n";
+	std::ofstream ofs(saveFile, std::ios::binary | std::ios::trunc | std::ios::out);
+	ofs.write(rewritten.data(), static_cast<std::streamsize>(rewritten.size()));
+	if (ofs.good())
+		std::cout << "Saved successfully to " << saveFile << "\n";
+	else
+		std::cout << "Error saving " << saveFile << "\n";
+}
@@ -0,0 +1,723 @@
+#include <iostream>
+#include <clang-c/Index.h>
+#include <string>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <set>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+#pragma comment(lib, "libclang.lib")
+
+// Rewrites the std containers among the data members of the chosen classes to their std::pmr equivalents and
+// threads a `std::pmr::memory_resource* resource` through the classes' constructors into them, defaulting to
+// MemoryManager::CurrentResource() (pmr_scope.h), so that objects built in a MonotonicScope allocate from it.
+// Only edits are insertions ("pmr::", parameters, member initializers), everything else stays byte for byte.
+// What it can't do safely it leaves alone and reports: containers spelled through aliases or with their own
+// allocator, brace-initialized and default member initialized containers, defaulted constructors, and members
+// whose uses need their std type (an accessor returning const std::string&, a std::vector<T>& parameter).
+// Headers first: a constructor defined in a .cpp finds the members of its class already rewritten that way.
+
+const char RESOURCE_PARAMETER[] = "std::pmr::memory_resource* resource";
+const char RESOURCE_DEFAULT[] = " = MemoryManager::CurrentResource()";
+const char RUNTIME_INCLUDE[] = "#include \"pmr_scope.h\"\r\n";
+
+std::string searchForFile;
+std::set<std::string> selectedClasses;				// --class, qualified without leading ::; all classes of searchForFile if none
+CXTranslationUnit unit;
+std::multimap<unsigned, std::string> edits;			// offset in searchForFile -> inserted there, same offsets in insertion order
+size_t rewrittenTypes = 0, rewrittenConstructors = 0, skipped = 0;
+
+std::string unwrapCXString(const CXString& str)
+{
+	auto charptr = clang_getCString(str);
+	std::string retval = charptr ? charptr : "";
+	clang_disposeString(str);
+	return retval;
+}
+
+struct Position
+{
+	std::string	file;
+	unsigned	line, column, offset;
+};
+
+Position position(CXSourceLocation location)
+{
+	CXFile cxfile;
+	Position pos;
+	clang_getExpansionLocation(location, &cxfile, &pos.line, &pos.column, &pos.offset);
+	pos.file = cxfile ? unwrapCXString(clang_getFileName(cxfile)) : "";
+	return pos;
+}
+
+bool inSearchedFile(CXCursor c)
+{
+	return position(clang_getCursorLocation(c)).file == searchForFile;
+}
+
+void report(CXCursor c, const std::string& message)
+{
+	const Position pos = position(clang_getCursorLocation(c));
+	std::cout << pos.file << ":" << pos.line << ":" << pos.column << ": " << message << "\n";
+}
+
+void skip(CXCursor c, const std::string& message)
+{
+	report(c, "not rewritten: " + message);
+	++skipped;
+}
+
+struct Token
+{
+	std::string	spelling;
+	CXTokenKind	kind;
+	unsigned	offset, endOffset;
+};
+
+std::vector<Token> tokensOf(CXCursor c)
+{
+	CXToken* tokens = nullptr;
+	unsigned count = 0;
+	clang_tokenize(unit, clang_getCursorExtent(c), &tokens, &count);
+	std::vector<Token> result;
+	for (unsigned i = 0; i < count; ++i)
+	{
+		const CXSourceRange extent = clang_getTokenExtent(unit, tokens[i]);
+		result.push_back({ unwrapCXString(clang_getTokenSpelling(unit, tokens[i])), clang_getTokenKind(tokens[i]),
+			position(clang_getRangeStart(extent)).offset, position(clang_getRangeEnd(extent)).offset });
+	}
+	clang_disposeTokens(unit, tokens, count);
+	return result;
+}
+
+// index of the bracket closing the one at open ( ( [ { < ), tokens.size() if there's none
+size_t matchingClose(const std::vector<Token>& tokens, size_t open)
+{
+	const std::string opening = tokens[open].spelling;
+	const std::string closing = opening == "(" ? ")" : opening == "[" ? "]" : opening == "{" ? "}" : ">";
+	int depth = 0;
+	for (size_t i = open; i < tokens.size(); ++i)
+	{
+		const std::string& s = tokens[i].spelling;
+		if (s == opening)
+			++depth;
+		else if (s == closing)
+			--depth;
+		else if (closing == ">" && s == ">>")
+			depth -= 2;
+		if (depth <= 0)
+			return i;
+	}
+	return tokens.size();
+}
+
+// the name the classes are selected by: namespaces and enclosing classes, anonymous parts as (anonymous)
+std::string qualifiedName(CXCursor c)
+{
+	std::string name;
+	for (CXCursor p = c; clang_getCursorKind(p) != CXCursor_TranslationUnit && !clang_Cursor_isNull(p); p = clang_getCursorSemanticParent(p))
+	{
+		if (clang_getCursorKind(p) == CXCursor_LinkageSpec)
+			continue;
+		std::string part = unwrapCXString(clang_getCursorSpelling(p));
+		if (part.empty())
+			part = "(anonymous)";
+		name = name.empty() ? part : part + "::" + name;
+	}
+	return name;
+}
+
+// the std containers with a std::pmr alias, and how many template arguments they take before the allocator
+const std::map<std::string, int> PMR_CONTAINERS = {
+	{ "vector", 1 }, { "deque", 1 }, { "list", 1 }, { "forward_list", 1 },
+	{ "set", 2 }, { "multiset", 2 }, { "map", 3 }, { "multimap", 3 },
+	{ "unordered_set", 3 }, { "unordered_multiset", 3 }, { "unordered_map", 4 }, { "unordered_multimap", 4 },
+	{ "basic_string", 2 }, { "string", 0 }, { "wstring", 0 }, { "u16string", 0 }, { "u32string", 0 },
+};
+
+// the canonical type is one of the containers (libstdc++'s std::__cxx11 and libc++'s std::__1 included)
+bool isStdContainer(CXType type)
+{
+	CXCursor decl = clang_getTypeDeclaration(clang_getCanonicalType(type));
+	if (clang_Cursor_isNull(decl) || PMR_CONTAINERS.count(unwrapCXString(clang_getCursorSpelling(decl))) == 0)
+		return false;
+	std::string outermost;
+	for (CXCursor p = clang_getCursorSemanticParent(decl); clang_getCursorKind(p) == CXCursor_Namespace; p = clang_getCursorSemanticParent(p))
+		outermost = unwrapCXString(clang_getCursorSpelling(p));
+	return outermost == "std";
+}
+
+// the container allocates through a std::pmr::polymorphic_allocator, so it takes a memory_resource*
+bool isPmrContainer(CXType type)
+{
+	const CXType canonical = clang_getCanonicalType(type);
+	const int arguments = clang_Type_getNumTemplateArguments(canonical);
+	return isStdContainer(type) && arguments > 0 &&
+		unwrapCXString(clang_getTypeSpelling(clang_Type_getTemplateArgumentAsType(canonical, arguments - 1))).find("polymorphic_allocator") != std::string::npos;
+}
+
+// the classes to rewrite: --class ones wherever they are, all classes defined in searchForFile if none given
+bool isSelected(CXCursor classCursor)
+{
+	return selectedClasses.empty() ? inSearchedFile(classCursor) : selectedClasses.count(qualifiedName(classCursor)) != 0;
+}
+
+// through references and pointers
+CXType pointee(CXType type)
+{
+	for (CXType inner = clang_getPointeeType(type); inner.kind != CXType_Invalid; inner = clang_getPointeeType(type))
+		type = inner;
+	return type;
+}
+
+bool isNonPmrContainer(CXType type)
+{
+	return isStdContainer(pointee(type)) && !isPmrContainer(pointee(type));
+}
+
+std::string containerName(CXType type)
+{
+	return unwrapCXString(clang_getCursorSpelling(clang_getTypeDeclaration(clang_getCanonicalType(pointee(type)))));
+}
+
+CXChildVisitResult firstChildVisitor(CXCursor c, CXCursor parent, CXClientData client_data)
+{
+	*static_cast<CXCursor*>(client_data) = c;
+	return CXChildVisit_Break;
+}
+
+CXChildVisitResult lastChildVisitor(CXCursor c, CXCursor parent, CXClientData client_data)
+{
+	*static_cast<CXCursor*>(client_data) = c;
+	return CXChildVisit_Continue;
+}
+
+CXCursor firstChild(CXCursor c)
+{
+	CXCursor child = clang_getNullCursor();
+	clang_visitChildren(c, &firstChildVisitor, &child);
+	return child;
+}
+
+// the type is spelled auto or decltype(...) before the name, so it follows the member's type
+bool isDeduced(CXCursor decl)
+{
+	const std::vector<Token> tokens = tokensOf(decl);
+	const unsigned nameOffset = position(clang_getCursorLocation(decl)).offset;
+	for (size_t i = 0; i < tokens.size() && tokens[i].offset < nameOffset; ++i)
+	{
+		if (tokens[i].spelling == "auto" || tokens[i].spelling == "decltype")
+			return true;
+	}
+	return false;
+}
+
+// the expression the value comes from: through implicit conversions, parentheses, & and copies into the same type
+CXCursor strippedExpression(CXCursor c)
+{
+	for (;;)
+	{
+		const CXCursorKind kind = clang_getCursorKind(c);
+		const CXCursor child = firstChild(c);
+		if (clang_Cursor_isNull(child))
+			return c;
+		if (kind == CXCursor_UnexposedExpr || kind == CXCursor_ParenExpr)
+			c = child;
+		else if (kind == CXCursor_UnaryOperator && !tokensOf(c).empty() && tokensOf(c)[0].spelling == "&")
+			c = child;
+		else if (kind == CXCursor_CallExpr && clang_getCursorKind(clang_getCursorReferenced(c)) == CXCursor_Constructor && clang_Cursor_getNumArguments(c) == 1 &&
+			clang_equalTypes(clang_getCanonicalType(clang_getCursorType(c)), clang_getCanonicalType(clang_getCursorType(clang_Cursor_getArgument(c, 0)))))
+			c = clang_Cursor_getArgument(c, 0);
+		else
+			return c;
+	}
+}
+
+// USR of the member the expression is, if it's a std container member of a selected class; empty if not
+std::string candidateField(CXCursor expression)
+{
+	const CXCursor c = strippedExpression(expression);
+	if (clang_getCursorKind(c) != CXCursor_MemberRefExpr)
+		return "";
+	const CXCursor field = clang_getCursorReferenced(c);
+	if (clang_getCursorKind(field) != CXCursor_FieldDecl || !isNonPmrContainer(clang_getCursorType(field)) || !isSelected(clang_getCursorSemanticParent(field)))
+		return "";
+	return unwrapCXString(clang_getCursorUSR(field));
+}
+
+// A member rewritten to std::pmr:: no longer converts to its std type, so the uses that need that type would stop
+// compiling: returned from a function declared to return the std container (accessors), bound to a std container
+// variable or member, passed to a std container parameter, or combined with a std container in a template or in
+// the container's own operations (=, ==, swap). Such a member is left alone, reported with the use. Only the uses
+// in this translation unit are seen; members of the rewritten classes are assumed to be rewritten together.
+std::map<std::string, std::string> pinnedFields;	// by USR: the first use that needs the std type
+
+void pin(const std::string& field, CXCursor use, const std::string& how)
+{
+	const Position pos = position(clang_getCursorLocation(use));
+	pinnedFields.emplace(field, how + " at " + pos.file + ":" + std::to_string(pos.line));
+}
+
+struct UseContext
+{
+	CXCursor	function;					// the function, constructor or lambda the use is in; null at namespace scope
+	CXCursor	initializedMember;			// in a constructor: the member whose initializer comes next
+};
+
+void checkCall(CXCursor call)
+{
+	const CXCursor callee = clang_getCursorReferenced(call);
+	if (clang_Cursor_isNull(callee))
+		return;
+	const int arguments = clang_Cursor_getNumArguments(call);
+	const int parameters = clang_Cursor_getNumArguments(callee);
+	// an overloaded member operator: the object is the first argument of the call, not a parameter
+	const int objectArguments = clang_getCursorKind(callee) == CXCursor_CXXMethod && arguments == parameters + 1 ? 1 : 0;
+	const bool bTemplate = clang_getCursorKind(callee) == CXCursor_FunctionTemplate || clang_Cursor_getNumTemplateArguments(callee) > 0;
+	const CXType owner = clang_getCursorType(clang_getCursorSemanticParent(callee));
+	for (int i = 0; i < arguments; ++i)
+	{
+		const std::string field = candidateField(clang_Cursor_getArgument(call, i));
+		if (field.empty())
+			continue;
+		const int parameter = i - objectArguments;
+		const CXType parameterType = parameter >= 0 && parameter < parameters ? clang_getCursorType(clang_Cursor_getArgument(callee, parameter)) : CXType{};
+		const bool bOwnType = parameterType.kind != CXType_Invalid && isStdContainer(owner) &&
+			clang_equalTypes(clang_getCanonicalType(pointee(parameterType)), clang_getCanonicalType(owner));
+		if (parameter < 0 || bTemplate || bOwnType)
+		{
+			// both sides have to be the same container type
+			const std::string name = containerName(clang_getCursorType(clang_Cursor_getArgument(call, i)));
+			for (int j = 0; j < arguments; ++j)
+			{
+				const CXCursor other = strippedExpression(clang_Cursor_getArgument(call, j));
+				if (j != i && candidateField(other).empty() && isNonPmrContainer(clang_getCursorType(other)) && containerName(clang_getCursorType(other)) == name)
+				{
+					pin(field, call, "used together with " + unwrapCXString(clang_getTypeSpelling(clang_getCursorType(other))));
+					break;
+				}
+			}
+		}
+		else if (parameterType.kind != CXType_Invalid && isNonPmrContainer(parameterType))
+			pin(field, call, "passed as " + unwrapCXString(clang_getTypeSpelling(parameterType)));
+	}
+}
+
+// pass zero: the uses of the container members of the selected classes, all over the translation unit
+CXChildVisitResult usesVisitor(CXCursor c, CXCursor parent, CXClientData client_data)
+{
+	UseContext* context = static_cast<UseContext*>(client_data);
+	const CXCursorKind kind = clang_getCursorKind(c);
+	if (kind == CXCursor_FunctionDecl || kind == CXCursor_CXXMethod || kind == CXCursor_Constructor || kind == CXCursor_Destructor ||
+		kind == CXCursor_ConversionFunction || kind == CXCursor_FunctionTemplate || kind == CXCursor_LambdaExpr)
+	{
+		UseContext inner{ c, clang_getNullCursor() };
+		clang_visitChildren(c, &usesVisitor, &inner);
+		return CXChildVisit_Continue;
+	}
+	if (kind == CXCursor_MemberRef && clang_getCursorKind(context->function) == CXCursor_Constructor && clang_equalCursors(parent, context->function))
+	{
+		context->initializedMember = clang_getCursorReferenced(c);
+		return CXChildVisit_Continue;
+	}
+	if (clang_isExpression(kind) && !clang_Cursor_isNull(context->initializedMember) && clang_equalCursors(parent, context->function))
+	{
+		// a member initializer: fine if it's a member rewritten the same way
+		const CXCursor member = context->initializedMember;
+		context->initializedMember = clang_getNullCursor();
+		const std::string field = candidateField(c);
+		const bool bRewrittenToo = isNonPmrContainer(clang_getCursorType(member)) && isSelected(clang_getCursorSemanticParent(member));
+		if (!field.empty() && !bRewrittenToo && isNonPmrContainer(clang_getCursorType(member)))
+			pin(field, c, "initializes " + unwrapCXString(clang_getCursorSpelling(member)) + " of type " + unwrapCXString(clang_getTypeSpelling(clang_getCursorType(member))));
+	}
+	if (kind == CXCursor_ReturnStmt)
+	{
+		const CXCursor value = firstChild(c);
+		const std::string field = clang_Cursor_isNull(value) ? "" : candidateField(value);
+		const CXCursorKind function = clang_getCursorKind(context->function);
+		if (!field.empty() && function != CXCursor_LambdaExpr && function != CXCursor_FunctionTemplate && !clang_Cursor_isNull(context->function) &&
+			!isDeduced(context->function) && isNonPmrContainer(clang_getCursorResultType(context->function)))
+			pin(field, c, "returned as " + unwrapCXString(clang_getTypeSpelling(clang_getCursorResultType(context->function))));
+	}
+	else if (kind == CXCursor_VarDecl)
+	{
+		CXCursor initializer = clang_getNullCursor();
+		clang_visitChildren(c, &lastChildVisitor, &initializer);
+		const std::string field = !clang_Cursor_isNull(initializer) && clang_isExpression(clang_getCursorKind(initializer)) ? candidateField(initializer) : "";
+		if (!field.empty() && !isDeduced(c) && isNonPmrContainer(clang_getCursorType(c)))
+			pin(field, c, "bound to " + unwrapCXString(clang_getTypeSpelling(clang_getCursorType(c))) + " " + unwrapCXString(clang_getCursorSpelling(c)));
+	}
+	else if (kind == CXCursor_CallExpr)
+		checkCall(c);
+	return CXChildVisit_Recurse;
+}
+
+struct PmrClass
+{
+	std::string					name;				// unqualified, as the constructors are named
+	std::vector<std::string>	fields;				// all data members, in declaration order
+	std::vector<std::string>	threadedFields;		// the ones initialized with resource in each constructor
+	bool						bUserConstructor = false;
+	CXCursor					cursor;
+};
+
+std::map<std::string, PmrClass> pmrClasses;		// by USR
+std::set<unsigned> rewrittenOffsets;			// "pmr::" already inserted there (int a, b; shares the type)
+
+// std::vector<...> -> std::pmr::vector<...> wherever spelled with std:: in the type of the member, nested ones too;
+// true if the member itself is a container now (or was already a pmr one)
+bool rewriteFieldType(CXCursor field, bool bEdit)
+{
+	const CXType type = clang_getCursorType(field);
+	if (isPmrContainer(type))
+		return true;
+	if (!isStdContainer(type))
+		return false;
+	const auto pinned = pinnedFields.find(unwrapCXString(clang_getCursorUSR(field)));
+	if (pinned != pinnedFields.end())
+	{
+		skip(field, "used as the std type: " + pinned->second);
+		return false;
+	}
+	const std::vector<Token> tokens = tokensOf(field);
+	const unsigned nameOffset = position(clang_getCursorLocation(field)).offset;
+	size_t nameIndex = 0;
+	while (nameIndex < tokens.size() && tokens[nameIndex].offset != nameOffset)
+		++nameIndex;
+	std::vector<unsigned> insertions;
+	size_t firstTypeToken = 0;
+	while (firstTypeToken < nameIndex && (tokens[firstTypeToken].spelling == "mutable" || tokens[firstTypeToken].spelling == "const" ||
+		tokens[firstTypeToken].spelling == "volatile" || tokens[firstTypeToken].spelling == "::"))
+		++firstTypeToken;
+	bool bOutermost = false;
+	for (size_t i = 0; i + 2 < nameIndex; ++i)
+	{
+		if (tokens[i].spelling != "std" || tokens[i + 1].spelling != "::" || (i > 0 && tokens[i - 1].spelling == "::"))
+			continue;
+		const auto container = PMR_CONTAINERS.find(tokens[i + 2].spelling);
+		if (container == PMR_CONTAINERS.end())
+			continue;
+		if (i + 3 < nameIndex && tokens[i + 3].spelling == "<")
+		{
+			// its own allocator: leave the whole member alone
+			const size_t close = matchingClose(tokens, i + 3);
+			int arguments = 1, depth = 0;
+			for (size_t j = i + 4; j < close; ++j)
+			{
+				const std::string& s = tokens[j].spelling;
+				depth += (s == "<" || s == "(" || s == "[" || s == "{") ? 1 : (s == ">" || s == ")" || s == "]" || s == "}") ? -1 : s == ">>" ? -2 : 0;
+				arguments += (depth == 0 && s == ",") ? 1 : 0;
+			}
+			if (arguments > container->second)
+			{
+				skip(field, tokens[i + 2].spelling + " with its own allocator");
+				return false;
+			}
+		}
+		insertions.push_back(tokens[i + 2].offset);
+		bOutermost = bOutermost || i == firstTypeToken;
+	}
+	if (!bOutermost)
+	{
+		skip(field, "the container type is spelled through an alias");
+		return false;
+	}
+	if (bEdit)
+	{
+		for (unsigned offset : insertions)
+		{
+			if (rewrittenOffsets.insert(offset).second)
+			{
+				edits.emplace(offset, "pmr::");
+				++rewrittenTypes;
+			}
+		}
+	}
+	// a default member initializer would be overridden by the member initializer the constructors get
+	if (nameIndex + 1 < tokens.size() && (tokens[nameIndex + 1].spelling == "=" || tokens[nameIndex + 1].spelling == "{"))
+	{
+		skip(field, "has a default member initializer, keeps using the default resource");
+		return false;
+	}
+	return true;
+}
+
+CXChildVisitResult classMemberVisitor(CXCursor c, CXCursor parent, CXClientData client_data)
+{
+	PmrClass* pmrClass = static_cast<PmrClass*>(client_data);
+	if (clang_getCursorKind(c) == CXCursor_FieldDecl)
+	{
+		pmrClass->fields.push_back(unwrapCXString(clang_getCursorSpelling(c)));
+		if (rewriteFieldType(c, inSearchedFile(c)))
+			pmrClass->threadedFields.push_back(pmrClass->fields.back());
+	}
+	else if (clang_getCursorKind(c) == CXCursor_Constructor)
+		pmrClass->bUserConstructor = true;
+	return CXChildVisit_Continue;
+}
+
+bool isClass(CXCursor c)
+{
+	const CXCursorKind kind = clang_getCursorKind(c);
+	return kind == CXCursor_ClassDecl || kind == CXCursor_StructDecl ||
+		((kind == CXCursor_ClassTemplate || kind == CXCursor_ClassTemplatePartialSpecialization) &&
+			(clang_getTemplateCursorKind(c) == CXCursor_ClassDecl || clang_getTemplateCursorKind(c) == CXCursor_StructDecl));
+}
+
+// first pass: the selected class definitions, wherever they are (a .cpp needs the members of its header's classes)
+CXChildVisitResult classVisitor(CXCursor c, CXCursor parent, CXClientData client_data)
+{
+	if (!isClass(c) || !clang_isCursorDefinition(c))
+		return CXChildVisit_Recurse;
+	if (!isSelected(c))
+		return CXChildVisit_Recurse;
+	PmrClass pmrClass;
+	pmrClass.name = unwrapCXString(clang_getCursorSpelling(c));
+	pmrClass.cursor = c;
+	clang_visitChildren(c, &classMemberVisitor, &pmrClass);
+	pmrClasses[unwrapCXString(clang_getCursorUSR(c))] = pmrClass;
+	return CXChildVisit_Recurse;
+}
+
+struct MemberInitializer
+{
+	std::string	name;
+	size_t		nameToken;
+	size_t		openToken, closeToken;			// ( ) or { }
+};
+
+// adds the parameter, and if it's a definition, passes resource on to the threaded members
+void rewriteConstructor(CXCursor c, const PmrClass& pmrClass)
+{
+	if (clang_CXXConstructor_isCopyConstructor(c) || clang_CXXConstructor_isMoveConstructor(c))
+		return;
+	const int parameters = clang_Cursor_getNumArguments(c);
+	for (int i = 0; i < parameters; ++i)
+	{
+		if (unwrapCXString(clang_getTypeSpelling(clang_getCursorType(clang_Cursor_getArgument(c, i)))).find("memory_resource") != std::string::npos)
+			return;				// done already
+	}
+	const std::vector<Token> tokens = tokensOf(c);
+	const unsigned nameOffset = position(clang_getCursorLocation(c)).offset;
+	size_t open = 0;
+	while (open < tokens.size() && (tokens[open].offset < nameOffset || tokens[open].spelling != "("))
+		++open;
+	const size_t close = open < tokens.size() ? matchingClose(tokens, open) : tokens.size();
+	if (close >= tokens.size())
+	{
+		skip(c, "constructor parameter list not found");
+		return;
+	}
+	if (close == open + 2 && tokens[open + 1].spelling == "void")
+	{
+		skip(c, "constructor with (void) parameter list");
+		return;
+	}
+	if (close > open + 1 && tokens[close - 1].spelling == "...")
+	{
+		skip(c, "variadic constructor");
+		return;
+	}
+	// the declaration part after the parameters: noexcept(...), try, = default, then the initializers or the body
+	size_t next = close + 1;
+	for (; next < tokens.size() && tokens[next].spelling != ":" && tokens[next].spelling != "{" && tokens[next].spelling != "=" && tokens[next].spelling != ";"; ++next)
+	{
+		if (tokens[next].spelling == "(")
+			next = matchingClose(tokens, next);
+	}
+	if (next < tokens.size() && tokens[next].spelling == "=")
+	{
+		skip(c, "defaulted or deleted constructor");
+		return;
+	}
+
+	const bool bFirstDeclaration = clang_equalCursors(c, clang_getCanonicalCursor(c)) != 0;
+	edits.emplace(tokens[close].offset, std::string(parameters > 0 ? ", " : "") + RESOURCE_PARAMETER + (bFirstDeclaration ? RESOURCE_DEFAULT : ""));
+	++rewrittenConstructors;
+	if (!clang_isCursorDefinition(c) || pmrClass.threadedFields.empty())
+		return;
+
+	std::vector<MemberInitializer> initializers;
+	size_t body = next;
+	if (next < tokens.size() && tokens[next].spelling == ":")
+	{
+		for (size_t i = next + 1; i < tokens.size(); )
+		{
+			MemberInitializer initializer{ "", i, 0, 0 };
+			size_t j = i;
+			for (; j < tokens.size() && tokens[j].spelling != "(" && tokens[j].spelling != "{"; ++j)
+			{
+				if (tokens[j].spelling == "<")
+					j = matchingClose(tokens, j);
+				else
+					initializer.name += tokens[j].spelling;
+			}
+			if (j >= tokens.size())
+				break;
+			initializer.openToken = j;
+			initializer.closeToken = matchingClose(tokens, j);
+			initializers.push_back(initializer);
+			i = initializer.closeToken + 1;
+			if (i < tokens.size() && tokens[i].spelling == "...")
+				++i;
+			if (i >= tokens.size() || tokens[i].spelling != ",")
+			{
+				body = i;
+				break;
+			}
+			++i;
+		}
+	}
+	if (body >= tokens.size() || tokens[body].spelling != "{")
+	{
+		skip(c, "constructor body not found, members not initialized with resource");
+		return;
+	}
+
+	// delegating: the target constructor gets resource, it initializes the members
+	for (const MemberInitializer& initializer : initializers)
+	{
+		if (initializer.name == pmrClass.name)
+		{
+			if (tokens[initializer.openToken].spelling == "(")
+				edits.emplace(tokens[initializer.closeToken].offset, initializer.closeToken == initializer.openToken + 1 ? "resource" : ", resource");
+			else
+				skip(c, "brace-initialized delegation, resource not passed on");
+			return;
+		}
+	}
+
+	auto fieldIndex = [&pmrClass](const std::string& name) {
+		return size_t(std::find(pmrClass.fields.begin(), pmrClass.fields.end(), name) - pmrClass.fields.begin());
+	};
+	std::vector<std::string> missing;
+	for (const std::string& field : pmrClass.threadedFields)
+	{
+		auto initializer = std::find_if(initializers.begin(), initializers.end(), [&field](const MemberInitializer& mi) { return mi.name == field; });
+		if (initializer == initializers.end())
+		{
+			// before the first initializer of a later member, to keep the declaration order
+			auto later = std::find_if(initializers.begin(), initializers.end(), [&](const MemberInitializer& mi) {
+				return fieldIndex(mi.name) < pmrClass.fields.size() && fieldIndex(mi.name) > fieldIndex(field);
+			});
+			if (later != initializers.end())
+				edits.emplace(tokens[later->nameToken].offset, field + "(resource), ");
+			else
+				missing.push_back(field);
+		}
+		else if (tokens[initializer->openToken].spelling == "(")
+			edits.emplace(tokens[initializer->closeToken].offset, initializer->closeToken == initializer->openToken + 1 ? "resource" : ", resource");
+		else
+			skip(c, field + " is brace-initialized, keeps using the default resource");
+	}
+	for (const std::string& field : missing)
+	{
+		if (initializers.empty())
+		{
+			edits.emplace(tokens[body - 1].endOffset, " : " + field + "(resource)");
+			initializers.push_back(MemberInitializer{ field, body, body, body - 1 });		// the next one goes after it
+		}
+		else
+			edits.emplace(tokens[initializers.back().closeToken].endOffset, ", " + field + "(resource)");
+	}
+}
+
+// second pass: the constructors of the classes found, declared or defined in searchForFile
+CXChildVisitResult constructorVisitor(CXCursor c, CXCursor parent, CXClientData client_data)
+{
+	if (clang_getCursorKind(c) != CXCursor_Constructor)
+		return CXChildVisit_Recurse;
+	auto pmrClass = pmrClasses.find(unwrapCXString(clang_getCursorUSR(clang_getCursorSemanticParent(c))));
+	if (pmrClass != pmrClasses.end() && inSearchedFile(c))
+		rewriteConstructor(c, pmrClass->second);
+	return CXChildVisit_Continue;
+}
+
+// classes without constructors of their own get a pair: the default one using CurrentResource(), and one taking the resource
+void addConstructors(const PmrClass& pmrClass)
+{
+	if (pmrClass.bUserConstructor || pmrClass.threadedFields.empty() || !inSearchedFile(pmrClass.cursor))
+		return;
+	std::string initializers;
+	for (const std::string& field : pmrClass.threadedFields)
+		initializers += (initializers.empty() ? " : " : ", ") + field + "(resource)";
+	const unsigned closingBrace = position(clang_getRangeEnd(clang_getCursorExtent(pmrClass.cursor))).offset - 1;
+	edits.emplace(closingBrace, "public:\r\n\t" + pmrClass.name + "() : " + pmrClass.name + "(MemoryManager::CurrentResource()) {}\r\n" +
+		"\texplicit " + pmrClass.name + "(" + RESOURCE_PARAMETER + ")" + initializers + " {}\r\n");
+	report(pmrClass.cursor, "constructors added, " + pmrClass.name + " is no longer an aggregate");
+	rewrittenConstructors += 2;
+}
+
+int main(int argc, char* argv[])
+{
+	int arg = 1;
+	for (; arg < argc && argv[arg][0] == '-' && argv[arg][1] == '-' && argv[arg][2] != '\0'; ++arg)
+	{
+		if (strcmp(argv[arg], "--class") == 0 && arg + 1 < argc)
+			selectedClasses.insert(argv[++arg]);
+		else
+			break;
+	}
+	if (argc - arg < 2)
+	{
+		std::cout << "Usage: " << argv[0] << " [--class <qualified name>]... <inputfile> <outputfile> [-- <compiler arguments>]\n";
+		std::cout << "  --class: rewrite this class (wherever the file defines or constructs it), all classes defined in inputfile if none given\n";
+		exit(-1);
+	}
+	searchForFile = argv[arg];
+	const std::string saveFile = argv[arg + 1];
+	std::vector<const char*> clangArgs;
+	if (arg + 2 < argc && strcmp(argv[arg + 2], "--") == 0)
+		clangArgs.assign(argv + arg + 3, argv + argc);
+
+	std::ifstream ifs(searchForFile, std::ios::binary);
+	if (!ifs.good())
+	{
+		std::cout << "File read error\n";
+		exit(-3);
+	}
+	const std::string contents((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+
+	CXIndex index = clang_createIndex(0, 0);
+	unit = clang_parseTranslationUnit(index, searchForFile.c_str(), clangArgs.data(), static_cast<int>(clangArgs.size()), nullptr, 0, CXTranslationUnit_None);
+	if (!unit)
+	{
+		std::cout << "Unable to parse translation unit." << std::endl;
+		clang_disposeIndex(index);
+		exit(-2);
+	}
+	CXCursor cursor = clang_getTranslationUnitCursor(unit);
+	UseContext context{ clang_getNullCursor(), clang_getNullCursor() };
+	clang_visitChildren(cursor, &usesVisitor, &context);
+	clang_visitChildren(cursor, &classVisitor, nullptr);
+	clang_visitChildren(cursor, &constructorVisitor, nullptr);
+	for (const auto& pmrClass : pmrClasses)
+		addConstructors(pmrClass.second);
+	clang_disposeTranslationUnit(unit);
+	clang_disposeIndex(index);
+
+	if (!edits.empty() && contents.find("pmr_scope.h") == std::string::npos)
+	{
+		const size_t firstInclude = contents.find("#include");
+		edits.emplace(firstInclude == std::string::npos ? 0 : static_cast<unsigned>(firstInclude), RUNTIME_INCLUDE);
+	}
+	std::string rewritten;
+	size_t from = 0;
+	for (const auto& edit : edits)
+	{
+		rewritten.append(contents, from, edit.first - from);
+		rewritten += edit.second;
+		from = edit.first;
+	}
+	rewritten.append(contents, from, std::string::npos);
+
+	std::cout << pmrClasses.size() << " classes, " << rewrittenTypes << " container types and " << rewrittenConstructors << " constructors rewritten, " << skipped << " places left alone\n";
+	std::ofstream ofs(saveFile, std::ios::binary | std::ios::trunc | std::ios::out);
+	ofs.write(rewritten.data(), static_cast<std::streamsize>(rewritten.size()));
+	if (ofs.good())
+		std::cout << "Saved successfully to " << saveFile << "\n";
+	else
+		std::cout << "Error saving " << saveFile << "\n";
+}
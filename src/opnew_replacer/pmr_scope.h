@@ -0,0 +1,139 @@
+#pragma once
+
+// Runtime for classes rewritten by pmr_injector: their std containers became std::pmr ones and their
+// constructors got a trailing `std::pmr::memory_resource* resource = MemoryManager::CurrentResource()`
+// parameter, passed on to the containers. CurrentResource() is the resource of the innermost MonotonicScope on
+// the thread, so whatever is built inside a scope allocates from it:
+//
+//		void HandleRequest(const Request& r)
+//		{
+//			MemoryManager::MonotonicScope scope;			// everything allocated below is released at once here
+//			Session session(r.user);						// rewritten class: its containers use the scope
+//			// ...
+//		}
+//
+// A scope is a std::pmr::monotonic_buffer_resource. The outermost scope of a thread starts with a thread-local
+// buffer that is kept between scopes and grown to what the previous scopes needed, so once a thread has seen
+// its largest request, requests don't allocate from the heap at all. Nested scopes take their memory from the
+// enclosing scope. Objects must not outlive the scope their resource came from.
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+
+namespace MemoryManager {
+
+namespace details {
+
+constexpr size_t MAX_SCOPE_BUFFER = size_t(64) << 20;			// the thread-local buffer doesn't grow beyond this
+
+inline std::pmr::memory_resource*& CurrentResource()
+{
+	static thread_local std::pmr::memory_resource* current = nullptr;
+	return current;
+}
+
+// the outermost scope's initial buffer, kept for the next scope on the thread
+struct ScopeBuffer
+{
+	std::unique_ptr<std::max_align_t[]>	data;
+	size_t								size = 0;
+	bool								bInUse = false;
+};
+
+inline ScopeBuffer& ThreadScopeBuffer()
+{
+	static thread_local ScopeBuffer buffer;
+	return buffer;
+}
+
+// passes everything to upstream, counting the bytes: what didn't fit in the initial buffer
+class CountingResource : public std::pmr::memory_resource {
+public:
+	explicit CountingResource(std::pmr::memory_resource* upstream) :
+		m_upstream(upstream) {}
+	size_t Bytes() const { return m_bytes; }
+private:
+	std::pmr::memory_resource*	m_upstream;
+	size_t						m_bytes = 0;
+
+	void* do_allocate(size_t bytes, size_t alignment) override
+	{
+		void* p = m_upstream->allocate(bytes, alignment);
+		m_bytes += bytes;
+		return p;
+	}
+	void do_deallocate(void* p, size_t bytes, size_t alignment) override { m_upstream->deallocate(p, bytes, alignment); }
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+
+} // namespace details
+
+// what the rewritten constructors use by default: the innermost scope's resource, the default resource outside of scopes
+inline std::pmr::memory_resource* CurrentResource()
+{
+	std::pmr::memory_resource* current = details::CurrentResource();
+	return current ? current : std::pmr::get_default_resource();
+}
+
+// Makes a monotonic resource the CurrentResource() of this thread and releases all of it on exit.
+// initialSize: the least the outermost scope starts with (nested scopes: the first chunk they take from the enclosing one)
+class MonotonicScope {
+public:
+	explicit MonotonicScope(size_t initialSize = 64 * 1024) :
+		m_previous(details::CurrentResource()),
+		m_upstream(m_previous ? m_previous : std::pmr::get_default_resource()),
+		m_buffer(m_previous || details::ThreadScopeBuffer().bInUse ? nullptr : &Reserve(initialSize))
+	{
+		if (m_buffer)
+			m_resource.emplace(m_buffer->data.get(), m_buffer->size, &m_upstream);
+		else
+			m_resource.emplace(initialSize, &m_upstream);
+		details::CurrentResource() = &*m_resource;
+	}
+	MonotonicScope(const MonotonicScope&) = delete;
+	MonotonicScope& operator= (const MonotonicScope&) = delete;
+	~MonotonicScope()
+	{
+		details::CurrentResource() = m_previous;
+		m_resource.reset();
+		if (m_buffer)
+		{
+			// next time all of it fits in the buffer
+			if (m_upstream.Bytes() > 0 && m_buffer->size < details::MAX_SCOPE_BUFFER)
+				Grow(*m_buffer, m_buffer->size + m_upstream.Bytes());
+			m_buffer->bInUse = false;
+		}
+	}
+
+	std::pmr::memory_resource* Resource() { return &*m_resource; }
+	// what this scope had to get beyond its initial buffer so far
+	size_t UpstreamBytes() const { return m_upstream.Bytes(); }
+
+private:
+	std::pmr::memory_resource*				m_previous;
+	details::CountingResource				m_upstream;
+	details::ScopeBuffer*					m_buffer;
+	std::optional<std::pmr::monotonic_buffer_resource>	m_resource;		// not movable, constructed in the body
+
+	static details::ScopeBuffer& Reserve(size_t initialSize)
+	{
+		details::ScopeBuffer& buffer = details::ThreadScopeBuffer();
+		if (buffer.size < initialSize)
+			Grow(buffer, initialSize);
+		buffer.bInUse = true;
+		return buffer;
+	}
+
+	static void Grow(details::ScopeBuffer& buffer, size_t size)
+	{
+		size = size < details::MAX_SCOPE_BUFFER ? size : details::MAX_SCOPE_BUFFER;
+		const size_t elements = (size + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t);
+		buffer.data.reset();
+		buffer.data.reset(new std::max_align_t[elements]);
+		buffer.size = elements * sizeof(std::max_align_t);
+	}
+};
+
+} // namespace MemoryManager
@@ -0,0 +1,127 @@
+#include <chrono>
+#include <cfenv>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+#define FLOATO_SCAN_MIN_PER_THREAD	1000
+#include "FLOATO_scan.h"
+
+#define CHECK(condition)	if (!(condition)) { std::cout << "FAILED: " << #condition << " at line " << __LINE__ << "\n"; bError = true; }
+
+// what std::fpclassify says, element by element
+template <typename T> FLOATO::ScanResult Reference(const std::vector<T>& values)
+{
+	FLOATO::ScanResult r;
+	for (size_t i = 0; i < values.size(); ++i)
+	{
+		const int c = std::fpclassify(values[i]);
+		size_t& count = c == FP_NAN ? r.nans : c == FP_INFINITE ? r.infs : r.subnormals;
+		size_t& first = c == FP_NAN ? r.firstNan : c == FP_INFINITE ? r.firstInf : r.firstSubnormal;
+		if (c == FP_NAN || c == FP_INFINITE || c == FP_SUBNORMAL)
+		{
+			if (count++ == 0)
+				first = i;
+		}
+	}
+	return r;
+}
+
+bool Same(const FLOATO::ScanResult& a, const FLOATO::ScanResult& b)
+{
+	return a.nans == b.nans && a.infs == b.infs && a.subnormals == b.subnormals &&
+		a.firstNan == b.firstNan && a.firstInf == b.firstInf && a.firstSubnormal == b.firstSubnormal;
+}
+
+template <typename T> bool CheckAllKernels(const std::vector<T>& values)
+{
+	const FLOATO::ScanResult expected = Reference(values);
+	bool bSame = Same(FLOATO::Scan(values), expected) && Same(FLOATO::ParallelScan(values, 3), expected);
+	for (FLOATO::ScanKernel kernel : { FLOATO::ScanScalar, FLOATO::ScanAvx2, FLOATO::ScanAvx512 })
+	{
+		if (FLOATO::ScanKernelSupported(kernel))
+			bSame = bSame && Same(FLOATO::Scan(kernel, values.data(), values.size()), expected);
+	}
+	return bSame;
+}
+
+// special values sprinkled over normal ones, every length up to a few blocks so that the tails are covered too
+template <typename T> bool CheckRandom(unsigned seed)
+{
+	typedef std::numeric_limits<T> L;
+	const T specials[] = { L::quiet_NaN(), -L::quiet_NaN(), L::signaling_NaN(), L::infinity(), -L::infinity(),
+		L::denorm_min(), -L::denorm_min(), L::min() / 2, -L::min() / 4 };
+	const T ordinary[] = { T(0), -T(0), L::min(), -L::min(), L::max(), L::lowest(), T(1), T(-3.5) };
+	std::mt19937 random(seed);
+	bool bSame = true;
+	for (size_t length = 0; length < 300; ++length)
+	{
+		std::vector<T> values(length);
+		for (T& v : values)
+			v = random() % 50 == 0 ? specials[random() % std::size(specials)] : ordinary[random() % std::size(ordinary)];
+		bSame = bSame && CheckAllKernels(values);
+	}
+	return bSame;
+}
+
+template <typename T> double GBPerSecond(FLOATO::ScanKernel kernel, const std::vector<T>& values, bool bParallel)
+{
+	const auto start = std::chrono::steady_clock::now();
+	size_t found = 0;
+	for (int repeat = 0; repeat < 5; ++repeat)
+		found += bParallel ? FLOATO::ParallelScan(values).nans : FLOATO::Scan(kernel, values.data(), values.size()).nans;
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return found == 5 ? 5 * values.size() * sizeof(T) / seconds / 1e9 : 0;
+}
+
+int main()
+{
+	bool bError = false;
+
+	CHECK(CheckRandom<double>(1));
+	CHECK(CheckRandom<float>(2));
+
+	// a clean buffer, then one of each at the end of a long one
+	{
+		std::vector<double> values(100000, 1.0);
+		FLOATO::ScanResult r = FLOATO::Scan(values);
+		CHECK(r.Clean() && r.Finite());
+		CHECK(r.firstNan == FLOATO::SCAN_NOT_FOUND);
+		values[99997] = std::numeric_limits<double>::denorm_min();
+		values[99998] = -std::numeric_limits<double>::infinity();
+		values[99999] = std::nan("");
+		values[5] = std::nan("");
+		r = FLOATO::ParallelScan(values, 7);
+		CHECK(r.nans == 2 && r.firstNan == 5);
+		CHECK(r.infs == 1 && r.firstInf == 99998);
+		CHECK(r.subnormals == 1 && r.firstSubnormal == 99997);
+		CHECK(!r.Finite());
+		CHECK(r.Describe() == "2 NaN (first at 5), 1 inf (first at 99998), 1 subnormal (first at 99997)");
+	}
+
+	// scanning doesn't touch the FP flags: nothing is computed with the values
+	{
+		std::vector<float> values(1000, std::numeric_limits<float>::signaling_NaN());
+		std::feclearexcept(FE_ALL_EXCEPT);
+		CHECK(FLOATO::Scan(values).nans == 1000);
+		CHECK(std::fetestexcept(FE_ALL_EXCEPT) == 0);
+	}
+
+	// throughput on a buffer bigger than the caches, a single NaN at the end
+	{
+		std::vector<double> values(size_t(32) << 20, 0.5);
+		values.back() = std::nan("");
+		std::cout << "scan of " << (values.size() * sizeof(double) >> 20) << " MB doubles, GB/s: scalar " << GBPerSecond(FLOATO::ScanScalar, values, false);
+		if (FLOATO::ScanKernelSupported(FLOATO::ScanAvx2))
+			std::cout << ", AVX2 " << GBPerSecond(FLOATO::ScanAvx2, values, false);
+		if (FLOATO::ScanKernelSupported(FLOATO::ScanAvx512))
+			std::cout << ", AVX-512 " << GBPerSecond(FLOATO::ScanAvx512, values, false);
+		std::cout << ", parallel " << GBPerSecond(FLOATO::BestScanKernel(), values, true) << "\n";
+	}
+
+	if (!bError)
+		std::cout << "FLOATO_scan: Test OK\n";
+	return bError ? 1 : 0;
+}
@@ -0,0 +1,172 @@
+#include <iostream>
+#include <cmath>
+#include <limits>
+#include <thread>
+#include <vector>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+
+#define __DEBUG_CHECK_FLOAT_EXCEPTIONS
+#include "FLOATO.h"
+
+static volatile int s_faults = 0;
+static volatile int s_lastCode = 0;
+
+void CountFault(const FLOATO::FaultInfo& info)
+{
+	s_faults = s_faults + 1;
+	s_lastCode = info.code;
+}
+
+// minimal pool, just enough to exercise FLOATO::ApplyToAllWorkers
+class TinyPool {
+public:
+	explicit TinyPool(unsigned n) { for (unsigned i = 0; i < n; ++i) m_workers.emplace_back([this]() { Work(); }); }
+	~TinyPool()
+	{
+		{ std::lock_guard<std::mutex> guard(m_lock); m_stop = true; }
+		m_changed.notify_all();
+		for (std::thread& t : m_workers) t.join();
+	}
+	void Submit(std::function<void()> task)
+	{
+		{ std::lock_guard<std::mutex> guard(m_lock); m_tasks.push_back(std::move(task)); }
+		m_changed.notify_one();
+	}
+private:
+	void Work()
+	{
+		for (;;)
+		{
+			std::function<void()> task;
+			{
+				std::unique_lock<std::mutex> guard(m_lock);
+				m_changed.wait(guard, [this]() { return m_stop || !m_tasks.empty(); });
+				if (m_tasks.empty()) return;
+				task = std::move(m_tasks.front());
+				m_tasks.pop_front();
+			}
+			task();
+		}
+	}
+	std::vector<std::thread>			m_workers;
+	std::deque<std::function<void()>>	m_tasks;
+	std::mutex							m_lock;
+	std::condition_variable				m_changed;
+	bool								m_stop = false;
+};
+
+// volatile operands keep the compiler from folding the operations away
+volatile double zero = 0.0;
+volatile double one = 1.0;
+volatile double huge = std::numeric_limits<double>::max();
+
+#define CHECK(condition)	if (!(condition)) { std::cout << "FAILED: " << #condition << " at line " << __LINE__ << "\n"; bError = true; }
+
+int main()
+{
+	bool bError = false;
+
+	FLOATO::InstallSigfpeHandler(FLOATO::TrapAction::Continue, &CountFault);
+
+	{
+		FLOATO::ScopedTraps traps(FLOATO::DivByZero | FLOATO::Invalid);
+		CHECK(FLOATO::GetEnabledTraps() == (FLOATO::DivByZero | FLOATO::Invalid));
+		volatile double r = one / zero;							// traps, handler masks and resumes
+		CHECK(std::isinf(r));
+		CHECK(s_faults == 1 && s_lastCode == FPE_FLTDIV);
+	}
+	CHECK(FLOATO::GetEnabledTraps() == 0);							// environment restored
+
+	{
+		FLOATO::ScopedTraps traps(FLOATO::Overflow);
+		{
+			FLOATO::ScopedNoTraps quiet;
+			volatile double r = huge * 2.0;						// masked: no SIGFPE
+			(void)r;
+		}
+		CHECK(s_faults == 1);
+		CHECK(FLOATO::GetEnabledTraps() == FLOATO::Overflow);
+	}
+
+	FLOATO::SetThreadDefault(FLOATO::Invalid);
+	CHECK(FLOATO::GetThreadDefault() == FLOATO::Invalid && FLOATO::GetEnabledTraps() == FLOATO::Invalid);
+	std::thread([&]() {
+		CHECK(FLOATO::GetThreadDefault() == 0);					// thread defaults don't propagate, the process default does
+		FLOATO::SetThreadDefault(FLOATO::Overflow);
+		CHECK(FLOATO::GetEnabledTraps() == FLOATO::Overflow);
+	}).join();
+	FLOATO::SetThreadDefault(0);
+
+	{
+		FLOATO::StickyCheck check;
+		volatile double sum = 0.0;
+		for (int i = 0; i < 100; ++i)
+			sum = sum + std::sqrt(double(i));
+		CHECK(check.Check("clean batch") == 0);
+		for (int i = 0; i < 100; ++i)
+			sum = sum + huge * double(i);
+		try
+		{
+			FLOATO_CHECK(check);
+			CHECK(false);
+		}
+		catch (FLOATO::FLOATO_exception& e)
+		{
+			std::cout << "Expected: " << e.what() << "\n";
+			CHECK(e.Raised() & FLOATO::Overflow);
+		}
+		CHECK(check.Peek() == 0);
+		(void)sum;
+	}
+
+	{
+		volatile float tiny = 1e-39f;								// subnormal
+		FLOATO::DenormalSampler sampler;
+		{
+			FLOATO::ScopedDenormalMode keep(FLOATO::KeepDenormals);
+			FLOATO::DenormalSampler::Region region(sampler);
+			volatile float r = tiny * 0.5f;
+			CHECK(r != 0.0f);
+		}
+		{
+			FLOATO::ScopedDenormalMode flush;
+			CHECK(FLOATO::GetDenormalMode() == FLOATO::FlushDenormals);
+			FLOATO::DenormalSampler::Region region(sampler);
+			volatile float r = tiny * 0.5f;
+			CHECK(r == 0.0f);
+		}
+		CHECK(FLOATO::GetDenormalMode() == FLOATO::KeepDenormals);
+		CHECK(sampler.Samples() == 2 && sampler.DenormalInputs() == 1);
+	}
+
+	{
+		// a busy sampler doesn't change when a quiet one samples: each counts its own regions
+		FLOATO::DenormalSampler busy(4), quiet(4);
+		for (int i = 0; i < 8; ++i)
+		{
+			for (int j = 0; j < 3; ++j)
+				FLOATO::DenormalSampler::Region region(busy);
+			FLOATO::DenormalSampler::Region region(quiet);
+		}
+		CHECK(busy.Samples() == 6 && quiet.Samples() == 2);
+	}
+
+	{
+		constexpr unsigned WORKERS = 3;
+		TinyPool pool(WORKERS);
+		FLOATO::ApplyToAllWorkers([&](std::function<void()> task) { pool.Submit(std::move(task)); }, WORKERS, FLOATO::FlushToZero);
+		std::mutex lock;
+		int flushing = 0;
+		FLOATO::ApplyToAllWorkers([&](std::function<void()> task) {
+			pool.Submit([&, task]() { { std::lock_guard<std::mutex> guard(lock); flushing += FLOATO::GetDenormalMode() == FLOATO::FlushToZero; } task(); });
+		}, WORKERS, FLOATO::FlushToZero);
+		CHECK(flushing == WORKERS);
+	}
+
+	if (!bError)
+		std::cout << "FLOATO: Test OK\n";
+	return bError ? 1 : 0;
+}
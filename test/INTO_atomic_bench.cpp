@@ -0,0 +1,51 @@
+// Shared counter increments: std::atomic<int64_t>::fetch_add against the atomic_overflowchecked policies,
+// single threaded (the uncontended fast path) and with all hardware threads hammering one counter.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#define __DEBUG_CHECK_INTEGER_OVERFLOW
+#include "INTO_atomic.h"
+
+template <typename Counter> double Measure(Counter& counter, int threads, int64_t perThread)
+{
+	const auto start = std::chrono::steady_clock::now();
+	std::vector<std::thread> workers;
+	for (int t = 0; t < threads; ++t)
+	{
+		workers.emplace_back([&]() {
+			for (int64_t i = 0; i < perThread; ++i)
+				counter.fetch_add(1, std::memory_order_relaxed);
+		});
+	}
+	for (auto& w : workers)
+		w.join();
+	const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count() / (threads * perThread);
+}
+
+template <typename Counter> void Run(const char* name, int threads, int64_t perThread)
+{
+	Counter counter(0);
+	const double ns = Measure(counter, threads, perThread);
+	std::cout << "  " << name << ": " << ns << " ns/op\n";
+}
+
+int main()
+{
+	const int64_t perThread = 20000000;
+	const int hwThreads = std::max(2u, std::thread::hardware_concurrency());
+	for (int threads : { 1, hwThreads })
+	{
+		std::cout << threads << " thread(s):\n";
+		Run<std::atomic<int64_t>>("std::atomic fetch_add", threads, perThread / threads);
+		Run<atomic_overflowchecked<int64_t, AtomicOverflowPolicy::Report>>("Report (xadd + post-check)", threads, perThread / threads);
+		Run<atomic_overflowchecked<int64_t, AtomicOverflowPolicy::Reject>>("Reject (CAS)", threads, perThread / threads);
+		Run<atomic_overflowchecked<int64_t, AtomicOverflowPolicy::Saturate>>("Saturate (CAS)", threads, perThread / threads);
+	}
+	return 0;
+}
@@ -0,0 +1,87 @@
+#include <iostream>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <functional>
+#include <thread>
+#include <vector>
+
+// these defines have to precede #include "INTO_atomic.h"
+#define __DEBUG_CHECK_INTEGER_OVERFLOW								// this switch changes unsignedo etc. typedefs back and forth between overflow checked and unchecked versions
+#define __DEBUG_CHECK_INTEGER_OVERFLOW_ALIAS						// unsignedo etc. typedefs can be turned off if not needed
+#include "INTO_atomic.h"
+
+auto TryOrExcept = [](std::string description, std::function<std::string(void)> tryThis) {
+	try
+	{
+		std::cout << "Trying " << description << "...";
+		std::string result = tryThis();
+		std::cout << "OK! [" << result << "]\n";
+	}
+	catch (std::exception& e)
+	{
+		std::cout << "Exception: " << e.what() << std::endl;
+	}
+};
+
+#define CHECK(cond) do { if (!(cond)) { std::cout << "FAILED: " #cond " (line " << __LINE__ << ")\n"; ++failures; } } while (0)
+
+int main()
+{
+	int failures = 0;
+	const int64_t max = std::numeric_limits<int64_t>::max();
+
+	TryOrExcept("Reject: INT64_MAX-1 += 5 (expect overflow)", [&]() {
+		atomic_overflowchecked<int64_t> c(max - 1);
+		try { c += 5; } catch (...) { CHECK(static_cast<int64_t>(c) == max - 1); throw; }		// old value kept
+		return std::to_string(static_cast<int64_t>(c));
+	});
+	TryOrExcept("Report: INT64_MAX-1 fetch_add 5 (expect overflow)", [&]() {
+		atomic_overflowchecked<int64_t, AtomicOverflowPolicy::Report> c(max - 1);
+		try { c.fetch_add(5); } catch (...) { CHECK(static_cast<int64_t>(c) == std::numeric_limits<int64_t>::min() + 3); throw; }	// wrapped value stays
+		return std::to_string(static_cast<int64_t>(c));
+	});
+	TryOrExcept("Saturate: INT64_MAX-1 += 5", [&]() {
+		atomic_overflowchecked<int64_t, AtomicOverflowPolicy::Saturate> c(max - 1);
+		const int64_t r = (c += 5);
+		CHECK(r == max && static_cast<int64_t>(c) == max);
+		return std::to_string(r);
+	});
+	TryOrExcept("Saturate: -3 * INT64_MAX", [&]() {
+		atomic_overflowchecked<int64_t, AtomicOverflowPolicy::Saturate> c(-3);
+		const int64_t r = (c *= max);
+		CHECK(r == std::numeric_limits<int64_t>::min());
+		return std::to_string(r);
+	});
+	TryOrExcept("Reject: unsigned 3 -= 4 (expect overflow)", [&]() { atomic_overflowchecked<unsigned> c(3u); c -= 4u; return std::to_string(static_cast<unsigned>(c)); });
+	TryOrExcept("Reject: 1 << 40 fetch_mul 1 << 30 (expect overflow)", [&]() { atomic_overflowchecked<int64_t> c(int64_t(1) << 40); c.fetch_mul(int64_t(1) << 30); return std::to_string(static_cast<int64_t>(c)); });
+	TryOrExcept("Reject: overflowchecked<int> operand", [&]() { atomic_overflowchecked<int64_t> c(10); c.fetch_add(overflowchecked<int>(-20)); return std::to_string(static_cast<int64_t>(c.load())); });
+
+	// concurrent: every increment counted exactly once, and with Reject exactly the in-range ones succeed
+	{
+		const int threads = 4, perThread = 100000;
+		atomic_overflowchecked<int64_t> sum;
+		atomic_overflowchecked<int32_t> capped(std::numeric_limits<int32_t>::max() - 1000);
+		std::atomic<int> rejected(0);
+		std::vector<std::thread> workers;
+		for (int t = 0; t < threads; ++t)
+		{
+			workers.emplace_back([&]() {
+				for (int i = 0; i < perThread; ++i)
+				{
+					++sum;
+					try { ++capped; } catch (INTO_exception&) { ++rejected; }
+				}
+			});
+		}
+		for (auto& w : workers)
+			w.join();
+		CHECK(static_cast<int64_t>(sum) == int64_t(threads) * perThread);
+		CHECK(static_cast<int32_t>(capped) == std::numeric_limits<int32_t>::max());
+		CHECK(rejected == threads * perThread - 1000);
+	}
+
+	if (failures == 0)
+		std::cout << "atomic_overflowchecked: Test OK\n";
+	return failures != 0;
+}
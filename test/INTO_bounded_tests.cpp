@@ -0,0 +1,65 @@
+#include <iostream>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <functional>
+#include <type_traits>
+
+// these defines have to precede #include "INTO_bounded.h"
+#define __DEBUG_CHECK_INTEGER_OVERFLOW								// this switch changes unsignedo etc. typedefs back and forth between overflow checked and unchecked versions
+#define __DEBUG_CHECK_INTEGER_OVERFLOW_ALIAS						// unsignedo etc. typedefs can be turned off if not needed
+#include "INTO_bounded.h"
+
+auto TryOrExcept = [](std::string description, std::function<std::string(void)> tryThis) {
+	try
+	{
+		std::cout << "Trying " << description << "...";
+		std::string result = tryThis();
+		std::cout << "OK! [" << result << "]\n";
+	}
+	catch (std::exception& e)
+	{
+		std::cout << "Exception: " << e.what() << std::endl;
+	}
+};
+
+typedef bounded<int, 0, 65535> sample_t;
+typedef bounded<int, 0, 1000> percent10_t;
+
+// the result ranges are part of the types, so most of the checking happens here
+static_assert(std::is_same<decltype(sample_t(1) + sample_t(2)), bounded<int, 0, 131070>>::value, "range of + is propagated");
+static_assert(std::is_same<decltype(sample_t(1) - sample_t(2)), bounded<int, -65535, 65535>>::value, "range of - is propagated");
+static_assert(std::is_same<decltype(sample_t(1) * sample_t(2)), bounded<int, 0, std::numeric_limits<int>::max()>>::value, "range of * is clamped to int");
+static_assert(std::is_same<decltype(sample_t(1) / bounded<int, 1, 16>(2)), bounded<int, 0, 65535>>::value, "range of / is propagated");
+static_assert(std::is_same<decltype(bounded<int, -10, 10>(1) / bounded<int, -2, 3>(1)), bounded<int, -10, 10>>::value, "divisor range through zero");
+static_assert(std::is_same<decltype(bounded<int, 10, 20>(10) / bounded<int, 2, 5>(2)), bounded<int, 2, 10>>::value, "smallest quotient is by the largest divisor");
+static_assert(std::is_same<decltype(bounded<int, -20, -10>(-10) / bounded<int, 2, 5>(2)), bounded<int, -10, -2>>::value, "negative numerator range");
+static_assert(std::is_same<decltype(bounded<int, 10, 20>(10) / bounded<int, -5, -2>(-2)), bounded<int, -10, -2>>::value, "negative divisor range");
+static_assert(std::is_same<decltype(bounded<int, -7, 20>(1) / bounded<int, -3, 5>(1)), bounded<int, -20, 20>>::value, "mixed signs on both sides");
+static_assert(std::is_same<decltype(bounded<int, 3, 9>(3) / bounded<int, -4, 0>(-1)), bounded<int, -9, 0>>::value, "divisor range ending at zero");
+static_assert(std::is_same<decltype(bounded_constant<1000>()), bounded<int, 1000, 1000>>::value, "bounded_constant");
+static_assert(sizeof(sample_t) == sizeof(int), "no space overhead");
+
+int main()
+{
+	TryOrExcept("sample_t 65535 + 65535 (no runtime check emitted)", []() { sample_t a = 65535, b = 65535; int r = a + b; return std::to_string(r); });
+	TryOrExcept("sample_t 40000 * 40000 (checked at runtime, fits)", []() { sample_t a = 40000, b = 40000; long long r = a * b; return std::to_string(r); });
+	TryOrExcept("sample_t 50000 * 50000 (expect overflow)", []() { sample_t a = 50000, b = 50000; long long r = a * b; return std::to_string(r); });
+	TryOrExcept("sample_t initialized with 70000 (expect overflow)", []() { sample_t a = 70000; return std::to_string(a); });
+	TryOrExcept("sample_t initialized with uint16_t (unchecked, subset)", []() { uint16_t v = 65535; sample_t a = v; return std::to_string(a); });
+	TryOrExcept("percent10_t = sample_t 999 (narrowing, checked)", []() { sample_t a = 999; percent10_t p = a; return std::to_string(p); });
+	TryOrExcept("percent10_t = sample_t 1001 (expect overflow)", []() { sample_t a = 1001; percent10_t p = a; return std::to_string(p); });
+	TryOrExcept("sample_t = percent10_t (widening, unchecked)", []() { percent10_t p = 1000; sample_t a = p; return std::to_string(a); });
+	TryOrExcept("percent10_t * 1000 / 65535", []() { percent10_t p = 500; auto r = p * bounded_constant<1000>() / bounded_constant<65535>(); return std::to_string(r); });
+	TryOrExcept("bounded<int,2,10> = bounded<int,10,20> 10 / bounded<int,2,5> 5 (unchecked, subset)", []() { bounded<int, 10, 20> a = 10; bounded<int, 2, 5> b = 5; bounded<int, 2, 10> r = a / b; return std::to_string(r); });
+	TryOrExcept("bounded<int,3,10> = bounded<int,10,20> 10 / bounded<int,2,5> 5 (expect overflow)", []() { bounded<int, 10, 20> a = 10; bounded<int, 2, 5> b = 5; bounded<int, 3, 10> r = a / b; return std::to_string(r); });
+	TryOrExcept("bounded<int,-10,10> / bounded<int,-2,3> 0 (expect division by zero)", []() { bounded<int, -10, 10> a = 7; bounded<int, -2, 3> b = 0; int r = a / b; return std::to_string(r); });
+	TryOrExcept("bounded<int> INT_MIN / -1 (expect overflow)", []() { bounded<int> a = std::numeric_limits<int>::min(); bounded<int> b = -1; int r = a / b; return std::to_string(r); });
+	TryOrExcept("bounded<unsigned> 0 - 1 (expect overflow)", []() { bounded<unsigned> a = 0u, b = 1u; unsigned r = a - b; return std::to_string(r); });
+	TryOrExcept("bounded<int64_t> max + 1 (expect overflow)", []() { bounded<int64_t> a = std::numeric_limits<int64_t>::max(); bounded<int64_t, 0, 1> b = 1; int64_t r = a + b; return std::to_string(r); });
+	TryOrExcept("overflowchecked<int> 70000 to sample_t (expect overflow)", []() { overflowchecked<int> o = 70000; sample_t a(o); return std::to_string(a); });
+	TryOrExcept("sample_t 65535 to overflowchecked<short> (expect overflow)", []() { sample_t a = 65535; overflowchecked<short> o(a); return std::to_string(o); });
+	TryOrExcept("sample_t 65535 to overflowchecked<unsigned short>", []() { sample_t a = 65535; overflowchecked<unsigned short> o(a); return std::to_string(o); });
+	TryOrExcept("bounded<int> -1 to overflowchecked<uint64_t> (expect overflow)", []() { bounded<int> a = -1; overflowchecked<uint64_t> o(a); return std::to_string(o); });
+	return 0;
+}
@@ -0,0 +1,94 @@
+#!/bin/sh
+# Compile-time cost of INTO on a many-TU project: header-only INTO.h against INTO_core.h with
+# __DEBUG_CHECK_INTEGER_OVERFLOW_PRECOMPILED (reporting code and alias type instantiations in INTO.cpp).
+#
+# Generates TUS translation units (64 by default), each one using every alias type with all four operators
+# plus a mixed-type expression, like a project compiled with __DEBUG_CHECK_INTEGER_OVERFLOW_ALIAS would, and
+# compiles them one by one at -O0 and -O2 in both configurations (INTO.cpp is counted in the second one).
+# With clang++ each compilation also writes a -ftime-trace JSON; the frontend / template instantiation totals
+# are summed over the TUs. Other compilers only get the wall clock time.
+#
+#		CXX=clang++ test/INTO_compiletime_bench.sh [TUS]
+
+set -e
+TUS=${1:-64}
+CXX=${CXX:-c++}
+SRC=$(cd "$(dirname "$0")/../src/INTO" && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+case $("$CXX" --version 2>/dev/null | head -n 1) in
+	*clang*) TIMETRACE=1 ;;
+	*) TIMETRACE=0 ;;
+esac
+
+i=0
+while [ $i -lt "$TUS" ]; do
+	cat > "$WORK/tu$i.cpp" <<EOF
+#define __DEBUG_CHECK_INTEGER_OVERFLOW
+#define __DEBUG_CHECK_INTEGER_OVERFLOW_ALIAS
+#include INTO_HEADER
+
+template <typename T> T Work$i(T a, T b, T c) { return (a + b) * c - a / (b + T(1)); }
+
+long long Tu$i(int n)
+{
+	long long sum = 0;
+	sum += Work$i<charo>(charo(n % 8), charo(2), charo(3));
+	sum += Work$i<scharo>(scharo(n % 8), scharo(2), scharo(3));
+	sum += Work$i<ucharo>(ucharo(n % 8), ucharo(2), ucharo(3));
+	sum += Work$i<shorto>(shorto(n % 100), shorto(2), shorto(3));
+	sum += Work$i<ushorto>(ushorto(n % 100), ushorto(2), ushorto(3));
+	sum += Work$i<into>(into(n), into(2), into(3));
+	sum += Work$i<uinto>(uinto(n), uinto(2), uinto(3));
+	sum += Work$i<longo>(longo(n), longo(2), longo(3));
+	sum += Work$i<ulongo>(ulongo(n), ulongo(2), ulongo(3));
+	sum += Work$i<llongo>(llongo(n), llongo(2), llongo(3));
+	sum += Work$i<ullongo>(ullongo(n), ullongo(2), ullongo(3));
+	sum += llongo(n) * into(7) + longo(n);
+	return sum;
+}
+EOF
+	i=$((i + 1))
+done
+
+now_ms() { echo $(($(date +%s%N) / 1000000)); }
+
+# $1: label, $2: optimization, $3: header, $4...: extra flags
+run() {
+	label=$1; opt=$2; header=$3; shift 3
+	rm -f "$WORK"/*.json "$WORK"/*.o
+	flags="-std=c++17 $opt -I$SRC -DINTO_HEADER=<$header> $*"
+	[ $TIMETRACE -eq 1 ] && flags="$flags -ftime-trace"
+	start=$(now_ms)
+	if [ "$header" = "INTO_core.h" ]; then
+		"$CXX" $flags -c "$SRC/INTO.cpp" -o "$WORK/INTO.o"
+	fi
+	i=0
+	while [ $i -lt "$TUS" ]; do
+		"$CXX" $flags -c "$WORK/tu$i.cpp" -o "$WORK/tu$i.o"
+		i=$((i + 1))
+	done
+	end=$(now_ms)
+	printf '%-28s %-4s %8d ms' "$label" "$opt" $((end - start))
+	if [ $TIMETRACE -eq 1 ]; then
+		python3 - "$WORK" <<'EOF'
+import glob, json, sys
+totals = {}
+for path in glob.glob(sys.argv[1] + "/*.json"):
+	for event in json.load(open(path))["traceEvents"]:
+		if event.get("name", "").startswith("Total "):
+			totals[event["name"]] = totals.get(event["name"], 0) + event.get("dur", 0)
+print("".join("   %s %d ms" % (name[6:], totals.get(name, 0) // 1000) for name in
+	("Total Frontend", "Total Source", "Total InstantiateClass", "Total InstantiateFunction", "Total Backend")))
+EOF
+	else
+		echo
+	fi
+}
+
+echo "$TUS TUs, $CXX"
+for opt in -O0 -O2; do
+	run "header-only INTO.h" $opt INTO.h
+	run "INTO_core.h + INTO.cpp" $opt INTO_core.h -D__DEBUG_CHECK_INTEGER_OVERFLOW_PRECOMPILED
+done
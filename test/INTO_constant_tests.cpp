@@ -0,0 +1,91 @@
+#include <iostream>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <functional>
+#include <type_traits>
+
+// these defines have to precede #include "INTO_constant.h"
+#define __DEBUG_CHECK_INTEGER_OVERFLOW								// this switch changes unsignedo etc. typedefs back and forth between overflow checked and unchecked versions
+#define __DEBUG_CHECK_INTEGER_OVERFLOW_ALIAS						// unsignedo etc. typedefs can be turned off if not needed
+#include "INTO_constant.h"
+
+using namespace INTO::literals;
+
+auto TryOrExcept = [](std::string description, std::function<std::string(void)> tryThis) {
+	try
+	{
+		std::cout << "Trying " << description << "...";
+		std::string result = tryThis();
+		std::cout << "OK! [" << result << "]\n";
+	}
+	catch (std::exception& e)
+	{
+		std::cout << "Exception: " << e.what() << std::endl;
+	}
+};
+
+static_assert(std::is_same<decltype(1000_ic), INTO::constant<1000>>::value, "decimal literal is int");
+static_assert(std::is_same<decltype(3'000'000'000_ic), INTO::constant<3000000000L>>::value, "decimal literal too big for int is long");
+static_assert(std::is_same<decltype(0xFFFFFFFF_ic), INTO::constant<0xFFFFFFFFu>>::value, "hex literal may be unsigned");
+static_assert(std::is_same<decltype(-1_ic), INTO::constant<-1>>::value, "negated literal");
+static_assert(decltype(0b1010_ic)::value == 10 && decltype(017_ic)::value == 15, "binary and octal literals");
+
+// every operand/constant combination of a small type against the exact result computed in int
+template <typename T, auto K> int ExhaustiveCheck()
+{
+	int failures = 0;
+	auto check = [&](const char* op, int x, bool threw, long long exact, long long result) {
+		const bool fits = exact >= std::numeric_limits<T>::min() && exact <= std::numeric_limits<T>::max();
+		if (threw == fits || (fits && result != exact))
+		{
+			std::cout << "FAILED: " << typeid(T).name() << " " << x << op << static_cast<long long>(K) << " exact " << exact << (threw ? " threw" : " didn't throw") << "\n";
+			++failures;
+		}
+	};
+	for (int x = std::numeric_limits<T>::min(); x <= std::numeric_limits<T>::max(); ++x)
+	{
+		const overflowchecked<T> v = static_cast<T>(x);
+		const INTO::constant<static_cast<T>(K)> k;			// of type T, otherwise the common type would be int
+		long long r = 0;
+		bool threw = false;
+		try { r = static_cast<T>(v * k); } catch (INTO_exception&) { threw = true; }
+		check("*", x, threw, static_cast<long long>(x) * K, r);
+		threw = false;
+		try { r = static_cast<T>(v + k); } catch (INTO_exception&) { threw = true; }
+		check("+", x, threw, static_cast<long long>(x) + K, r);
+		threw = false;
+		try { r = static_cast<T>(v - k); } catch (INTO_exception&) { threw = true; }
+		check("-", x, threw, static_cast<long long>(x) - K, r);
+		threw = false;
+		try { r = static_cast<T>(k - v); } catch (INTO_exception&) { threw = true; }
+		check(" (reversed) -", x, threw, K - static_cast<long long>(x), r);
+		if constexpr (K != 0)
+		{
+			threw = false;
+			try { r = static_cast<T>(v / k); } catch (INTO_exception&) { threw = true; }
+			check("/", x, threw, static_cast<long long>(x) / K, r);
+		}
+	}
+	return failures;
+}
+
+int main()
+{
+	TryOrExcept("into 3000000 * 1000_ic (expect overflow)", []() { into x = 3000000; int r = x * 1000_ic; return std::to_string(r); });
+	TryOrExcept("into -2000000 * 1000_ic", []() { into x = -2000000; int r = x * 1000_ic; return std::to_string(r); });
+	TryOrExcept("into INT_MIN * -1_ic (expect overflow)", []() { into x = std::numeric_limits<int>::min(); int r = x * -1_ic; return std::to_string(r); });
+	TryOrExcept("into INT_MAX - 5 + 10_ic (expect overflow)", []() { into x = std::numeric_limits<int>::max() - 5; int r = x + 10_ic; return std::to_string(r); });
+	TryOrExcept("uinto 3 - 5_ic (expect overflow)", []() { uinto x = 3u; unsigned r = x - INTO::constant<5u>(); return std::to_string(r); });
+	TryOrExcept("into INT_MIN / -1_ic (expect overflow)", []() { into x = std::numeric_limits<int>::min(); int r = x / -1_ic; return std::to_string(r); });
+	TryOrExcept("llongo 1000000 * 3'000'000'000_ic", []() { llongo x = 1000000LL; long long r = x * 3'000'000'000_ic; return std::to_string(r); });
+
+	int failures = 0;
+	failures += ExhaustiveCheck<int8_t, 0>() + ExhaustiveCheck<int8_t, 1>() + ExhaustiveCheck<int8_t, -1>() + ExhaustiveCheck<int8_t, 3>();
+	failures += ExhaustiveCheck<int8_t, -7>() + ExhaustiveCheck<int8_t, 127>() + ExhaustiveCheck<int8_t, -128>() + ExhaustiveCheck<int8_t, 64>();
+	failures += ExhaustiveCheck<uint8_t, 0>() + ExhaustiveCheck<uint8_t, 1>() + ExhaustiveCheck<uint8_t, 10>() + ExhaustiveCheck<uint8_t, 255>();
+	failures += ExhaustiveCheck<int16_t, 1000>() + ExhaustiveCheck<int16_t, -32768>() + ExhaustiveCheck<uint16_t, 300>();
+	if (failures == 0)
+		std::cout << "Exhaustive small type check: Test OK\n";
+	return failures != 0;
+}
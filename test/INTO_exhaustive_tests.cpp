@@ -0,0 +1,175 @@
+// Exhaustive verification of the INTO operators: every operand pair of every 8/16-bit type combination,
+// for +, -, * and /, against the exact result computed in 128 bits.
+//
+// The pairs go through the non-throwing checks the operators are built on (AddOverflows etc.), row by row
+// (one lhs value against every rhs value), the rows are handed out to all hardware threads. The throwing
+// operators themselves are verified on the 8-bit matrix. The full matrix, 16x16-bit included (4 x 2^32 pairs per
+// operator), is the default; --quick skips the 16x16-bit combinations for a fast local run.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <thread>
+#include <typeinfo>
+#include <vector>
+
+#define __DEBUG_CHECK_INTEGER_OVERFLOW
+#include "INTO.h"
+
+typedef __int128 Reference_t;
+
+enum class Op { Add, Sub, Mul, Div };
+const char* OP_NAMES[] = { "+", "-", "*", "/" };
+
+template <Op op, typename U, typename V> inline bool Check(U lhs, V rhs, INTO_common_t<U, V>& result)
+{
+	if constexpr (op == Op::Add)		return AddOverflows(lhs, rhs, result);
+	else if constexpr (op == Op::Sub)	return SubOverflows(lhs, rhs, result);
+	else if constexpr (op == Op::Mul)	return MulOverflows(lhs, rhs, result);
+	else								return DivOverflows(lhs, rhs, result);
+}
+
+// the operands as the operation sees them: converted to the common type
+template <Op op, typename C> inline Reference_t Exact(C lhs, C rhs)
+{
+	if constexpr (op == Op::Add)		return Reference_t(lhs) + Reference_t(rhs);
+	else if constexpr (op == Op::Sub)	return Reference_t(lhs) - Reference_t(rhs);
+	else if constexpr (op == Op::Mul)	return Reference_t(lhs) * Reference_t(rhs);
+	else								return Reference_t(lhs) / Reference_t(rhs);
+}
+
+struct Failure
+{
+	long long lhs, rhs;
+	bool bReportedOverflow;
+};
+
+// one row: lhs against every rhs; returns the number of mismatches, keeps the first one
+template <Op op, typename U, typename V> uint64_t CheckRow(U lhs, Failure& first)
+{
+	using C = INTO_common_t<U, V>;
+	constexpr Reference_t lowerBound = std::numeric_limits<C>::min(), upperBound = std::numeric_limits<C>::max();
+	uint64_t failures = 0;
+	for (long long r = std::numeric_limits<V>::min(); r <= std::numeric_limits<V>::max(); ++r)
+	{
+		const V rhs = static_cast<V>(r);
+		if (op == Op::Div && rhs == 0)
+			continue;
+		C result;
+		const bool bOverflow = Check<op>(lhs, rhs, result);
+		const Reference_t exact = Exact<op>(static_cast<C>(lhs), static_cast<C>(rhs));
+		const bool bExactOverflow = exact < lowerBound || exact > upperBound;
+		const bool bWrong = bOverflow != bExactOverflow || (!bExactOverflow && Reference_t(result) != exact);
+		if (bWrong && failures++ == 0)
+			first = { static_cast<long long>(lhs), r, bOverflow };
+	}
+	return failures;
+}
+
+template <Op op, typename U, typename V> uint64_t CheckMatrix(unsigned threads)
+{
+	std::atomic<long long> nextRow(std::numeric_limits<U>::min());
+	std::atomic<uint64_t> failures(0);
+	Failure first = {};
+	std::atomic<bool> bFirstTaken(false);
+	auto work = [&]() {
+		for (;;)
+		{
+			const long long row = nextRow++;
+			if (row > std::numeric_limits<U>::max())
+				break;
+			Failure rowFirst;
+			const uint64_t rowFailures = CheckRow<op, U, V>(static_cast<U>(row), rowFirst);
+			if (rowFailures)
+			{
+				failures += rowFailures;
+				if (!bFirstTaken.exchange(true))
+					first = rowFirst;
+			}
+		}
+	};
+	std::vector<std::thread> workers;
+	for (unsigned i = 1; i < threads; ++i)
+		workers.emplace_back(work);
+	work();
+	for (auto& w : workers)
+		w.join();
+	if (failures)
+	{
+		std::cout << "FAILED: " << typeid(U).name() << " " << OP_NAMES[static_cast<int>(op)] << " " << typeid(V).name() << ": " << failures <<
+			" wrong, first: " << first.lhs << OP_NAMES[static_cast<int>(op)] << first.rhs << (first.bReportedOverflow ? " reported" : " didn't report") << " overflow\n";
+	}
+	return failures;
+}
+
+template <typename U, typename V> uint64_t CheckAllOps(unsigned threads)
+{
+	const auto start = std::chrono::steady_clock::now();
+	const uint64_t failures = CheckMatrix<Op::Add, U, V>(threads) + CheckMatrix<Op::Sub, U, V>(threads) +
+		CheckMatrix<Op::Mul, U, V>(threads) + CheckMatrix<Op::Div, U, V>(threads);
+	const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	std::cout << typeid(U).name() << " x " << typeid(V).name() << ": " << (failures ? "FAILED" : "OK") << " (" << elapsed.count() << " s)\n";
+	return failures;
+}
+
+// the throwing operators around the checks, on the full 8-bit matrix
+template <typename U, typename V> uint64_t CheckOperators()
+{
+	using C = INTO_common_t<U, V>;
+	uint64_t failures = 0;
+	for (int l = std::numeric_limits<U>::min(); l <= std::numeric_limits<U>::max(); ++l)
+	{
+		for (int r = std::numeric_limits<V>::min(); r <= std::numeric_limits<V>::max(); ++r)
+		{
+			const overflowchecked<U> lhs = static_cast<U>(l);
+			const overflowchecked<V> rhs = static_cast<V>(r);
+			const Reference_t exacts[] = { Reference_t(C(l)) + C(r), Reference_t(C(l)) - C(r), Reference_t(C(l)) * C(r), r ? Reference_t(C(l)) / C(r) : 0 };
+			for (int op = 0; op < (r ? 4 : 3); ++op)
+			{
+				const bool bExactOverflow = exacts[op] < std::numeric_limits<C>::min() || exacts[op] > std::numeric_limits<C>::max();
+				bool bThrew = false;
+				C result = 0;
+				try
+				{
+					result = op == 0 ? C(lhs + rhs) : op == 1 ? C(lhs - rhs) : op == 2 ? C(lhs * rhs) : C(lhs / rhs);
+				}
+				catch (INTO_exception&)
+				{
+					bThrew = true;
+				}
+				if (bThrew != bExactOverflow || (!bThrew && Reference_t(result) != exacts[op]))
+					++failures;
+			}
+		}
+	}
+	std::cout << "operators " << typeid(U).name() << " x " << typeid(V).name() << ": " << (failures ? "FAILED" : "OK") << "\n";
+	return failures;
+}
+
+int main(int argc, char* argv[])
+{
+	const bool bFull = !(argc > 1 && std::strcmp(argv[1], "--quick") == 0);
+	const unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+	std::cout << threads << " threads" << (bFull ? ", full 16x16-bit matrix" : ", 16x16-bit matrix skipped (--quick)") << "\n";
+
+	uint64_t failures = 0;
+	failures += CheckOperators<int8_t, int8_t>() + CheckOperators<uint8_t, uint8_t>() + CheckOperators<int8_t, uint8_t>() + CheckOperators<uint8_t, int8_t>();
+
+	failures += CheckAllOps<int8_t, int8_t>(threads) + CheckAllOps<int8_t, uint8_t>(threads) + CheckAllOps<uint8_t, int8_t>(threads) + CheckAllOps<uint8_t, uint8_t>(threads);
+	failures += CheckAllOps<int8_t, int16_t>(threads) + CheckAllOps<int16_t, int8_t>(threads) + CheckAllOps<uint8_t, uint16_t>(threads) + CheckAllOps<uint16_t, uint8_t>(threads);
+	failures += CheckAllOps<int8_t, uint16_t>(threads) + CheckAllOps<uint16_t, int8_t>(threads) + CheckAllOps<uint8_t, int16_t>(threads) + CheckAllOps<int16_t, uint8_t>(threads);
+	if (bFull)
+	{
+		failures += CheckAllOps<int16_t, int16_t>(threads) + CheckAllOps<int16_t, uint16_t>(threads);
+		failures += CheckAllOps<uint16_t, int16_t>(threads) + CheckAllOps<uint16_t, uint16_t>(threads);
+	}
+
+	if (failures == 0)
+		std::cout << "Exhaustive INTO operator check: Test OK\n";
+	return failures != 0;
+}
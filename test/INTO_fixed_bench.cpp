@@ -0,0 +1,74 @@
+// Money arithmetic: fixedo<int64_t, 2> against double with std::round after each rounding step, and
+// to_chars/from_chars against snprintf/strtod.
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#define __DEBUG_CHECK_INTEGER_OVERFLOW
+#include "INTO_fixed.h"
+
+typedef fixedo<int64_t, 2> money;
+typedef fixedo<int64_t, 4> rate;
+
+template <typename F> void Measure(const char* name, size_t count, F f)
+{
+	const auto start = std::chrono::steady_clock::now();
+	const double result = f();
+	const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+	std::cout << "  " << name << ": " << elapsed.count() / count << " ns/op (" << result << ")\n";
+}
+
+int main()
+{
+	const size_t count = 10000000;
+	std::vector<money> amounts(count);
+	std::vector<double> amountsDouble(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		amounts[i] = money::from_raw(static_cast<int64_t>((i * 7919) % 1000000));
+		amountsDouble[i] = amounts[i].to_double();
+	}
+	const rate vat = rate::parse("0.2700");
+
+	std::cout << "amount * rate, rounded to cents, summed:\n";
+	Measure("double + std::round", count, [&]() {
+		double sum = 0;
+		for (double a : amountsDouble)
+			sum += std::round(a * 0.27 * 100) / 100;
+		return sum;
+	});
+	Measure("fixedo", count, [&]() {
+		money sum = 0;
+		for (money a : amounts)
+			sum += a * vat;
+		return sum.to_double();
+	});
+
+	std::cout << "formatting and parsing:\n";
+	char buffer[64];
+	Measure("snprintf(\"%.2f\") + strtod", count / 10, [&]() {
+		double sum = 0;
+		for (size_t i = 0; i < count / 10; ++i)
+		{
+			std::snprintf(buffer, sizeof(buffer), "%.2f", amountsDouble[i]);
+			sum += std::strtod(buffer, nullptr);
+		}
+		return sum;
+	});
+	Measure("INTO::to_chars + INTO::from_chars", count / 10, [&]() {
+		money sum = 0, parsed;
+		for (size_t i = 0; i < count / 10; ++i)
+		{
+			const auto written = INTO::to_chars(buffer, buffer + sizeof(buffer), amounts[i]);
+			INTO::from_chars(buffer, written.ptr, parsed);
+			sum += parsed;
+		}
+		return sum.to_double();
+	});
+	return 0;
+}
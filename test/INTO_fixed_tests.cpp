@@ -0,0 +1,98 @@
+#include <iostream>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <functional>
+
+// these defines have to precede #include "INTO_fixed.h"
+#define __DEBUG_CHECK_INTEGER_OVERFLOW								// this switch changes unsignedo etc. typedefs back and forth between overflow checked and unchecked versions
+#define __DEBUG_CHECK_INTEGER_OVERFLOW_ALIAS						// unsignedo etc. typedefs can be turned off if not needed
+#include "INTO_fixed.h"
+
+auto TryOrExcept = [](std::string description, std::function<std::string(void)> tryThis) {
+	try
+	{
+		std::cout << "Trying " << description << "...";
+		std::string result = tryThis();
+		std::cout << "OK! [" << result << "]\n";
+	}
+	catch (std::exception& e)
+	{
+		std::cout << "Exception: " << e.what() << std::endl;
+	}
+};
+
+#define CHECK(cond) do { if (!(cond)) { std::cout << "FAILED: " #cond " (line " << __LINE__ << ")\n"; ++failures; } } while (0)
+
+typedef fixedo<int64_t, 2> money;
+typedef fixedo<int64_t, 4> rate;
+using INTO::RoundingMode;
+
+int main()
+{
+	int failures = 0;
+
+	CHECK(money::parse("19.99").raw() == 1999);
+	CHECK(money::parse("-0.5").raw() == -50);
+	CHECK(money::parse("+7").to_string() == "7.00");
+	CHECK((money::parse("19.99") * 3 + money::parse("0.015")).to_string() == "59.99");
+
+	// the rounding modes on the ties and near-ties of parsing
+	CHECK(money::parse("0.125").raw() == 12 && money::parse("0.135").raw() == 14 && money::parse("0.1250001").raw() == 13);
+	CHECK(money::parse("-0.125").raw() == -12 && money::parse("-0.135").raw() == -14);
+	CHECK((fixedo<int64_t, 2, RoundingMode::HalfUp>::parse("0.125").raw() == 13));
+	CHECK((fixedo<int64_t, 2, RoundingMode::HalfUp>::parse("-0.125").raw() == -13));
+	CHECK((fixedo<int64_t, 2, RoundingMode::TowardZero>::parse("-0.129").raw() == -12));
+	CHECK((fixedo<int64_t, 2, RoundingMode::Floor>::parse("-0.121").raw() == -13));
+	CHECK((fixedo<int64_t, 2, RoundingMode::Ceiling>::parse("0.121").raw() == 13));
+
+	// multiplication/division with rescaling
+	const money amount = money::parse("100.05");
+	const rate vat = rate::parse("0.2700");
+	CHECK((amount * vat).to_string() == "27.01");								// 27.0135
+	CHECK(INTO::mul<RoundingMode::Ceiling>(amount, vat).to_string() == "27.02");
+	CHECK((money::parse("10.00") / money::parse("3.00")).to_string() == "3.33");
+	CHECK((money::parse("0.05") / 2).to_string() == "0.02");					// 0.025, half to even
+	CHECK((money::parse("0.07") / 2).to_string() == "0.04");					// 0.035
+	CHECK(amount.rescale<4>().raw() == 1000500 && rate::parse("1.23456").rescale<2>().to_string() == "1.23");
+	CHECK(money::from_double(0.125).raw() == 12 && money::from_double(2.675).raw() == 268);	// 2.675 * 100 rounds to 267.5 in double
+	CHECK(money::parse("-92233720368547758.08").raw() == std::numeric_limits<int64_t>::min());
+
+	// to_chars/from_chars
+	char buffer[32];
+	auto written = INTO::to_chars(buffer, buffer + sizeof(buffer), money::parse("-1234.5"));
+	CHECK(written.ec == std::errc() && std::string(buffer, written.ptr) == "-1234.50");
+	CHECK(INTO::to_chars(buffer, buffer + 3, money::parse("1234.5")).ec == std::errc::value_too_large);
+	money parsed = 1;
+	const char* text = "12.34;rest";
+	auto read = INTO::from_chars(text, text + std::strlen(text), parsed);
+	CHECK(read.ec == std::errc() && *read.ptr == ';' && parsed.raw() == 1234);
+	CHECK(INTO::from_chars(text + 5, text + 10, parsed).ec == std::errc::invalid_argument);
+	const char* huge = "99999999999999999999999";
+	CHECK(INTO::from_chars(huge, huge + std::strlen(huge), parsed).ec == std::errc::result_out_of_range && parsed.raw() == 1234);
+
+	bool bThrown = false;
+	try { (void)(money(1) / 0); }
+	catch (const std::exception&) { bThrown = true; }
+	CHECK(bThrown);											// reported, not SIGFPE
+	std::string message;
+	try { (void)money::from_double(9.25e16); }
+	catch (const std::exception& e) { message = e.what(); }
+	CHECK(message.find(" from_double overflow:") != std::string::npos);
+	try { (void)money::from_raw(std::numeric_limits<int64_t>::max()).rescale<4>(); }
+	catch (const std::exception& e) { message = e.what(); }
+	CHECK(message.find(" rescale overflow:") != std::string::npos);
+
+	TryOrExcept("money 92233720368547758.07 + 0.01 (expect overflow)", []() { return (money::from_raw(std::numeric_limits<int64_t>::max()) + money::parse("0.01")).to_string(); });
+	TryOrExcept("money 10^15 * 10^4 (expect overflow)", []() { return (money(1000000000000000LL) * money(10000)).to_string(); });
+	TryOrExcept("money 1 / 0 (expect division by zero)", []() { return (money(1) / money(0)).to_string(); });
+	TryOrExcept("money 1 / integer 0 (expect division by zero)", []() { return (money(1) / 0).to_string(); });
+	TryOrExcept("money 1 /= unsigned 0 (expect division by zero)", []() { money m(1); m /= 0u; return m.to_string(); });
+	TryOrExcept("money parse 10^17 (expect overflow)", []() { return money::parse("100000000000000000").to_string(); });
+	TryOrExcept("money parse \"12a\" (expect invalid argument)", []() { return money::parse("12a").to_string(); });
+
+	if (failures == 0)
+		std::cout << "fixedo: Test OK\n";
+	return failures != 0;
+}
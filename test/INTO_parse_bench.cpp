@@ -0,0 +1,93 @@
+// Parsing a CSV-like buffer of integers into into (overflowchecked<int>): strtoll and the overflowchecked
+// constructor's check, std::from_chars and the same check, INTO::parse_column.
+
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#define __DEBUG_CHECK_INTEGER_OVERFLOW
+#define __DEBUG_CHECK_INTEGER_OVERFLOW_ALIAS
+#include "INTO_parse.h"
+
+template <typename F> void Measure(const char* name, const std::string& text, size_t count, F f)
+{
+	long long best = 0;
+	double bestSeconds = 1e9;
+	for (int repeat = 0; repeat < 5; ++repeat)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		const long long result = f();
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		if (seconds < bestSeconds)
+			bestSeconds = seconds, best = result;
+	}
+	std::cout << "  " << name << ": " << bestSeconds * 1e9 / count << " ns/value, " << text.size() / bestSeconds / 1e9 << " GB/s (sum " << best << ")\n";
+}
+
+// rows of 8 columns, values of 1 to 10 digits, some negative
+std::string MakeCsv(size_t count, size_t& written)
+{
+	std::mt19937 random(1);
+	std::string text;
+	for (written = 0; written < count; ++written)
+	{
+		const int digits = 1 + random() % 10;
+		long long value = random() % 2147483647LL;
+		for (int d = 10; d > digits; --d)
+			value /= 10;
+		if (random() % 4 == 0)
+			value = -value;
+		text += std::to_string(value);
+		text += (written % 8 == 7) ? '\n' : ',';
+	}
+	return text;
+}
+
+int main()
+{
+	size_t count;
+	const std::string text = MakeCsv(10000000, count);
+	std::vector<into> values(count);
+	std::cout << count << " values, " << (text.size() >> 20) << " MB of text\n";
+
+	auto sum = [&]() {
+		long long s = 0;
+		for (into v : values)
+			s += static_cast<int>(v);
+		return s;
+	};
+	Measure("strtoll + overflowchecked(long long)", text, count, [&]() {
+		const char* p = text.c_str();
+		for (size_t i = 0; i < count; ++i)
+		{
+			char* end;
+			values[i] = into(std::strtoll(p, &end, 10));
+			p = end + 1;
+		}
+		return sum();
+	});
+	Measure("std::from_chars + overflowchecked(long long)", text, count, [&]() {
+		const char* p = text.data();
+		const char* last = p + text.size();
+		for (size_t i = 0; i < count; ++i)
+		{
+			long long v = 0;
+			const std::from_chars_result r = std::from_chars(p, last, v);
+			if (r.ec != std::errc())
+				return -1LL;
+			p = r.ptr + 1;
+			values[i] = into(v);
+		}
+		return sum();
+	});
+	Measure("INTO::parse_column", text, count, [&]() {
+		const INTO::parse_column_result r = INTO::parse_column(text, ',', values.data(), values.size());
+		return r.ec == std::errc() && r.count == count ? sum() : -1;
+	});
+	return 0;
+}
@@ -0,0 +1,142 @@
+#include <charconv>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+// these defines have to precede #include "INTO_parse.h"
+#define __DEBUG_CHECK_INTEGER_OVERFLOW
+#define __DEBUG_CHECK_INTEGER_OVERFLOW_ALIAS
+#include "INTO_parse.h"
+
+#define CHECK(condition)	if (!(condition)) { std::cout << "FAILED: " << #condition << " at line " << __LINE__ << "\n"; bError = true; }
+
+// INTO::parse has to agree with std::from_chars on value, error and end position
+template <typename T> bool SameAsFromChars(const std::string& text)
+{
+	T expected = 42, actual = 42;
+	const std::from_chars_result reference = std::from_chars(text.data(), text.data() + text.size(), expected);
+	const INTO::parse_chars_result parsed = INTO::parse(text.data(), text.data() + text.size(), actual);
+	const bool bSame = reference.ec == parsed.ec && reference.ptr == parsed.ptr && expected == actual;
+	if (!bSame)
+		std::cout << "  differs from std::from_chars on \"" << text << "\"\n";
+	return bSame;
+}
+
+// digit runs of every length up to past the 20 digits of uint64_t, leading zeros, signs and stray characters
+template <typename T> bool CheckRandom(unsigned seed)
+{
+	std::mt19937_64 random(seed);
+	const char* prefixes[] = { "", "", "", "-", "+", "0", "000000000", "-0", " " };
+	const char* suffixes[] = { "", "", ",", "\n", "x", "5", ".5", "-" };
+	bool bSame = true;
+	for (int i = 0; i < 100000; ++i)
+	{
+		std::string text = prefixes[random() % std::size(prefixes)];
+		const size_t length = random() % 24;
+		for (size_t d = 0; d < length; ++d)
+			text += static_cast<char>('0' + random() % 10);
+		text += suffixes[random() % std::size(suffixes)];
+		bSame = SameAsFromChars<T>(text) && bSame;
+	}
+	return bSame;
+}
+
+// the limits and one past them, for every type
+template <typename T> bool CheckLimits()
+{
+	typedef std::numeric_limits<T> L;
+	bool bSame = SameAsFromChars<T>(std::to_string(L::max())) && SameAsFromChars<T>(std::to_string(L::min()));
+	std::string above = std::to_string(L::max());
+	for (size_t i = above.size(); i-- > 0; )
+	{
+		if (above[i] != '9') { ++above[i]; break; }
+		above[i] = '0';
+	}
+	bSame = SameAsFromChars<T>(above) && SameAsFromChars<T>("0" + above) && bSame;
+	if (L::is_signed)
+	{
+		std::string below = std::to_string(L::min());
+		++below.back();									// no limit ends in 9
+		bSame = SameAsFromChars<T>(below) && bSame;
+	}
+	return bSame && SameAsFromChars<T>("18446744073709551615") && SameAsFromChars<T>("18446744073709551616") &&
+		SameAsFromChars<T>("99999999999999999999") && SameAsFromChars<T>("100000000000000000000") && SameAsFromChars<T>("-9223372036854775809");
+}
+
+int main()
+{
+	bool bError = false;
+
+	CHECK(CheckRandom<int8_t>(1) && CheckRandom<uint8_t>(2) && CheckRandom<int16_t>(3) && CheckRandom<uint16_t>(4));
+	CHECK(CheckRandom<int32_t>(5) && CheckRandom<uint32_t>(6) && CheckRandom<int64_t>(7) && CheckRandom<uint64_t>(8));
+	CHECK(CheckLimits<int8_t>() && CheckLimits<uint8_t>() && CheckLimits<int16_t>() && CheckLimits<uint16_t>());
+	CHECK(CheckLimits<int32_t>() && CheckLimits<uint32_t>() && CheckLimits<int64_t>() && CheckLimits<uint64_t>());
+
+	// whole strings, into overflowchecked<T>
+	{
+		const INTO::parse_value_result<into> ok = INTO::parse<into>("-2147483648");
+		CHECK(ok && static_cast<int>(ok.value) == std::numeric_limits<int>::min());
+		CHECK(INTO::parse<into>("2147483648").ec == std::errc::result_out_of_range);
+		CHECK(INTO::parse<unsignedo>("-1").ec == std::errc::invalid_argument);
+		CHECK(INTO::parse<llongo>("12 ").ec == std::errc::invalid_argument);
+		CHECK(INTO::parse<llongo>("").ec == std::errc::invalid_argument);
+		CHECK(INTO::parse<int16_t>("00000000000000000000000000032767").value == 32767);
+		bool bThrown = false;
+		try { ok.value + into(-1); }
+		catch (const INTO_exception&) { bThrown = true; }
+		CHECK(bThrown);									// still checked from there on
+	}
+
+	// columns
+	{
+		std::vector<llongo> values(8);
+		std::string text = "1,-22,333\r\n4444,55555\n-9223372036854775808\n";
+		INTO::parse_column_result r = INTO::parse_column(text, ',', values.data(), values.size());
+		CHECK(r.ec == std::errc() && r.count == 6);
+		CHECK(static_cast<long long>(values[1]) == -22 && static_cast<long long>(values[5]) == std::numeric_limits<long long>::min());
+
+		std::vector<int8_t> small(8);
+		text = "1;2;300;4";
+		r = INTO::parse_column(text, ';', small.data(), small.size());
+		CHECK(r.ec == std::errc::result_out_of_range && r.count == 2 && r.ptr == text.data() + 4);
+		text = "1;;3";
+		r = INTO::parse_column(text, ';', small.data(), small.size());
+		CHECK(r.ec == std::errc::invalid_argument && r.count == 1 && r.ptr == text.data() + 2);
+		text = "1;2;";
+		r = INTO::parse_column(text, ';', small.data(), small.size());
+		CHECK(r.ec == std::errc::invalid_argument && r.count == 2);
+		text = "1;2x;3";
+		r = INTO::parse_column(text, ';', small.data(), small.size());
+		CHECK(r.ec == std::errc::invalid_argument && r.count == 1 && r.ptr == text.data() + 2);
+		text = "1;2;3";
+		r = INTO::parse_column(text, ';', small.data(), 2);
+		CHECK(r.ec == std::errc::value_too_large && r.count == 2 && r.ptr == text.data() + 4);
+		r = INTO::parse_column(std::string_view(), ';', small.data(), small.size());
+		CHECK(r.ec == std::errc() && r.count == 0);
+
+		// fields of every length, separators at every position of the 8 byte words
+		std::mt19937 random(9);
+		std::vector<long long> expected;
+		text.clear();
+		for (int i = 0; i < 20000; ++i)
+		{
+			long long value = static_cast<long long>((static_cast<uint64_t>(random()) * random() >> 1) >> (random() % 63));
+			if (random() % 3 == 0)
+				value = -value;
+			expected.push_back(value);
+			text += std::to_string(value);
+			text += random() % 5 == 0 ? (random() % 2 ? "\r\n" : "\n") : ",";
+		}
+		text.back() = '\n';									// a line end after the last field
+		std::vector<long long> parsed(expected.size());
+		r = INTO::parse_column(text, ',', parsed.data(), parsed.size());
+		CHECK(r.ec == std::errc() && r.count == expected.size() && parsed == expected);
+	}
+
+	if (!bError)
+		std::cout << "INTO_parse: Test OK\n";
+	return bError ? 1 : 0;
+}
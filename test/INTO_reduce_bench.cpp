@@ -0,0 +1,40 @@
+// Summing 200M llongo values: the element by element overflowchecked loop against INTO::checked_reduce
+// on one thread and on all hardware threads.
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#define __DEBUG_CHECK_INTEGER_OVERFLOW
+#define __DEBUG_CHECK_INTEGER_OVERFLOW_ALIAS
+#include "INTO_reduce.h"
+
+template <typename F> void Measure(const char* name, size_t count, F f)
+{
+	const auto start = std::chrono::steady_clock::now();
+	const long long result = f();
+	const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+	std::cout << "  " << name << ": " << elapsed.count() / count << " ns/element (sum " << result << ")\n";
+}
+
+int main()
+{
+	const size_t count = 200000000;
+	std::vector<long long> values(count);
+	for (size_t i = 0; i < count; ++i)
+		values[i] = static_cast<long long>(i % 1000) - 499;
+
+	Measure("overflowchecked loop", count, [&]() {
+		llongo sum = 0LL;
+		for (long long v : values)
+			sum = sum + llongo(v);
+		return static_cast<long long>(sum);
+	});
+	Measure("checked_reduce, 1 thread", count, [&]() { return static_cast<long long>(INTO::checked_reduce(values.begin(), values.end(), 0LL, 1)); });
+	const unsigned threads = std::thread::hardware_concurrency();
+	std::cout << "  (" << threads << " hardware threads)\n";
+	Measure("checked_reduce, all threads", count, [&]() { return static_cast<long long>(INTO::checked_reduce(values.begin(), values.end(), 0LL)); });
+	return 0;
+}
@@ -0,0 +1,65 @@
+#include <iostream>
+#include <cstdint>
+#include <limits>
+#include <list>
+#include <string>
+#include <functional>
+#include <vector>
+
+// these defines have to precede #include "INTO_reduce.h"
+#define __DEBUG_CHECK_INTEGER_OVERFLOW								// this switch changes unsignedo etc. typedefs back and forth between overflow checked and unchecked versions
+#define __DEBUG_CHECK_INTEGER_OVERFLOW_ALIAS						// unsignedo etc. typedefs can be turned off if not needed
+#define INTO_REDUCE_MIN_PER_THREAD	16								// so that the small test ranges are split too
+#include "INTO_reduce.h"
+
+auto TryOrExcept = [](std::string description, std::function<std::string(void)> tryThis) {
+	try
+	{
+		std::cout << "Trying " << description << "...";
+		std::string result = tryThis();
+		std::cout << "OK! [" << result << "]\n";
+	}
+	catch (std::exception& e)
+	{
+		std::cout << "Exception: " << e.what() << std::endl;
+	}
+};
+
+#define CHECK(cond) do { if (!(cond)) { std::cout << "FAILED: " #cond " (line " << __LINE__ << ")\n"; ++failures; } } while (0)
+
+int main()
+{
+	int failures = 0;
+	const long long max = std::numeric_limits<long long>::max();
+
+	// intermediate sums overflow, the final one doesn't: no error
+	std::vector<long long> wandering;
+	for (int i = 0; i < 1000; ++i)
+		wandering.push_back(max / 4);
+	for (int i = 0; i < 1000; ++i)
+		wandering.push_back(-(max / 4));
+	wandering.push_back(42);
+	for (unsigned threads : { 1u, 3u, 8u })
+		CHECK(static_cast<long long>(INTO::checked_reduce(wandering.begin(), wandering.end(), llongo(0), threads)) == 42);
+
+	std::vector<llongo> checkedValues(1000, llongo(1000LL));
+	CHECK(static_cast<long long>(INTO::checked_reduce(checkedValues.begin(), checkedValues.end(), 5LL)) == 1000005);
+
+	std::list<int> listed = { 1, 2, 3, std::numeric_limits<int>::max() };
+	TryOrExcept("checked_reduce on a list of int, sum > INT_MAX (expect overflow)", [&]() {
+		return std::to_string(INTO::checked_reduce(listed.begin(), listed.end(), into(0))); });
+	TryOrExcept("checked_reduce 1000 x LLONG_MAX/4 (expect overflow)", [&]() {
+		return std::to_string(INTO::checked_reduce(wandering.begin(), wandering.begin() + 1000, 0LL)); });
+	TryOrExcept("checked_transform_reduce of squares into uint8_t (expect overflow)", [&]() {
+		std::vector<int> v = { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+		return std::to_string(INTO::checked_transform_reduce(v.begin(), v.end(), uint8_t(0), [](int x) { return x * x; })); });
+	std::vector<unsigned long long> big(100, std::numeric_limits<unsigned long long>::max());
+	TryOrExcept("checked_transform_reduce 100 x ULLONG_MAX/100", [&]() {
+		return std::to_string(INTO::checked_transform_reduce(big.begin(), big.end(), 0ULL, [](unsigned long long x) { return x / 100; })); });
+	TryOrExcept("checked_reduce 100 x ULLONG_MAX (expect overflow)", [&]() {
+		return std::to_string(INTO::checked_reduce(big.begin(), big.end(), 0ULL)); });
+
+	if (failures == 0)
+		std::cout << "checked_reduce: Test OK\n";
+	return failures != 0;
+}
@@ -0,0 +1,215 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+// these defines have to precede #include "INTO.h"
+#define __DEBUG_CHECK_INTEGER_OVERFLOW
+#define __DEBUG_CHECK_INTEGER_OVERFLOW_SAMPLED						// one in INTO::sampling_period() operations is checked at each site
+#define __DEBUG_CHECK_INTEGER_OVERFLOW_ALIAS
+#include "INTO.h"
+
+#define CHECK(condition)	if (!(condition)) { std::cout << "FAILED: " << #condition << " at line " << __LINE__ << "\n"; bError = true; }
+
+static std::atomic<int> s_handled{ 0 };
+static std::string s_lastMessage;
+
+void CountOverflow(const char* message)
+{
+	if (s_handled.fetch_add(1) == 0)
+		s_lastMessage = message;
+}
+
+// overflows on every call (and the result is the wrapped one whether it's checked or not)
+int OverflowingAdd(int i)
+{
+	into big = std::numeric_limits<int>::max() - (i & 7);
+	into sum = big + into(100);
+	return sum;
+}
+
+// the same operator and types, with a countdown of its own
+int RareSite(int i)
+{
+	INTO_SAMPLING_SITE();
+	into big = std::numeric_limits<int>::max() - (i & 1);
+	return big + into(10);
+}
+
+// ten overflowing additions in a sampled scope: all of them checked or none
+int OverflowingScope(int i)
+{
+	INTO::sampled_scope sampled;
+	int result = 0;
+	for (int k = 0; k < 10; ++k)
+		result += OverflowingAdd(i + k);
+	return result;
+}
+
+// a rolling hash, the kind of loop where checking every multiplication costs a division each
+template <typename I> I Hash(const std::vector<int>& values)
+{
+	I h = 17;
+	for (int v : values)
+		h = h * I(31) + I(v & 0xFFFF);
+	return h;
+}
+
+int main()
+{
+	bool bError = false;
+
+	// period 1: every operation is checked and thrown as before, in scopes or not; nested scopes follow the outermost
+	{
+		INTO::set_sampling_period(1);
+		int thrown = 0;
+		for (int i = 0; i < 1000; ++i)
+		{
+			try { OverflowingAdd(i); }
+			catch (const INTO_exception&) { ++thrown; }
+		}
+		CHECK(thrown == 1000);
+		{
+			INTO::sampled_scope outer;
+			INTO::sampled_scope inner;
+			CHECK(outer.checked() && inner.checked());
+			bool bThrown = false;
+			try { OverflowingAdd(0); }
+			catch (const INTO_exception&) { bThrown = true; }
+			CHECK(bThrown);
+		}
+		bool bThrown = false;
+		try { into narrow = 5000000000LL; (void)narrow; }
+		catch (const INTO_exception&) { bThrown = true; }
+		CHECK(bThrown);
+	}
+
+	// period 100 with a handler: about 1% of the operations is checked, nothing thrown, results wrapped
+	{
+		INTO::set_sampling_period(100);
+		INTO::set_sampled_overflow_handler(&CountOverflow);
+		const uint64_t countBefore = INTO::sampled_overflow_count();
+		const int calls = 1000000;
+		bool bWrapped = true;
+		for (int i = 0; i < calls; ++i)
+			bWrapped = bWrapped && OverflowingAdd(i) == static_cast<int>(static_cast<unsigned>(std::numeric_limits<int>::max() - (i & 7)) + 100u);
+		CHECK(bWrapped);
+		const double rate = double(s_handled.load()) / calls;
+		std::cout << "period 100: " << rate * 100 << "% of the overflowing additions caught\n";
+		CHECK(rate > 0.007 && rate < 0.013);
+		CHECK(INTO::sampled_overflow_count() - countBefore == uint64_t(s_handled.load()));
+		CHECK(s_lastMessage.find("op+ overflow") != std::string::npos);
+
+		// a site executed 1000 times less often is sampled at the same rate
+		s_handled = 0;
+		int handledRare = 0;
+		for (int i = 0; i < 2000000; ++i)
+		{
+			OverflowingAdd(i);
+			if (i % 1000 == 0)
+			{
+				const int before = s_handled.load();
+				RareSite(i);
+				handledRare += s_handled.load() - before;
+			}
+		}
+		std::cout << "rare site: " << handledRare << " of 2000 caught\n";
+		CHECK(handledRare >= 5 && handledRare <= 60);
+
+		// in a scope, the operations are checked together: 10 reports or none, for about 1% of the scopes
+		int checkedScopes = 0;
+		bool bTogether = true;
+		for (int i = 0; i < 100000; ++i)
+		{
+			const int before = s_handled.load();
+			OverflowingScope(i);
+			const int handled = s_handled.load() - before;
+			bTogether = bTogether && (handled == 0 || handled == 10);
+			checkedScopes += handled == 10;
+		}
+		std::cout << "scopes: " << checkedScopes << " of 100000 checked\n";
+		CHECK(bTogether && checkedScopes > 700 && checkedScopes < 1300);
+	}
+
+	// period 0: nothing is checked
+	{
+		INTO::set_sampling_period(0);
+		s_handled = 0;
+		for (int i = 0; i < 200000; ++i)
+			OverflowingAdd(i);
+		CHECK(s_handled.load() <= 1);						// what was left of the countdown at the switch
+	}
+
+	// every thread has its own countdowns
+	{
+		INTO::set_sampling_period(10);
+		s_handled = 0;
+		std::vector<std::thread> threads;
+		for (int t = 0; t < 4; ++t)
+			threads.emplace_back([]() { for (int i = 0; i < 100000; ++i) OverflowingAdd(i); });
+		for (auto& thread : threads)
+			thread.join();
+		CHECK(s_handled.load() > 30000 && s_handled.load() < 50000);
+		INTO::set_sampled_overflow_handler(nullptr);
+	}
+
+	// what it costs: a dot product of small values (never overflows) with plain long long, and with llongo: never
+	// checked (period 0), sampled at 100 by the operations' own countdowns and by scopes of 10000 elements each,
+	// always checked (period 1)
+	{
+		std::vector<int> values(20000000);
+		for (size_t i = 0; i < values.size(); ++i)
+			values[i] = static_cast<int>(static_cast<uint32_t>(i * 2654435761u) >> 20);
+		auto dot = [&](auto zero, bool bScopes) {
+			typedef decltype(zero) I;
+			I sum = zero;
+			for (size_t from = 1; from < values.size(); from += 10000)
+			{
+				std::optional<INTO::sampled_scope> sampled;
+				if (bScopes)
+					sampled.emplace();
+				const size_t to = std::min(values.size(), from + 10000);
+				for (size_t i = from; i < to; ++i)
+					sum = sum + I(values[i]) * I(values[i - 1]);
+			}
+			return static_cast<long long>(sum);
+		};
+		auto measure = [&](auto run) {
+			double best = 1e9;
+			for (int repeat = 0; repeat < 3; ++repeat)
+			{
+				const auto start = std::chrono::steady_clock::now();
+				volatile long long sink = run();
+				(void)sink;
+				best = std::min(best, std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / values.size());
+			}
+			return best;
+		};
+		const double plain = measure([&]() { return dot(0LL, false); });
+		INTO::set_sampling_period(0);
+		const double unchecked = measure([&]() { return dot(llongo(0), false); });
+		INTO::set_sampling_period(100);
+		const double sampled = measure([&]() { return dot(llongo(0), false); });
+		const double scoped = measure([&]() { return dot(llongo(0), true); });
+		INTO::set_sampling_period(1);
+		const double full = measure([&]() { return dot(llongo(0), false); });
+		std::cout << "ns per element: " << plain << " plain, " << unchecked << " never checked, " << sampled << " sampled at 100, " <<
+			scoped << " sampled at 100 in scopes, " << full << " checked everywhere\n";
+
+		INTO::set_sampling_period(100);
+		INTO::set_sampled_overflow_handler(&CountOverflow);
+		s_handled = 0;
+		for (int i = 0; i < 1000; ++i)
+			Hash<llongo>(std::vector<int>(values.begin(), values.begin() + 1000));		// overflows all the time
+		CHECK(s_handled.load() > 0);
+		INTO::set_sampled_overflow_handler(nullptr);
+	}
+
+	if (!bError)
+		std::cout << "INTO_sampled: Test OK\n";
+	return bError ? 1 : 0;
+}
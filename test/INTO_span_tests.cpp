@@ -0,0 +1,66 @@
+#include <iostream>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <functional>
+#include <vector>
+
+// these defines have to precede #include "INTO_span.h"
+#define __DEBUG_CHECK_INTEGER_OVERFLOW								// this switch changes unsignedo etc. typedefs back and forth between overflow checked and unchecked versions
+#define __DEBUG_CHECK_INTEGER_OVERFLOW_ALIAS						// unsignedo etc. typedefs can be turned off if not needed
+#include "INTO_span.h"
+
+auto TryOrExcept = [](std::string description, std::function<std::string(void)> tryThis) {
+	try
+	{
+		std::cout << "Trying " << description << "...";
+		std::string result = tryThis();
+		std::cout << "OK! [" << result << "]\n";
+	}
+	catch (std::exception& e)
+	{
+		std::cout << "Exception: " << e.what() << std::endl;
+	}
+};
+
+#define CHECK(cond) do { if (!(cond)) { std::cout << "FAILED: " #cond " (line " << __LINE__ << ")\n"; ++failures; } } while (0)
+
+int main()
+{
+	int failures = 0;
+
+	// a "network buffer": bytes memcpy'd into place, then viewed as checked values without a copy
+	alignas(8) unsigned char buffer[4 * sizeof(int32_t)];
+	const int32_t wire[4] = { 1, 2, std::numeric_limits<int32_t>::max() - 1, 4 };
+	std::memcpy(buffer, wire, sizeof(wire));
+	std::span<const int32_t> column(reinterpret_cast<const int32_t*>(buffer), 4);
+	auto checked = INTO::checked_view(column);
+	static_assert(std::is_same<decltype(checked), std::span<const overflowchecked<int32_t>>>::value, "const is kept");
+	CHECK(static_cast<const void*>(checked.data()) == static_cast<const void*>(buffer));
+	CHECK(checked[0] + checked[1] == 3);
+
+	TryOrExcept("sum of a checked view over a raw buffer (expect overflow)", [&]() {
+		into sum = 0;
+		for (into value : checked)
+			sum = sum + value;
+		return std::to_string(sum);
+	});
+
+	// writing through a view, and back to raw for code that takes plain buffers
+	std::vector<int64_t> values = { 10, 20, 30 };
+	auto writable = INTO::checked_view(values);
+	writable[1] = writable[1] + overflowchecked<int64_t>(40);
+	CHECK(values[1] == 60);
+	std::span<int64_t> raw = INTO::raw_view(writable);
+	CHECK(raw.data() == values.data() && raw[2] == 30);
+
+	std::vector<llongo> checkedValues(3, llongo(7LL));
+	std::span<long long> rawOfChecked = INTO::raw_view(checkedValues);
+	rawOfChecked[0] = 8;
+	CHECK(static_cast<long long>(checkedValues[0]) == 8);
+
+	if (failures == 0)
+		std::cout << "checked_view/raw_view: Test OK\n";
+	return failures != 0;
+}
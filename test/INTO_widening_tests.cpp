@@ -0,0 +1,94 @@
+#include <iostream>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <functional>
+#include <vector>
+
+// these defines have to precede #include "INTO_widening.h"
+#define __DEBUG_CHECK_INTEGER_OVERFLOW								// this switch changes unsignedo etc. typedefs back and forth between overflow checked and unchecked versions
+#define __DEBUG_CHECK_INTEGER_OVERFLOW_ALIAS						// unsignedo etc. typedefs can be turned off if not needed
+#include "INTO_widening.h"
+
+auto TryOrExcept = [](std::string description, std::function<std::string(void)> tryThis) {
+	try
+	{
+		std::cout << "Trying " << description << "...";
+		std::string result = tryThis();
+		std::cout << "OK! [" << result << "]\n";
+	}
+	catch (std::exception& e)
+	{
+		std::cout << "Exception: " << e.what() << std::endl;
+	}
+};
+
+#define CHECK(cond) do { if (!(cond)) { std::cout << "FAILED: " #cond " (line " << __LINE__ << ")\n"; ++failures; } } while (0)
+
+int main()
+{
+	int failures = 0;
+	typedef widening<int64_t> wint64;
+	const int64_t max = std::numeric_limits<int64_t>::max();
+
+	static_assert(sizeof(wint64) == 16, "16 bytes");
+
+	wint64 a = max;
+	CHECK(!a.is_wide());
+	a += 1;
+	CHECK(a.is_wide() && a.to_string() == "9223372036854775808");
+	a -= 1;
+	CHECK(!a.is_wide() && static_cast<int64_t>(a) == max);
+	wint64 p = wint64(max) * wint64(max);
+	CHECK(p.to_string() == "85070591730234615847396907784232501249");
+	CHECK(p / wint64(max) == wint64(max));
+	CHECK(wint64(std::numeric_limits<int64_t>::min()) / wint64(-1) == wint64(max) + wint64(1));
+	CHECK(widening<unsigned>(3u) - widening<unsigned>(5u) == widening<unsigned>(-2));
+	CHECK(wint64(-7) % wint64(3) == wint64(-1));
+
+	TryOrExcept("widening<int64_t> max^5 (expect overflow, beyond the bignum's 256 bits)", []() {
+		wint64 m = std::numeric_limits<int64_t>::max(); return (m * m * m * m * m).to_string(); });
+	TryOrExcept("widening<int64_t> wide value back to int64_t (expect overflow)", []() {
+		wint64 m = std::numeric_limits<int64_t>::max(); m += 1; return std::to_string(static_cast<int64_t>(m)); });
+	TryOrExcept("bignum<4> max^3", []() {
+		INTO::bignum<4> m = wint64(std::numeric_limits<int64_t>::max()); return (m * m * m).to_string(); });
+	TryOrExcept("bignum<2> max^3 (expect overflow)", []() {
+		INTO::bignum<2> m = wint64(std::numeric_limits<int64_t>::max()); return (m * m * m).to_string(); });
+
+	INTO::bignum<4> b = -123456789;
+	b = b * b * b;
+	CHECK(b.to_string() == "-1881676371789154860897069");
+	CHECK((b - b).is_zero() && b + INTO::bignum<4>(1) - INTO::bignum<4>(1) == b && b < INTO::bignum<4>(0));
+	CHECK(INTO::bignum<4>(wint64(max) * wint64(max)).to_string() == "85070591730234615847396907784232501249");
+
+	// beyond 128 bits: promoted to bignum<>, and back to 128 bits (then to T) when the results fit again
+	wint64 cube = wint64(max) * wint64(max) * wint64(max);
+	CHECK(cube.is_bignum() && cube.to_string() == "784637716923335095224261902710254454442933591094742482943");
+	wint64 copy = cube;
+	CHECK(copy.is_bignum() && copy == cube && cube > p && -cube < p && cube - wint64(1) < cube);
+	copy = copy / wint64(max);
+	CHECK(!copy.is_bignum() && copy == p && cube % wint64(max) == wint64(0));
+	CHECK(static_cast<int64_t>(cube / p) == max);
+	CHECK(INTO::bignum<4>(cube) == INTO::bignum<4>(p) * INTO::bignum<4>(max));
+	// the 128-bit values under the promotion marker are promoted too
+	const __int128 min128 = -static_cast<__int128>(~static_cast<unsigned __int128>(0) >> 1) - 1;
+	wint64 low = wint64::from_int128(min128);
+	CHECK(low.is_bignum() && low.to_string() == "-170141183460469231731687303715884105728");
+	CHECK(!(low + wint64(uint64_t(1) << 63) + wint64(uint64_t(1) << 63)).is_bignum());
+	CHECK(low / wint64(-1) == -low && (-low).is_bignum());
+	CHECK(INTO::bignum<4>(-100) / INTO::bignum<4>(7) == INTO::bignum<4>(-14) && INTO::bignum<4>(-100) % INTO::bignum<4>(7) == INTO::bignum<4>(-2));
+
+	// running sum that wanders out of int64 and back
+	std::vector<wint64> values(1000, wint64(max / 100));
+	wint64 sum = 0;
+	for (const auto& v : values)
+		sum += v;
+	CHECK(sum.is_wide());
+	for (const auto& v : values)
+		sum -= v;
+	CHECK(!sum.is_wide() && static_cast<int64_t>(sum) == 0);
+
+	if (failures == 0)
+		std::cout << "widening: Test OK\n";
+	return failures != 0;
+}
@@ -0,0 +1,77 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define __LSCT_MEMMANAGER_INSTRUMENT
+#include "memmanager.h"
+
+struct Node {
+	explicit Node(int v) : value(v) {}
+	int value;
+	Node* next = nullptr;
+	char payload[40];
+};
+
+#define CHECK(condition)	if (!(condition)) { std::cout << "FAILED: " << #condition << " at line " << __LINE__ << "\n"; bError = true; }
+
+int main()
+{
+	bool bError = false;
+
+	std::vector<Node*> kept;
+	for (int i = 0; i < 1000; ++i)
+	{
+		Node* n = LSCT_NEW(Node, i);
+		if (i % 10 == 0)
+			kept.push_back(n);
+		else
+			LSCT_DELETE(n);
+	}
+	std::thread worker([]() {
+		for (int i = 0; i < 500; ++i)
+			LSCT_DELETE_ARRAY(LSCT_NEW_ARRAY_AT(7, char, 100));
+	});
+	worker.join();
+	std::string* untracked = LSCT_NEW_AT(3, std::string, "baked site id");
+
+	const std::vector<MemoryManager::AllocSites::SiteSummary> sites = MemoryManager::AllocSites::Collect();
+	CHECK(sites.size() == 3);
+	for (const MemoryManager::AllocSites::SiteSummary& s : sites)
+	{
+		if (s.id == 7)
+		{
+			CHECK(s.allocs == 500 && s.frees == 500 && s.allocBytes == 50000 && s.threads == 1);
+		}
+		else if (s.id == 3)
+		{
+			CHECK(s.allocs == 1 && s.frees == 0);
+		}
+		else
+		{
+			CHECK(s.id >= MemoryManager::AllocSites::FIRST_DYNAMIC_SITE);
+			CHECK(s.allocs == 1000 && s.frees == 900 && s.allocBytes == 1000 * sizeof(Node));
+			uint64_t histogramTotal = 0;
+			for (uint64_t n : s.lifetime) histogramTotal += n;
+			CHECK(histogramTotal == 900);
+		}
+	}
+
+	std::ostringstream flat, pprof;
+	MemoryManager::AllocSites::DumpFlatProfile(flat);
+	MemoryManager::AllocSites::WritePprofHeapProfile(pprof);
+	std::cout << flat.str();
+	CHECK(pprof.str().rfind("heap profile: 101: ", 0) == 0);
+	CHECK(pprof.str().find("MAPPED_LIBRARIES:") != std::string::npos);
+
+	for (Node* n : kept)
+		LSCT_DELETE(n);
+	LSCT_DELETE(untracked);
+
+	// the last baked ID is still below the dynamic range
+	CHECK(MemoryManager::AllocSites::BakedSite(MemoryManager::AllocSites::FIRST_DYNAMIC_SITE - 1) == MemoryManager::AllocSites::FIRST_DYNAMIC_SITE - 1);
+	if (!bError)
+		std::cout << "allocsites: Test OK\n";
+	return bError ? 1 : 0;
+}
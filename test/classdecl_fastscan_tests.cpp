@@ -0,0 +1,121 @@
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "classdecl_fastscan.h"
+#include "debugfriend_common.h"
+
+// the expected output of classdecl_modifier for debugfriend_test.cpp is debugfriend_test_out.cpp
+// usage: classdecl_fastscan_tests [<path of test/>]
+
+#define CHECK(condition)	if (!(condition)) { std::cout << "FAILED: " << #condition << " at line " << __LINE__ << "\n"; bError = true; }
+
+std::string ReadFile(const std::string& filename)
+{
+	std::ifstream ifs(filename, std::ios::binary);
+	return std::string(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+}
+
+classdecl_fastscan::ScanResult Scan(const std::string& source)
+{
+	return classdecl_fastscan::ScanClassBodies(source.data(), source.size());
+}
+
+// what's between each class keyword and its closing brace, for the checks below
+std::vector<std::string> Classes(const std::string& source)
+{
+	std::vector<std::string> classes;
+	for (const auto& body : Scan(source).classes)
+		classes.push_back(source.substr(body.keywordOffset, body.closeBraceOffset + 1 - body.keywordOffset));
+	return classes;
+}
+
+int main(int argc, char* argv[])
+{
+	bool bError = false;
+	const std::string testDir = argc > 1 ? std::string(argv[1]) + "/" : "test/";
+
+	{
+		const std::string source = ReadFile(testDir + "debugfriend_test.cpp");
+		const std::string expected = ReadFile(testDir + "debugfriend_test_out.cpp");
+		CHECK(!source.empty() && !expected.empty());
+		const classdecl_fastscan::ScanResult scan = Scan(source);
+		CHECK(!scan.bAmbiguous);
+		CHECK(scan.classes.size() == 8);
+		// from the back, so that the offsets still to come stay valid (nested classes close before the outer one)
+		std::vector<size_t> insertionPoints;
+		for (const auto& body : scan.classes)
+			insertionPoints.push_back(body.closeBraceOffset);
+		std::sort(insertionPoints.rbegin(), insertionPoints.rend());
+		std::string modified = source;
+		for (size_t offset : insertionPoints)
+			modified.insert(offset, INSERT_THIS);
+		CHECK(modified == expected);
+		CHECK(scan.classes.size() > 1 && scan.classes[1].keywordLine == 6 && scan.classes[1].keywordColumn == 1);		// class outer
+	}
+
+	// declarations, template parameters, enum class, elaborated type specifiers: no definitions
+	CHECK(Classes("class A; template <class T, class U = int> void f(class B* b); enum class E { x, y }; friend class C;").empty());
+	CHECK(Classes("template <template <class> class TT> struct S {}; void g(class D d) {}").empty());
+
+	// heads with bases, templates, attributes; nested and local classes
+	{
+		const auto classes = Classes(
+			"template <class T> class X : public Base<T, 3>, private std::vector<int> { class Y final { }; };\n"
+			"class alignas(16) [[nodiscard]] Z : decltype(w) { void f() { class L { }; auto l = [] { return 1; }; } };\n"
+			"template <> class X<int> { };\n");
+		CHECK(classes.size() == 5);
+		CHECK(classes.size() == 5 && classes[0].find("class Y final { }; }") != std::string::npos);
+		CHECK(classes.size() == 5 && classes[1] == "class Y final { }");
+		CHECK(classes.size() == 5 && classes[3] == "class L { }");
+		CHECK(classes.size() == 5 && classes[4] == "class X<int> { }");
+	}
+
+	// braces in comments, literals and raw strings don't count; neither does 'class' in them
+	{
+		const auto classes = Classes(
+			"class A {\n"
+			"\t// } class B {\n"
+			"\t/* } */ const char* s = \"}\\\"class C {\";\n"
+			"\tchar c = '}'; char d = '\\''; int n = 1'000'000;\n"
+			"\tconst char* r = R\"x(} )\" class D { )x\";\n"
+			"\tconst wchar_t* w = LR\"(})\"; auto u = u8\"}\";\n"
+			"};\n");
+		CHECK(classes.size() == 1 && classes[0].back() == '}' && classes[0].find("u8") != std::string::npos);
+	}
+
+	// preprocessor lines are skipped, balanced conditional branches are fine
+	{
+		const auto classes = Classes(
+			"#include <string> // {\n"
+			"#define BRACE {\\\n   }\n"
+			"class A {\n"
+			"#ifdef X\n"
+			"\tint f() { return 1; }\n"
+			"#else\n"
+			"\tint f() { return 2; }\n"
+			"#endif\n"
+			"};\n");
+		CHECK(classes.size() == 1);
+	}
+
+	// ambiguous: left to libclang
+	CHECK(Scan("#define DECLARE(name) class name {};\nDECLARE(A)").bAmbiguous);
+	CHECK(Scan("class EXPORT A { };").bAmbiguous);
+	CHECK(Scan("class A : public B<C<int>> { };").bAmbiguous);
+	CHECK(Scan("class API(1) A { };").bAmbiguous);
+	CHECK(Scan("class A\n#ifdef X\n : public B\n#endif\n{ };").bAmbiguous);
+	CHECK(Scan("#ifdef X\nclass A : public B {\n#else\nclass A {\n#endif\n};").bAmbiguous);
+	CHECK(Scan("class A { const char* s = \"unterminated; };").bAmbiguous);
+	CHECK(Scan("class A { /* unterminated };").bAmbiguous);
+	CHECK(Scan("class A { };\n}").bAmbiguous);
+	CHECK(Scan("class A { ").bAmbiguous);
+	CHECK(Scan("class EXPORT A { };").ambiguity == "more than one identifier before the class name at line 1");
+
+	if (!bError)
+		std::cout << "classdecl_fastscan: Test OK\n";
+	return bError ? 1 : 0;
+}
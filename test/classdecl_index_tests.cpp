@@ -0,0 +1,126 @@
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "classdecl_index.h"
+
+#define CHECK(condition)	if (!(condition)) { std::cout << "FAILED: " << #condition << " at line " << __LINE__ << "\n"; bError = true; }
+
+classdecl_index::ClassEntry Entry(const std::string& name, const std::string& file, uint32_t fromOffset, std::vector<std::string> members = {})
+{
+	return classdecl_index::ClassEntry{ name, "c:@S@" + name + "@" + file, file, fromOffset / 10 + 1, 1, fromOffset / 10 + 3, 2, fromOffset, fromOffset + 20, std::move(members) };
+}
+
+int main()
+{
+	bool bError = false;
+	const std::string filename = "classdecl_index_tests.idx";
+
+	// what a first run finds in one file, a second one in another
+	{
+		classdecl_index::IndexBuilder builder;
+		builder.Add(Entry("outer::inner", "a.cpp", 40, { "value", "get" }));
+		builder.Add(Entry("outer", "a.cpp", 10, { "_inner", "instance" }));
+		builder.Add(Entry("someancestor", "a.cpp", 0));
+		CHECK(builder.Write(filename));
+	}
+	{
+		classdecl_index::ClassIndex previous;
+		std::string error;
+		CHECK(previous.Open(filename, error));
+		classdecl_index::IndexBuilder builder;
+		builder.Add(previous, "b.h");
+		builder.Add(Entry("outer", "b.h", 100, { "other" }));
+		builder.Add(Entry("zeta", "b.h", 5));
+		CHECK(builder.Write(filename));
+	}
+
+	{
+		classdecl_index::ClassIndex index;
+		std::string error;
+		CHECK(index.Open(filename, error));
+		CHECK(index.ClassCount() == 5 && index.FileCount() == 2);
+
+		const auto outer = index.FindByName("outer");
+		CHECK(outer.second - outer.first == 2);
+		CHECK(index.Class(outer.first).file == "a.cpp" && index.Class(outer.first + 1).file == "b.h");
+		const classdecl_index::ClassInfo first = index.Class(outer.first);
+		CHECK(first.record->memberCount == 2 && index.Member(first, 0) == "_inner" && index.Member(first, 1) == "instance");
+		CHECK(first.record->fromOffset == 10 && first.record->toOffset == 30 && first.record->fromLine == 2);
+		CHECK(index.FindByName("inner").first == index.FindByName("inner").second);
+
+		const uint32_t inner = index.FindByUsr("c:@S@outer::inner@a.cpp");
+		CHECK(inner != classdecl_index::NOT_FOUND && index.Class(inner).name == "outer::inner");
+		CHECK(index.FindByUsr("c:@S@nothing") == classdecl_index::NOT_FOUND);
+
+		std::vector<std::string> inA;
+		for (auto range = index.ClassesInFile("a.cpp"); range.first != range.second; ++range.first)
+			inA.emplace_back(index.Class(*range.first).name);
+		CHECK((inA == std::vector<std::string>{ "someancestor", "outer", "outer::inner" }));
+		const auto inB = index.ClassesInFile("b.h");
+		CHECK(inB.second - inB.first == 2 && index.Class(*inB.first).name == "zeta");
+		const auto inC = index.ClassesInFile("c.h");
+		CHECK(inC.first == inC.second);
+	}
+
+	// a rerun of a file replaces its classes
+	{
+		classdecl_index::ClassIndex previous;
+		std::string error;
+		CHECK(previous.Open(filename, error));
+		classdecl_index::IndexBuilder builder;
+		builder.Add(previous, "a.cpp");
+		builder.Add(Entry("someancestor", "a.cpp", 0, { "renamed" }));
+		CHECK(builder.Size() == 3);
+		CHECK(builder.Write(filename));
+		classdecl_index::ClassIndex index;
+		CHECK(index.Open(filename, error));
+		CHECK(index.ClassCount() == 3);
+		CHECK(index.FindByName("outer").second - index.FindByName("outer").first == 1);
+		const classdecl_index::ClassInfo ancestor = index.Class(index.FindByName("someancestor").first);
+		CHECK(ancestor.record->memberCount == 1 && index.Member(ancestor, 0) == "renamed");
+	}
+
+	// not an index
+	{
+		std::FILE* file = std::fopen(filename.c_str(), "wb");
+		std::fputs("something else entirely", file);
+		std::fclose(file);
+		classdecl_index::ClassIndex index;
+		std::string error;
+		CHECK(!index.Open(filename, error) && !error.empty());
+	}
+
+	// lookups in a large index
+	{
+		classdecl_index::IndexBuilder builder;
+		const int classes = 200000;
+		for (int i = 0; i < classes; ++i)
+			builder.Add(Entry("ns" + std::to_string(i % 97) + "::Class" + std::to_string(i), "src/file" + std::to_string(i / 20) + ".h", (i % 20) * 100, { "m_a", "m_b", "Get" }));
+		CHECK(builder.Write(filename));
+		classdecl_index::ClassIndex index;
+		std::string error;
+		CHECK(index.Open(filename, error));
+		CHECK(index.ClassCount() == uint32_t(classes) && index.FileCount() == uint32_t(classes / 20));
+		const int lookups = 100000;
+		size_t found = 0;
+		const auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < lookups; ++i)
+		{
+			const int n = (i * 7919) % classes;
+			const auto byName = index.FindByName("ns" + std::to_string(n % 97) + "::Class" + std::to_string(n));
+			const auto inFile = index.ClassesInFile("src/file" + std::to_string(n / 20) + ".h");
+			found += (byName.second - byName.first) + (inFile.second - inFile.first);
+		}
+		const double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / lookups;
+		CHECK(found == size_t(lookups) * 21);
+		std::cout << "FindByName + ClassesInFile: " << us << " us per lookup in " << classes << " classes\n";
+	}
+	std::remove(filename.c_str());
+
+	if (!bError)
+		std::cout << "classdecl_index: Test OK\n";
+	return bError ? 1 : 0;
+}
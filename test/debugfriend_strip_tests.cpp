@@ -0,0 +1,159 @@
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "debugfriend_strip.h"
+
+// stripping debugfriend_test_out.cpp (the expected output of classdecl_modifier) has to give back debugfriend_test.cpp
+// usage: debugfriend_strip_tests [<path of test/>]
+
+#define CHECK(condition)	if (!(condition)) { std::cout << "FAILED: " << #condition << " at line " << __LINE__ << "\n"; bError = true; }
+
+std::string ReadFile(const std::string& filename)
+{
+	std::ifstream ifs(filename, std::ios::binary);
+	return std::string(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+}
+
+void WriteFile(const std::string& filename, const std::string& content)
+{
+	std::ofstream ofs(filename, std::ios::binary | std::ios::trunc);
+	ofs << content;
+}
+
+std::string Strip(const std::string& source)
+{
+	std::string stripped;
+	debugfriend_strip::StripInjected(source.data(), source.size(), debugfriend_strip::FindOccurrences(source.data(), source.size()),
+		[&stripped](const char* bytes, size_t len) { stripped.append(bytes, len); });
+	return stripped;
+}
+
+int main(int argc, char* argv[])
+{
+	bool bError = false;
+	const std::string testDir = argc > 1 ? std::string(argv[1]) + "/" : "test/";
+
+	// FindBytes against std::string::find, at every alignment and at the end of the buffer
+	{
+		std::mt19937 random(42);
+		bool bSame = true;
+		for (int round = 0; round < 2000; ++round)
+		{
+			std::string haystack(random() % 200, 'a');
+			for (char& c : haystack)
+				c = "ab;f"[random() % 4];
+			const std::string needle = round % 3 == 0 ? "f" : round % 3 == 1 ? "fa;" : "fab;ab;af";
+			if (round % 5 == 0 && haystack.size() >= needle.size())
+				haystack.replace(haystack.size() - needle.size(), needle.size(), needle);
+			const char* found = debugfriend_strip::FindBytes(haystack.data(), haystack.data() + haystack.size(), needle.data(), needle.size());
+			const size_t expected = haystack.find(needle);
+			bSame = bSame && (found ? size_t(found - haystack.data()) : std::string::npos) == expected;
+		}
+		CHECK(bSame);
+	}
+
+	// the inverse of classdecl_modifier, also after the line endings were converted
+	{
+		const std::string source = ReadFile(testDir + "debugfriend_test.cpp");
+		const std::string injected = ReadFile(testDir + "debugfriend_test_out.cpp");
+		CHECK(!source.empty() && !injected.empty());
+		CHECK(Strip(injected) == source);
+		CHECK(debugfriend_strip::FindOccurrences(injected.data(), injected.size()).size() == 8);
+		std::string sourceLF = source, injectedLF = injected;
+		sourceLF.erase(std::remove(sourceLF.begin(), sourceLF.end(), '\r'), sourceLF.end());
+		injectedLF.erase(std::remove(injectedLF.begin(), injectedLF.end(), '\r'), injectedLF.end());
+		CHECK(Strip(injectedLF) == sourceLF);
+		CHECK(Strip(source) == source);
+	}
+
+	// hand-written declarations stay; two in a row: only the one before the brace was injected
+	{
+		const std::string handWritten = "class A {\r\n\tfriend DEBUGXRAY::DEBUGCLASS;\r\n};\r\n";
+		CHECK(Strip(handWritten) == handWritten);
+		const std::string ownLineCRLF = "class A {\r\n\tint x;\r\nfriend DEBUGXRAY::DEBUGCLASS;\r\n\tint y;\r\n};\r\n";	// CRLF, not before a brace
+		CHECK(Strip(ownLineCRLF) == ownLineCRLF);
+		const std::string ownLine = "class A {\nfriend DEBUGXRAY::DEBUGCLASS;\n\tint x;\n};\n";		// LF, not before a brace
+		CHECK(Strip(ownLine) == ownLine);
+		const std::string mixedEndings = "class A {\r\n\tint x;\nfriend DEBUGXRAY::DEBUGCLASS;\n};\r\n";	// not a converted file
+		CHECK(Strip(mixedEndings) == mixedEndings);
+		CHECK(debugfriend_strip::FindOccurrences(mixedEndings.data(), mixedEndings.size()).size() == 1 &&
+			!debugfriend_strip::FindOccurrences(mixedEndings.data(), mixedEndings.size())[0].bInjected);
+		const std::string twice = std::string("class A {") + INSERT_THIS + "friend DEBUGXRAY::DEBUGCLASS;\r\n}";
+		CHECK(Strip(twice) == "class A {\r\nfriend DEBUGXRAY::DEBUGCLASS;}");
+	}
+
+	// files: only those with injected declarations are rewritten, what's left is reported with its line
+	{
+		const std::filesystem::path dir = std::filesystem::temp_directory_path() / "debugfriend_strip_tests";
+		std::filesystem::remove_all(dir);
+		std::filesystem::create_directories(dir / "sub");
+		WriteFile((dir / "injected.cpp").string(), ReadFile(testDir + "debugfriend_test_out.cpp"));
+		WriteFile((dir / "sub" / "clean.h").string(), "class B { };\n");
+		WriteFile((dir / "sub" / "handwritten.hpp").string(), "class C {\n\tfriend DEBUGXRAY::DEBUGCLASS;\n};\n");
+		WriteFile((dir / "sub" / "notes.txt").string(), std::string("x") + INSERT_THIS);
+		const auto cleanTime = std::filesystem::last_write_time(dir / "sub" / "clean.h");
+
+		const std::vector<std::string> files = debugfriend_strip::CollectSourceFiles({ dir.string() });
+		CHECK(files.size() == 3);
+		std::vector<debugfriend_strip::FileResult> verified = debugfriend_strip::StripFiles(files, false);
+		size_t found = 0, remaining = 0;
+		for (const auto& result : verified)
+		{
+			found += result.stripped;
+			remaining += result.remainingLines.size();
+			CHECK(!result.bRewritten && result.error.empty());
+		}
+		CHECK(found == 8 && remaining == 9);
+
+		for (const auto& result : debugfriend_strip::StripFiles(files, true, 2))
+		{
+			CHECK(result.error.empty());
+			if (result.path.find("injected.cpp") != std::string::npos)
+			{
+				CHECK(result.bRewritten && result.stripped == 8 && result.remainingLines.empty());
+			}
+			else if (result.path.find("handwritten.hpp") != std::string::npos)
+			{
+				CHECK(!result.bRewritten && result.remainingLines == std::vector<size_t>{ 2 });
+			}
+			else
+			{
+				CHECK(!result.bRewritten && result.remainingLines.empty());
+			}
+		}
+		CHECK(ReadFile((dir / "injected.cpp").string()) == ReadFile(testDir + "debugfriend_test.cpp"));
+		CHECK(std::filesystem::last_write_time(dir / "sub" / "clean.h") == cleanTime);
+		CHECK(ReadFile((dir / "sub" / "notes.txt").string()) == std::string("x") + INSERT_THIS);
+		CHECK(!std::filesystem::exists(dir / "injected.cpp.debugfriend_strip.tmp"));
+
+		// the line of what's left is the line in the stripped file
+		WriteFile((dir / "mixed.h").string(), std::string("class D {") + INSERT_THIS + "};\nclass E {\nfriend DEBUGXRAY::DEBUGCLASS; };\n");
+		const debugfriend_strip::FileResult mixed = debugfriend_strip::StripFile((dir / "mixed.h").string(), true);
+		CHECK(mixed.stripped == 1 && mixed.remainingLines == std::vector<size_t>{ 3 });
+		CHECK(ReadFile((dir / "mixed.h").string()) == "class D {};\nclass E {\nfriend DEBUGXRAY::DEBUGCLASS; };\n");
+		std::filesystem::remove_all(dir);
+	}
+
+	// search speed on a source-like buffer with no match
+	{
+		std::string text;
+		while (text.size() < (64 << 20))
+			text += "\tfor (int i = 0; i < count; ++i) { friends[i] = DEBUG(classes[i]); } // DEBUGXRAY:: later\r\n";
+		const auto start = std::chrono::steady_clock::now();
+		const auto occurrences = debugfriend_strip::FindOccurrences(text.data(), text.size());
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		CHECK(occurrences.empty());
+		std::cout << "FindOccurrences: " << text.size() / seconds / 1e6 << " MB/s\n";
+	}
+
+	if (!bError)
+		std::cout << "debugfriend_strip: Test OK\n";
+	return bError ? 1 : 0;
+}
@@ -0,0 +1,217 @@
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "debugxray.h"
+
+#define CHECK(condition)	if (!(condition)) { std::cout << "FAILED: " << #condition << " at line " << __LINE__ << "\n"; bError = true; }
+
+namespace book {
+
+class Level {
+public:
+	void Set(long quantity) { this->quantity = quantity; notional = quantity * 0.5; ++updates; }
+private:
+	long		quantity = 0;
+	double		notional = 0;
+	unsigned	updates = 0;
+	std::string	venue = "X";
+
+friend DEBUGXRAY::DEBUGCLASS;
+};
+
+class Wide {
+	char	bytes[512] = {};
+
+friend DEBUGXRAY::DEBUGCLASS;
+};
+
+}
+
+// what classdecl_modifier --xray generates for the classes above (offsets as libclang reports them on x86-64)
+#include "debugxray_snapshot.h"
+
+namespace DEBUGXRAY {
+
+template <> inline const ClassFields& DEBUGCLASS::Fields<::book::Level>()
+{
+	static const FieldInfo fields[] = {
+		DEBUGXRAY_FIELD(::book::Level, quantity, "long", 0),
+		DEBUGXRAY_FIELD(::book::Level, notional, "double", 8),
+		DEBUGXRAY_FIELD(::book::Level, updates, "unsigned int", 16),
+		DEBUGXRAY_FIELD(::book::Level, venue, "std::string", 24),
+	};
+	static const ClassFields table = MakeClassFields("book::Level", sizeof(::book::Level), fields);
+	return table;
+}
+template <> inline void DEBUGCLASS::Snapshot<::book::Level>(const ::book::Level& object, char* out)
+{
+	out = CaptureField(out, object.quantity);
+	out = CaptureField(out, object.notional);
+	out = CaptureField(out, object.updates);
+	out = CaptureField(out, object.venue);
+	(void)object;
+	(void)out;
+}
+
+template <> inline const ClassFields& DEBUGCLASS::Fields<::book::Wide>()
+{
+	static const FieldInfo fields[] = {
+		DEBUGXRAY_FIELD(::book::Wide, bytes, "char[512]", 0),
+	};
+	static const ClassFields table = MakeClassFields("book::Wide", sizeof(::book::Wide), fields);
+	return table;
+}
+template <> inline void DEBUGCLASS::Snapshot<::book::Wide>(const ::book::Wide& object, char* out)
+{
+	out = CaptureField(out, object.bytes);
+	(void)object;
+	(void)out;
+}
+
+}
+
+#include "debugxray_live_reader.h"
+
+int main()
+{
+	bool bError = false;
+	const uint64_t pid = static_cast<uint64_t>(getpid());
+
+	// registration, publishing, decoding, giving the slot back
+	{
+		DEBUGXRAY::LiveRegion region(4, 256, 4096);
+		CHECK(region.Valid());
+		book::Level first, second;
+		DEBUGXRAY::LiveHandle firstHandle = region.Register(first);
+		DEBUGXRAY::LiveHandle secondHandle = region.Register(second);
+		CHECK(firstHandle.Valid() && secondHandle.Valid());
+		CHECK(!region.Register(book::Wide()).Valid());				// doesn't fit in a slot
+
+		DEBUGXRAY::LiveReader reader;
+		std::string error;
+		CHECK(reader.Open(pid, error));
+		CHECK(reader.Read().empty());								// registered, not published yet
+		first.Set(10);
+		firstHandle.Publish(first);
+		std::vector<DEBUGXRAY::LiveObject> objects = reader.Read();
+		CHECK(objects.size() == 1 && objects[0].objectAddress == reinterpret_cast<uint64_t>(&first));
+		std::ostringstream text;
+		reader.Print(objects, text);
+		CHECK(text.str().find("book::Level at 0x") == 4);
+		CHECK(text.str().find("\tlong quantity = 10\n\tdouble notional = 5.000000\n\tunsigned int updates = 1\n\tstd::string venue (not captured)\n") != std::string::npos);
+
+		second.Set(3);
+		secondHandle.Publish(second);
+		CHECK(reader.Read().size() == 2);
+		secondHandle = DEBUGXRAY::LiveHandle();
+		CHECK(reader.Read().size() == 1);
+		std::vector<DEBUGXRAY::LiveHandle> handles;
+		for (int i = 0; i < 4; ++i)
+			handles.push_back(region.Register(second));
+		CHECK(handles[2].Valid() && !handles[3].Valid());			// 3 slots left
+		CHECK(reader.Classes().size() == 1);
+	}
+
+	// a slot given back and taken again: the new owner is hidden until its own first publish
+	{
+		DEBUGXRAY::LiveRegion region(1, 256, 4096);
+		DEBUGXRAY::LiveReader reader;
+		std::string error;
+		CHECK(reader.Open(pid, error));
+		book::Level previous, next;
+		{
+			DEBUGXRAY::LiveHandle handle = region.Register(previous);
+			previous.Set(42);
+			handle.Publish(previous);
+			CHECK(reader.Read().size() == 1);
+		}
+		CHECK(reader.Read().empty());
+		DEBUGXRAY::LiveHandle handle = region.Register(next);
+		CHECK(handle.Valid());
+		next.Set(7);
+		CHECK(reader.Read().empty());								// not the previous owner's payload under the new address
+		handle.Publish(next);
+		std::vector<DEBUGXRAY::LiveObject> objects = reader.Read();
+		long quantity = 0;
+		if (objects.size() == 1)
+			std::memcpy(&quantity, objects[0].payload.data(), sizeof(quantity));
+		CHECK(objects.size() == 1 && objects[0].objectAddress == reinterpret_cast<uint64_t>(&next) && quantity == 7);
+	}
+
+	// a writer publishing as fast as it can, a reader reading all along: every copy is consistent
+	{
+		DEBUGXRAY::LiveRegion region(16, 256, 4096);
+		std::atomic<bool> bStop{ false };
+		std::thread writer([&region, &bStop]() {
+			book::Level level;
+			DEBUGXRAY::LiveHandle handle = region.Register(level);
+			for (long i = 1; !bStop.load(std::memory_order_relaxed); ++i)
+			{
+				level.Set(i);
+				handle.Publish(level);
+			}
+		});
+		DEBUGXRAY::LiveReader reader;
+		std::string error;
+		CHECK(reader.Open(pid, error));
+		int reads = 0;
+		bool bConsistent = true;
+		long lastQuantity = 0;
+		const auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(300);
+		while (std::chrono::steady_clock::now() < until)
+		{
+			for (const DEBUGXRAY::LiveObject& object : reader.Read())
+			{
+				long quantity;
+				double notional;
+				unsigned updates;
+				std::memcpy(&quantity, object.payload.data(), sizeof(quantity));
+				std::memcpy(&notional, object.payload.data() + sizeof(quantity), sizeof(notional));
+				std::memcpy(&updates, object.payload.data() + sizeof(quantity) + sizeof(notional), sizeof(updates));
+				bConsistent = bConsistent && notional == quantity * 0.5 && updates == unsigned(quantity) && quantity >= lastQuantity;
+				lastQuantity = quantity;
+				++reads;
+			}
+		}
+		bStop = true;
+		writer.join();
+		CHECK(bConsistent);
+		CHECK(reads > 0);
+	}
+
+	// the cost on the owner's side
+	{
+		DEBUGXRAY::LiveRegion region(16, 256, 4096);
+		region.SetPublishInterval(0.1);
+		book::Level level;
+		DEBUGXRAY::LiveHandle handle = region.Register(level);
+		const int count = 1000000;
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < count; ++i)
+		{
+			level.Set(i);
+			handle.Publish(level);
+		}
+		const double publishNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / count;
+		handle = region.Register(level);
+		start = std::chrono::steady_clock::now();
+		for (int i = 0; i < count; ++i)
+		{
+			level.Set(i);
+			handle.MaybePublish(level);
+		}
+		const double maybeNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / count;
+		std::cout << "Publish: " << publishNs << " ns, MaybePublish: " << maybeNs << " ns per call\n";
+	}
+
+	if (!bError)
+		std::cout << "debugxray live: Test OK\n";
+	return bError ? 1 : 0;
+}
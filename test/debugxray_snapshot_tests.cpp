@@ -0,0 +1,182 @@
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "debugxray.h"
+
+#define CHECK(condition)	if (!(condition)) { std::cout << "FAILED: " << #condition << " at line " << __LINE__ << "\n"; bError = true; }
+
+namespace shop {
+
+class Order {
+public:
+	Order(int id, double price, const char* symbol) : id(id), price(price), bFilled(id % 2 == 0), note("order " + std::to_string(id)), next(nullptr)
+	{
+		std::snprintf(this->symbol, sizeof(this->symbol), "%s", symbol);
+	}
+	int Id() const { return id; }
+private:
+	int			id;
+	double		price;
+	bool		bFilled;
+	std::string	note;
+	char		symbol[8];
+	const Order*	next;
+
+friend DEBUGXRAY::DEBUGCLASS;
+};
+
+class Empty {
+
+friend DEBUGXRAY::DEBUGCLASS;
+};
+
+}
+
+// what classdecl_modifier --xray generates for the classes above (offsets as libclang reports them on x86-64)
+#include "debugxray_snapshot.h"
+
+namespace DEBUGXRAY {
+
+template <> inline const ClassFields& DEBUGCLASS::Fields<::shop::Order>()
+{
+	static const FieldInfo fields[] = {
+		DEBUGXRAY_FIELD(::shop::Order, id, "int", 0),
+		DEBUGXRAY_FIELD(::shop::Order, price, "double", 8),
+		DEBUGXRAY_FIELD(::shop::Order, bFilled, "bool", 16),
+		DEBUGXRAY_FIELD(::shop::Order, note, "std::string", 24),
+		DEBUGXRAY_FIELD(::shop::Order, symbol, "char[8]", 56),
+		DEBUGXRAY_FIELD(::shop::Order, next, "const shop::Order *", 64),
+	};
+	static const ClassFields table = MakeClassFields("shop::Order", sizeof(::shop::Order), fields);
+	return table;
+}
+template <> inline void DEBUGCLASS::Snapshot<::shop::Order>(const ::shop::Order& object, char* out)
+{
+	out = CaptureField(out, object.id);
+	out = CaptureField(out, object.price);
+	out = CaptureField(out, object.bFilled);
+	out = CaptureField(out, object.note);
+	out = CaptureField(out, object.symbol);
+	out = CaptureField(out, object.next);
+	(void)object;
+	(void)out;
+}
+
+template <> inline const ClassFields& DEBUGCLASS::Fields<::shop::Empty>()
+{
+	static const ClassFields table = { "shop::Empty", sizeof(::shop::Empty), nullptr, 0, 0 };
+	return table;
+}
+template <> inline void DEBUGCLASS::Snapshot<::shop::Empty>(const ::shop::Empty& object, char* out)
+{
+	(void)object;
+	(void)out;
+}
+
+}
+
+#include "debugxray_decode.h"
+
+bool DumpAndRead(const DEBUGXRAY::SnapshotRing& ring, DEBUGXRAY::SnapshotDump& dump)
+{
+	const std::string filename = "debugxray_snapshot_tests.dxray";
+	if (!ring.Dump(filename))
+		return false;
+	std::ifstream ifs(filename, std::ios::binary);
+	std::string error;
+	const bool bRead = DEBUGXRAY::ReadSnapshotDump(ifs, dump, error);
+	if (!bRead)
+		std::cout << "ReadSnapshotDump: " << error << "\n";
+	ifs.close();
+	std::remove(filename.c_str());
+	return bRead;
+}
+
+int main()
+{
+	bool bError = false;
+
+	const DEBUGXRAY::ClassFields& orderFields = DEBUGXRAY::DEBUGCLASS::Fields<shop::Order>();
+	CHECK(orderFields.count == 6);
+	CHECK(!orderFields.fields[3].bCaptured);					// std::string isn't trivially copyable
+	CHECK(orderFields.fields[4].size == 8);
+	CHECK(orderFields.capturedSize == sizeof(int) + sizeof(double) + sizeof(bool) + 8 + sizeof(void*));
+
+	// a few records, nothing overwritten: decoded as captured, in order
+	{
+		DEBUGXRAY::SnapshotRing ring(4096);
+		const shop::Order first(1, 10.5, "ABC");
+		const shop::Order second(2, -3.25, "XYZW");
+		ring.Capture(first);
+		ring.Capture(shop::Empty());
+		ring.Capture(second);
+		DEBUGXRAY::SnapshotDump dump;
+		CHECK(DumpAndRead(ring, dump));
+		CHECK(DEBUGXRAY::SnapshotRecords(dump).size() == 3);
+		std::ostringstream text;
+		DEBUGXRAY::PrintSnapshotRecords(dump, text);
+		const std::string decoded = text.str();
+		CHECK(decoded.find("shop::Order\n\tint id = 1\n\tdouble price = 10.500000\n\tbool bFilled = false\n\tstd::string note (not captured)\n"
+			"\tchar[8] symbol = {41 42 43 00 00 00 00 00}\n\tconst shop::Order * next = 0x0\n") != std::string::npos);
+		CHECK(decoded.find("shop::Empty\n") != std::string::npos);
+		CHECK(decoded.find("int id = 2\n\tdouble price = -3.250000\n\tbool bFilled = true\n") != std::string::npos);
+		CHECK(decoded.find("id = 1") < decoded.find("shop::Empty") && decoded.find("shop::Empty") < decoded.find("id = 2"));
+	}
+
+	// many threads, many wrap-arounds: what's left are the newest records, all of them complete
+	{
+		DEBUGXRAY::SnapshotRing ring(4096);
+		const int threads = 4, perThread = 20000;
+		std::vector<std::thread> workers;
+		for (int t = 0; t < threads; ++t)
+		{
+			workers.emplace_back([&ring, t]() {
+				for (int i = 0; i < perThread; ++i)
+				{
+					const shop::Order order(t * perThread + i, (t * perThread + i) * 0.5, "T");
+					ring.Capture(order);
+				}
+			});
+		}
+		for (auto& worker : workers)
+			worker.join();
+		DEBUGXRAY::SnapshotDump dump;
+		CHECK(DumpAndRead(ring, dump));
+		const auto records = DEBUGXRAY::SnapshotRecords(dump);
+		const size_t recordSize = (sizeof(DEBUGXRAY::SnapshotRecord) + orderFields.capturedSize + 7) / 8 * 8;
+		CHECK(records.size() > 4096 / recordSize - 2 && records.size() <= 4096 / recordSize);
+		CHECK(ring.BytesWritten() >= uint64_t(threads) * perThread * recordSize);
+		bool bConsistent = true;
+		for (const DEBUGXRAY::SnapshotRecord* record : records)
+		{
+			int id;
+			double price;
+			const char* payload = reinterpret_cast<const char*>(record) + sizeof(DEBUGXRAY::SnapshotRecord);
+			std::memcpy(&id, payload, sizeof(id));
+			std::memcpy(&price, payload + sizeof(id), sizeof(price));
+			bConsistent = bConsistent && price == id * 0.5 && record->position - 1 >= ring.BytesWritten() - 4096;
+		}
+		CHECK(bConsistent);
+	}
+
+	// the cost in the hot path
+	{
+		DEBUGXRAY::SnapshotRing ring(1 << 20);
+		const shop::Order order(7, 1.0, "HOT");
+		const int count = 1000000;
+		const auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < count; ++i)
+			ring.Capture(order);
+		const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / count;
+		std::cout << "Capture: " << ns << " ns per snapshot\n";
+	}
+
+	if (!bError)
+		std::cout << "debugxray snapshot: Test OK\n";
+	return bError ? 1 : 0;
+}
@@ -0,0 +1,62 @@
+#include <iostream>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <functional>
+
+// these defines have to precede #include "fpchecked.h"
+#define __DEBUG_CHECK_FLOAT									// this switch changes floato etc. typedefs back and forth between checked and plain versions
+#define __DEBUG_CHECK_FLOAT_ALIAS							// floato etc. typedefs can be turned off if not needed
+#define __DEBUG_CHECK_FLOAT_PRECISION_LOSS					// integer <-> floating point conversions are checked for lost precision as well
+#include "fpchecked.h"
+
+auto TryOrExcept = [](std::string description, std::function<std::string(void)> tryThis) {
+	try
+	{
+		std::cout << "Trying " << description << "...";
+		std::string result = tryThis();
+		std::cout << "OK! [" << result << "]\n";
+	}
+	catch (std::exception& e)
+	{
+		std::cout << "Exception: " << e.what() << std::endl;
+	}
+};
+
+volatile double zero = 0.0;
+
+int main()
+{
+	TryOrExcept("doubleo 1.5 * 2 + 1", []() { doubleo x = 1.5; double r = x * 2 + 1; return std::to_string(r); });
+	TryOrExcept("doubleo 1 / 0 (expect divbyzero)", []() { doubleo x = 1.0; double r = x / zero; return std::to_string(r); });
+	TryOrExcept("doubleo sqrt(-1) (expect invalid)", []() { doubleo x = -1.0; double r = std::sqrt(static_cast<double>(x)) + x; return std::to_string(r); });
+	TryOrExcept("floato 1e30f * 1e30f then 1/that (expect overflow, the result is a finite 0)", []() { floato x = 1e30f; double r = 1.0f / (x * x); return std::to_string(r); });
+	TryOrExcept("fpchecked_block around a loop with an overflow (expect overflow)", []() {
+		fpchecked_block block;
+		doubleo acc = 1.0;
+		for (int i = 0; i < 2000; ++i)
+			acc *= 2.0;												// no test per iteration
+		return std::string("not reached: ") + std::to_string(acc.raw());
+	});
+	TryOrExcept("fpchecked_block clean loop", []() {
+		fpchecked_block block;
+		doubleo acc = 0.0;
+		for (int i = 1; i < 1000; ++i)
+			acc += 1.0 / i;
+		block.Check();
+		return std::to_string(acc.raw());
+	});
+	TryOrExcept("fpchecked_block<float> around a float overflow (expect overflow reported for f)", []() {
+		fpchecked_block<float> block;
+		floato x = 1e30f;
+		floato y = x * x;
+		return std::string("not reached: ") + std::to_string(y.raw());
+	});
+	TryOrExcept("doubleo from int64 2^53+1 (expect precision loss)", []() { doubleo x = (int64_t(1) << 53) + 1; return std::to_string(x.raw()); });
+	TryOrExcept("doubleo from int64 2^60 (exact)", []() { doubleo x = int64_t(1) << 60; return std::to_string(x.raw()); });
+	TryOrExcept("int from doubleo 3.0", []() { doubleo x = 3.0; return std::to_string(static_cast<int>(x)); });
+	TryOrExcept("int from doubleo 3.5 (expect precision loss)", []() { doubleo x = 3.5; return std::to_string(static_cast<int>(x)); });
+	TryOrExcept("int from doubleo 3e9 (expect out of range)", []() { doubleo x = 3e9; return std::to_string(static_cast<int>(x)); });
+	TryOrExcept("uint64_t from doubleo 2^64 (expect out of range)", []() { doubleo x = 18446744073709551616.0; return std::to_string(static_cast<uint64_t>(x)); });
+}
@@ -0,0 +1,64 @@
+// The module versions of INTO, expires and debugxray, imported together. Build the interfaces first, with the
+// switches defined below, e.g. with GCC:
+//
+//		g++ -std=c++20 -fmodules-ts -D__DEBUG_CHECK_INTEGER_OVERFLOW -D__DEBUG_CHECK_INTEGER_OVERFLOW_ALIAS -Isrc -x c++ -c src/INTO/INTO.cppm src/expires/expires.cppm src/debugfriend/debugxray.cppm
+//		g++ -std=c++20 -fmodules-ts -Isrc test/lsct_modules_tests.cpp INTO.o expires.o debugxray.o
+
+#include <cstring>
+#include <iostream>
+
+// these defines have to precede #include "lsct_config.h", and match the ones the modules were built with
+#define __DEBUG_CHECK_INTEGER_OVERFLOW
+#define __DEBUG_CHECK_INTEGER_OVERFLOW_ALIAS
+#include "lsct_config.h"
+
+import lsct.into;
+import lsct.expires;
+import lsct.debugxray;
+
+#define CHECK(condition)	if (!(condition)) { std::cout << "FAILED: " << #condition << " at line " << __LINE__ << "\n"; bError = true; }
+
+// checked as of this TU's __DATE__, whenever the module was built
+__EXPIRES__("20991231");
+static_assert(!CodeExpiresFeature::ExpiresConditionCheck("20200101", __DATE__), "a date in the past has expired");
+static_assert(CodeExpiresFeature::ExpiresConditionCheck("20261020", "Oct 19 2026") && !CodeExpiresFeature::ExpiresConditionCheck("20261019", "Oct 19 2026"),
+	"expires the day it says");
+
+class Olive {
+	friend class DEBUGXRAY::DEBUGCLASS;
+	int m_pits = 3;
+};
+
+template <> const DEBUGXRAY::ClassFields& DEBUGXRAY::DEBUGCLASS::Fields<Olive>()
+{
+	static const DEBUGXRAY::FieldInfo fields[] = { { "m_pits", "int", 0, sizeof(int), true } };
+	static const DEBUGXRAY::ClassFields classFields = DEBUGXRAY::MakeClassFields("Olive", sizeof(Olive), fields);
+	return classFields;
+}
+
+template <> void DEBUGXRAY::DEBUGCLASS::Snapshot<Olive>(const Olive& object, char* out)
+{
+	std::memcpy(out, &object.m_pits, sizeof(int));
+}
+
+int main()
+{
+	bool bError = false;
+
+	llongo a = 5LL;
+	into b = 7;
+	CHECK(static_cast<long long>(a * b + llongo(1)) == 36);
+	bool bThrown = false;
+	try { into c = into(2147483647) + into(1); (void)c; }
+	catch (const INTO_exception& e) { bThrown = std::strstr(e.what(), "op+ overflow") != nullptr; }
+	CHECK(bThrown);
+
+	Olive olive;
+	int pits = 0;
+	DEBUGXRAY::DEBUGCLASS::Snapshot(olive, reinterpret_cast<char*>(&pits));
+	CHECK(pits == 3 && DEBUGXRAY::DEBUGCLASS::Fields<Olive>().capturedSize == sizeof(int));
+
+	if (!bError)
+		std::cout << "lsct modules: Test OK\n";
+	return bError ? 1 : 0;
+}
@@ -0,0 +1,122 @@
+// Compares glibc malloc/free with MemoryManager's pool and arena on a request-handling allocation pattern:
+// every request allocates a few dozen mixed-size blocks (parsed headers, strings, small nodes), frees most
+// of them in arbitrary order when it's done, and hands ~10% over to a session cache that outlives it.
+// Usage: memmanager_bench [requests] [threads]
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "memmanager.h"
+
+constexpr size_t ALLOCS_PER_REQUEST = 64;
+constexpr size_t SESSION_CACHE_SIZE = 4096;
+constexpr size_t SIZE_MIX[] = { 24, 24, 32, 48, 48, 64, 64, 96, 128, 200, 256, 512, 1500, 4000 };
+
+struct XorShift
+{
+	uint64_t state;
+	uint64_t operator()() { state ^= state << 13; state ^= state >> 7; state ^= state << 17; return state; }
+};
+
+struct MallocBackend
+{
+	static void* Allocate(size_t size) { return std::malloc(size); }
+	static void Deallocate(void* p) { std::free(p); }
+	static constexpr const char* NAME = "glibc malloc/free";
+};
+
+struct PoolBackend
+{
+	static void* Allocate(size_t size) { return MemoryManager::Allocate(size); }
+	static void Deallocate(void* p) { MemoryManager::Deallocate(p); }
+	static constexpr const char* NAME = "MemoryManager pool";
+};
+
+template <typename Backend>
+void ServeRequests(size_t requests, uint64_t seed)
+{
+	XorShift rng{ seed };
+	std::vector<void*> live(ALLOCS_PER_REQUEST);
+	std::vector<void*> sessionCache(SESSION_CACHE_SIZE, nullptr);
+	for (size_t r = 0; r < requests; ++r)
+	{
+		for (size_t i = 0; i < ALLOCS_PER_REQUEST; ++i)
+		{
+			const size_t size = SIZE_MIX[rng() % (sizeof(SIZE_MIX) / sizeof(SIZE_MIX[0]))];
+			live[i] = Backend::Allocate(size);
+			static_cast<char*>(live[i])[0] = static_cast<char>(i);		// touch it
+		}
+		for (size_t i = ALLOCS_PER_REQUEST; i > 1; --i)				// shuffle free order
+			std::swap(live[i - 1], live[rng() % i]);
+		for (size_t i = 0; i < ALLOCS_PER_REQUEST; ++i)
+		{
+			if (i < ALLOCS_PER_REQUEST / 10)
+			{
+				void*& slot = sessionCache[rng() % SESSION_CACHE_SIZE];
+				Backend::Deallocate(slot);
+				slot = live[i];
+			}
+			else
+				Backend::Deallocate(live[i]);
+		}
+	}
+	for (void* p : sessionCache)
+		Backend::Deallocate(p);
+}
+
+// the arena variant has no per-object frees at all: the request scope rewinds everything at once
+void ServeRequestsArena(size_t requests, uint64_t seed)
+{
+	XorShift rng{ seed };
+	MemoryManager::Arena arena;
+	std::vector<void*> sessionCache(SESSION_CACHE_SIZE, nullptr);
+	for (size_t r = 0; r < requests; ++r)
+	{
+		MemoryManager::ArenaScope scope(arena);
+		for (size_t i = 0; i < ALLOCS_PER_REQUEST; ++i)
+		{
+			const size_t size = SIZE_MIX[rng() % (sizeof(SIZE_MIX) / sizeof(SIZE_MIX[0]))];
+			void* p = i < ALLOCS_PER_REQUEST / 10 ? MemoryManager::Allocate(size) : arena.Allocate(size);
+			static_cast<char*>(p)[0] = static_cast<char>(i);
+			if (i < ALLOCS_PER_REQUEST / 10)
+			{
+				void*& slot = sessionCache[rng() % SESSION_CACHE_SIZE];
+				MemoryManager::Deallocate(slot);
+				slot = p;
+			}
+		}
+	}
+	for (void* p : sessionCache)
+		MemoryManager::Deallocate(p);
+}
+
+template <typename Fn>
+void Measure(const char* name, size_t requests, unsigned threads, Fn serve)
+{
+	const auto start = std::chrono::steady_clock::now();
+	std::vector<std::thread> workers;
+	for (unsigned t = 0; t < threads; ++t)
+		workers.emplace_back([=]() { serve(requests, 0x9E3779B97F4A7C15ull * (t + 1)); });
+	for (std::thread& w : workers)
+		w.join();
+	const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+	const double ops = double(requests) * threads * ALLOCS_PER_REQUEST;
+	std::cout << name << "\t" << threads << " thread(s)\t" << ns / ops << " ns/alloc+free\t" << ops / ns * 1e3 << " Mops/s\n";
+}
+
+int main(int argc, char* argv[])
+{
+	const size_t requests = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+	const unsigned maxThreads = argc > 2 ? static_cast<unsigned>(std::strtoul(argv[2], nullptr, 10)) : std::thread::hardware_concurrency();
+	for (unsigned threads = 1; threads <= (maxThreads ? maxThreads : 1); threads *= 2)
+	{
+		Measure(MallocBackend::NAME, requests, threads, ServeRequests<MallocBackend>);
+		Measure(PoolBackend::NAME, requests, threads, ServeRequests<PoolBackend>);
+		Measure("MemoryManager arena scope", requests, threads, ServeRequestsArena);
+	}
+}
@@ -0,0 +1,103 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <cstring>
+
+#include "memmanager.h"
+
+static int s_liveObjects = 0;
+
+struct Tracked {
+	Tracked() { ++s_liveObjects; }
+	explicit Tracked(int v) : value(v) { ++s_liveObjects; }
+	virtual ~Tracked() { --s_liveObjects; }
+	int value = 0;
+};
+
+struct Other { virtual ~Other() = default; int pad[5]; };
+struct Multi : Other, Tracked { Multi() : Tracked(7) {} std::string name = "multi"; };
+
+#define CHECK(condition)	if (!(condition)) { std::cout << "FAILED: " << #condition << " at line " << __LINE__ << "\n"; bError = true; }
+
+int main()
+{
+	bool bError = false;
+
+	// size class table round trip: every size maps to a class that is big enough and no class is skipped
+	for (size_t size = MemoryManager::details::HEADER_SIZE; size <= MemoryManager::details::MAX_POOLED_SIZE; ++size)
+	{
+		const uint32_t sizeClass = MemoryManager::details::SizeToClass(size);
+		CHECK(sizeClass < MemoryManager::details::NUM_SIZE_CLASSES);
+		CHECK(MemoryManager::details::ClassToSize(sizeClass) >= size);
+		CHECK(sizeClass == 0 || MemoryManager::details::ClassToSize(sizeClass - 1) < size);
+		if (bError) break;
+	}
+
+	{
+		Tracked* t = LSCT_NEW(Tracked, 42);
+		CHECK(t->value == 42 && s_liveObjects == 1);
+		CHECK(reinterpret_cast<uintptr_t>(t) % alignof(std::max_align_t) == 0);
+		LSCT_DELETE(t);
+		CHECK(s_liveObjects == 0);
+
+		Tracked* base = LSCT_NEW(Multi);							// non-first base: Delete has to find the real block start
+		CHECK(base->value == 7);
+		LSCT_DELETE(base);
+		CHECK(s_liveObjects == 0);
+
+		Tracked* arr = LSCT_NEW_ARRAY(Tracked, 10);
+		CHECK(s_liveObjects == 10);
+		LSCT_DELETE_ARRAY(arr);
+		CHECK(s_liveObjects == 0);
+
+		char* big = LSCT_NEW_ARRAY(char, 1 << 20);					// beyond the pooled sizes
+		std::memset(big, 1, 1 << 20);
+		LSCT_DELETE_ARRAY(big);
+	}
+
+	{
+		MemoryManager::Arena arena(1024);
+		void* before = arena.Allocate(16);
+		{
+			MemoryManager::ArenaScope scope(arena);
+			for (int i = 0; i < 1000; ++i)							// spills over many chunks
+			{
+				Tracked* t = LSCT_ARENA_NEW(Tracked, i);
+				CHECK(t->value == i);
+				if (i % 2) LSCT_DELETE(t);							// destructor runs, memory stays with the arena
+			}
+			CHECK(s_liveObjects == 500);
+		}
+		s_liveObjects = 0;
+		CHECK(arena.Allocate(16) == static_cast<char*>(before) + 16);	// rewound to the scope entry
+		Tracked* noScope = LSCT_ARENA_NEW(Tracked, 1);				// no active scope: comes from the pool
+		LSCT_DELETE(noScope);
+	}
+
+	{
+		MemoryManager::ObjectPool<Tracked, 8> pool;
+		std::vector<Tracked*> objs;
+		for (int i = 0; i < 100; ++i)
+			objs.push_back(pool.Create(i));
+		CHECK(s_liveObjects == 100);
+		for (Tracked* t : objs)
+			pool.Destroy(t);
+		CHECK(s_liveObjects == 0);
+		CHECK(pool.Create(5) == objs.back());						// LIFO reuse
+		s_liveObjects = 0;
+	}
+
+	{
+		// allocate on one thread, free on another
+		std::vector<std::string*> produced;
+		std::thread producer([&]() { for (int i = 0; i < 10000; ++i) produced.push_back(LSCT_NEW(std::string, std::to_string(i))); });
+		producer.join();
+		std::thread consumer([&]() { for (std::string* s : produced) LSCT_DELETE(s); });
+		consumer.join();
+	}
+
+	if (!bError)
+		std::cout << "memmanager: Test OK\n";
+	return bError ? 1 : 0;
+}
@@ -0,0 +1,131 @@
+#!/bin/sh
+# Compile-time cost of the header versions of INTO, expires and debugxray against their module versions
+# (import lsct.into; import lsct.expires; import lsct.debugxray;) on a many-TU project.
+#
+# Generates TUS translation units (64 by default), each one using every INTO alias type with all four operators,
+# an __EXPIRES__ and a class that befriends DEBUGXRAY::DEBUGCLASS, once with #include and once with import, and
+# compiles them one by one at -O0 and -O2. The module interface units are compiled first and counted in the
+# module total. GCC needs -fmodules-ts (GCC 11 and later); clang++ (16 and later) precompiles the interfaces to
+# .pcm files and also writes -ftime-trace JSONs, whose frontend totals are summed over the TUs.
+#
+#		test/modules_compiletime_bench.sh [TUS]
+#		CXX=clang++ test/modules_compiletime_bench.sh [TUS]
+
+set -e
+TUS=${1:-64}
+CXX=${CXX:-c++}
+SRC=$(cd "$(dirname "$0")/../src" && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+case $("$CXX" --version 2>/dev/null | head -n 1) in
+	*clang*) CLANG=1 ;;
+	*) CLANG=0 ;;
+esac
+
+SWITCHES="-D__DEBUG_CHECK_INTEGER_OVERFLOW -D__DEBUG_CHECK_INTEGER_OVERFLOW_ALIAS"
+
+i=0
+while [ $i -lt "$TUS" ]; do
+	for variant in header module; do
+		if [ $variant = header ]; then
+			prologue='#include "INTO/INTO.h"
+#include "expires/expires.h"
+#include "debugfriend/debugxray.h"'
+		else
+			prologue='#include "lsct_config.h"
+import lsct.into;
+import lsct.expires;
+import lsct.debugxray;'
+		fi
+		cat > "$WORK/${variant}$i.cpp" <<EOF
+$prologue
+
+__EXPIRES__("20991231");
+
+class Holder$i {
+	friend class DEBUGXRAY::DEBUGCLASS;
+	llongo m_total = 0LL;
+public:
+	void Add(llongo value) { m_total = m_total + value; }
+};
+
+template <typename T> T Work$i(T a, T b, T c) { return (a + b) * c - a / (b + T(1)); }
+
+long long Tu$i(int n)
+{
+	long long sum = 0;
+	sum += Work$i<charo>(charo(n % 8), charo(2), charo(3));
+	sum += Work$i<scharo>(scharo(n % 8), scharo(2), scharo(3));
+	sum += Work$i<ucharo>(ucharo(n % 8), ucharo(2), ucharo(3));
+	sum += Work$i<shorto>(shorto(n % 100), shorto(2), shorto(3));
+	sum += Work$i<ushorto>(ushorto(n % 100), ushorto(2), ushorto(3));
+	sum += Work$i<into>(into(n), into(2), into(3));
+	sum += Work$i<uinto>(uinto(n), uinto(2), uinto(3));
+	sum += Work$i<longo>(longo(n), longo(2), longo(3));
+	sum += Work$i<ulongo>(ulongo(n), ulongo(2), ulongo(3));
+	sum += Work$i<llongo>(llongo(n), llongo(2), llongo(3));
+	sum += Work$i<ullongo>(ullongo(n), ullongo(2), ullongo(3));
+	Holder$i holder;
+	holder.Add(llongo(sum));
+	return sum;
+}
+EOF
+	done
+	i=$((i + 1))
+done
+
+now_ms() { echo $(($(date +%s%N) / 1000000)); }
+
+# $1: header or module, $2: optimization
+run() {
+	variant=$1; opt=$2
+	rm -rf "$WORK"/*.json "$WORK"/*.o "$WORK"/*.pcm "$WORK/gcm.cache"
+	flags="-std=c++20 $opt -I$SRC $SWITCHES"
+	[ $CLANG -eq 1 ] && flags="$flags -ftime-trace"
+	start=$(now_ms)
+	if [ $variant = module ]; then
+		for unit in INTO/INTO expires/expires debugfriend/debugxray; do
+			name=$(basename $unit)
+			if [ $CLANG -eq 1 ]; then
+				module=lsct.$(echo "$name" | tr 'A-Z' 'a-z')
+				"$CXX" $flags --precompile -x c++-module "$SRC/$unit.cppm" -o "$WORK/$module.pcm"
+				"$CXX" $flags -c "$WORK/$module.pcm" -o "$WORK/$name.o"
+			else
+				(cd "$WORK" && "$CXX" $flags -fmodules-ts -x c++ -c "$SRC/$unit.cppm" -o "$WORK/$name.o")
+			fi
+		done
+		if [ $CLANG -eq 1 ]; then
+			flags="$flags -fprebuilt-module-path=$WORK"
+		else
+			flags="$flags -fmodules-ts"
+		fi
+	fi
+	i=0
+	while [ $i -lt "$TUS" ]; do
+		(cd "$WORK" && "$CXX" $flags -c "$WORK/${variant}$i.cpp" -o "$WORK/${variant}$i.o")
+		i=$((i + 1))
+	done
+	end=$(now_ms)
+	printf '%-8s %-4s %8d ms' "$variant" "$opt" $((end - start))
+	if [ $CLANG -eq 1 ]; then
+		python3 - "$WORK" <<'EOF'
+import glob, json, sys
+totals = {}
+for path in glob.glob(sys.argv[1] + "/*.json"):
+	for event in json.load(open(path))["traceEvents"]:
+		if event.get("name", "").startswith("Total "):
+			totals[event["name"]] = totals.get(event["name"], 0) + event.get("dur", 0)
+print("".join("   %s %d ms" % (name[6:], totals.get(name, 0) // 1000) for name in
+	("Total Frontend", "Total Source", "Total InstantiateClass", "Total InstantiateFunction", "Total Backend")))
+EOF
+	else
+		echo
+	fi
+}
+
+echo "$TUS TUs, $CXX"
+for opt in -O0 -O2; do
+	run header $opt
+	run module $opt
+done
@@ -0,0 +1,100 @@
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+// input for newsite_analyzer: the comments tell what each site is expected to be classified as
+
+struct Point
+{
+	double x, y;
+	Point(double x, double y) : x(x), y(y) {}
+};
+
+struct Shape
+{
+	virtual ~Shape() = default;
+	virtual double Area() const = 0;
+};
+
+struct Square : Shape
+{
+	double side = 1;
+	double Area() const override { return side * side; }
+};
+
+struct Big
+{
+	char data[8192];
+};
+
+std::vector<Shape*> registry;
+
+Shape* Make()
+{
+	return new Square;										// loop depth 0, escaping: returned
+}
+
+double Sum(const std::vector<double>& values)
+{
+	double sum = 0;
+	for (size_t i = 0; i < values.size(); ++i)
+	{
+		Point* p = new Point(values[i], 1.0);				// loop depth 1, freed in scope -> stack, applied
+		sum += p->x * p->y;
+		delete p;
+	}
+	return sum;
+}
+
+double Areas(int n)
+{
+	double area = 0;
+	for (int i = 0; i < n; ++i)
+	{
+		for (int j = 0; j < n; ++j)
+		{
+			std::unique_ptr<Square> square(new Square());	// loop depth 2, local unique_ptr -> stack, applied
+			square->side = i + j;
+			area += square->Area();
+			std::unique_ptr<Shape> shape(new Square);		// loop depth 2, local unique_ptr -> stack (held through another type)
+			area += shape->Area();
+			registry.push_back(new Square);					// loop depth 2, escaping -> pool
+		}
+	}
+	return area;
+}
+
+int Buffers(int n)
+{
+	int total = 0;
+	while (n-- > 0)
+	{
+		int* counts = new int[16];							// loop depth 1, freed in scope -> arena
+		counts[0] = n;
+		total += counts[0];
+		delete[] counts;
+		Big* big = new Big;									// loop depth 1, freed in scope -> arena (8192 bytes)
+		big->data[0] = 1;
+		total += big->data[0];
+		delete big;
+		Point* q = new (std::nothrow) Point(1, 2);			// loop depth 1, escaping (deleted conditionally)
+		if (q)
+			delete q;
+	}
+	alignas(Point) unsigned char storage[sizeof(Point)];
+	Point* placed = new (storage) Point(3, 4);				// placement new, left out
+	total += static_cast<int>(placed->x);
+	std::string* name = new std::string("name");			// loop depth 0, freed in scope -> stack, not applied: the delete is not the last statement
+	int length = static_cast<int>(name->size());
+	delete name;
+	return total + length;
+}
+
+int main()
+{
+	delete Make();
+	for (Shape* shape : registry)
+		delete shape;
+	return static_cast<int>(Sum({ 1.0, 2.0 }) + Areas(2) + Buffers(2));
+}
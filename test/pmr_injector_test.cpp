@@ -0,0 +1,53 @@
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+// input for pmr_injector: the comments tell what each member is expected to become
+
+double Total(const std::map<int, double>& prices)
+{
+	double total = 0;
+	for (const auto& price : prices)
+		total += price.second;
+	return total;
+}
+
+class Order
+{
+public:
+	explicit Order(std::string id) : m_id(std::move(id)) {}
+	Order(const Order& other) : m_id(other.m_id), m_quantities(other.m_quantities), m_note(other.m_note) {}
+
+	const std::string& Id() const { return m_id; }					// accessor: needs m_id to stay std::string
+	const std::vector<int>& Lines() const { return m_lines; }		// accessor: needs m_lines to stay std::vector<int>
+	const auto& Quantities() const { return m_quantities; }			// deduced, follows the member
+	size_t Count() const { return m_quantities.size(); }
+	double Reprice() const { return Total(m_prices); }				// needs m_prices to stay std::map
+	void Reset(const std::vector<int>& lines) { m_history = lines; }	// needs m_history to stay std::vector<int>
+	bool Urgent() const { return m_note == "urgent"; }
+	void Note(const char* note) { m_note += note; }
+
+private:
+	std::string				m_id;				// not rewritten: returned as const std::string&
+	std::vector<int>		m_lines;			// not rewritten: returned as const std::vector<int>&
+	std::vector<long>		m_quantities;		// rewritten to std::pmr::vector<long>
+	std::map<int, double>	m_prices;			// not rewritten: passed as const std::map<int, double>&
+	std::vector<int>		m_history;			// not rewritten: assigned a std::vector<int>
+	std::string				m_note;				// rewritten to std::pmr::string
+};
+
+std::string Describe(const Order& order)
+{
+	const std::string& id = order.Id();
+	return id + ": " + std::to_string(order.Count());
+}
+
+int main()
+{
+	Order order("A-1");
+	order.Reset({ 1, 2, 3 });
+	order.Note("urgent");
+	Order copy(order);
+	return static_cast<int>(Describe(copy).size() + copy.Lines().size() + copy.Quantities().size() + (copy.Urgent() ? 1 : 0) + copy.Reprice());
+}
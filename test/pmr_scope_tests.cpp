@@ -0,0 +1,137 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "pmr_scope.h"
+
+#define CHECK(condition)	if (!(condition)) { std::cout << "FAILED: " << #condition << " at line " << __LINE__ << "\n"; bError = true; }
+
+// every heap allocation of the test, to see what the scopes save
+std::atomic<size_t> heapAllocations{ 0 };
+void* operator new(size_t size)
+{
+	heapAllocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* p = std::malloc(size ? size : 1))
+		return p;
+	throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+// a class as it is before pmr_injector
+class Session {
+public:
+	explicit Session(const std::string& user) : user(user) {}
+	void Handle(int request)
+	{
+		char key[16], tag[64];
+		for (int i = 0; i < 50; ++i)
+		{
+			history.push_back(request * 100 + i);
+			std::snprintf(key, sizeof(key), "%d", i);
+			std::snprintf(tag, sizeof(tag), "tag for request number %d", request);
+			tags[key] = tag;
+		}
+	}
+private:
+	std::string									user;
+	std::vector<int>							history;
+	std::unordered_map<std::string, std::string>	tags;
+};
+
+// and after it
+class PmrSession {
+public:
+	explicit PmrSession(const std::string& user, std::pmr::memory_resource* resource = MemoryManager::CurrentResource()) : user(user, resource), history(resource), tags(resource) {}
+	void Handle(int request)
+	{
+		char key[16], tag[64];
+		for (int i = 0; i < 50; ++i)
+		{
+			history.push_back(request * 100 + i);
+			std::snprintf(key, sizeof(key), "%d", i);
+			std::snprintf(tag, sizeof(tag), "tag for request number %d", request);
+			tags[std::pmr::string(key, tags.get_allocator())] = tag;
+		}
+	}
+	std::pmr::memory_resource* Resource() const { return history.get_allocator().resource(); }
+	size_t TagCount() const { return tags.size(); }
+private:
+	std::pmr::string									user;
+	std::pmr::vector<int>								history;
+	std::pmr::unordered_map<std::pmr::string, std::pmr::string>	tags;
+};
+
+int main()
+{
+	bool bError = false;
+
+	// scopes nest, the current resource follows them
+	{
+		CHECK(MemoryManager::CurrentResource() == std::pmr::get_default_resource());
+		MemoryManager::MonotonicScope outer;
+		CHECK(MemoryManager::CurrentResource() == outer.Resource());
+		PmrSession first("first");
+		CHECK(first.Resource() == outer.Resource());
+		{
+			MemoryManager::MonotonicScope inner(1024);
+			PmrSession second("second");
+			CHECK(second.Resource() == inner.Resource());
+			second.Handle(1);
+			CHECK(second.TagCount() == 50);
+			CHECK(inner.UpstreamBytes() > 0);				// from the outer scope
+		}
+		CHECK(MemoryManager::CurrentResource() == outer.Resource());
+		PmrSession explicitResource("third", std::pmr::new_delete_resource());
+		CHECK(explicitResource.Resource() == std::pmr::new_delete_resource());
+	}
+	CHECK(MemoryManager::CurrentResource() == std::pmr::get_default_resource());
+
+	// a warmed-up thread doesn't go to the heap for a request any more
+	{
+		const int requests = 20000;
+		for (int warmup = 0; warmup < 3; ++warmup)
+		{
+			MemoryManager::MonotonicScope scope(1024);
+			PmrSession session("warmup");
+			session.Handle(warmup);
+		}
+		const size_t pmrBefore = heapAllocations.load();
+		auto start = std::chrono::steady_clock::now();
+		size_t upstreamBytes = 0;
+		for (int r = 0; r < requests; ++r)
+		{
+			MemoryManager::MonotonicScope scope;
+			PmrSession session("user");
+			session.Handle(r);
+			upstreamBytes += scope.UpstreamBytes();
+		}
+		const double pmrNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / requests;
+		const size_t pmrAllocations = heapAllocations.load() - pmrBefore;
+
+		const size_t stdBefore = heapAllocations.load();
+		start = std::chrono::steady_clock::now();
+		for (int r = 0; r < requests; ++r)
+		{
+			Session session("user");
+			session.Handle(r);
+		}
+		const double stdNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / requests;
+		const size_t stdAllocations = heapAllocations.load() - stdBefore;
+
+		CHECK(upstreamBytes == 0);
+		CHECK(pmrAllocations == 0);
+		std::cout << "per request: " << double(stdAllocations) / requests << " heap allocations, " << stdNs << " ns with std containers; "
+			<< double(pmrAllocations) / requests << " heap allocations, " << pmrNs << " ns with pmr containers in a MonotonicScope\n";
+	}
+
+	if (!bError)
+		std::cout << "pmr_scope: Test OK\n";
+	return bError ? 1 : 0;
+}